@@ -24,7 +24,11 @@
  ********************************************************************************************************
  */
 
-
+                                                                /* Listing both a TPM and a host library in INIT      */
+                                                                /* builds both into one image. Each operation below   */
+                                                                /* is then routed to its configured backend at init,  */
+                                                                /* falling back to the host library if the TPM is not */
+                                                                /* found or does not support the operation.           */
 #define OCKAM_VAULT_CFG_INIT               
 
 #define OCKAM_VAULT_CFG_RAND               
@@ -38,4 +42,158 @@
 #define OCKAM_VAULT_CFG_AES_GCM            
 
 
+/*
+ ********************************************************************************************************
+ *                                          Routing Thresholds                                          *
+ ********************************************************************************************************
+ */
+
+                                                                /* Only used when dispatching. SHA256, HKDF and AES   */
+                                                                /* GCM inputs of at least this many bytes go to the   */
+                                                                /* host library even when routed to the TPM. Set to a */
+                                                                /* byte count, OCKAM_VAULT_SIZE_AUTO to measure on the*/
+                                                                /* first init in the process or OCKAM_VAULT_SIZE_NEVER*/
+                                                                /* to keep them on the TPM. Keys held in the TPM never*/
+                                                                /* leave it.                                          */
+#define OCKAM_VAULT_CFG_SHA256_HOST_SIZE        OCKAM_VAULT_SIZE_AUTO
+
+#define OCKAM_VAULT_CFG_HKDF_HOST_SIZE          OCKAM_VAULT_SIZE_AUTO
+
+#define OCKAM_VAULT_CFG_AES_GCM_HOST_SIZE       OCKAM_VAULT_SIZE_AUTO
+
+
+/*
+ ********************************************************************************************************
+ *                                            TPM Failover                                              *
+ ********************************************************************************************************
+ */
+
+                                                                /* After this many TPM failures in a row, TPM calls   */
+                                                                /* fail fast with OCKAM_ERR_VAULT_TPM_DOWN until the  */
+                                                                /* retry time has passed. One call is then let through*/
+                                                                /* to test the TPM. When dispatching, calls that do   */
+                                                                /* not use a key held in the TPM are rerun on the host*/
+                                                                /* library instead of failing.                        */
+#define OCKAM_VAULT_CFG_TPM_FAIL_LIMIT          3u
+
+#define OCKAM_VAULT_CFG_TPM_RETRY_MS            5000u
+
+
+/*
+ ********************************************************************************************************
+ *                                              Host DRBG                                               *
+ ********************************************************************************************************
+ */
+
+                                                                /* Number of CTR DRBGs in each host library instance. */
+                                                                /* Each thread is given one of them and they are all  */
+                                                                /* seeded and reseeded on their own, so random and key*/
+                                                                /* calls from different threads rarely wait on each   */
+                                                                /* other. Around one per core is a good choice.       */
+#define OCKAM_VAULT_CFG_HOST_DRBG_COUNT         4u
+
+                                                                /* Engine behind each host DRBG. ChaCha20 is several  */
+                                                                /* times faster than CTR_DRBG on CPUs without AES     */
+                                                                /* instructions. Needs MBEDTLS_CHACHA20_C.            */
+#define OCKAM_VAULT_CFG_HOST_DRBG               OCKAM_VAULT_HOST_DRBG_CTR
+
+                                                                /* Only used when dispatching with a TPM fitted. Where*/
+                                                                /* the host DRBGs get their seeds:                    */
+                                                                /*  - OCKAM_VAULT_HOST_SEED_PLATFORM: platform only.  */
+                                                                /*  - OCKAM_VAULT_HOST_SEED_TPM_MIX: every seed needs */
+                                                                /*    32 bytes from the TPM and from the platform.    */
+                                                                /*  - OCKAM_VAULT_HOST_SEED_TPM_ONLY: seeds come from */
+                                                                /*    the TPM alone, so init does not wait on platform*/
+                                                                /*    entropy early in boot.                          */
+                                                                /* With either TPM mode, seeding falls back to        */
+                                                                /* platform entropy only while the TPM is down. Route */
+                                                                /* OCKAM_VAULT_CFG_RAND to the host library to then   */
+                                                                /* serve random numbers at memory speed.              */
+#define OCKAM_VAULT_CFG_HOST_SEED_TPM           OCKAM_VAULT_HOST_SEED_PLATFORM
+
+                                                                /* Random requests each host DRBG serves between      */
+                                                                /* reseeds. 10000 is the default value.               */
+#define OCKAM_VAULT_CFG_HOST_RESEED_INTERVAL    10000u
+
+
+/*
+ ********************************************************************************************************
+ *                                          Ephemeral Key Pool                                          *
+ ********************************************************************************************************
+ */
+
+                                                                /* Number of keypairs the host library generates ahead*/
+                                                                /* of time. Ephemeral key generation and new key      */
+                                                                /* handles take a ready key from the pool and only    */
+                                                                /* generate inline when it is empty. The pool is      */
+                                                                /* refilled by ockam_vault_key_pool_fill(), or by the */
+                                                                /* refill thread once it is down to the low-water     */
+                                                                /* mark below. Set to 0 to generate every key inline. */
+#define OCKAM_VAULT_CFG_KEY_POOL_SIZE           4u
+
+#define OCKAM_VAULT_CFG_KEY_POOL_LOW            2u
+
+
+/*
+ ********************************************************************************************************
+ *                                            Peer Key Cache                                            *
+ ********************************************************************************************************
+ */
+
+                                                                /* Number of peer public keys the host library keeps  */
+                                                                /* decoded for ECDH. Repeat ECDH with a known peer    */
+                                                                /* skips decoding and checking its key. The least     */
+                                                                /* recently used key is replaced when the cache is    */
+                                                                /* full. Set to 0 to decode the key on every call.    */
+#define OCKAM_VAULT_CFG_PEER_CACHE_SIZE         64u
+
+
+/*
+ ********************************************************************************************************
+ *                                            Random Buffer                                             *
+ ********************************************************************************************************
+ */
+
+                                                                /* Random requests under 32 bytes are served from a   */
+                                                                /* buffer of this many bytes instead of going to the  */
+                                                                /* TPM or DRBG. Each thread is given one of the       */
+                                                                /* buffers. Buffers are filled ahead of time by       */
+                                                                /* ockam_vault_random_refill(), or by the refill      */
+                                                                /* thread once one is down to the low-water mark. A   */
+                                                                /* buffer that runs short only gets one 32 byte chunk */
+                                                                /* inline. Set the size to 0 to send every request to */
+                                                                /* the backend.                                       */
+#define OCKAM_VAULT_CFG_RAND_BUF_SIZE           512u
+
+#define OCKAM_VAULT_CFG_RAND_BUF_COUNT          4u
+
+#define OCKAM_VAULT_CFG_RAND_BUF_LOW            256u
+
+
+/*
+ ********************************************************************************************************
+ *                                          Background Refill                                           *
+ ********************************************************************************************************
+ */
+
+                                                                /* Set to 1 to give each vault instance a KAL thread  */
+                                                                /* that refills the ephemeral key pool and random     */
+                                                                /* buffers whenever they drop to their low-water      */
+                                                                /* marks. The thread is stopped by ockam_vault_free().*/
+#define OCKAM_VAULT_CFG_REFILL_EN               1u
+
+
+/*
+ ********************************************************************************************************
+ *                                          Per-Thread Lock Options                                     *
+ ********************************************************************************************************
+ */
+
+                                                                /* Number of threads that can hold their own lock     */
+                                                                /* options on a vault instance at the same time, set  */
+                                                                /* with ockam_vault_lock_opt_set(). Other threads use */
+                                                                /* the lock options given at init. 0 disables it.     */
+#define OCKAM_VAULT_CFG_LOCK_OPT_THREADS        4u
+
+
 #endif
@@ -37,6 +37,13 @@ typedef enum {
     OCKAM_ERR_INVALID_SIZE                            = 0x0013, /*!< Invalid size specified                           */
     OCKAM_ERR_UNIMPLEMENTED                           = 0x0014, /*!< Function has not yet been implemented            */
 
+    OCKAM_ERR_KAL_INIT_FAIL                           = 0x0041, /*!< OS object could not be created                   */
+    OCKAM_ERR_KAL_LOCK_FAIL                           = 0x0042, /*!< Mutex could not be acquired or released          */
+    OCKAM_ERR_KAL_TIMEOUT                             = 0x0043, /*!< Timed out waiting on an OS object                */
+    OCKAM_ERR_KAL_QUEUE_EMPTY                         = 0x0044, /*!< Non-blocking pop on an empty queue               */
+    OCKAM_ERR_KAL_QUEUE_FULL                          = 0x0045, /*!< Non-blocking push on a full queue                */
+    OCKAM_ERR_KAL_TIME_FAIL                           = 0x0046, /*!< The monotonic clock could not be read            */
+
     OCKAM_ERR_MEM_INSUFFICIENT                        = 0x0080, /*!< Insufficent space for a memory allocation        */
     OCKAM_ERR_MEM_INVALID_PTR                         = 0x0081, /*!< The specified buffer is not a managed buffer     */
     OCKAM_ERR_MEM_UNAVAIL                             = 0x0082, /*!< The requested memory size is not available       */
@@ -47,6 +54,12 @@ typedef enum {
     OCKAM_ERR_VAULT_INVALID_KEY_SIZE                  = 0x0104, /*!< Supplied keysize is invalid for call             */
     OCKAM_ERR_VAULT_INVALID_BUFFER                    = 0x0105, /*!< Supplied buffer is null                          */
     OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE               = 0x0106, /*!< Supplied buffer size is invalid for call         */
+    OCKAM_ERR_VAULT_ASYNC_STOPPED                     = 0x0107, /*!< Async worker was asked to stop                   */
+    OCKAM_ERR_VAULT_INVALID_STATE                     = 0x0108, /*!< Call made out of order for a streaming operation */
+    OCKAM_ERR_VAULT_BUSY                              = 0x0109, /*!< Vault or TPM in use and the call would not wait  */
+    OCKAM_ERR_VAULT_CANCELLED                         = 0x010A, /*!< Request was cancelled before it completed        */
+    OCKAM_ERR_VAULT_DEADLINE                          = 0x010B, /*!< Request deadline passed before it could start    */
+    OCKAM_ERR_VAULT_LOCK_OPT_FULL                     = 0x010C, /*!< Too many threads have their own lock options     */
 
     OCKAM_ERR_VAULT_TPM_INIT_FAIL                     = 0x0201, /*!< TPM failed to initialize                         */
     OCKAM_ERR_VAULT_TPM_RAND_FAIL                     = 0x0202, /*!< Random number generator failure                  */
@@ -60,6 +73,8 @@ typedef enum {
     OCKAM_ERR_VAULT_TPM_UNLOCKED                      = 0x020A, /*!< The hardware configuration is unlocked           */
     OCKAM_ERR_VAULT_TPM_UNSUPPORTED_IFACE             = 0x020B, /*!< The specified interface is not supported         */
     OCKAM_ERR_VAULT_TPM_AES_GCM_DECRYPT_INVALID       = 0x020C, /*!< AES GCM tag invalid for decryption               */
+    OCKAM_ERR_VAULT_TPM_UNSUPPORTED                   = 0x020D, /*!< Operation is not supported by the hardware       */
+    OCKAM_ERR_VAULT_TPM_DOWN                          = 0x020E, /*!< TPM skipped after repeated failures              */
 
     OCKAM_ERR_VAULT_HOST_INIT_FAIL                    = 0x0301, /*!< Host software library failed to initialize       */
     OCKAM_ERR_VAULT_HOST_RAND_FAIL                    = 0x0302, /*!< Random number failed to generate on host         */
@@ -38,6 +38,8 @@
  ********************************************************************************************************
  */
 
+#define OCKAM_KAL_ONCE_INIT                         { 0 }       /* Static initializer for OCKAM_KAL_ONCE              */
+
 /*
  ********************************************************************************************************
  *                                               CONSTANTS                                              *
@@ -79,6 +81,18 @@ typedef struct {
 } OCKAM_KAL_MUTEX;
 
 
+/**
+ *******************************************************************************
+ * @struct  OCKAM_KAL_RWLOCK
+ * @brief   Kernel abstraction layer for reader-writer lock
+ *******************************************************************************
+ */
+
+typedef struct {
+    void *rwlock_ptr;                                           /*!< Void* for the reader-writer lock                 */
+} OCKAM_KAL_RWLOCK;
+
+
 /**
  *******************************************************************************
  * @struct  OCKAM_KAL_QUEUE
@@ -91,6 +105,51 @@ typedef struct {
 } OCKAM_KAL_QUEUE;
 
 
+/**
+ *******************************************************************************
+ * @struct  OCKAM_KAL_THREAD
+ * @brief   Kernel abstraction layer for thread
+ *******************************************************************************
+ */
+
+typedef struct {
+    void *thread_ptr;                                           /*!< Void* for the thread                             */
+} OCKAM_KAL_THREAD;
+
+
+/**
+ *******************************************************************************
+ * @typedef OCKAM_KAL_THREAD_FN
+ * @brief   Function run by a thread started with ockam_kal_thread_create()
+ *******************************************************************************
+ */
+
+typedef void (*OCKAM_KAL_THREAD_FN)(void *p_arg);
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_KAL_ONCE
+ * @brief   Kernel abstraction layer for one-time initialization. Must be
+ *          statically initialized with OCKAM_KAL_ONCE_INIT.
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint32_t done;                                              /*!< Set once the init function has succeeded         */
+} OCKAM_KAL_ONCE;
+
+
+/**
+ *******************************************************************************
+ * @typedef OCKAM_KAL_ONCE_FN
+ * @brief   Init function run by ockam_kal_once()
+ *******************************************************************************
+ */
+
+typedef OCKAM_ERR (*OCKAM_KAL_ONCE_FN)(void);
+
+
 /*
  ********************************************************************************************************
  ********************************************************************************************************
@@ -122,6 +181,27 @@ OCKAM_ERR  ockam_kal_mutex_unlock (OCKAM_KAL_MUTEX *p_mutex,
                                    OCKAM_KAL_OPT opt);
 
 
+/*
+ ********************************************************************************************************
+ *                                              RWLOCK                                                  *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR  ockam_kal_rwlock_init (OCKAM_KAL_RWLOCK *p_rwlock);
+
+OCKAM_ERR  ockam_kal_rwlock_free (OCKAM_KAL_RWLOCK *p_rwlock);
+
+OCKAM_ERR  ockam_kal_rwlock_read_lock (OCKAM_KAL_RWLOCK *p_rwlock,
+                                       OCKAM_KAL_OPT opt,
+                                       uint32_t timeout_ms);
+
+OCKAM_ERR  ockam_kal_rwlock_write_lock (OCKAM_KAL_RWLOCK *p_rwlock,
+                                        OCKAM_KAL_OPT opt,
+                                        uint32_t timeout_ms);
+
+OCKAM_ERR  ockam_kal_rwlock_unlock (OCKAM_KAL_RWLOCK *p_rwlock);
+
+
 /*
  ********************************************************************************************************
  *                                              QUEUE                                                   *
@@ -134,12 +214,41 @@ OCKAM_ERR  ockam_kal_queue_init (OCKAM_KAL_QUEUE *p_queue,
 OCKAM_ERR  ockam_kal_queue_free (OCKAM_KAL_QUEUE *p_queue);
 
 OCKAM_ERR  ockam_kal_queue_pop (OCKAM_KAL_QUEUE *p_queue,
+                                void **p_item,
                                 OCKAM_KAL_OPT opt,
                                 uint32_t timeout_ms);
 
 OCKAM_ERR  ockam_kal_queue_push (OCKAM_KAL_QUEUE *p_queue,
+                                 void *p_item,
                                  OCKAM_KAL_OPT opt);
 
+
+/*
+ ********************************************************************************************************
+ *                                               TIME                                                   *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR  ockam_kal_time_us (uint64_t *p_time_us);
+
+
+/*
+ ********************************************************************************************************
+ *                                              THREAD                                                  *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR  ockam_kal_thread_id (uint32_t *p_thread_id);
+
+OCKAM_ERR  ockam_kal_thread_create (OCKAM_KAL_THREAD *p_thread,
+                                    OCKAM_KAL_THREAD_FN p_fn,
+                                    void *p_arg);
+
+OCKAM_ERR  ockam_kal_thread_join (OCKAM_KAL_THREAD *p_thread);
+
+OCKAM_ERR  ockam_kal_once (OCKAM_KAL_ONCE *p_once,
+                           OCKAM_KAL_ONCE_FN p_fn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,7 @@
 
 #include <ockam/define.h>
 #include <ockam/error.h>
+#include <ockam/kal.h>
 
 
 /*
@@ -25,6 +26,9 @@
  ********************************************************************************************************
  */
 
+#define OCKAM_VAULT_AES_GCM_BLOCK_SIZE              16u         /* Streaming updates except the last are a multiple   */
+#define OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX           2u         /* Most secrets one ECDH derive can return            */
+
 /*
  ********************************************************************************************************
  *                                               CONSTANTS                                              *
@@ -76,6 +80,16 @@ typedef enum {
  ********************************************************************************************************
  */
 
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_s
+ * @brief   Opaque handle for a single Ockam Vault instance. Each instance owns
+ *          its own lock, host library state and key material.
+ *******************************************************************************
+ */
+typedef struct OCKAM_VAULT_s OCKAM_VAULT_s;
+
+
 /**
  *******************************************************************************
  * @struct  OCKAM_VAULT_CFG_s
@@ -86,9 +100,89 @@ typedef struct {
     void* p_tpm;                                                /*!<  TPM specific configuration                      */
     void* p_host;                                               /*!<  Host software library specific configuration    */
     OCKAM_VAULT_EC_e ec;                                        /*!< The type of EC Key supported by vault            */
+    OCKAM_KAL_OPT lock_opt;                                     /*!< NON_BLOCKING fails with VAULT_BUSY right away    */
+    uint32_t lock_timeout_ms;                                   /*!< Wait limit for each lock, 0 waits forever        */
 } OCKAM_VAULT_CFG_s;
 
 
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_AES_GCM_REC_s
+ * @brief   A single record of a batched AES GCM call. Every record in a batch
+ *          is processed with the key passed to the batch call.
+ *******************************************************************************
+ */
+typedef struct {
+    uint8_t *p_iv;                                              /*!< Initialization vector for this record            */
+    uint32_t iv_size;                                           /*!< Size of the initialization vector                */
+    uint8_t *p_aad;                                             /*!< Additional data (can be NULL)                    */
+    uint32_t aad_size;                                          /*!< Size of the additional data                      */
+    uint8_t *p_tag;                                             /*!< Tag out when encrypting, tag in when decrypting  */
+    uint32_t tag_size;                                          /*!< Size of the tag buffer                           */
+    uint8_t *p_input;                                           /*!< Data to encrypt or decrypt                       */
+    uint32_t input_size;                                        /*!< Size of the input data                           */
+    uint8_t *p_output;                                          /*!< Result. Can be p_input to work in place.         */
+    uint32_t output_size;                                       /*!< Size of the output buffer                        */
+} OCKAM_VAULT_AES_GCM_REC_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_IOVEC_s
+ * @brief   One fragment of a scatter/gather buffer
+ *******************************************************************************
+ */
+typedef struct {
+    uint8_t *p_buf;                                             /*!< Start of the fragment                            */
+    uint32_t size;                                              /*!< Size of the fragment, can be 0                   */
+} OCKAM_VAULT_IOVEC_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_KEY_s
+ * @brief   Opaque handle for a key held in the key table of a vault instance
+ *******************************************************************************
+ */
+typedef struct OCKAM_VAULT_KEY_s OCKAM_VAULT_KEY_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_SHA256_CTX_s
+ * @brief   Opaque handle for a streaming SHA-256 operation
+ *******************************************************************************
+ */
+typedef struct OCKAM_VAULT_SHA256_CTX_s OCKAM_VAULT_SHA256_CTX_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_HKDF_PRK_s
+ * @brief   Opaque handle for the pseudo-random key of an HKDF extract
+ *******************************************************************************
+ */
+typedef struct OCKAM_VAULT_HKDF_PRK_s OCKAM_VAULT_HKDF_PRK_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_AES_GCM_CTX_s
+ * @brief   Opaque handle for a streaming AES GCM operation
+ *******************************************************************************
+ */
+typedef struct OCKAM_VAULT_AES_GCM_CTX_s OCKAM_VAULT_AES_GCM_CTX_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_SECRET_s
+ * @brief   Opaque handle for an AES GCM key kept ready for use by the vault
+ *******************************************************************************
+ */
+typedef struct OCKAM_VAULT_SECRET_s OCKAM_VAULT_SECRET_s;
+
+
 /*
  ********************************************************************************************************
  *                                          FUNCTION PROTOTYPES                                         *
@@ -114,31 +208,98 @@ typedef struct {
  */
 
 
-OCKAM_ERR ockam_vault_init(OCKAM_VAULT_CFG_s *p_cfg);
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OCKAM_ERR ockam_vault_init(OCKAM_VAULT_s **p_vault, OCKAM_VAULT_CFG_s *p_cfg);
+
+OCKAM_ERR ockam_vault_free(OCKAM_VAULT_s *p_vault);
+
+OCKAM_ERR ockam_vault_lock_opt_set(OCKAM_VAULT_s *p_vault,
+                                   OCKAM_KAL_OPT lock_opt, uint32_t lock_timeout_ms);
 
-OCKAM_ERR ockam_vault_random(uint8_t *p_rand_num, uint32_t rand_num_size);
+OCKAM_ERR ockam_vault_lock_opt_clear(OCKAM_VAULT_s *p_vault);
 
-OCKAM_ERR ockam_vault_key_gen(OCKAM_VAULT_KEY_e key_type);
+OCKAM_ERR ockam_vault_random(OCKAM_VAULT_s *p_vault,
+                             uint8_t *p_rand_num, uint32_t rand_num_size);
 
-OCKAM_ERR ockam_vault_key_get_pub(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_random_refill(OCKAM_VAULT_s *p_vault);
+
+OCKAM_ERR ockam_vault_key_gen(OCKAM_VAULT_s *p_vault,
+                              OCKAM_VAULT_KEY_e key_type);
+
+OCKAM_ERR ockam_vault_key_get_pub(OCKAM_VAULT_s *p_vault,
+                                  OCKAM_VAULT_KEY_e key_type,
                                   uint8_t *p_pub_key, uint32_t pub_key_size);
 
-OCKAM_ERR ockam_vault_key_write(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_key_write(OCKAM_VAULT_s *p_vault,
+                                OCKAM_VAULT_KEY_e key_type,
                                 uint8_t *p_priv_key, uint32_t priv_key_size);
 
-OCKAM_ERR ockam_vault_ecdh(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_ecdh(OCKAM_VAULT_s *p_vault,
+                           OCKAM_VAULT_KEY_e key_type,
                            uint8_t *p_pub_key, uint32_t pub_key_size,
                            uint8_t *p_pms, uint32_t pms_size);
 
-OCKAM_ERR ockam_vault_sha256(uint8_t *p_msg, uint16_t msg_size,
+OCKAM_ERR ockam_vault_key_pool_fill(OCKAM_VAULT_s *p_vault);
+
+OCKAM_ERR ockam_vault_key_handle_create(OCKAM_VAULT_s *p_vault,
+                                        OCKAM_VAULT_KEY_s **p_key);
+
+OCKAM_ERR ockam_vault_key_handle_generate(OCKAM_VAULT_s *p_vault,
+                                          OCKAM_VAULT_KEY_s *p_key);
+
+OCKAM_ERR ockam_vault_key_handle_import(OCKAM_VAULT_s *p_vault,
+                                        OCKAM_VAULT_KEY_s *p_key,
+                                        uint8_t *p_priv_key, uint32_t priv_key_size);
+
+OCKAM_ERR ockam_vault_key_handle_get_pub(OCKAM_VAULT_s *p_vault,
+                                         OCKAM_VAULT_KEY_s *p_key,
+                                         uint8_t *p_pub_key, uint32_t pub_key_size);
+
+OCKAM_ERR ockam_vault_key_handle_ecdh(OCKAM_VAULT_s *p_vault,
+                                      OCKAM_VAULT_KEY_s *p_key,
+                                      uint8_t *p_pub_key, uint32_t pub_key_size,
+                                      uint8_t *p_pms, uint32_t pms_size);
+
+OCKAM_ERR ockam_vault_key_handle_destroy(OCKAM_VAULT_s *p_vault,
+                                         OCKAM_VAULT_KEY_s *p_key);
+
+OCKAM_ERR ockam_vault_sha256(OCKAM_VAULT_s *p_vault,
+                             uint8_t *p_msg, uint32_t msg_size,
                              uint8_t *p_digest, uint8_t digest_size);
 
-OCKAM_ERR ockam_vault_hkdf(uint8_t *p_salt, uint32_t salt_size,
+OCKAM_ERR ockam_vault_sha256_ctx_init(OCKAM_VAULT_s *p_vault,
+                                      OCKAM_VAULT_SHA256_CTX_s **p_ctx);
+
+OCKAM_ERR ockam_vault_sha256_ctx_update(OCKAM_VAULT_SHA256_CTX_s *p_ctx,
+                                        uint8_t *p_msg, uint32_t msg_size);
+
+OCKAM_ERR ockam_vault_sha256_ctx_finish(OCKAM_VAULT_SHA256_CTX_s *p_ctx,
+                                        uint8_t *p_digest, uint8_t digest_size);
+
+OCKAM_ERR ockam_vault_sha256_ctx_free(OCKAM_VAULT_SHA256_CTX_s *p_ctx);
+
+OCKAM_ERR ockam_vault_hkdf(OCKAM_VAULT_s *p_vault,
+                           uint8_t *p_salt, uint32_t salt_size,
                            uint8_t *p_ikm, uint32_t ikm_size,
                            uint8_t *p_info, uint32_t info_size,
                            uint8_t *p_out, uint32_t out_size);
 
-OCKAM_ERR ockam_vault_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
+OCKAM_ERR ockam_vault_hkdf_extract(OCKAM_VAULT_s *p_vault,
+                                   OCKAM_VAULT_HKDF_PRK_s **p_prk,
+                                   uint8_t *p_salt, uint32_t salt_size,
+                                   uint8_t *p_ikm, uint32_t ikm_size);
+
+OCKAM_ERR ockam_vault_hkdf_expand(OCKAM_VAULT_HKDF_PRK_s *p_prk,
+                                  uint8_t *p_info, uint32_t info_size,
+                                  uint8_t *p_out, uint32_t out_size);
+
+OCKAM_ERR ockam_vault_hkdf_prk_free(OCKAM_VAULT_HKDF_PRK_s *p_prk);
+
+OCKAM_ERR ockam_vault_aes_gcm(OCKAM_VAULT_s *p_vault,
+                              OCKAM_VAULT_AES_GCM_MODE_e mode,
                               uint8_t *p_key, uint32_t key_size,
                               uint8_t *p_iv, uint32_t iv_size,
                               uint8_t *p_aad, uint32_t aad_size,
@@ -146,18 +307,121 @@ OCKAM_ERR ockam_vault_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
                               uint8_t *p_input, uint32_t input_size,
                               uint8_t *p_output, uint32_t output_size);
 
-OCKAM_ERR ockam_vault_aes_gcm_encrypt(uint8_t *p_key, uint32_t key_size,
+OCKAM_ERR ockam_vault_aes_gcm_encrypt(OCKAM_VAULT_s *p_vault,
+                                      uint8_t *p_key, uint32_t key_size,
                                       uint8_t *p_iv, uint32_t iv_size,
                                       uint8_t *p_aad, uint32_t aad_size,
                                       uint8_t *p_tag, uint32_t tag_size,
                                       uint8_t *p_input, uint32_t input_size,
                                       uint8_t *p_output, uint32_t output_size);
 
-OCKAM_ERR ockam_vault_aes_gcm_decrypt(uint8_t *p_key, uint32_t key_size,
+OCKAM_ERR ockam_vault_aes_gcm_decrypt(OCKAM_VAULT_s *p_vault,
+                                      uint8_t *p_key, uint32_t key_size,
                                       uint8_t *p_iv, uint32_t iv_size,
                                       uint8_t *p_aad, uint32_t aad_size,
                                       uint8_t *p_tag, uint32_t tag_size,
                                       uint8_t *p_input, uint32_t input_size,
                                       uint8_t *p_output, uint32_t output_size);
 
+OCKAM_ERR ockam_vault_aes_gcm_batch(OCKAM_VAULT_s *p_vault,
+                                    OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                    uint8_t *p_key, uint32_t key_size,
+                                    OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count);
+
+OCKAM_ERR ockam_vault_aes_gcm_encrypt_batch(OCKAM_VAULT_s *p_vault,
+                                            uint8_t *p_key, uint32_t key_size,
+                                            OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count);
+
+OCKAM_ERR ockam_vault_aes_gcm_decrypt_batch(OCKAM_VAULT_s *p_vault,
+                                            uint8_t *p_key, uint32_t key_size,
+                                            OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count);
+
+OCKAM_ERR ockam_vault_aes_gcm_iov(OCKAM_VAULT_s *p_vault,
+                                  OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                  uint8_t *p_key, uint32_t key_size,
+                                  uint8_t *p_iv, uint32_t iv_size,
+                                  OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                  uint8_t *p_tag, uint32_t tag_size,
+                                  OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                  OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count);
+
+OCKAM_ERR ockam_vault_aes_gcm_encrypt_iov(OCKAM_VAULT_s *p_vault,
+                                          uint8_t *p_key, uint32_t key_size,
+                                          uint8_t *p_iv, uint32_t iv_size,
+                                          OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                          uint8_t *p_tag, uint32_t tag_size,
+                                          OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                          OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count);
+
+OCKAM_ERR ockam_vault_aes_gcm_decrypt_iov(OCKAM_VAULT_s *p_vault,
+                                          uint8_t *p_key, uint32_t key_size,
+                                          uint8_t *p_iv, uint32_t iv_size,
+                                          OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                          uint8_t *p_tag, uint32_t tag_size,
+                                          OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                          OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count);
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_init(OCKAM_VAULT_s *p_vault,
+                                       OCKAM_VAULT_AES_GCM_CTX_s **p_ctx,
+                                       OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                       uint8_t *p_key, uint32_t key_size,
+                                       uint8_t *p_iv, uint32_t iv_size);
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_aad_update(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx,
+                                             uint8_t *p_aad, uint32_t aad_size);
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_update(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx,
+                                         uint8_t *p_input, uint32_t input_size,
+                                         uint8_t *p_output, uint32_t output_size);
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_finish(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx,
+                                         uint8_t *p_tag, uint32_t tag_size);
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_free(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx);
+
+OCKAM_ERR ockam_vault_secret_import(OCKAM_VAULT_s *p_vault,
+                                    OCKAM_VAULT_SECRET_s **p_secret,
+                                    uint8_t *p_key, uint32_t key_size);
+
+OCKAM_ERR ockam_vault_secret_derive(OCKAM_VAULT_HKDF_PRK_s *p_prk,
+                                    uint8_t *p_info, uint32_t info_size,
+                                    uint32_t key_size,
+                                    OCKAM_VAULT_SECRET_s **p_secret);
+
+OCKAM_ERR ockam_vault_secret_aes_gcm(OCKAM_VAULT_SECRET_s *p_secret,
+                                     OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                     uint8_t *p_iv, uint32_t iv_size,
+                                     uint8_t *p_aad, uint32_t aad_size,
+                                     uint8_t *p_tag, uint32_t tag_size,
+                                     uint8_t *p_input, uint32_t input_size,
+                                     uint8_t *p_output, uint32_t output_size);
+
+OCKAM_ERR ockam_vault_secret_aes_gcm_encrypt(OCKAM_VAULT_SECRET_s *p_secret,
+                                             uint8_t *p_iv, uint32_t iv_size,
+                                             uint8_t *p_aad, uint32_t aad_size,
+                                             uint8_t *p_tag, uint32_t tag_size,
+                                             uint8_t *p_input, uint32_t input_size,
+                                             uint8_t *p_output, uint32_t output_size);
+
+OCKAM_ERR ockam_vault_secret_aes_gcm_decrypt(OCKAM_VAULT_SECRET_s *p_secret,
+                                             uint8_t *p_iv, uint32_t iv_size,
+                                             uint8_t *p_aad, uint32_t aad_size,
+                                             uint8_t *p_tag, uint32_t tag_size,
+                                             uint8_t *p_input, uint32_t input_size,
+                                             uint8_t *p_output, uint32_t output_size);
+
+OCKAM_ERR ockam_vault_secret_free(OCKAM_VAULT_SECRET_s *p_secret);
+
+OCKAM_ERR ockam_vault_ecdh_derive(OCKAM_VAULT_s *p_vault,
+                                  OCKAM_VAULT_KEY_e key_type,
+                                  uint8_t *p_pub_key, uint32_t pub_key_size,
+                                  uint8_t *p_salt, uint32_t salt_size,
+                                  uint8_t *p_info, uint32_t info_size,
+                                  uint32_t key_size,
+                                  OCKAM_VAULT_SECRET_s **p_secrets, uint32_t secret_count);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
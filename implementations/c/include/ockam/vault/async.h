@@ -0,0 +1,239 @@
+/**
+ ********************************************************************************************************
+ * @file    async.h
+ * @brief   Asynchronous request interface for Ockam Vault
+ ********************************************************************************************************
+ */
+
+#ifndef OCKAM_VAULT_ASYNC_H_
+#define OCKAM_VAULT_ASYNC_H_
+
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <ockam/define.h>
+#include <ockam/error.h>
+#include <ockam/kal.h>
+#include <ockam/vault.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @enum    OCKAM_VAULT_ASYNC_OP_e
+ * @brief   Vault operations that can be submitted asynchronously
+ *******************************************************************************
+ */
+
+typedef enum {
+    OCKAM_VAULT_ASYNC_OP_RANDOM = 0,                            /*!< ockam_vault_random()                             */
+    OCKAM_VAULT_ASYNC_OP_KEY_GEN,                               /*!< ockam_vault_key_gen()                            */
+    OCKAM_VAULT_ASYNC_OP_KEY_GET_PUB,                           /*!< ockam_vault_key_get_pub()                        */
+    OCKAM_VAULT_ASYNC_OP_ECDH,                                  /*!< ockam_vault_ecdh()                               */
+    OCKAM_VAULT_ASYNC_OP_SHA256,                                /*!< ockam_vault_sha256()                             */
+    OCKAM_VAULT_ASYNC_OP_HKDF,                                  /*!< ockam_vault_hkdf()                               */
+    OCKAM_VAULT_ASYNC_OP_AES_GCM,                               /*!< ockam_vault_aes_gcm()                            */
+    OCKAM_VAULT_ASYNC_OP_KEY_POOL_FILL,                         /*!< ockam_vault_key_pool_fill(), takes no arguments  */
+    OCKAM_VAULT_ASYNC_OP_RANDOM_REFILL,                         /*!< ockam_vault_random_refill(), takes no arguments  */
+    MAX_OCKAM_VAULT_ASYNC_OP                                    /*!< Total number of async operations                 */
+} OCKAM_VAULT_ASYNC_OP_e;
+
+
+/**
+ *******************************************************************************
+ * @enum    OCKAM_VAULT_ASYNC_LANE_e
+ * @brief   Priority lanes of an async queue. Each lane has its own queue and
+ *          workers, so slow key operations never hold up bulk crypto.
+ *******************************************************************************
+ */
+
+typedef enum {
+    OCKAM_VAULT_ASYNC_LANE_FAST = 0,                            /*!< SHA256, HKDF and AES GCM                         */
+    OCKAM_VAULT_ASYNC_LANE_SLOW,                                /*!< Random, key generation and ECDH                  */
+    MAX_OCKAM_VAULT_ASYNC_LANE                                  /*!< Total number of lanes                            */
+} OCKAM_VAULT_ASYNC_LANE_e;
+
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_ASYNC_s
+ * @brief   Opaque handle for an async request queue bound to a vault instance
+ *******************************************************************************
+ */
+
+typedef struct OCKAM_VAULT_ASYNC_s OCKAM_VAULT_ASYNC_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_ASYNC_TOKEN_s
+ * @brief   Cancellation token shared by any number of requests, for example
+ *          every request made for one connection. Owned by the caller and
+ *          zeroed before use.
+ *******************************************************************************
+ */
+
+typedef struct {
+    volatile uint32_t cancelled;                                /*!< Set by ockam_vault_async_cancel()                */
+} OCKAM_VAULT_ASYNC_TOKEN_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_REQ_s
+ * @brief   An asynchronous vault request. The request and every buffer it
+ *          points to are owned by the caller and must stay valid until the
+ *          completion callback has been called.
+ *******************************************************************************
+ */
+
+typedef struct OCKAM_VAULT_REQ_s OCKAM_VAULT_REQ_s;
+
+typedef void (*OCKAM_VAULT_ASYNC_CB)(OCKAM_VAULT_REQ_s *p_req); /* Called on the worker thread when a request is done */
+
+struct OCKAM_VAULT_REQ_s {
+    OCKAM_VAULT_ASYNC_OP_e op;                                  /*!< Operation to perform                             */
+    OCKAM_VAULT_ASYNC_CB cb;                                    /*!< Completion callback, may be 0                    */
+    void *p_cb_arg;                                             /*!< Caller data for the completion callback          */
+    OCKAM_ERR result;                                           /*!< Result of the operation, set before the callback */
+    uint64_t deadline_us;                                       /*!< Latest ockam_kal_time_us() to start at, 0 if none*/
+    OCKAM_VAULT_ASYNC_TOKEN_s *p_token;                         /*!< Cancellation token, may be 0                     */
+
+    union {                                                     /*!< Arguments for the operation, see vault.h         */
+        struct {
+            uint8_t *p_rand_num;
+            uint32_t rand_num_size;
+        } random;
+
+        struct {
+            OCKAM_VAULT_KEY_e key_type;
+        } key_gen;
+
+        struct {
+            OCKAM_VAULT_KEY_e key_type;
+            uint8_t *p_pub_key;
+            uint32_t pub_key_size;
+        } key_get_pub;
+
+        struct {
+            OCKAM_VAULT_KEY_e key_type;
+            uint8_t *p_pub_key;
+            uint32_t pub_key_size;
+            uint8_t *p_pms;
+            uint32_t pms_size;
+        } ecdh;
+
+        struct {
+            uint8_t *p_msg;
+            uint32_t msg_size;
+            uint8_t *p_digest;
+            uint8_t digest_size;
+        } sha256;
+
+        struct {
+            uint8_t *p_salt;
+            uint32_t salt_size;
+            uint8_t *p_ikm;
+            uint32_t ikm_size;
+            uint8_t *p_info;
+            uint32_t info_size;
+            uint8_t *p_out;
+            uint32_t out_size;
+        } hkdf;
+
+        struct {
+            OCKAM_VAULT_AES_GCM_MODE_e mode;
+            uint8_t *p_key;
+            uint32_t key_size;
+            uint8_t *p_iv;
+            uint32_t iv_size;
+            uint8_t *p_aad;
+            uint32_t aad_size;
+            uint8_t *p_tag;
+            uint32_t tag_size;
+            uint8_t *p_input;
+            uint32_t input_size;
+            uint8_t *p_output;
+            uint32_t output_size;
+        } aes_gcm;
+    } args;
+};
+
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                           GLOBAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            LOCAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OCKAM_ERR ockam_vault_async_init(OCKAM_VAULT_ASYNC_s **p_async,
+                                 OCKAM_VAULT_s *p_vault,
+                                 uint32_t queue_size);
+
+OCKAM_ERR ockam_vault_async_free(OCKAM_VAULT_ASYNC_s *p_async);
+
+OCKAM_ERR ockam_vault_async_limit_set(OCKAM_VAULT_ASYNC_s *p_async,
+                                      OCKAM_VAULT_ASYNC_LANE_e lane,
+                                      uint32_t max_active);
+
+OCKAM_ERR ockam_vault_async_submit(OCKAM_VAULT_ASYNC_s *p_async,
+                                   OCKAM_VAULT_REQ_s *p_req);
+
+OCKAM_ERR ockam_vault_async_run(OCKAM_VAULT_ASYNC_s *p_async,
+                                OCKAM_VAULT_ASYNC_LANE_e lane,
+                                OCKAM_KAL_OPT opt,
+                                uint32_t timeout_ms);
+
+OCKAM_ERR ockam_vault_async_stop(OCKAM_VAULT_ASYNC_s *p_async,
+                                 OCKAM_VAULT_ASYNC_LANE_e lane);
+
+OCKAM_ERR ockam_vault_async_cancel(OCKAM_VAULT_ASYNC_TOKEN_s *p_token);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ ********************************************************************************************************
+ * @file    backend.h
+ * @brief   Ockam Vault backend function table
+ ********************************************************************************************************
+ */
+
+#ifndef OCKAM_VAULT_BACKEND_H_
+#define OCKAM_VAULT_BACKEND_H_
+
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <ockam/define.h>
+#include <ockam/error.h>
+#include <ockam/vault.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_BACKEND_s
+ * @brief   Function table exported by a vault backend. Every function takes the
+ *          context returned by the backend init function. Operations a backend
+ *          does not support are set to 0 and vault routes them elsewhere.
+ *******************************************************************************
+ */
+
+typedef struct {
+    OCKAM_ERR (*random)(void *p_ctx,                            /*!< Generate a random number                         */
+                        uint8_t *p_rand_num, uint32_t rand_num_size);
+
+    OCKAM_ERR (*key_gen)(void *p_ctx,                           /*!< Generate a keypair                               */
+                         OCKAM_VAULT_KEY_e key_type);
+
+    OCKAM_ERR (*key_get_pub)(void *p_ctx,                       /*!< Get the public key of a keypair                  */
+                             OCKAM_VAULT_KEY_e key_type,
+                             uint8_t *p_pub_key, uint32_t pub_key_size);
+
+    OCKAM_ERR (*key_write)(void *p_ctx,                         /*!< Load a private key into a key slot               */
+                           OCKAM_VAULT_KEY_e key_type,
+                           uint8_t *p_priv_key, uint32_t priv_key_size);
+
+    OCKAM_ERR (*ecdh)(void *p_ctx,                              /*!< Calculate a shared secret                        */
+                      OCKAM_VAULT_KEY_e key_type,
+                      uint8_t *p_pub_key, uint32_t pub_key_size,
+                      uint8_t *p_pms, uint32_t pms_size);
+
+    OCKAM_ERR (*sha256)(void *p_ctx,                            /*!< Calculate a SHA-256 digest                       */
+                        uint8_t *p_msg, uint32_t msg_size,
+                        uint8_t *p_digest, uint8_t digest_size);
+
+    OCKAM_ERR (*sha256_ctx_init)(void *p_ctx,                   /*!< Start a streaming SHA-256 digest                 */
+                                 void **p_sha_ctx);
+
+    OCKAM_ERR (*sha256_ctx_update)(void *p_sha_ctx,             /*!< Add the next part of the message                 */
+                                   uint8_t *p_msg, uint32_t msg_size);
+
+    OCKAM_ERR (*sha256_ctx_finish)(void *p_sha_ctx,             /*!< Output the digest of a stream                    */
+                                   uint8_t *p_digest, uint8_t digest_size);
+
+    OCKAM_ERR (*sha256_ctx_free)(void *p_sha_ctx);              /*!< Release a streaming SHA-256 digest               */
+
+    OCKAM_ERR (*hkdf)(void *p_ctx,                              /*!< Derive key material with HKDF-SHA256             */
+                      uint8_t *p_salt, uint32_t salt_size,
+                      uint8_t *p_ikm, uint32_t ikm_size,
+                      uint8_t *p_info, uint32_t info_size,
+                      uint8_t *p_out, uint32_t out_size);
+
+    OCKAM_ERR (*hkdf_extract)(void *p_ctx,                      /*!< HKDF extract stage, keeps the PRK                */
+                              void **p_prk,
+                              uint8_t *p_salt, uint32_t salt_size,
+                              uint8_t *p_ikm, uint32_t ikm_size);
+
+    OCKAM_ERR (*hkdf_expand)(void *p_prk,                       /*!< HKDF expand stage from a kept PRK                */
+                             uint8_t *p_info, uint32_t info_size,
+                             uint8_t *p_out, uint32_t out_size);
+
+    OCKAM_ERR (*hkdf_prk_free)(void *p_prk);                    /*!< Release a kept PRK                               */
+
+    OCKAM_ERR (*aes_gcm)(void *p_ctx,                           /*!< AES GCM encrypt or decrypt                       */
+                         OCKAM_VAULT_AES_GCM_MODE_e mode,
+                         uint8_t *p_key, uint32_t key_size,
+                         uint8_t *p_iv, uint32_t iv_size,
+                         uint8_t *p_aad, uint32_t aad_size,
+                         uint8_t *p_tag, uint32_t tag_size,
+                         uint8_t *p_input, uint32_t input_size,
+                         uint8_t *p_output, uint32_t output_size);
+
+    OCKAM_ERR (*aes_gcm_batch)(void *p_ctx,                     /*!< AES GCM on many records under one key            */
+                               OCKAM_VAULT_AES_GCM_MODE_e mode,
+                               uint8_t *p_key, uint32_t key_size,
+                               OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count);
+
+    OCKAM_ERR (*aes_gcm_iov)(void *p_ctx,                       /*!< AES GCM on scatter/gather buffers                */
+                             OCKAM_VAULT_AES_GCM_MODE_e mode,
+                             uint8_t *p_key, uint32_t key_size,
+                             uint8_t *p_iv, uint32_t iv_size,
+                             OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                             uint8_t *p_tag, uint32_t tag_size,
+                             OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                             OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count);
+
+    OCKAM_ERR (*aes_gcm_ctx_init)(void *p_ctx,                  /*!< Start a streaming AES GCM operation              */
+                                  void **p_gcm_ctx,
+                                  OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                  uint8_t *p_key, uint32_t key_size,
+                                  uint8_t *p_iv, uint32_t iv_size);
+
+    OCKAM_ERR (*aes_gcm_ctx_aad_update)(void *p_gcm_ctx,        /*!< Add additional data to a stream                  */
+                                        uint8_t *p_aad, uint32_t aad_size);
+
+    OCKAM_ERR (*aes_gcm_ctx_update)(void *p_gcm_ctx,            /*!< Encrypt or decrypt the next part of a stream     */
+                                    uint8_t *p_input, uint32_t input_size,
+                                    uint8_t *p_output, uint32_t output_size);
+
+    OCKAM_ERR (*aes_gcm_ctx_finish)(void *p_gcm_ctx,            /*!< Output or verify the tag of a stream             */
+                                    uint8_t *p_tag, uint32_t tag_size);
+
+    OCKAM_ERR (*aes_gcm_ctx_free)(void *p_gcm_ctx);             /*!< Release a streaming AES GCM operation            */
+
+    OCKAM_ERR (*secret_import)(void *p_ctx,                     /*!< Load an AES key once for use by handle           */
+                               void **p_secret,
+                               uint8_t *p_key, uint32_t key_size);
+
+    OCKAM_ERR (*secret_aes_gcm)(void *p_secret,                 /*!< AES GCM with the key of a secret                 */
+                                OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                uint8_t *p_iv, uint32_t iv_size,
+                                uint8_t *p_aad, uint32_t aad_size,
+                                uint8_t *p_tag, uint32_t tag_size,
+                                uint8_t *p_input, uint32_t input_size,
+                                uint8_t *p_output, uint32_t output_size);
+
+    OCKAM_ERR (*secret_free)(void *p_secret);                   /*!< Release a secret and wipe its key                */
+
+    OCKAM_ERR (*ecdh_derive)(void *p_ctx,                       /*!< ECDH into HKDF into secrets in one operation     */
+                             OCKAM_VAULT_KEY_e key_type,
+                             uint8_t *p_pub_key, uint32_t pub_key_size,
+                             uint8_t *p_salt, uint32_t salt_size,
+                             uint8_t *p_info, uint32_t info_size,
+                             uint32_t key_size,
+                             void **p_secrets, uint32_t secret_count);
+} OCKAM_VAULT_BACKEND_s;
+
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+extern const OCKAM_VAULT_BACKEND_s ockam_vault_tpm_backend;     /* Defined by the TPM backend compiled into the build */
+extern const OCKAM_VAULT_BACKEND_s ockam_vault_host_backend;    /* Defined by the host library compiled into the build*/
+
+
+#endif
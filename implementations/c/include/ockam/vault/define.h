@@ -47,4 +47,61 @@
 #define OCKAM_VAULT_HOST_MBEDCRYPTO               (OCKAM_VAULT_CFG_HOST | 0x00000001)
 
 
+/*
+ ********************************************************************************************************
+ *                                           Backend Dispatch                                           *
+ ********************************************************************************************************
+ */
+
+                                                                /* When both a TPM and a host library are initialized */
+                                                                /* the vault routes each operation through backend    */
+                                                                /* function tables chosen at init. With one backend   */
+                                                                /* the calls are resolved at compile time.            */
+#define OCKAM_VAULT_CFG_DISPATCH_EN             (((OCKAM_VAULT_CFG_INIT) & OCKAM_VAULT_CFG_TPM) && \
+                                                 ((OCKAM_VAULT_CFG_INIT) & OCKAM_VAULT_CFG_HOST))
+
+                                                                /* A backend compiles an operation when configured    */
+                                                                /* for it, or for every operation when dispatching    */
+#define OCKAM_VAULT_CFG_EN(cfg, backend)        (((cfg) == (backend)) ||                                \
+                                                 (OCKAM_VAULT_CFG_DISPATCH_EN &&                        \
+                                                  (((OCKAM_VAULT_CFG_INIT) & (backend)) == (backend))))
+
+
+/*
+ ********************************************************************************************************
+ *                                          Size Based Routing                                          *
+ ********************************************************************************************************
+ */
+
+                                                                /* Values for OCKAM_VAULT_CFG_xxx_HOST_SIZE. With     */
+                                                                /* both a TPM and a host library initialized, one-shot*/
+                                                                /* calls on inputs of at least that many bytes are    */
+                                                                /* sent to the host library instead of the TPM.       */
+#define OCKAM_VAULT_SIZE_AUTO                   0xFFFFFFFFu     /* Measure both backends once per process            */
+#define OCKAM_VAULT_SIZE_NEVER                  0xFFFFFFFEu     /* Always use the configured backend                  */
+
+
+/*
+ ********************************************************************************************************
+ *                                           Host DRBG Engines                                          *
+ ********************************************************************************************************
+ */
+
+                                                                /* Values for OCKAM_VAULT_CFG_HOST_DRBG               */
+#define OCKAM_VAULT_HOST_DRBG_CTR               0x01u           /* mbedtls CTR_DRBG with AES-256                      */
+#define OCKAM_VAULT_HOST_DRBG_CHACHA20          0x02u           /* ChaCha20 keystream with fast key erasure           */
+
+
+/*
+ ********************************************************************************************************
+ *                                           Host DRBG Seeding                                          *
+ ********************************************************************************************************
+ */
+
+                                                                /* Values for OCKAM_VAULT_CFG_HOST_SEED_TPM           */
+#define OCKAM_VAULT_HOST_SEED_PLATFORM          0x00u           /* Platform entropy only                              */
+#define OCKAM_VAULT_HOST_SEED_TPM_MIX           0x01u           /* TPM and platform entropy, both required            */
+#define OCKAM_VAULT_HOST_SEED_TPM_ONLY          0x02u           /* TPM alone, platform entropy while it is down       */
+
+
 #endif
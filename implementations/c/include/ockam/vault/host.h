@@ -37,6 +37,13 @@
  ********************************************************************************************************
  */
 
+                                                                /* Extra entropy source for the host DRBG. Fills the  */
+                                                                /* whole buffer, reporting the bytes written in       */
+                                                                /* p_size. Returns OCKAM_ERR_VAULT_TPM_DOWN when the  */
+                                                                /* source is down and seeding may fall back to        */
+                                                                /* platform entropy. Other errors fail the seed.      */
+typedef OCKAM_ERR (*OCKAM_VAULT_HOST_ENTROPY)(void *p_arg, uint8_t *p_buf, uint32_t size, uint32_t *p_size);
+
 /*
  ********************************************************************************************************
  *                                          FUNCTION PROTOTYPES                                         *
@@ -72,7 +79,15 @@ extern "C" {
  *
  * @brief   Initialize the host for Ockam Vault
  *
- * @param   p_arg   Optional void* argument
+ * @param   p_arg[in]           Optional void* argument
+ *
+ * @param   entropy[in]         Optional entropy source, such as the TPM, used with or instead of the
+ *                              platform entropy to seed and reseed the DRBG, according to
+ *                              OCKAM_VAULT_CFG_HOST_SEED_TPM. 0 for platform entropy only.
+ *
+ * @param   p_entropy_arg[in]   Passed to the entropy source
+ *
+ * @param   p_ctx[out]          Backend context for the vault instance being initialized
  *
  * @return  OCKAM_ERR_NONE if initialized successfully. OCKAM_ERR_VAULT_ALREADY_INIT if already
  *          initialized. Other errors if specific chip fails init.
@@ -80,7 +95,9 @@ extern "C" {
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_init(void *p_arg);
+OCKAM_ERR ockam_vault_host_init(void *p_arg,
+                                OCKAM_VAULT_HOST_ENTROPY entropy, void *p_entropy_arg,
+                                void **p_ctx);
 
 
 /**
@@ -89,12 +106,14 @@ OCKAM_ERR ockam_vault_host_init(void *p_arg);
  *
  * @brief   Free the host and all associated data structures
  *
+ * @param   p_ctx[in]   Backend context returned from init
+ *
  * @return  OCKAM_ERR_NONE on success.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_free(void);
+OCKAM_ERR ockam_vault_host_free(void *p_ctx);
 
 
 /**
@@ -103,6 +122,8 @@ OCKAM_ERR ockam_vault_host_free(void);
  *
  * @brief   Generate and return a random number
  *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
  * @param   p_rand_num[out]     32-byte array to be filled with the random number
  *
  * @param   rand_num_size[in]   The size of the desired random number & buffer passed in. Used to verify
@@ -113,7 +134,8 @@ OCKAM_ERR ockam_vault_host_free(void);
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_random(uint8_t *p_rand_num,
+OCKAM_ERR ockam_vault_host_random(void *p_ctx,
+                                  uint8_t *p_rand_num,
                                   uint32_t rand_num_size);
 
 
@@ -123,6 +145,8 @@ OCKAM_ERR ockam_vault_host_random(uint8_t *p_rand_num,
  *
  * @brief   Generate an keypair of a specified type
  *
+ * @param   p_ctx[in]       Backend context for the vault instance
+ *
  * @param   key_type[in]    The type of key pair to generate.
  *
  * @return  OCKAM_ERR_NONE if successful.
@@ -130,7 +154,8 @@ OCKAM_ERR ockam_vault_host_random(uint8_t *p_rand_num,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_key_gen(OCKAM_VAULT_KEY_e key_type);
+OCKAM_ERR ockam_vault_host_key_gen(void *p_ctx,
+                                   OCKAM_VAULT_KEY_e key_type);
 
 
 /**
@@ -139,6 +164,8 @@ OCKAM_ERR ockam_vault_host_key_gen(OCKAM_VAULT_KEY_e key_type);
  *
  * @brief   Get a public key from the host vault
  *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
  * @param   key_type[in]        OCKAM_VAULT_KEY_STATIC if requesting static public key
  *                              OCKAM_VAULT_KEY_EPHEMERAL if requesting the ephemeral public key
  *
@@ -151,7 +178,8 @@ OCKAM_ERR ockam_vault_host_key_gen(OCKAM_VAULT_KEY_e key_type);
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_key_get_pub(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_host_key_get_pub(void *p_ctx,
+                                       OCKAM_VAULT_KEY_e key_type,
                                        uint8_t *p_pub_key,
                                        uint32_t pub_key_size);
 
@@ -162,6 +190,8 @@ OCKAM_ERR ockam_vault_host_key_get_pub(OCKAM_VAULT_KEY_e key_type,
  *
  * @brief   Write a private key to the Ockam Vault. Should typically be used for testing only.
  *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
  * @param   key_type[in]        OCKAM_VAULT_KEY_STATIC if requesting static public key
  *                              OCKAM_VAULT_KEY_EPHEMERAL if requesting the ephemeral public key
  *
@@ -174,7 +204,8 @@ OCKAM_ERR ockam_vault_host_key_get_pub(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_key_write(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_host_key_write(void *p_ctx,
+                                     OCKAM_VAULT_KEY_e key_type,
                                      uint8_t *p_priv_key, uint32_t priv_key_size);
 
 
@@ -184,6 +215,8 @@ OCKAM_ERR ockam_vault_host_key_write(OCKAM_VAULT_KEY_e key_type,
  *
  * @brief   Perform ECDH using the specified key
  *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
  * @param   key_type[in]        Specify which key type to use in the ECDH execution
  *
  * @param   p_pub_key[in]       Buffer with the public key
@@ -199,19 +232,192 @@ OCKAM_ERR ockam_vault_host_key_write(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_ecdh(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_host_ecdh(void *p_ctx,
+                                OCKAM_VAULT_KEY_e key_type,
                                 uint8_t *p_pub_key,
                                 uint32_t pub_key_size,
                                 uint8_t *p_pms,
                                 uint32_t pms_size);
 
 
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_key_pool_fill()
+ *
+ * @brief   Generate keys into the ephemeral key pool until it is full. Safe to call while other
+ *          threads use the vault instance.
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_pool_fill(void *p_ctx);
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_key_pool_count()
+ *
+ * @brief   Get the number of keys ready in the ephemeral key pool
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_count[out]        Returns the number of ready keys, always 0 without a pool
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_pool_count(void *p_ctx, uint32_t *p_count);
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_key_handle_create()
+ *
+ * @brief   Take an empty key from the key table of a vault instance. The key table has its own lock,
+ *          so key handle calls may run concurrently without the vault instance lock.
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_key[out]          Returns the key handle
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_create(void *p_ctx,
+                                             void **p_key);
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_host_key_handle_generate()
+ *
+ * @brief   Generate a Curve25519 keypair into a key handle
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_host_key_handle_create()
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_generate(void *p_ctx,
+                                               void *p_key);
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_key_handle_import()
+ *
+ * @brief   Load a private key into a key handle and derive its public key
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_host_key_handle_create()
+ *
+ * @param   p_priv_key[in]      Buffer with the private key
+ *
+ * @param   priv_key_size[in]   Size of the private key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_import(void *p_ctx,
+                                             void *p_key,
+                                             uint8_t *p_priv_key, uint32_t priv_key_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_host_key_handle_get_pub()
+ *
+ * @brief   Get the public key of a key handle
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_host_key_handle_create()
+ *
+ * @param   p_pub_key[out]      Buffer to place the public key in
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_get_pub(void *p_ctx,
+                                              void *p_key,
+                                              uint8_t *p_pub_key, uint32_t pub_key_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_key_handle_ecdh()
+ *
+ * @brief   Perform ECDH using the private key of a key handle
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_host_key_handle_create()
+ *
+ * @param   p_pub_key[in]       Buffer with the public key
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_pms[out]          Pre-master secret from ECDH
+ *
+ * @param   pms_size[in]        Size of the pre-master secret buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_ecdh(void *p_ctx,
+                                           void *p_key,
+                                           uint8_t *p_pub_key, uint32_t pub_key_size,
+                                           uint8_t *p_pms, uint32_t pms_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_host_key_handle_destroy()
+ *
+ * @brief   Clear a key handle and return it to the key table
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_host_key_handle_create()
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_destroy(void *p_ctx,
+                                              void *p_key);
+
+
 /**
  ********************************************************************************************************
  *                                    ockam_vault_host_sha256()
  *
  * @brief   Perform a SHA256 operation on the message passed in using the host library.
  *
+ * @param   p_ctx[in]       Backend context for the vault instance
+ *
  * @param   p_msg[in]       The message to run through SHA256
  *
  * @param   msg_size[in]    The size of the message to be run through SHA256
@@ -225,18 +431,98 @@ OCKAM_ERR ockam_vault_host_ecdh(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_sha256(uint8_t *p_msg,
-                                  uint16_t msg_size,
+OCKAM_ERR ockam_vault_host_sha256(void *p_ctx,
+                                  uint8_t *p_msg,
+                                  uint32_t msg_size,
                                   uint8_t *p_digest,
                                   uint8_t digest_size);
 
 
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_sha256_ctx_init()
+ *
+ * @brief   Start a streaming SHA-256 digest in the host vault
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_sha_ctx[out]      Returns the context for the streaming digest
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_init(void *p_ctx,
+                                           void **p_sha_ctx);
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_sha256_ctx_update()
+ *
+ * @brief   Add the next part of the message to a streaming SHA-256 digest
+ *
+ * @param   p_sha_ctx[in]       Context of the streaming digest
+ *
+ * @param   p_msg[in]           The next part of the message
+ *
+ * @param   msg_size[in]        Size of this part of the message
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_update(void *p_sha_ctx,
+                                             uint8_t *p_msg, uint32_t msg_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_sha256_ctx_finish()
+ *
+ * @brief   Output the digest of everything passed to a streaming SHA-256 digest
+ *
+ * @param   p_sha_ctx[in]       Context of the streaming digest
+ *
+ * @param   p_digest[out]       Buffer to place the resulting SHA256 digest in
+ *
+ * @param   digest_size[in]     The size of the digest buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_finish(void *p_sha_ctx,
+                                             uint8_t *p_digest, uint8_t digest_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_sha256_ctx_free()
+ *
+ * @brief   Release a streaming SHA-256 digest, finished or not
+ *
+ * @param   p_sha_ctx[in]       Context of the streaming digest
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_free(void *p_sha_ctx);
+
+
 /**
  ********************************************************************************************************
  *                                     ockam_vault_host_hkdf()
  *
  * @brief   Perform HKDF in the host vault
  *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
  * @param   p_salt[in]          Buffer for the Ockam salt value
  *
  * @param   salt_size[in]       Size of the Ockam salt value
@@ -258,18 +544,93 @@ OCKAM_ERR ockam_vault_host_sha256(uint8_t *p_msg,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_hkdf(uint8_t *p_salt, uint32_t salt_size,
+OCKAM_ERR ockam_vault_host_hkdf(void *p_ctx,
+                                uint8_t *p_salt, uint32_t salt_size,
                                 uint8_t *p_ikm, uint32_t ikm_size,
                                 uint8_t *p_info, uint32_t info_size,
                                 uint8_t *p_out, uint32_t out_size);
 
 
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_host_hkdf_extract()
+ *
+ * @brief   Run the HKDF extract stage in the host vault and keep the pseudo-random key for any number
+ *          of expand calls
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_prk[out]          Returns the handle for the pseudo-random key
+ *
+ * @param   p_salt[in]          Buffer for the Ockam salt value
+ *
+ * @param   salt_size[in]       Size of the Ockam salt value
+ *
+ * @param   p_ikm[in]           Buffer with the input key material for HKDF
+ *
+ * @param   ikm_size[in]        Size of the input key material
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf_extract(void *p_ctx,
+                                        void **p_prk,
+                                        uint8_t *p_salt, uint32_t salt_size,
+                                        uint8_t *p_ikm, uint32_t ikm_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_hkdf_expand()
+ *
+ * @brief   Run the HKDF expand stage from a pseudo-random key kept by an extract
+ *
+ * @param   p_prk[in]           Handle for the pseudo-random key
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info.
+ *
+ * @param   p_out[out]          Buffer for the output of the HKDF operation
+ *
+ * @param   out_size[in]        Size of the HKDF output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf_expand(void *p_prk,
+                                       uint8_t *p_info, uint32_t info_size,
+                                       uint8_t *p_out, uint32_t out_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_host_hkdf_prk_free()
+ *
+ * @brief   Clear and release a pseudo-random key kept by an extract
+ *
+ * @param   p_prk[in]           Handle for the pseudo-random key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf_prk_free(void *p_prk);
+
+
 /**
  ********************************************************************************************************
  *                                       ockam_vault_host_aes_gcm()
  *
  * @brief   Perform AES GCM in the host vault
  *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
  * @param   mode                AES GCM Mode: Encrypt or Decrypt
  *
  * @param   p_key[in]           Buffer for the AES Key
@@ -293,8 +654,8 @@ OCKAM_ERR ockam_vault_host_hkdf(uint8_t *p_salt, uint32_t salt_size,
  *
  * @param   input_size[in]      Size of the input data
  *
- * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can NOT be the
- *                              input buffer.
+ * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can be the input
+ *                              buffer to operate in place, but must not partially overlap it.
  *
  * @param   output_size[in]     Size of the output buffer
  *
@@ -303,7 +664,8 @@ OCKAM_ERR ockam_vault_host_hkdf(uint8_t *p_salt, uint32_t salt_size,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
+OCKAM_ERR ockam_vault_host_aes_gcm(void *p_ctx,
+                                   OCKAM_VAULT_AES_GCM_MODE_e mode,
                                    uint8_t *p_key, uint32_t key_size,
                                    uint8_t *p_iv, uint32_t iv_size,
                                    uint8_t *p_aad, uint32_t aad_size,
@@ -311,6 +673,333 @@ OCKAM_ERR ockam_vault_host_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
                                    uint8_t *p_input, uint32_t input_size,
                                    uint8_t *p_output, uint32_t output_size);
 
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_host_aes_gcm_batch()
+ *
+ * @brief   Perform AES GCM on a batch of records in the host vault. The key is set up once for the whole
+ *          batch. Processing stops at the first record that fails.
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key shared by every record
+ *
+ * @param   key_size[in]        Size of the AES Key
+ *
+ * @param   p_recs[in,out]      Array of records to encrypt or decrypt
+ *
+ * @param   rec_count[in]       Number of records in the array
+ *
+ * @return  OCKAM_ERR_NONE if every record was successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_batch(void *p_ctx,
+                                         OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                         uint8_t *p_key, uint32_t key_size,
+                                         OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count);
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_aes_gcm_iov()
+ *
+ * @brief   Perform AES GCM in the host vault on scatter/gather buffers
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Fragments of the additional data (can be NULL)
+ *
+ * @param   aad_count[in]       Number of additional data fragments (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Fragments of the data to encrypt or decrypt
+ *
+ * @param   input_count[in]     Number of input fragments
+ *
+ * @param   p_output[out]       Fragments for the result. Total size must match the input. A
+ *                              fragment can be the matching input fragment to operate in place.
+ *
+ * @param   output_count[in]    Number of output fragments
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_iov(void *p_ctx,
+                                       OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                       uint8_t *p_key, uint32_t key_size,
+                                       uint8_t *p_iv, uint32_t iv_size,
+                                       OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                       uint8_t *p_tag, uint32_t tag_size,
+                                       OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                       OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count);
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_aes_gcm_ctx_init()
+ *
+ * @brief   Start a streaming AES GCM operation in the host vault
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_gcm_ctx[out]      Returns the context for the streaming operation
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_init(void *p_ctx,
+                                            void **p_gcm_ctx,
+                                            OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                            uint8_t *p_key, uint32_t key_size,
+                                            uint8_t *p_iv, uint32_t iv_size);
+
+
+/**
+ ********************************************************************************************************
+ *                              ockam_vault_host_aes_gcm_ctx_aad_update()
+ *
+ * @brief   Add additional data to a streaming AES GCM operation. Must be called before any data
+ *          is encrypted or decrypted.
+ *
+ * @param   p_gcm_ctx[in]       Context of the streaming operation
+ *
+ * @param   p_aad[in]           Buffer with the additional data
+ *
+ * @param   aad_size[in]        Size of the additional data
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_aad_update(void *p_gcm_ctx,
+                                                  uint8_t *p_aad, uint32_t aad_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_host_aes_gcm_ctx_update()
+ *
+ * @brief   Encrypt or decrypt the next part of a streaming AES GCM operation. Every update except
+ *          the last must be a multiple of OCKAM_VAULT_AES_GCM_BLOCK_SIZE.
+ *
+ * @param   p_gcm_ctx[in]       Context of the streaming operation
+ *
+ * @param   p_input[in]         Buffer with the data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the result. Can be the input buffer.
+ *
+ * @param   output_size[in]     Size of the output buffer. Must match the input size.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_update(void *p_gcm_ctx,
+                                              uint8_t *p_input, uint32_t input_size,
+                                              uint8_t *p_output, uint32_t output_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_host_aes_gcm_ctx_finish()
+ *
+ * @brief   Finish a streaming AES GCM operation. Outputs the tag when encrypting and verifies it
+ *          when decrypting.
+ *
+ * @param   p_gcm_ctx[in]       Context of the streaming operation
+ *
+ * @param   p_tag[in,out]       Buffer for the tag
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_finish(void *p_gcm_ctx,
+                                              uint8_t *p_tag, uint32_t tag_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_aes_gcm_ctx_free()
+ *
+ * @brief   Release a streaming AES GCM operation, finished or not
+ *
+ * @param   p_gcm_ctx[in]       Context of the streaming operation
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_free(void *p_gcm_ctx);
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_host_secret_import()
+ *
+ * @brief   Load an AES key into the host vault once so it can be used by handle
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   p_secret[out]       Returns the secret
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_secret_import(void *p_ctx,
+                                         void **p_secret,
+                                         uint8_t *p_key, uint32_t key_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_secret_aes_gcm()
+ *
+ * @brief   AES GCM encrypt or decrypt with the key of a secret. Calls on the same secret take turns,
+ *          calls on different secrets can run at the same time.
+ *
+ * @param   p_secret[in]        Secret holding the key
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data
+ *
+ * @param   aad_size[in]        Size of the additional data
+ *
+ * @param   p_tag[in,out]       Buffer for the tag
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the result. Can be the input buffer.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_secret_aes_gcm(void *p_secret,
+                                          OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                          uint8_t *p_iv, uint32_t iv_size,
+                                          uint8_t *p_aad, uint32_t aad_size,
+                                          uint8_t *p_tag, uint32_t tag_size,
+                                          uint8_t *p_input, uint32_t input_size,
+                                          uint8_t *p_output, uint32_t output_size);
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_secret_free()
+ *
+ * @brief   Release a secret and wipe its key
+ *
+ * @param   p_secret[in]        Secret to release
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_secret_free(void *p_secret);
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_ecdh_derive()
+ *
+ * @brief   Run ECDH, HKDF and secret import as one operation in the host library
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance
+ *
+ * @param   key_type[in]        Specify which key type to use in the ECDH execution
+ *
+ * @param   p_pub_key[in]       Buffer with the peer public key
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_salt[in]          Buffer for the HKDF salt
+ *
+ * @param   salt_size[in]       Size of the HKDF salt
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info
+ *
+ * @param   key_size[in]        Size of each AES Key in bytes
+ *
+ * @param   p_secrets[out]      Array that returns secret_count secrets
+ *
+ * @param   secret_count[in]    Number of secrets to derive
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_ecdh_derive(void *p_ctx,
+                                       OCKAM_VAULT_KEY_e key_type,
+                                       uint8_t *p_pub_key, uint32_t pub_key_size,
+                                       uint8_t *p_salt, uint32_t salt_size,
+                                       uint8_t *p_info, uint32_t info_size,
+                                       uint32_t key_size,
+                                       void **p_secrets, uint32_t secret_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,7 @@
 /**
  ********************************************************************************************************
  * @file        linux.c
- * @brief   
+ * @brief   Kernel abstraction layer for Linux using POSIX threads
  ********************************************************************************************************
  */
 
@@ -11,6 +11,10 @@
  ********************************************************************************************************
  */
 
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
 #include <ockam/error.h>
 #include <ockam/kal.h>
 
@@ -33,18 +37,60 @@
  ********************************************************************************************************
  */
 
+/**
+ *******************************************************************************
+ * @struct  KAL_LINUX_QUEUE_s
+ * @brief   Fixed size ring buffer of item pointers
+ *******************************************************************************
+ */
+
+typedef struct {
+    pthread_mutex_t lock;                                       /*!< Protects the ring buffer indexes                 */
+    pthread_cond_t not_empty;                                   /*!< Signalled when an item is pushed                 */
+    pthread_cond_t not_full;                                    /*!< Signalled when an item is popped                 */
+    uint32_t size;                                              /*!< Maximum number of items in the queue             */
+    uint32_t head;                                              /*!< Index of the next item to pop                    */
+    uint32_t count;                                             /*!< Number of items currently in the queue           */
+    void **p_items;                                             /*!< Item storage, allocated after the struct         */
+} KAL_LINUX_QUEUE_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  KAL_LINUX_THREAD_s
+ * @brief   A started thread and the function it runs
+ *******************************************************************************
+ */
+
+typedef struct {
+    pthread_t thread;                                           /*!< POSIX thread handle                              */
+    OCKAM_KAL_THREAD_FN p_fn;                                   /*!< Function the thread runs                         */
+    void *p_arg;                                                /*!< Argument passed to the function                  */
+} KAL_LINUX_THREAD_s;
+
 /*
  ********************************************************************************************************
  *                                          FUNCTION PROTOTYPES                                         *
  ********************************************************************************************************
  */
 
+static void kal_linux_deadline(struct timespec *p_ts, uint32_t timeout_ms);
+
+static void *kal_linux_thread_start(void *p_arg);
+
 /*
  ********************************************************************************************************
  *                                            GLOBAL VARIABLES                                          *
  ********************************************************************************************************
  */
 
+static __thread uint32_t g_kal_linux_thread_id = 0;             /* Assigned on the first call from each thread, 0 is  */
+                                                                /* unassigned                                         */
+static uint32_t g_kal_linux_thread_count = 0;                   /* Last id handed out                                 */
+static pthread_mutex_t g_kal_linux_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_kal_linux_once_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
 /*
  ********************************************************************************************************
  *                                           GLOBAL FUNCTIONS                                           *
@@ -72,7 +118,32 @@
 
 OCKAM_ERR ockam_kal_mutex_init(OCKAM_KAL_MUTEX *p_mutex)
 {
-    return OCKAM_ERR_NONE;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    pthread_mutex_t *p_pmutex = 0;
+
+
+    do {
+        if(p_mutex == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_pmutex = malloc(sizeof(pthread_mutex_t));
+        if(p_pmutex == 0) {
+            ret_val = OCKAM_ERR_MEM_UNAVAIL;
+            break;
+        }
+
+        if(pthread_mutex_init(p_pmutex, 0) != 0) {
+            free(p_pmutex);
+            ret_val = OCKAM_ERR_KAL_INIT_FAIL;
+            break;
+        }
+
+        p_mutex->mutex_ptr = p_pmutex;
+    } while(0);
+
+    return ret_val;
 }
 
 
@@ -91,7 +162,21 @@ OCKAM_ERR ockam_kal_mutex_init(OCKAM_KAL_MUTEX *p_mutex)
 
 OCKAM_ERR ockam_kal_mutex_free(OCKAM_KAL_MUTEX *p_mutex)
 {
-    return OCKAM_ERR_NONE;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_mutex == 0) || (p_mutex->mutex_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        pthread_mutex_destroy((pthread_mutex_t*) p_mutex->mutex_ptr);
+        free(p_mutex->mutex_ptr);
+        p_mutex->mutex_ptr = 0;
+    } while(0);
+
+    return ret_val;
 }
 
 
@@ -116,7 +201,37 @@ OCKAM_ERR ockam_kal_mutex_lock(OCKAM_KAL_MUTEX *p_mutex,
                                OCKAM_KAL_OPT opt,
                                uint32_t timeout_ms)
 {
-    return OCKAM_ERR_NONE;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    pthread_mutex_t *p_pmutex = 0;
+    struct timespec deadline;
+    int status = 0;
+
+
+    do {
+        if((p_mutex == 0) || (p_mutex->mutex_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_pmutex = (pthread_mutex_t*) p_mutex->mutex_ptr;
+
+        if(opt & OCKAM_KAL_OPT_NON_BLOCKING) {                  /* Non-blocking only tries once                       */
+            status = pthread_mutex_trylock(p_pmutex);
+        } else if(timeout_ms != 0) {                            /* A timeout of 0 waits forever                       */
+            kal_linux_deadline(&deadline, timeout_ms);
+            status = pthread_mutex_timedlock(p_pmutex, &deadline);
+        } else {
+            status = pthread_mutex_lock(p_pmutex);
+        }
+
+        if((status == ETIMEDOUT) || (status == EBUSY)) {
+            ret_val = OCKAM_ERR_KAL_TIMEOUT;
+        } else if(status != 0) {
+            ret_val = OCKAM_ERR_KAL_LOCK_FAIL;
+        }
+    } while(0);
+
+    return ret_val;
 }
 
 
@@ -139,6 +254,731 @@ OCKAM_ERR ockam_kal_mutex_lock(OCKAM_KAL_MUTEX *p_mutex,
 OCKAM_ERR ockam_kal_mutex_unlock (OCKAM_KAL_MUTEX *p_mutex,
                                   OCKAM_KAL_OPT opt)
 {
-    return OCKAM_ERR_NONE;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_mutex == 0) || (p_mutex->mutex_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(pthread_mutex_unlock((pthread_mutex_t*) p_mutex->mutex_ptr) != 0) {
+            ret_val = OCKAM_ERR_KAL_LOCK_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_rwlock_init()
+ *
+ * @brief   Initialize a reader-writer lock
+ *
+ * @param   p_rwlock    The reader-writer lock object to initialize
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_rwlock_init(OCKAM_KAL_RWLOCK *p_rwlock)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    pthread_rwlock_t *p_prwlock = 0;
+
+
+    do {
+        if(p_rwlock == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_prwlock = malloc(sizeof(pthread_rwlock_t));
+        if(p_prwlock == 0) {
+            ret_val = OCKAM_ERR_MEM_UNAVAIL;
+            break;
+        }
+
+        if(pthread_rwlock_init(p_prwlock, 0) != 0) {
+            free(p_prwlock);
+            ret_val = OCKAM_ERR_KAL_INIT_FAIL;
+            break;
+        }
+
+        p_rwlock->rwlock_ptr = p_prwlock;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_rwlock_free()
+ *
+ * @brief   Free a reader-writer lock
+ *
+ * @param   p_rwlock    The reader-writer lock object to free
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_rwlock_free(OCKAM_KAL_RWLOCK *p_rwlock)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_rwlock == 0) || (p_rwlock->rwlock_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        pthread_rwlock_destroy((pthread_rwlock_t*) p_rwlock->rwlock_ptr);
+        free(p_rwlock->rwlock_ptr);
+        p_rwlock->rwlock_ptr = 0;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        ockam_kal_rwlock_read_lock()
+ *
+ * @brief   Lock a reader-writer lock shared with other readers
+ *
+ * @param   p_rwlock    The reader-writer lock to lock
+ *
+ * @param   opt         Options to pass into the lock
+ *
+ * @param   timeout_ms  The maximum amount of time to wait for the lock, 0 waits forever
+ *
+ * @return  OCKAM_ERR_NONE when the lock is acquired.
+ *          OCKAM_ERR_KAL_TIMEOUT if a writer holds the lock and the call did not wait for it.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_rwlock_read_lock(OCKAM_KAL_RWLOCK *p_rwlock,
+                                     OCKAM_KAL_OPT opt,
+                                     uint32_t timeout_ms)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    pthread_rwlock_t *p_prwlock = 0;
+    struct timespec deadline;
+    int status = 0;
+
+
+    do {
+        if((p_rwlock == 0) || (p_rwlock->rwlock_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_prwlock = (pthread_rwlock_t*) p_rwlock->rwlock_ptr;
+
+        if(opt & OCKAM_KAL_OPT_NON_BLOCKING) {
+            status = pthread_rwlock_tryrdlock(p_prwlock);
+        } else if(timeout_ms != 0) {
+            kal_linux_deadline(&deadline, timeout_ms);
+            status = pthread_rwlock_timedrdlock(p_prwlock, &deadline);
+        } else {
+            status = pthread_rwlock_rdlock(p_prwlock);
+        }
+
+        if((status == ETIMEDOUT) || (status == EBUSY)) {
+            ret_val = OCKAM_ERR_KAL_TIMEOUT;
+        } else if(status != 0) {
+            ret_val = OCKAM_ERR_KAL_LOCK_FAIL;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        ockam_kal_rwlock_write_lock()
+ *
+ * @brief   Lock a reader-writer lock exclusively, waiting for readers to leave
+ *
+ * @param   p_rwlock    The reader-writer lock to lock
+ *
+ * @param   opt         Options to pass into the lock
+ *
+ * @param   timeout_ms  The maximum amount of time to wait for the lock, 0 waits forever
+ *
+ * @return  OCKAM_ERR_NONE when the lock is acquired.
+ *          OCKAM_ERR_KAL_TIMEOUT if the lock is held and the call did not wait for it.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_rwlock_write_lock(OCKAM_KAL_RWLOCK *p_rwlock,
+                                      OCKAM_KAL_OPT opt,
+                                      uint32_t timeout_ms)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    pthread_rwlock_t *p_prwlock = 0;
+    struct timespec deadline;
+    int status = 0;
+
+
+    do {
+        if((p_rwlock == 0) || (p_rwlock->rwlock_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_prwlock = (pthread_rwlock_t*) p_rwlock->rwlock_ptr;
+
+        if(opt & OCKAM_KAL_OPT_NON_BLOCKING) {
+            status = pthread_rwlock_trywrlock(p_prwlock);
+        } else if(timeout_ms != 0) {
+            kal_linux_deadline(&deadline, timeout_ms);
+            status = pthread_rwlock_timedwrlock(p_prwlock, &deadline);
+        } else {
+            status = pthread_rwlock_wrlock(p_prwlock);
+        }
+
+        if((status == ETIMEDOUT) || (status == EBUSY)) {
+            ret_val = OCKAM_ERR_KAL_TIMEOUT;
+        } else if(status != 0) {
+            ret_val = OCKAM_ERR_KAL_LOCK_FAIL;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_rwlock_unlock()
+ *
+ * @brief   Release a reader-writer lock held for reading or writing
+ *
+ * @param   p_rwlock    The reader-writer lock to release
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_rwlock_unlock(OCKAM_KAL_RWLOCK *p_rwlock)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_rwlock == 0) || (p_rwlock->rwlock_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(pthread_rwlock_unlock((pthread_rwlock_t*) p_rwlock->rwlock_ptr) != 0) {
+            ret_val = OCKAM_ERR_KAL_LOCK_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_queue_init()
+ *
+ * @brief   Initialize a queue of item pointers
+ *
+ * @param   p_queue     The queue object to initialize
+ *
+ * @param   queue_size  Maximum number of items the queue can hold
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_queue_init(OCKAM_KAL_QUEUE *p_queue,
+                               uint32_t queue_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    KAL_LINUX_QUEUE_s *p_q = 0;
+
+
+    do {
+        if((p_queue == 0) || (queue_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_q = malloc(sizeof(KAL_LINUX_QUEUE_s) +                /* Item storage lives directly after the queue struct */
+                     (queue_size * sizeof(void*)));
+        if(p_q == 0) {
+            ret_val = OCKAM_ERR_MEM_UNAVAIL;
+            break;
+        }
+
+        p_q->p_items = (void**) (p_q + 1);
+        p_q->size = queue_size;
+        p_q->head = 0;
+        p_q->count = 0;
+
+        if(pthread_mutex_init(&(p_q->lock), 0) != 0) {
+            free(p_q);
+            ret_val = OCKAM_ERR_KAL_INIT_FAIL;
+            break;
+        }
+
+        pthread_cond_init(&(p_q->not_empty), 0);
+        pthread_cond_init(&(p_q->not_full), 0);
+
+        p_queue->queue_ptr = p_q;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_queue_free()
+ *
+ * @brief   Free a queue. Any items still in the queue are dropped.
+ *
+ * @param   p_queue     The queue object to free
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_queue_free(OCKAM_KAL_QUEUE *p_queue)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    KAL_LINUX_QUEUE_s *p_q = 0;
+
+
+    do {
+        if((p_queue == 0) || (p_queue->queue_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_q = (KAL_LINUX_QUEUE_s*) p_queue->queue_ptr;
+
+        pthread_cond_destroy(&(p_q->not_full));
+        pthread_cond_destroy(&(p_q->not_empty));
+        pthread_mutex_destroy(&(p_q->lock));
+        free(p_q);
+
+        p_queue->queue_ptr = 0;
+    } while(0);
+
+    return ret_val;
 }
 
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_queue_pop()
+ *
+ * @brief   Remove the oldest item from a queue
+ *
+ * @param   p_queue     The queue to pop from
+ *
+ * @param   p_item      Returns the item pointer that was pushed
+ *
+ * @param   opt         OCKAM_KAL_OPT_NON_BLOCKING to return immediately if the queue is empty
+ *
+ * @param   timeout_ms  The maximum amount of time to wait for an item. 0 waits forever.
+ *
+ * @return  OCKAM_ERR_NONE if an item was popped. OCKAM_ERR_KAL_QUEUE_EMPTY or OCKAM_ERR_KAL_TIMEOUT
+ *          if no item became available.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_queue_pop(OCKAM_KAL_QUEUE *p_queue,
+                              void **p_item,
+                              OCKAM_KAL_OPT opt,
+                              uint32_t timeout_ms)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    KAL_LINUX_QUEUE_s *p_q = 0;
+    struct timespec deadline;
+    int status = 0;
+
+
+    do {
+        if((p_queue == 0) || (p_queue->queue_ptr == 0) || (p_item == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_q = (KAL_LINUX_QUEUE_s*) p_queue->queue_ptr;
+
+        if(timeout_ms != 0) {
+            kal_linux_deadline(&deadline, timeout_ms);
+        }
+
+        pthread_mutex_lock(&(p_q->lock));
+
+        while((p_q->count == 0) && (status == 0)) {             /* Wait for an item unless the caller can't block     */
+            if(opt & OCKAM_KAL_OPT_NON_BLOCKING) {
+                status = EAGAIN;
+            } else if(timeout_ms != 0) {
+                status = pthread_cond_timedwait(&(p_q->not_empty), &(p_q->lock), &deadline);
+            } else {
+                status = pthread_cond_wait(&(p_q->not_empty), &(p_q->lock));
+            }
+        }
+
+        if(p_q->count != 0) {                                   /* An item may arrive together with the timeout       */
+            *p_item = p_q->p_items[p_q->head];
+            p_q->head = (p_q->head + 1) % p_q->size;
+            p_q->count--;
+            pthread_cond_signal(&(p_q->not_full));
+        } else if(status == EAGAIN) {
+            ret_val = OCKAM_ERR_KAL_QUEUE_EMPTY;
+        } else {
+            ret_val = OCKAM_ERR_KAL_TIMEOUT;
+        }
+
+        pthread_mutex_unlock(&(p_q->lock));
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_queue_push()
+ *
+ * @brief   Add an item to the back of a queue
+ *
+ * @param   p_queue     The queue to push to
+ *
+ * @param   p_item      The item pointer to queue. The queue does not copy what it points to.
+ *
+ * @param   opt         OCKAM_KAL_OPT_NON_BLOCKING to return immediately if the queue is full
+ *
+ * @return  OCKAM_ERR_NONE if the item was queued. OCKAM_ERR_KAL_QUEUE_FULL if the queue is full and
+ *          the call was non-blocking.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_queue_push(OCKAM_KAL_QUEUE *p_queue,
+                               void *p_item,
+                               OCKAM_KAL_OPT opt)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    KAL_LINUX_QUEUE_s *p_q = 0;
+
+
+    do {
+        if((p_queue == 0) || (p_queue->queue_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_q = (KAL_LINUX_QUEUE_s*) p_queue->queue_ptr;
+
+        pthread_mutex_lock(&(p_q->lock));
+
+        while((p_q->count == p_q->size) &&                      /* Wait for space unless the caller can't block       */
+              !(opt & OCKAM_KAL_OPT_NON_BLOCKING)) {
+            pthread_cond_wait(&(p_q->not_full), &(p_q->lock));
+        }
+
+        if(p_q->count < p_q->size) {
+            p_q->p_items[(p_q->head + p_q->count) % p_q->size] = p_item;
+            p_q->count++;
+            pthread_cond_signal(&(p_q->not_empty));
+        } else {
+            ret_val = OCKAM_ERR_KAL_QUEUE_FULL;
+        }
+
+        pthread_mutex_unlock(&(p_q->lock));
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_time_us()
+ *
+ * @brief   Read a monotonic clock for measuring elapsed time
+ *
+ * @param   p_time_us   Returns the current time in microseconds
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_time_us(uint64_t *p_time_us)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    struct timespec ts;
+
+
+    do {
+        if(p_time_us == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {          /* Unaffected by changes to the wall clock            */
+            ret_val = OCKAM_ERR_KAL_TIME_FAIL;
+            break;
+        }
+
+        *p_time_us = ((uint64_t) ts.tv_sec * 1000000u) + ((uint64_t) ts.tv_nsec / 1000u);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_thread_id()
+ *
+ * @brief   Get a small number identifying the calling thread. Ids are handed out in the order threads
+ *          first ask for one, so they can be used to spread threads evenly across a set of resources.
+ *
+ * @param   p_thread_id Returns the id of the calling thread, never 0
+ *
+ * @return  OCKAM_ERR_NONE on success.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_thread_id(uint32_t *p_thread_id)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(p_thread_id == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(g_kal_linux_thread_id == 0) {                        /* Only the first call from a thread takes the lock   */
+            pthread_mutex_lock(&g_kal_linux_thread_lock);
+            g_kal_linux_thread_count++;
+            if(g_kal_linux_thread_count == 0) {                 /* Skip 0 if the count ever wraps                     */
+                g_kal_linux_thread_count++;
+            }
+            g_kal_linux_thread_id = g_kal_linux_thread_count;
+            pthread_mutex_unlock(&g_kal_linux_thread_lock);
+        }
+
+        *p_thread_id = g_kal_linux_thread_id;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_thread_create()
+ *
+ * @brief   Start a thread running the specified function
+ *
+ * @param   p_thread    The thread object to initialize
+ *
+ * @param   p_fn        The function to run
+ *
+ * @param   p_arg       Argument passed to the function
+ *
+ * @return  OCKAM_ERR_NONE if the thread was started.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_thread_create(OCKAM_KAL_THREAD *p_thread,
+                                  OCKAM_KAL_THREAD_FN p_fn,
+                                  void *p_arg)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    KAL_LINUX_THREAD_s *p_t = 0;
+
+
+    do {
+        if((p_thread == 0) || (p_fn == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_t = malloc(sizeof(KAL_LINUX_THREAD_s));
+        if(p_t == 0) {
+            ret_val = OCKAM_ERR_MEM_UNAVAIL;
+            break;
+        }
+
+        p_t->p_fn = p_fn;
+        p_t->p_arg = p_arg;
+
+        if(pthread_create(&(p_t->thread), 0, kal_linux_thread_start, p_t) != 0) {
+            free(p_t);
+            ret_val = OCKAM_ERR_KAL_INIT_FAIL;
+            break;
+        }
+
+        p_thread->thread_ptr = p_t;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_kal_thread_join()
+ *
+ * @brief   Wait for a thread to return from its function and release it
+ *
+ * @param   p_thread    The thread object from ockam_kal_thread_create()
+ *
+ * @return  OCKAM_ERR_NONE once the thread has finished.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_thread_join(OCKAM_KAL_THREAD *p_thread)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    KAL_LINUX_THREAD_s *p_t = 0;
+
+
+    do {
+        if((p_thread == 0) || (p_thread->thread_ptr == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_t = (KAL_LINUX_THREAD_s*) p_thread->thread_ptr;
+
+        if(pthread_join(p_t->thread, 0) != 0) {
+            ret_val = OCKAM_ERR_KAL_LOCK_FAIL;
+            break;
+        }
+
+        free(p_t);
+        p_thread->thread_ptr = 0;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                            ockam_kal_once()
+ *
+ * @brief   Run an init function exactly once no matter how many threads call at the same time. Callers
+ *          wait until the function has finished. If it fails, the next call runs it again.
+ *
+ * @param   p_once      Statically initialized with OCKAM_KAL_ONCE_INIT
+ *
+ * @param   p_fn        The init function
+ *
+ * @return  OCKAM_ERR_NONE once the init function has succeeded, otherwise its error.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_kal_once(OCKAM_KAL_ONCE *p_once,
+                         OCKAM_KAL_ONCE_FN p_fn)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_once == 0) || (p_fn == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        pthread_mutex_lock(&g_kal_linux_once_lock);
+        if(p_once->done == 0) {
+            ret_val = p_fn();
+            if(ret_val == OCKAM_ERR_NONE) {
+                p_once->done = 1;
+            }
+        }
+        pthread_mutex_unlock(&g_kal_linux_once_lock);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          kal_linux_deadline()
+ *
+ * @brief   Convert a relative timeout into an absolute deadline for the pthread timed calls
+ *
+ * @param   p_ts        Returns the absolute deadline
+ *
+ * @param   timeout_ms  The relative timeout in milliseconds
+ *
+ ********************************************************************************************************
+ */
+
+static void kal_linux_deadline(struct timespec *p_ts, uint32_t timeout_ms)
+{
+    clock_gettime(CLOCK_REALTIME, p_ts);
+
+    p_ts->tv_sec += timeout_ms / 1000;
+    p_ts->tv_nsec += (long) (timeout_ms % 1000) * 1000000L;
+    if(p_ts->tv_nsec >= 1000000000L) {
+        p_ts->tv_sec++;
+        p_ts->tv_nsec -= 1000000000L;
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        kal_linux_thread_start()
+ *
+ * @brief   Entry point handed to pthread_create(). Runs the function given to ockam_kal_thread_create().
+ *
+ * @param   p_arg       The KAL_LINUX_THREAD_s of the thread
+ *
+ * @return  Always 0
+ *
+ ********************************************************************************************************
+ */
+
+static void *kal_linux_thread_start(void *p_arg)
+{
+    KAL_LINUX_THREAD_s *p_t = (KAL_LINUX_THREAD_s*) p_arg;
+
+
+    p_t->p_fn(p_t->p_arg);
+
+    return 0;
+}
@@ -0,0 +1,719 @@
+/**
+ ********************************************************************************************************
+ * @file    async.c
+ * @brief   Asynchronous request queue for the Ockam Vault
+ *
+ * Requests are pushed onto a KAL queue by the submitting thread and executed by one or more worker
+ * threads calling ockam_vault_async_run(). Secure element latency is only ever paid on the worker.
+ * Every priority lane has its own queue and workers, so a burst of key operations on the slow lane
+ * does not delay record encryption waiting on the fast lane. When dispatching, one-shot SHA256, HKDF
+ * and AES GCM calls routed to the TPM run on the host library while the TPM bus is held, so fast
+ * lane requests do not wait behind slow lane TPM commands either.
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <ockam/define.h>
+#include <ockam/error.h>
+
+#include <ockam/kal.h>
+#include <ockam/memory.h>
+#include <ockam/vault.h>
+#include <ockam/vault/async.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+/**
+ *******************************************************************************
+ * @struct  VAULT_ASYNC_LANE_s
+ * @brief   Queue and concurrency limit of one priority lane
+ *******************************************************************************
+ */
+
+typedef struct {
+    OCKAM_KAL_QUEUE queue;                                      /*!< Pending requests. A null item stops a worker.    */
+    OCKAM_KAL_QUEUE slots;                                      /*!< One item per request allowed to run at once      */
+    uint32_t max_active;                                        /*!< 0 if the lane has no concurrency limit           */
+} VAULT_ASYNC_LANE_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_ASYNC_s
+ * @brief   Async request queue bound to a vault instance
+ *******************************************************************************
+ */
+
+struct OCKAM_VAULT_ASYNC_s {
+    OCKAM_VAULT_s *p_vault;                                     /*!< Vault instance requests are executed on          */
+    VAULT_ASYNC_LANE_s lane[MAX_OCKAM_VAULT_ASYNC_LANE];        /*!< Requests waiting on each priority lane           */
+};
+
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_async_exec(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_REQ_s *p_req);
+
+static OCKAM_ERR vault_async_check(OCKAM_VAULT_REQ_s *p_req);
+
+static void vault_async_discard(OCKAM_VAULT_REQ_s *p_req);
+
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+                                                                /* Lane for each operation. Anything that may wait    */
+                                                                /* on a key operation in the TPM goes on the slow     */
+                                                                /* lane.                                              */
+static const OCKAM_VAULT_ASYNC_LANE_e g_vault_async_lane[MAX_OCKAM_VAULT_ASYNC_OP] = {
+    OCKAM_VAULT_ASYNC_LANE_SLOW,                                /* OCKAM_VAULT_ASYNC_OP_RANDOM                        */
+    OCKAM_VAULT_ASYNC_LANE_SLOW,                                /* OCKAM_VAULT_ASYNC_OP_KEY_GEN                       */
+    OCKAM_VAULT_ASYNC_LANE_SLOW,                                /* OCKAM_VAULT_ASYNC_OP_KEY_GET_PUB                   */
+    OCKAM_VAULT_ASYNC_LANE_SLOW,                                /* OCKAM_VAULT_ASYNC_OP_ECDH                          */
+    OCKAM_VAULT_ASYNC_LANE_FAST,                                /* OCKAM_VAULT_ASYNC_OP_SHA256                        */
+    OCKAM_VAULT_ASYNC_LANE_FAST,                                /* OCKAM_VAULT_ASYNC_OP_HKDF                          */
+    OCKAM_VAULT_ASYNC_LANE_FAST,                                /* OCKAM_VAULT_ASYNC_OP_AES_GCM                       */
+    OCKAM_VAULT_ASYNC_LANE_SLOW,                                /* OCKAM_VAULT_ASYNC_OP_KEY_POOL_FILL                 */
+    OCKAM_VAULT_ASYNC_LANE_SLOW                                 /* OCKAM_VAULT_ASYNC_OP_RANDOM_REFILL                 */
+};
+
+                                                                /* Set for operations that only write to the request  */
+                                                                /* buffers. Their result can be thrown away when the  */
+                                                                /* request is cancelled while running. Operations     */
+                                                                /* that change the vault keep their real result.      */
+static const uint8_t g_vault_async_pure[MAX_OCKAM_VAULT_ASYNC_OP] = {
+    1,                                                          /* OCKAM_VAULT_ASYNC_OP_RANDOM                        */
+    0,                                                          /* OCKAM_VAULT_ASYNC_OP_KEY_GEN                       */
+    1,                                                          /* OCKAM_VAULT_ASYNC_OP_KEY_GET_PUB                   */
+    1,                                                          /* OCKAM_VAULT_ASYNC_OP_ECDH                          */
+    1,                                                          /* OCKAM_VAULT_ASYNC_OP_SHA256                        */
+    1,                                                          /* OCKAM_VAULT_ASYNC_OP_HKDF                          */
+    1,                                                          /* OCKAM_VAULT_ASYNC_OP_AES_GCM                       */
+    0,                                                          /* OCKAM_VAULT_ASYNC_OP_KEY_POOL_FILL                 */
+    0                                                           /* OCKAM_VAULT_ASYNC_OP_RANDOM_REFILL                 */
+};
+
+/*
+ ********************************************************************************************************
+ *                                           GLOBAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_async_init()
+ *
+ * @brief   Create an async request queue for a vault instance
+ *
+ * @param   p_async[out]    Returns the handle for the async queue
+ *
+ * @param   p_vault[in]     Vault instance the requests are executed on
+ *
+ * @param   queue_size[in]  Maximum number of requests that can be pending at once on each lane
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_init(OCKAM_VAULT_ASYNC_s **p_async,
+                                 OCKAM_VAULT_s *p_vault,
+                                 uint32_t queue_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_ASYNC_s *p_new = 0;
+    uint32_t i;
+
+
+    do {
+        if((p_async == 0) || (p_vault == 0) || (queue_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(OCKAM_VAULT_ASYNC_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_set(p_new, 0, sizeof(OCKAM_VAULT_ASYNC_s));
+        p_new->p_vault = p_vault;
+
+        for(i = 0; i < MAX_OCKAM_VAULT_ASYNC_LANE; i++) {
+            ret_val = ockam_kal_queue_init(&(p_new->lane[i].queue), queue_size);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Release the lanes created before the failure       */
+            while(i > 0) {
+                i--;
+                ockam_kal_queue_free(&(p_new->lane[i].queue));
+            }
+
+            ockam_mem_free(p_new);
+            break;
+        }
+
+        *p_async = p_new;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_async_free()
+ *
+ * @brief   Free an async request queue. All workers must have been stopped first and any requests
+ *          still pending are dropped without their callbacks being called.
+ *
+ * @param   p_async[in]     The async queue to free
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_free(OCKAM_VAULT_ASYNC_s *p_async)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t i;
+
+
+    do {
+        if(p_async == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        for(i = 0; i < MAX_OCKAM_VAULT_ASYNC_LANE; i++) {
+            ockam_kal_queue_free(&(p_async->lane[i].queue));
+
+            if(p_async->lane[i].max_active != 0) {
+                ockam_kal_queue_free(&(p_async->lane[i].slots));
+            }
+        }
+
+        ret_val = ockam_mem_free(p_async);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        ockam_vault_async_limit_set()
+ *
+ * @brief   Limit how many requests of a lane can run at once across all of its workers. Extra
+ *          workers wait until a running request completes. Must be called before any worker is
+ *          started on the lane, and only once per lane.
+ *
+ * @param   p_async[in]     The async queue to configure
+ *
+ * @param   lane[in]        The lane to limit
+ *
+ * @param   max_active[in]  Most requests of the lane that can run at once. Must not be 0.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_limit_set(OCKAM_VAULT_ASYNC_s *p_async,
+                                      OCKAM_VAULT_ASYNC_LANE_e lane,
+                                      uint32_t max_active)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    VAULT_ASYNC_LANE_s *p_lane = 0;
+    uint32_t i;
+
+
+    do {
+        if((p_async == 0) || (lane >= MAX_OCKAM_VAULT_ASYNC_LANE) || (max_active == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_lane = &(p_async->lane[lane]);
+        if(p_lane->max_active != 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+                                                                /* The slot queue works as a counting semaphore.      */
+                                                                /* A worker pops a slot before taking a request       */
+                                                                /* and pushes it back when the request is done.       */
+        ret_val = ockam_kal_queue_init(&(p_lane->slots), max_active);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < max_active; i++) {
+            ret_val = ockam_kal_queue_push(&(p_lane->slots), p_async, OCKAM_KAL_OPT_NON_BLOCKING);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_kal_queue_free(&(p_lane->slots));
+            break;
+        }
+
+        p_lane->max_active = max_active;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_async_submit()
+ *
+ * @brief   Queue a request for a worker on the lane of its operation. Never blocks, so it is safe to
+ *          call from an event loop.
+ *
+ * @param   p_async[in]     The async queue to submit to
+ *
+ * @param   p_req[in]       The request. Must stay valid until its callback has been called.
+ *
+ * @return  OCKAM_ERR_NONE if queued. OCKAM_ERR_KAL_QUEUE_FULL if too many requests are pending on
+ *          the lane. OCKAM_ERR_VAULT_CANCELLED or OCKAM_ERR_VAULT_DEADLINE if the request is already
+ *          dead, in which case it is not queued and its callback is not called.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_submit(OCKAM_VAULT_ASYNC_s *p_async,
+                                   OCKAM_VAULT_REQ_s *p_req)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_async == 0) || (p_req == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_req->op >= MAX_OCKAM_VAULT_ASYNC_OP) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_async_check(p_req);                     /* Don't take up queue space for a dead request       */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+                                                                /* Never block the submitting thread. The caller can  */
+                                                                /* retry later if the lane is full.                   */
+        ret_val = ockam_kal_queue_push(&(p_async->lane[g_vault_async_lane[p_req->op]].queue),
+                                       p_req,
+                                       OCKAM_KAL_OPT_NON_BLOCKING);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_async_run()
+ *
+ * @brief   Execute one pending request of a lane and call its completion callback. Worker threads
+ *          call this in a loop until it returns OCKAM_ERR_VAULT_ASYNC_STOPPED, with at least one
+ *          worker per lane. An event loop can also call it with OCKAM_KAL_OPT_NON_BLOCKING to drain
+ *          the lanes inline, fast lane first.
+ *
+ * @param   p_async[in]     The async queue to run
+ *
+ * @param   lane[in]        The lane this worker serves
+ *
+ * @param   opt[in]         OCKAM_KAL_OPT_NON_BLOCKING to return immediately if nothing is pending
+ *
+ * @param   timeout_ms[in]  Maximum time to wait for a request when blocking. 0 waits forever. On a
+ *                          limited lane the wait for a free slot is bounded separately.
+ *
+ * @return  OCKAM_ERR_NONE if a request was executed. The request's own result is in p_req->result.
+ *          Requests cancelled or past their deadline when taken off the lane are not executed and
+ *          complete with OCKAM_ERR_VAULT_CANCELLED or OCKAM_ERR_VAULT_DEADLINE.
+ *          OCKAM_ERR_KAL_QUEUE_EMPTY or OCKAM_ERR_KAL_TIMEOUT if there was nothing to run or the
+ *          lane was at its limit.
+ *          OCKAM_ERR_VAULT_ASYNC_STOPPED if this worker was asked to stop.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_run(OCKAM_VAULT_ASYNC_s *p_async,
+                                OCKAM_VAULT_ASYNC_LANE_e lane,
+                                OCKAM_KAL_OPT opt,
+                                uint32_t timeout_ms)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    VAULT_ASYNC_LANE_s *p_lane = 0;
+    void *p_slot = 0;
+    void *p_item = 0;
+    OCKAM_VAULT_REQ_s *p_req = 0;
+
+
+    do {
+        if((p_async == 0) || (lane >= MAX_OCKAM_VAULT_ASYNC_LANE)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_lane = &(p_async->lane[lane]);
+
+        if(p_lane->max_active != 0) {                           /* Hold a slot before taking a request so no more     */
+            ret_val = ockam_kal_queue_pop(&(p_lane->slots),     /* than max_active requests of the lane run at once   */
+                                          &p_slot,
+                                          opt,
+                                          timeout_ms);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        ret_val = ockam_kal_queue_pop(&(p_lane->queue), &p_item, opt, timeout_ms);
+        if((ret_val == OCKAM_ERR_NONE) && (p_item == 0)) {      /* A null request is the stop signal for one worker   */
+            ret_val = OCKAM_ERR_VAULT_ASYNC_STOPPED;
+        }
+
+        if(ret_val == OCKAM_ERR_NONE) {
+            p_req = (OCKAM_VAULT_REQ_s*) p_item;
+            p_req->result = vault_async_check(p_req);           /* Dead requests never reach the vault or the TPM     */
+            if(p_req->result == OCKAM_ERR_NONE) {
+                p_req->result = vault_async_exec(p_async->p_vault, p_req);
+            }
+
+                                                                /* Cancelled while running. The work is done but the  */
+                                                                /* outputs are thrown away. Changes to the vault have */
+                                                                /* happened, so those requests report them instead.   */
+            if((p_req->result == OCKAM_ERR_NONE) && (p_req->p_token != 0) && (p_req->p_token->cancelled) &&
+               (g_vault_async_pure[p_req->op])) {
+                vault_async_discard(p_req);
+                p_req->result = OCKAM_ERR_VAULT_CANCELLED;
+            }
+        }
+
+        if(p_slot != 0) {                                       /* Give the slot back before the callback, which      */
+            ockam_kal_queue_push(&(p_lane->slots),              /* does not count against the limit                   */
+                                 p_slot,
+                                 OCKAM_KAL_OPT_NON_BLOCKING);
+        }
+
+        if((p_req != 0) && (p_req->cb != 0)) {                  /* The callback may reuse or free the request         */
+            p_req->cb(p_req);
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_async_stop()
+ *
+ * @brief   Ask one worker of a lane to stop. Requests queued on the lane before the stop are still
+ *          executed. Call once for every worker thread running on the lane.
+ *
+ * @param   p_async[in]     The async queue to stop a worker on
+ *
+ * @param   lane[in]        The lane the worker serves
+ *
+ * @return  OCKAM_ERR_NONE if the stop signal was queued.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_stop(OCKAM_VAULT_ASYNC_s *p_async,
+                                 OCKAM_VAULT_ASYNC_LANE_e lane)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((p_async == 0) || (lane >= MAX_OCKAM_VAULT_ASYNC_LANE)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+                                                                /* Stopping is not latency sensitive, wait for space  */
+        ret_val = ockam_kal_queue_push(&(p_async->lane[lane].queue),
+                                       0,
+                                       OCKAM_KAL_OPT_BLOCKING);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_async_cancel()
+ *
+ * @brief   Cancel every request carrying a token. Requests still queued complete without being
+ *          executed, and outputs of requests already running are discarded. Requests that change
+ *          the vault, such as key generation, cannot be undone once running and complete with their
+ *          real result. Callbacks are still called for all of them. Safe to call from any thread.
+ *
+ * @param   p_token[in]     The token to cancel
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_async_cancel(OCKAM_VAULT_ASYNC_TOKEN_s *p_token)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(p_token == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_token->cancelled = 1;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                            LOCAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_async_exec()
+ *
+ * @brief   Execute a request using the synchronous vault API
+ *
+ * @param   p_vault[in]     Vault instance to execute on
+ *
+ * @param   p_req[in]       The request to execute
+ *
+ * @return  The result of the vault call.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_async_exec(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_REQ_s *p_req)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    switch(p_req->op) {
+        case OCKAM_VAULT_ASYNC_OP_RANDOM:
+            ret_val = ockam_vault_random(p_vault,
+                                         p_req->args.random.p_rand_num,
+                                         p_req->args.random.rand_num_size);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_KEY_GEN:
+            ret_val = ockam_vault_key_gen(p_vault,
+                                          p_req->args.key_gen.key_type);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_KEY_GET_PUB:
+            ret_val = ockam_vault_key_get_pub(p_vault,
+                                              p_req->args.key_get_pub.key_type,
+                                              p_req->args.key_get_pub.p_pub_key,
+                                              p_req->args.key_get_pub.pub_key_size);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_ECDH:
+            ret_val = ockam_vault_ecdh(p_vault,
+                                       p_req->args.ecdh.key_type,
+                                       p_req->args.ecdh.p_pub_key,
+                                       p_req->args.ecdh.pub_key_size,
+                                       p_req->args.ecdh.p_pms,
+                                       p_req->args.ecdh.pms_size);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_SHA256:
+            ret_val = ockam_vault_sha256(p_vault,
+                                         p_req->args.sha256.p_msg,
+                                         p_req->args.sha256.msg_size,
+                                         p_req->args.sha256.p_digest,
+                                         p_req->args.sha256.digest_size);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_HKDF:
+            ret_val = ockam_vault_hkdf(p_vault,
+                                       p_req->args.hkdf.p_salt,
+                                       p_req->args.hkdf.salt_size,
+                                       p_req->args.hkdf.p_ikm,
+                                       p_req->args.hkdf.ikm_size,
+                                       p_req->args.hkdf.p_info,
+                                       p_req->args.hkdf.info_size,
+                                       p_req->args.hkdf.p_out,
+                                       p_req->args.hkdf.out_size);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_AES_GCM:
+            ret_val = ockam_vault_aes_gcm(p_vault,
+                                          p_req->args.aes_gcm.mode,
+                                          p_req->args.aes_gcm.p_key,
+                                          p_req->args.aes_gcm.key_size,
+                                          p_req->args.aes_gcm.p_iv,
+                                          p_req->args.aes_gcm.iv_size,
+                                          p_req->args.aes_gcm.p_aad,
+                                          p_req->args.aes_gcm.aad_size,
+                                          p_req->args.aes_gcm.p_tag,
+                                          p_req->args.aes_gcm.tag_size,
+                                          p_req->args.aes_gcm.p_input,
+                                          p_req->args.aes_gcm.input_size,
+                                          p_req->args.aes_gcm.p_output,
+                                          p_req->args.aes_gcm.output_size);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_KEY_POOL_FILL:
+            ret_val = ockam_vault_key_pool_fill(p_vault);
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_RANDOM_REFILL:
+            ret_val = ockam_vault_random_refill(p_vault);
+            break;
+
+        default:
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_async_check()
+ *
+ * @brief   Check whether a request should still be executed
+ *
+ * @param   p_req[in]       The request to check
+ *
+ * @return  OCKAM_ERR_NONE if the request is live. OCKAM_ERR_VAULT_CANCELLED if its token was
+ *          cancelled, OCKAM_ERR_VAULT_DEADLINE if its deadline has passed.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_async_check(OCKAM_VAULT_REQ_s *p_req)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint64_t now_us = 0;
+
+
+    do {
+        if((p_req->p_token != 0) && (p_req->p_token->cancelled)) {
+            ret_val = OCKAM_ERR_VAULT_CANCELLED;
+            break;
+        }
+
+        if(p_req->deadline_us == 0) {                           /* Only read the clock for requests with a deadline   */
+            break;
+        }
+
+        ret_val = ockam_kal_time_us(&now_us);
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Without a clock, run the request rather than drop  */
+            ret_val = OCKAM_ERR_NONE;                           /* it on a guess                                      */
+            break;
+        }
+
+        if(now_us > p_req->deadline_us) {
+            ret_val = OCKAM_ERR_VAULT_DEADLINE;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_async_discard()
+ *
+ * @brief   Clear secret outputs of a request whose result is being thrown away, so a caller that
+ *          ignores the result never sees random numbers, shared secrets or plaintext it cancelled
+ *
+ * @param   p_req[in]       The request that completed after being cancelled
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_async_discard(OCKAM_VAULT_REQ_s *p_req)
+{
+    switch(p_req->op) {
+        case OCKAM_VAULT_ASYNC_OP_RANDOM:
+            if(p_req->args.random.p_rand_num != 0) {
+                ockam_mem_set(p_req->args.random.p_rand_num, 0, p_req->args.random.rand_num_size);
+            }
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_ECDH:                         /* The shared secret is not left behind for a         */
+            if(p_req->args.ecdh.p_pms != 0) {                   /* connection that is gone                            */
+                ockam_mem_set(p_req->args.ecdh.p_pms, 0, p_req->args.ecdh.pms_size);
+            }
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_HKDF:
+            if(p_req->args.hkdf.p_out != 0) {
+                ockam_mem_set(p_req->args.hkdf.p_out, 0, p_req->args.hkdf.out_size);
+            }
+            break;
+
+        case OCKAM_VAULT_ASYNC_OP_AES_GCM:                      /* Ciphertext is not secret, plaintext is             */
+            if((p_req->args.aes_gcm.mode == OCKAM_VAULT_AES_GCM_MODE_DECRYPT) &&
+               (p_req->args.aes_gcm.p_output != 0)) {
+                ockam_mem_set(p_req->args.aes_gcm.p_output, 0, p_req->args.aes_gcm.output_size);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
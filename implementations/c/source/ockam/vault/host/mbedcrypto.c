@@ -17,15 +17,18 @@
 #include <ockam/memory.h>
 #include <ockam/vault.h>
 #include <ockam/vault/host.h>
+#include <ockam/vault/backend.h>
 
 #include "mbedtls/ecp.h"
 #include "mbedtls/ecdh.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
+#include "mbedtls/chacha20.h"
 #include "mbedtls/md.h"
 #include "mbedtls/hkdf.h"
 #include "mbedtls/gcm.h"
 #include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h"
 
 #if !defined(OCKAM_VAULT_CONFIG_FILE)
 #error "Error: Ockam Vault Config File Missing"
@@ -40,12 +43,54 @@
  ********************************************************************************************************
  */
 
-#define MBEDCRYPTO_KEY_CURVE25519_STATIC            0u
-#define MBEDCRYPTO_KEY_CURVE25519_EPHEMERAL         1u
-#define MBEDCRYPTO_KEY_CURVE25519_TOTAL             2u
+#define MBEDCRYPTO_KEY_SLAB_SIZE                    32u         /* Keys added to the key table at a time              */
+#define MBEDCRYPTO_KEY_GEN_BITS                     16u         /* Low bits of a key handle holding the generation,   */
+#define MBEDCRYPTO_KEY_GEN_MASK                     0xFFFFu     /* the rest hold the key slot                         */
+#define MBEDCRYPTO_KEY_SLOT_MAX                     0xFFFFu     /* Most key slots a handle can address                */
+#define MBEDCRYPTO_PMS_SIZE                         32u         /* Shared secret size for both supported curves       */
 
 #define MBEDCRYPTO_SHA256_IS224                     0u          /* Used to specify SHA256 rather than SHA224          */
 
+#define MBEDCRYPTO_HKDF_PRK_SIZE                    32u         /* HKDF-SHA256 pseudo-random key is one digest        */
+
+#define MBEDCRYPTO_AES_GCM_BLOCK_SIZE               16u         /* Only the last AES GCM update can be a partial block*/
+#define MBEDCRYPTO_AES_GCM_TAG_SIZE_MAX             16u         /* Largest tag mbedtls_gcm_finish() can produce       */
+#define MBEDCRYPTO_AES_GCM_KEY_SIZE_MAX             32u         /* AES-256 key size in bytes                          */
+
+#ifndef OCKAM_VAULT_CFG_HOST_DRBG_COUNT
+#define OCKAM_VAULT_CFG_HOST_DRBG_COUNT             4u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_HOST_DRBG
+#define OCKAM_VAULT_CFG_HOST_DRBG                   OCKAM_VAULT_HOST_DRBG_CTR
+#endif
+
+#ifndef OCKAM_VAULT_CFG_HOST_RESEED_INTERVAL
+#define OCKAM_VAULT_CFG_HOST_RESEED_INTERVAL        10000u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_HOST_SEED_TPM
+#define OCKAM_VAULT_CFG_HOST_SEED_TPM               OCKAM_VAULT_HOST_SEED_PLATFORM
+#endif
+
+#ifndef OCKAM_VAULT_CFG_KEY_POOL_SIZE
+#define OCKAM_VAULT_CFG_KEY_POOL_SIZE               0u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_PEER_CACHE_SIZE
+#define OCKAM_VAULT_CFG_PEER_CACHE_SIZE             0u
+#endif
+
+#define MBEDCRYPTO_ENTROPY_THRESHOLD                32u         /* Bytes every seed needs from the extra source       */
+#define MBEDCRYPTO_DRBG_PERS_SIZE                   32u         /* Personalization string plus the DRBG index         */
+
+#define MBEDCRYPTO_KEY_PUB_SIZE                     32u         /* Curve25519 public key                              */
+#define MBEDCRYPTO_PEER_KEY_SIZE                    32u         /* Largest peer public key kept in the peer cache     */
+
+#define MBEDCRYPTO_CHACHA_KEY_SIZE                  32u         /* ChaCha20 key, replaced after every refill          */
+#define MBEDCRYPTO_CHACHA_NONCE_SIZE                12u         /* Always zero since no key is ever used twice        */
+#define MBEDCRYPTO_CHACHA_BUF_SIZE                  512u        /* Keystream generated per refill, including next key */
+
 
 /*
  ********************************************************************************************************
@@ -60,6 +105,182 @@
  ********************************************************************************************************
  */
 
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_KEY_s
+ * @brief   Entry in the key table of a vault instance
+ *******************************************************************************
+ */
+
+typedef struct MBEDCRYPTO_KEY_s {
+    mbedtls_ecp_keypair keypair;                                /*!< Curve25519 keypair, empty until generated        */
+    void *p_owner;                                              /*!< Context the key belongs to, 0 while free         */
+    uint32_t slot;                                              /*!< Position in the key table, from 1                */
+    uint32_t gen;                                               /*!< Bumped on release so stale handles are caught    */
+    struct MBEDCRYPTO_KEY_s *p_next;                            /*!< Next free key while on the free list             */
+    uint8_t pub[MBEDCRYPTO_KEY_PUB_SIZE];                       /*!< Public key as last handed out                    */
+    uint32_t pub_size;                                          /*!< Bytes in pub, 0 when the key has changed         */
+} MBEDCRYPTO_KEY_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_KEY_SLAB_s
+ * @brief   Block of keys added to the key table with a single allocation
+ *******************************************************************************
+ */
+
+typedef struct MBEDCRYPTO_KEY_SLAB_s {
+    struct MBEDCRYPTO_KEY_SLAB_s *p_next;                       /*!< Next slab owned by the same context              */
+    uint32_t base;                                              /*!< Slot of the first key in this slab               */
+    MBEDCRYPTO_KEY_s key[MBEDCRYPTO_KEY_SLAB_SIZE];             /*!< Keys in this slab                                */
+} MBEDCRYPTO_KEY_SLAB_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_DRBG_s
+ * @brief   CTR DRBG handed out to the threads using a vault instance
+ *******************************************************************************
+ */
+
+typedef struct {
+    OCKAM_KAL_MUTEX mutex;                                      /*!< Held while generating or reseeding               */
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+    uint8_t key[MBEDCRYPTO_CHACHA_KEY_SIZE];                    /*!< Key for the next refill                          */
+    uint8_t buf[MBEDCRYPTO_CHACHA_BUF_SIZE];                    /*!< Keystream, wiped as it is handed out             */
+    uint32_t avail;                                             /*!< Unused bytes at the end of buf                   */
+    uint32_t requests;                                          /*!< Requests served since the last reseed            */
+#else
+    mbedtls_ctr_drbg_context ctr_drbg;                          /*!< Seeded and reseeded separately from the others   */
+#endif
+} MBEDCRYPTO_DRBG_s;
+
+
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_PEER_s
+ * @brief   Peer public key decoded and checked by an earlier ECDH
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint8_t pub_key[MBEDCRYPTO_PEER_KEY_SIZE];                  /*!< Public key as received from the peer             */
+    uint32_t pub_key_size;                                      /*!< Bytes in pub_key                                 */
+    mbedtls_ecp_point point;                                    /*!< Decoded point, ready for ECDH                    */
+    uint64_t last_use;                                          /*!< ECDH count at the last use, 0 while empty        */
+} MBEDCRYPTO_PEER_s;
+#endif
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_CTX_s
+ * @brief   mbedcrypto state owned by a single vault instance
+ *******************************************************************************
+ */
+
+typedef struct {
+    mbedtls_entropy_context entropy;                            /*!< Platform entropy shared by every DRBG            */
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+    mbedtls_entropy_context entropy_mix;                        /*!< Platform entropy plus the extra source           */
+#endif
+    OCKAM_KAL_MUTEX entropy_mutex;                              /*!< Serializes seeding and reseeding                 */
+    OCKAM_VAULT_HOST_ENTROPY entropy_source;                    /*!< Extra entropy source, 0 if platform only         */
+    void *p_entropy_arg;                                        /*!< Argument for the extra entropy source            */
+    OCKAM_ERR entropy_err;                                      /*!< Last result of the extra entropy source          */
+    MBEDCRYPTO_DRBG_s drbg[OCKAM_VAULT_CFG_HOST_DRBG_COUNT];    /*!< Threads are spread across these by thread id     */
+    OCKAM_KAL_MUTEX key_mutex;                                  /*!< Protects the key table and its entries           */
+    MBEDCRYPTO_KEY_SLAB_s *p_key_slab;                          /*!< Every slab of the key table, newest first        */
+    uint32_t key_slots;                                         /*!< Key slots in the table                           */
+    MBEDCRYPTO_KEY_s *p_key_free;                               /*!< Keys ready to be handed out                      */
+    MBEDCRYPTO_KEY_s *p_key_type[MAX_OCKAM_VAULT_KEY];          /*!< Keys behind the static and ephemeral types       */
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+    OCKAM_KAL_MUTEX pool_mutex;                                 /*!< Protects the pool, not held while generating     */
+    mbedtls_ecp_keypair pool[OCKAM_VAULT_CFG_KEY_POOL_SIZE];    /*!< Keys generated ahead of time                     */
+    uint32_t pool_count;                                        /*!< Ready keys, from the start of pool               */
+#endif
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+    OCKAM_KAL_MUTEX peer_mutex;                                 /*!< Protects the peer cache                          */
+    MBEDCRYPTO_PEER_s peer[OCKAM_VAULT_CFG_PEER_CACHE_SIZE];    /*!< Decoded public keys of recent peers              */
+    uint64_t peer_uses;                                         /*!< ECDH calls that went through the peer cache      */
+#endif
+} MBEDCRYPTO_CTX_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_IOV_CURSOR_s
+ * @brief   Current position within a scatter/gather buffer
+ *******************************************************************************
+ */
+
+typedef struct {
+    OCKAM_VAULT_IOVEC_s *p_iov;                                 /*!< Fragments being walked                           */
+    uint32_t count;                                             /*!< Number of fragments                              */
+    uint32_t idx;                                               /*!< Current fragment                                 */
+    uint32_t off;                                               /*!< Offset within the current fragment               */
+} MBEDCRYPTO_IOV_CURSOR_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_HKDF_PRK_s
+ * @brief   Pseudo-random key kept from an HKDF extract
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint8_t prk[MBEDCRYPTO_HKDF_PRK_SIZE];                      /*!< Output of the extract stage                      */
+} MBEDCRYPTO_HKDF_PRK_s;
+
+
+/**
+ *******************************************************************************
+ * @enum    MBEDCRYPTO_AES_GCM_STATE_e
+ * @brief   Progress of a streaming AES GCM operation
+ *******************************************************************************
+ */
+
+typedef enum {
+    MBEDCRYPTO_AES_GCM_STATE_AAD = 0,                           /* Collecting additional data, GCM not started        */
+    MBEDCRYPTO_AES_GCM_STATE_DATA,                              /* Started, full blocks processed so far              */
+    MBEDCRYPTO_AES_GCM_STATE_PARTIAL,                           /* A partial block was processed, only finish allowed */
+    MBEDCRYPTO_AES_GCM_STATE_DONE                               /* Tag output or verified                             */
+} MBEDCRYPTO_AES_GCM_STATE_e;
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_AES_GCM_CTX_s
+ * @brief   State for a streaming AES GCM operation
+ *******************************************************************************
+ */
+
+typedef struct {
+    mbedtls_gcm_context gcm;                                    /*!< GCM context with the key set                     */
+    OCKAM_VAULT_AES_GCM_MODE_e mode;                            /*!< Encrypt or decrypt                               */
+    MBEDCRYPTO_AES_GCM_STATE_e state;                           /*!< Progress of the operation                        */
+    uint8_t *p_iv;                                              /*!< Copy of the IV until GCM is started              */
+    uint32_t iv_size;                                           /*!< Size of the IV                                   */
+    uint8_t *p_aad;                                             /*!< Additional data collected so far                 */
+    uint32_t aad_size;                                          /*!< Size of the additional data collected            */
+} MBEDCRYPTO_AES_GCM_CTX_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  MBEDCRYPTO_SECRET_s
+ * @brief   AES key loaded once and used by handle
+ *******************************************************************************
+ */
+
+typedef struct {
+    OCKAM_KAL_MUTEX mutex;                                      /*!< Held while gcm is in use by a call               */
+    mbedtls_gcm_context gcm;                                    /*!< GCM context with the key set                     */
+} MBEDCRYPTO_SECRET_s;
+
 
 /*
  ********************************************************************************************************
@@ -67,6 +288,90 @@
  ********************************************************************************************************
  */
 
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_HOST_MBEDCRYPTO)
+static int mbedcrypto_entropy(void *p_arg, unsigned char *p_buf, size_t size);
+
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+static int mbedcrypto_entropy_source(void *p_arg, unsigned char *p_buf, size_t size, size_t *p_size);
+#elif(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_ONLY)
+static int mbedcrypto_entropy_extra(MBEDCRYPTO_CTX_s *p_mbed_ctx, unsigned char *p_buf, size_t size);
+#endif
+
+static void mbedcrypto_drbg_init(MBEDCRYPTO_DRBG_s *p_drbg);
+
+static int mbedcrypto_drbg_seed(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_DRBG_s *p_drbg, uint32_t index);
+
+static void mbedcrypto_drbg_free(MBEDCRYPTO_DRBG_s *p_drbg);
+
+static int mbedcrypto_drbg_random(void *p_arg, unsigned char *p_buf, size_t size);
+
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+static int mbedcrypto_chacha_random(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_DRBG_s *p_drbg,
+                                    unsigned char *p_buf, size_t size);
+#endif
+#endif
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH, OCKAM_VAULT_HOST_MBEDCRYPTO))
+static OCKAM_ERR mbedcrypto_key_alloc(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_KEY_s **p_key);
+
+static void mbedcrypto_key_release(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_KEY_s *p_key);
+
+static OCKAM_ERR mbedcrypto_key_commit(MBEDCRYPTO_CTX_s *p_mbed_ctx, void *p_handle,
+                                       mbedtls_ecp_keypair *p_keypair);
+
+static void *mbedcrypto_key_handle(MBEDCRYPTO_KEY_s *p_key);
+
+static OCKAM_ERR mbedcrypto_key_check(MBEDCRYPTO_CTX_s *p_mbed_ctx, void *p_handle, MBEDCRYPTO_KEY_s **p_key);
+
+static OCKAM_ERR mbedcrypto_key_type(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                     OCKAM_VAULT_KEY_e key_type,
+                                     MBEDCRYPTO_KEY_s **p_key);
+
+static OCKAM_ERR mbedcrypto_key_gen(MBEDCRYPTO_CTX_s *p_mbed_ctx, mbedtls_ecp_keypair *p_key);
+
+static OCKAM_ERR mbedcrypto_key_gen_pooled(MBEDCRYPTO_CTX_s *p_mbed_ctx, mbedtls_ecp_keypair *p_key);
+
+static OCKAM_ERR mbedcrypto_key_get_pub(MBEDCRYPTO_KEY_s *p_key,
+                                        uint8_t *p_pub_key, uint32_t pub_key_size);
+
+static OCKAM_ERR mbedcrypto_key_write(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                      mbedtls_ecp_keypair *p_ecp,
+                                      uint8_t *p_priv_key, uint32_t priv_key_size);
+
+static OCKAM_ERR mbedcrypto_ecdh(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                 mbedtls_ecp_keypair *p_key,
+                                 uint8_t *p_pub_key, uint32_t pub_key_size,
+                                 uint8_t *p_pms, uint32_t pms_size);
+
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+static OCKAM_ERR mbedcrypto_peer_get(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                     mbedtls_ecp_group *p_grp,
+                                     uint8_t *p_pub_key, uint32_t pub_key_size,
+                                     mbedtls_ecp_point *p_point);
+#endif
+#endif
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_AES_GCM, OCKAM_VAULT_HOST_MBEDCRYPTO))
+static OCKAM_ERR mbedcrypto_aes_gcm_rec(mbedtls_gcm_context *p_gcm,
+                                        OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                        OCKAM_VAULT_AES_GCM_REC_s *p_rec);
+
+static OCKAM_ERR mbedcrypto_aes_gcm_iov_update(mbedtls_gcm_context *p_gcm,
+                                               OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                               OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count);
+
+static OCKAM_ERR mbedcrypto_iov_size(OCKAM_VAULT_IOVEC_s *p_iov, uint32_t count, uint32_t *p_size);
+
+static uint32_t mbedcrypto_iov_run(MBEDCRYPTO_IOV_CURSOR_s *p_cur);
+
+static void mbedcrypto_iov_skip(MBEDCRYPTO_IOV_CURSOR_s *p_cur, uint32_t size);
+
+static uint32_t mbedcrypto_iov_read(MBEDCRYPTO_IOV_CURSOR_s *p_cur, uint8_t *p_buf, uint32_t size);
+
+static void mbedcrypto_iov_write(MBEDCRYPTO_IOV_CURSOR_s *p_cur, uint8_t *p_buf, uint32_t size);
+
+static OCKAM_ERR mbedcrypto_aes_gcm_ctx_start(MBEDCRYPTO_AES_GCM_CTX_s *p_stream);
+#endif
 
 /*
  ********************************************************************************************************
@@ -77,9 +382,11 @@
 uint32_t g_mbedcrypto_str_len = 23;
 char *g_mbedcrypto_str = "ockam_mbedcrypto_string";
 
-mbedtls_entropy_context g_entropy;
-mbedtls_ctr_drbg_context g_ctr_drbg;
-mbedtls_ecp_keypair g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_TOTAL];
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+                                                                /* ChaCha20 encrypts zeros to produce keystream. The  */
+                                                                /* first bytes double as the all zero nonce.          */
+static const uint8_t g_mbedcrypto_chacha_zero[MBEDCRYPTO_CHACHA_BUF_SIZE] = {0};
+#endif
 
 
 /*
@@ -105,249 +412,3125 @@ mbedtls_ecp_keypair g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_TOTAL];
  *
  * @brief   Initialize mbedtls for crypto operations
  *
- * @param   p_arg   Optional void* argument
+ * @param   p_arg[in]           Optional void* argument
+ *
+ * @param   entropy[in]         Optional entropy source, see OCKAM_VAULT_CFG_HOST_SEED_TPM
+ *
+ * @param   p_entropy_arg[in]   Passed to the entropy source
+ *
+ * @param   p_ctx[out]          Returns the mbedcrypto context allocated for the vault instance
  *
  * @return  OCKAM_ERR_NONE if initialized successfully.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_init(void *p_arg)
+OCKAM_ERR ockam_vault_host_init(void *p_arg,
+                                OCKAM_VAULT_HOST_ENTROPY entropy, void *p_entropy_arg,
+                                void **p_ctx)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     int mbed_ret = 0;
+    uint32_t i = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = 0;
 
 
     do {
-        mbedtls_entropy_init(&g_entropy);                       /* Initialize the entropy before CTR DRBG. Both inits */
-        mbedtls_ctr_drbg_init(&g_ctr_drbg);                     /* have no return value.                              */
-
-        mbed_ret = mbedtls_ctr_drbg_seed(&g_ctr_drbg,           /* Seed the CTR DRBG using exisitng entropy and the   */
-                                         mbedtls_entropy_func,  /* personalization string                             */
-                                         &g_entropy,
-                                         (const unsigned char*) g_mbedcrypto_str,
-                                         g_mbedcrypto_str_len);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_INIT_FAIL;
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
-    } while(0);
 
-    return ret_val;
-}
+        ret_val = ockam_mem_alloc((void**) &p_mbed_ctx,         /* Every vault instance gets its own DRBG and keys    */
+                                  sizeof(MBEDCRYPTO_CTX_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
 
+        mbedtls_entropy_init(&(p_mbed_ctx->entropy));           /* Initialize the entropy before CTR DRBG. Both inits */
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+        mbedtls_entropy_init(&(p_mbed_ctx->entropy_mix));
+#endif
+        p_mbed_ctx->entropy_mutex.mutex_ptr = 0;                /* have no return value. Mutexes are created below so */
+        for(i = 0; i < OCKAM_VAULT_CFG_HOST_DRBG_COUNT; i++) {  /* free can tell which ones exist.                    */
+            mbedcrypto_drbg_init(&(p_mbed_ctx->drbg[i]));
+        }
 
-#endif                                                          /* OCKAM_VAULT_CFG_INIT                               */
+        p_mbed_ctx->key_mutex.mutex_ptr = 0;                    /* Key table starts empty and grows by a slab at a    */
+        p_mbed_ctx->p_key_slab = 0;                             /* time as keys are needed                            */
+        p_mbed_ctx->p_key_free = 0;
+        p_mbed_ctx->key_slots = 0;
+        for(i = 0; i < MAX_OCKAM_VAULT_KEY; i++) {
+            p_mbed_ctx->p_key_type[i] = 0;
+        }
 
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+        p_mbed_ctx->pool_mutex.mutex_ptr = 0;                   /* Pool starts empty until the first fill             */
+        p_mbed_ctx->pool_count = 0;
+        for(i = 0; i < OCKAM_VAULT_CFG_KEY_POOL_SIZE; i++) {
+            mbedtls_ecp_keypair_init(&(p_mbed_ctx->pool[i]));
+        }
+#endif
 
-/*
- ********************************************************************************************************
- ********************************************************************************************************
- *                                         OCKAM_VAULT_CFG_RAND
- ********************************************************************************************************
- ********************************************************************************************************
- */
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+        p_mbed_ctx->peer_mutex.mutex_ptr = 0;                   /* Peer cache starts empty                            */
+        p_mbed_ctx->peer_uses = 0;
+        for(i = 0; i < OCKAM_VAULT_CFG_PEER_CACHE_SIZE; i++) {
+            mbedtls_ecp_point_init(&(p_mbed_ctx->peer[i].point));
+            p_mbed_ctx->peer[i].pub_key_size = 0;
+            p_mbed_ctx->peer[i].last_use = 0;
+        }
+#endif
 
-#if(OCKAM_VAULT_CFG_RAND == OCKAM_VAULT_HOST_MBEDCRYPTO)
+        ret_val = ockam_kal_mutex_init(&(p_mbed_ctx->entropy_mutex));
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_host_free(p_mbed_ctx);
+            break;
+        }
 
-/*
- ********************************************************************************************************
- *                                        ockam_vault_tpm_random()
- ********************************************************************************************************
- */
+        ret_val = ockam_kal_mutex_init(&(p_mbed_ctx->key_mutex));
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_host_free(p_mbed_ctx);
+            break;
+        }
 
-OCKAM_ERR ockam_vault_host_random(uint8_t *p_rand_num, uint32_t rand_num_size)
-{
-    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    int mbed_ret = 0;
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+        ret_val = ockam_kal_mutex_init(&(p_mbed_ctx->peer_mutex));
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_host_free(p_mbed_ctx);
+            break;
+        }
+#endif
 
-    mbed_ret = mbedtls_ctr_drbg_random(&g_ctr_drbg,
-                                       p_rand_num,
-                                       rand_num_size);
-    if(mbed_ret != 0) {
-        ret_val = OCKAM_ERR_VAULT_HOST_RAND_FAIL;
-    }
+        p_mbed_ctx->entropy_source = entropy;
+        p_mbed_ctx->p_entropy_arg = p_entropy_arg;
+        p_mbed_ctx->entropy_err = OCKAM_ERR_NONE;
+
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+                                                                /* The extra source is a strong source with its own   */
+                                                                /* threshold, so every seed holds 32 bytes from it as */
+                                                                /* well as the platform entropy.                      */
+        if(entropy != 0) {
+            mbed_ret = mbedtls_entropy_add_source(&(p_mbed_ctx->entropy_mix),
+                                                  mbedcrypto_entropy_source,
+                                                  p_mbed_ctx,
+                                                  MBEDCRYPTO_ENTROPY_THRESHOLD,
+                                                  MBEDTLS_ENTROPY_SOURCE_STRONG);
+            if(mbed_ret != 0) {
+                ockam_vault_host_free(p_mbed_ctx);
+                ret_val = OCKAM_ERR_VAULT_HOST_INIT_FAIL;
+                break;
+            }
+        }
+#endif
 
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+        ret_val = ockam_kal_mutex_init(&(p_mbed_ctx->pool_mutex));
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_host_free(p_mbed_ctx);
+            break;
+        }
+#endif
 
-    return ret_val;
-}
+        for(i = 0; i < OCKAM_VAULT_CFG_HOST_DRBG_COUNT; i++) {
+            ret_val = ockam_kal_mutex_init(&(p_mbed_ctx->drbg[i].mutex));
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
 
+            mbed_ret = mbedcrypto_drbg_seed(p_mbed_ctx, &(p_mbed_ctx->drbg[i]), i);
+            if(mbed_ret != 0) {
+                ret_val = OCKAM_ERR_VAULT_HOST_INIT_FAIL;
+                break;
+            }
+        }
 
-#endif                                                          /* OCKAM_VAULT_CFG_RAND                               */
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_host_free(p_mbed_ctx);
+            break;
+        }
 
+        *p_ctx = p_mbed_ctx;
+    } while(0);
 
-/*
- ********************************************************************************************************
- ********************************************************************************************************
- *                                      OCKAM_VAULT_CFG_KEY_ECDH
- ********************************************************************************************************
- ********************************************************************************************************
- */
+    return ret_val;
+}
 
-#if(OCKAM_VAULT_CFG_KEY_ECDH == OCKAM_VAULT_HOST_MBEDCRYPTO)
 
-/*
+/**
  ********************************************************************************************************
- *                                     ockam_vault_host_key_gen()
+ *                                         ockam_vault_host_free()
+ *
+ * @brief   Free the mbedtls state owned by a vault instance
+ *
+ * @param   p_ctx[in]   The mbedcrypto context returned from ockam_vault_host_init()
+ *
+ * @return  OCKAM_ERR_NONE if freed successfully.
+ *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_key_gen(OCKAM_VAULT_KEY_e key_type)
+OCKAM_ERR ockam_vault_host_free(void *p_ctx)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    int mbed_ret = 0;
-    mbedtls_ecp_keypair *p_key = 0;
+    uint32_t i = 0;
+    MBEDCRYPTO_KEY_SLAB_s *p_slab = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
 
 
     do {
-        if(key_type == OCKAM_VAULT_KEY_STATIC) {                /* Set the keypair data based on the desired key      */
-            p_key = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_STATIC];
-        } else if(key_type == OCKAM_VAULT_KEY_EPHEMERAL) {
-            p_key = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_EPHEMERAL];
-        } else {
+        if(p_mbed_ctx == 0) {
             ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        mbedtls_ecp_keypair_init(p_key);                        /* Always initialize the keypair first                */
+        while(p_mbed_ctx->p_key_slab != 0) {                    /* Clear out all key material before releasing the    */
+            p_slab = p_mbed_ctx->p_key_slab;                    /* memory. Free keys are empty but still initialized. */
+            p_mbed_ctx->p_key_slab = p_slab->p_next;
 
-                                                                /* Generate the keypair on Curve25519                 */
-        mbed_ret = mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_CURVE25519,
-                                       p_key,
-                                       mbedtls_ctr_drbg_random,
-                                       &g_ctr_drbg);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
+            for(i = 0; i < MBEDCRYPTO_KEY_SLAB_SIZE; i++) {
+                mbedtls_ecp_keypair_free(&(p_slab->key[i].keypair));
+            }
+
+            ockam_mem_free(p_slab);
         }
+        ockam_kal_mutex_free(&(p_mbed_ctx->key_mutex));
 
-        mbed_ret = mbedtls_ecp_check_pubkey(&(p_key->grp),      /* Check that generated public key lies on the curve  */
-                                            &(p_key->Q));
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
+                                                                /* Mutexes that were never created are skipped by     */
+                                                                /* ockam_kal_mutex_free()                             */
+        for(i = 0; i < OCKAM_VAULT_CFG_HOST_DRBG_COUNT; i++) {
+            mbedcrypto_drbg_free(&(p_mbed_ctx->drbg[i]));
         }
 
-        mbed_ret = mbedtls_ecp_check_privkey(&(p_key->grp),     /* Check that the generated private key is valid      */
-                                             &(p_key->d));
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+        for(i = 0; i < OCKAM_VAULT_CFG_KEY_POOL_SIZE; i++) {    /* Keys still in the pool were never handed out       */
+            mbedtls_ecp_keypair_free(&(p_mbed_ctx->pool[i]));
+        }
+        ockam_kal_mutex_free(&(p_mbed_ctx->pool_mutex));
+#endif
+
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+        for(i = 0; i < OCKAM_VAULT_CFG_PEER_CACHE_SIZE; i++) {
+            mbedtls_ecp_point_free(&(p_mbed_ctx->peer[i].point));
         }
+        ockam_kal_mutex_free(&(p_mbed_ctx->peer_mutex));
+#endif
+
+        mbedtls_entropy_free(&(p_mbed_ctx->entropy));
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+        mbedtls_entropy_free(&(p_mbed_ctx->entropy_mix));
+#endif
+        ockam_kal_mutex_free(&(p_mbed_ctx->entropy_mutex));
+
+        ret_val = ockam_mem_free(p_mbed_ctx);
     } while(0);
 
     return ret_val;
 }
 
 
-/*
+/**
  ********************************************************************************************************
- *                                      ockam_vault_host_key_get_pub()
+ *                                         mbedcrypto_entropy()
+ *
+ * @brief   Entropy callback for the CTR DRBGs. Each DRBG seeds and reseeds on its own schedule, so
+ *          calls to the shared entropy source are serialized here. With an extra entropy source the
+ *          seed is taken as set by OCKAM_VAULT_CFG_HOST_SEED_TPM, and only falls back to platform
+ *          entropy alone when the extra source reports that it is down.
+ *
+ * @param   p_arg[in]   The mbedcrypto context owning the entropy source
+ *
+ * @param   p_buf[out]  Buffer to fill with entropy
+ *
+ * @param   size[in]    Number of bytes to fill
+ *
+ * @return  0 if successful, otherwise an mbedtls error code.
+ *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_key_get_pub(OCKAM_VAULT_KEY_e key_type,
-                                       uint8_t *p_pub_key,
-                                       uint32_t pub_key_size)
+static int mbedcrypto_entropy(void *p_arg, unsigned char *p_buf, size_t size)
 {
-    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     int mbed_ret = 0;
-    mbedtls_ecp_keypair *p_key = 0;
-    size_t olen = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_arg;
 
 
     do {
-        if(key_type == OCKAM_VAULT_KEY_STATIC) {                /* Set the keypair data based on the desired key      */
-            p_key = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_STATIC];
-        } else if(key_type == OCKAM_VAULT_KEY_EPHEMERAL) {
-            p_key = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_EPHEMERAL];
-        } else {
-            ret_val = OCKAM_ERR_INVALID_PARAM;
+        if(ockam_kal_mutex_lock(&(p_mbed_ctx->entropy_mutex), 0, 0) != OCKAM_ERR_NONE) {
+            mbed_ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
             break;
         }
 
-        mbed_ret = mbedtls_ecp_point_write_binary(&(p_key->grp),
-                                                  &(p_key->Q),
-                                                  MBEDTLS_ECP_PF_UNCOMPRESSED,
-                                                  &olen,
-                                                  p_pub_key,
-                                                  pub_key_size);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM != OCKAM_VAULT_HOST_SEED_PLATFORM)
+        if(p_mbed_ctx->entropy_source != 0) {
+            p_mbed_ctx->entropy_err = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+            mbed_ret = mbedtls_entropy_func(&(p_mbed_ctx->entropy_mix), p_buf, size);
+#else
+            mbed_ret = mbedcrypto_entropy_extra(p_mbed_ctx, p_buf, size);
+#endif
+            if((mbed_ret == 0) || (p_mbed_ctx->entropy_err != OCKAM_ERR_VAULT_TPM_DOWN)) {
+                ockam_kal_mutex_unlock(&(p_mbed_ctx->entropy_mutex), 0);
+                break;                                          /* Only a source that is down falls back below        */
+            }
+        }
+#endif
+
+        mbed_ret = mbedtls_entropy_func(&(p_mbed_ctx->entropy), p_buf, size);
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->entropy_mutex), 0);
+    } while(0);
+
+    return mbed_ret;
+}
+
+
+#if(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_MIX)
+/**
+ ********************************************************************************************************
+ *                                     mbedcrypto_entropy_source()
+ *
+ * @brief   mbedtls entropy source wrapping the extra entropy source given at init
+ *
+ * @param   p_arg[in]   The mbedcrypto context holding the extra entropy source
+ *
+ * @param   p_buf[out]  Buffer to fill with entropy
+ *
+ * @param   size[in]    Size of the buffer
+ *
+ * @param   p_size[out] Number of bytes written
+ *
+ * @return  0 if successful, otherwise an mbedtls error code. The source's own error is kept in the
+ *          context for mbedcrypto_entropy().
+ *
+ ********************************************************************************************************
+ */
+
+static int mbedcrypto_entropy_source(void *p_arg, unsigned char *p_buf, size_t size, size_t *p_size)
+{
+    int mbed_ret = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_arg;
+    uint32_t filled = 0;
+
+
+    *p_size = 0;
+    p_mbed_ctx->entropy_err = p_mbed_ctx->entropy_source(p_mbed_ctx->p_entropy_arg,
+                                                         p_buf, (uint32_t) size, &filled);
+    if(p_mbed_ctx->entropy_err == OCKAM_ERR_NONE) {
+        *p_size = (filled < size) ? filled : size;
+    } else {
+        mbed_ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+    }
+
+    return mbed_ret;
+}
+
+
+#elif(OCKAM_VAULT_CFG_HOST_SEED_TPM == OCKAM_VAULT_HOST_SEED_TPM_ONLY)
+/**
+ ********************************************************************************************************
+ *                                      mbedcrypto_entropy_extra()
+ *
+ * @brief   Take a whole seed from the extra entropy source, without platform entropy. Must be called
+ *          with the entropy lock held.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context holding the extra entropy source
+ *
+ * @param   p_buf[out]      Buffer to fill with entropy
+ *
+ * @param   size[in]        Number of bytes to fill
+ *
+ * @return  0 if the whole buffer was filled, otherwise an mbedtls error code. The source's own error
+ *          is kept in the context for mbedcrypto_entropy().
+ *
+ ********************************************************************************************************
+ */
+
+static int mbedcrypto_entropy_extra(MBEDCRYPTO_CTX_s *p_mbed_ctx, unsigned char *p_buf, size_t size)
+{
+    int mbed_ret = 0;
+    uint32_t filled = 0;
+
+
+    p_mbed_ctx->entropy_err = p_mbed_ctx->entropy_source(p_mbed_ctx->p_entropy_arg,
+                                                         p_buf, (uint32_t) size, &filled);
+    if((p_mbed_ctx->entropy_err != OCKAM_ERR_NONE) || (filled < size)) {
+        mbedtls_platform_zeroize(p_buf, size);
+        mbed_ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+    }
+
+    return mbed_ret;
+}
+#endif
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_drbg_init()
+ *
+ * @brief   Put a DRBG in a state where it can always be safely freed
+ *
+ * @param   p_drbg[in]  The DRBG to initialize
+ *
+ ********************************************************************************************************
+ */
+
+static void mbedcrypto_drbg_init(MBEDCRYPTO_DRBG_s *p_drbg)
+{
+    p_drbg->mutex.mutex_ptr = 0;
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+    ockam_mem_set(p_drbg->key, 0, MBEDCRYPTO_CHACHA_KEY_SIZE);
+    ockam_mem_set(p_drbg->buf, 0, MBEDCRYPTO_CHACHA_BUF_SIZE);
+    p_drbg->avail = 0;
+    p_drbg->requests = 0;
+#else
+    mbedtls_ctr_drbg_init(&(p_drbg->ctr_drbg));
+#endif
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_drbg_seed()
+ *
+ * @brief   Seed a DRBG from the shared entropy source
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context owning the entropy source
+ *
+ * @param   p_drbg[in]      The DRBG to seed
+ *
+ * @param   index[in]       Index of the DRBG in the context
+ *
+ * @return  0 if successful, otherwise an mbedtls error code.
+ *
+ ********************************************************************************************************
+ */
+
+static int mbedcrypto_drbg_seed(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_DRBG_s *p_drbg, uint32_t index)
+{
+    int mbed_ret = 0;
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+
+
+    (void) index;                                               /* Every key comes straight from the entropy source   */
+    mbed_ret = mbedcrypto_entropy(p_mbed_ctx, p_drbg->key, MBEDCRYPTO_CHACHA_KEY_SIZE);
+#else
+    uint8_t pers[MBEDCRYPTO_DRBG_PERS_SIZE];
+
+
+    ockam_mem_copy(pers, g_mbedcrypto_str, g_mbedcrypto_str_len);
+                                                                /* The DRBG index is added to the personalization     */
+                                                                /* string so no two DRBGs start from the same input.  */
+    pers[g_mbedcrypto_str_len] = (uint8_t) index;
+    mbed_ret = mbedtls_ctr_drbg_seed(&(p_drbg->ctr_drbg),
+                                     mbedcrypto_entropy,
+                                     p_mbed_ctx,
+                                     (const unsigned char*) pers,
+                                     g_mbedcrypto_str_len + 1);
+    if(mbed_ret == 0) {
+        mbedtls_ctr_drbg_set_reseed_interval(&(p_drbg->ctr_drbg),
+                                             OCKAM_VAULT_CFG_HOST_RESEED_INTERVAL);
+    }
+#endif
+
+    return mbed_ret;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_drbg_free()
+ *
+ * @brief   Wipe the state of a DRBG and release its mutex
+ *
+ * @param   p_drbg[in]  The DRBG to free
+ *
+ ********************************************************************************************************
+ */
+
+static void mbedcrypto_drbg_free(MBEDCRYPTO_DRBG_s *p_drbg)
+{
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+    mbedtls_platform_zeroize(p_drbg->key, MBEDCRYPTO_CHACHA_KEY_SIZE);
+    mbedtls_platform_zeroize(p_drbg->buf, MBEDCRYPTO_CHACHA_BUF_SIZE);
+#else
+    mbedtls_ctr_drbg_free(&(p_drbg->ctr_drbg));
+#endif
+    ockam_kal_mutex_free(&(p_drbg->mutex));                     /* Skipped if the mutex was never created             */
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       mbedcrypto_drbg_random()
+ *
+ * @brief   RNG callback used for random numbers, key generation and blinding. The calling thread
+ *          always gets the same CTR DRBG, so threads only wait on each other when they share one.
+ *
+ * @param   p_arg[in]   The mbedcrypto context of the vault instance
+ *
+ * @param   p_buf[out]  Buffer to fill with random data
+ *
+ * @param   size[in]    Number of bytes to fill
+ *
+ * @return  0 if successful, otherwise an mbedtls error code.
+ *
+ ********************************************************************************************************
+ */
+
+static int mbedcrypto_drbg_random(void *p_arg, unsigned char *p_buf, size_t size)
+{
+    int mbed_ret = 0;
+    uint32_t thread_id = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_arg;
+    MBEDCRYPTO_DRBG_s *p_drbg = 0;
+
+
+    if(ockam_kal_thread_id(&thread_id) != OCKAM_ERR_NONE) {     /* Without a thread id everything shares the first    */
+        thread_id = 0;                                          /* DRBG, which is still correct                       */
+    }
+
+    p_drbg = &(p_mbed_ctx->drbg[thread_id % OCKAM_VAULT_CFG_HOST_DRBG_COUNT]);
+
+    if(ockam_kal_mutex_lock(&(p_drbg->mutex), 0, 0) != OCKAM_ERR_NONE) {
+        mbed_ret = MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    } else {
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+        mbed_ret = mbedcrypto_chacha_random(p_mbed_ctx, p_drbg, p_buf, size);
+#else
+        mbed_ret = mbedtls_ctr_drbg_random(&(p_drbg->ctr_drbg), p_buf, size);
+#endif
+        ockam_kal_mutex_unlock(&(p_drbg->mutex), 0);
+    }
+
+    return mbed_ret;
+}
+
+
+#if(OCKAM_VAULT_CFG_HOST_DRBG == OCKAM_VAULT_HOST_DRBG_CHACHA20)
+/**
+ ********************************************************************************************************
+ *                                      mbedcrypto_chacha_random()
+ *
+ * @brief   Generate random bytes with ChaCha20 using fast key erasure. Each refill encrypts a buffer
+ *          of zeros, keeps the first bytes as the next key and hands out the rest, wiping every byte
+ *          as it goes. Past output cannot be recovered from the state. Must be called with the DRBG
+ *          locked.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context owning the entropy source used for reseeding
+ *
+ * @param   p_drbg[in]      The DRBG to use
+ *
+ * @param   p_buf[out]      Buffer to fill with random data
+ *
+ * @param   size[in]        Number of bytes to fill
+ *
+ * @return  0 if successful, otherwise an mbedtls error code.
+ *
+ ********************************************************************************************************
+ */
+
+static int mbedcrypto_chacha_random(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_DRBG_s *p_drbg,
+                                    unsigned char *p_buf, size_t size)
+{
+    int mbed_ret = 0;
+    uint32_t i = 0;
+    uint32_t off = 0;
+    size_t run = 0;
+    uint8_t seed[MBEDCRYPTO_CHACHA_KEY_SIZE];
+
+
+    do {
+        if(p_drbg->requests >= OCKAM_VAULT_CFG_HOST_RESEED_INTERVAL) {
+            mbed_ret = mbedcrypto_entropy(p_mbed_ctx, seed, MBEDCRYPTO_CHACHA_KEY_SIZE);
+            if(mbed_ret != 0) {
+                break;
+            }
+
+            for(i = 0; i < MBEDCRYPTO_CHACHA_KEY_SIZE; i++) {   /* Mix fresh entropy into the key and drop keystream  */
+                p_drbg->key[i] ^= seed[i];                      /* made with the old one                              */
+            }
+            mbedtls_platform_zeroize(seed, MBEDCRYPTO_CHACHA_KEY_SIZE);
+            mbedtls_platform_zeroize(p_drbg->buf, MBEDCRYPTO_CHACHA_BUF_SIZE);
+            p_drbg->avail = 0;
+            p_drbg->requests = 0;
+        }
+        p_drbg->requests++;
+
+        while(size > 0) {
+            if(p_drbg->avail == 0) {
+                mbed_ret = mbedtls_chacha20_crypt(p_drbg->key,
+                                                  g_mbedcrypto_chacha_zero,
+                                                  0,
+                                                  MBEDCRYPTO_CHACHA_BUF_SIZE,
+                                                  g_mbedcrypto_chacha_zero,
+                                                  p_drbg->buf);
+                if(mbed_ret != 0) {
+                    break;
+                }
+                                                                /* Replace the key before any output is handed out    */
+                ockam_mem_copy(p_drbg->key, p_drbg->buf, MBEDCRYPTO_CHACHA_KEY_SIZE);
+                mbedtls_platform_zeroize(p_drbg->buf, MBEDCRYPTO_CHACHA_KEY_SIZE);
+                p_drbg->avail = MBEDCRYPTO_CHACHA_BUF_SIZE - MBEDCRYPTO_CHACHA_KEY_SIZE;
+            }
+
+            run = (size < p_drbg->avail) ? size : p_drbg->avail;
+            off = MBEDCRYPTO_CHACHA_BUF_SIZE - p_drbg->avail;
+            ockam_mem_copy(p_buf, &(p_drbg->buf[off]), (uint32_t) run);
+            mbedtls_platform_zeroize(&(p_drbg->buf[off]), run);
+            p_drbg->avail -= (uint32_t) run;
+            p_buf += run;
+            size -= run;
+        }
+    } while(0);
+
+    return mbed_ret;
+}
+#endif
+
+
+#endif                                                          /* OCKAM_VAULT_CFG_INIT                               */
+
+
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                         OCKAM_VAULT_CFG_RAND
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_RAND, OCKAM_VAULT_HOST_MBEDCRYPTO))
+
+/*
+ ********************************************************************************************************
+ *                                        ockam_vault_host_random()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_random(void *p_ctx, uint8_t *p_rand_num, uint32_t rand_num_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+    mbed_ret = mbedcrypto_drbg_random(p_mbed_ctx,               /* Safe to call from many threads at once             */
+                                      p_rand_num,
+                                      rand_num_size);
+    if(mbed_ret != 0) {
+        ret_val = OCKAM_ERR_VAULT_HOST_RAND_FAIL;
+    }
+
+
+    return ret_val;
+}
+
+
+#endif                                                          /* OCKAM_VAULT_CFG_RAND                               */
+
+
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                      OCKAM_VAULT_CFG_KEY_ECDH
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH, OCKAM_VAULT_HOST_MBEDCRYPTO))
+
+/*
+ ********************************************************************************************************
+ *                                     ockam_vault_host_key_gen()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_gen(void *p_ctx, OCKAM_VAULT_KEY_e key_type)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        ret_val = mbedcrypto_key_type(p_mbed_ctx, key_type, &p_key);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_key->pub_size = 0;
+        if(key_type == OCKAM_VAULT_KEY_EPHEMERAL) {             /* Ephemeral keys are on the handshake path, take one */
+            ret_val = mbedcrypto_key_gen_pooled(p_mbed_ctx,     /* from the pool when there is one ready              */
+                                                &(p_key->keypair));
+        } else {
+            ret_val = mbedcrypto_key_gen(p_mbed_ctx, &(p_key->keypair));
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                      ockam_vault_host_key_get_pub()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_get_pub(void *p_ctx,
+                                       OCKAM_VAULT_KEY_e key_type,
+                                       uint8_t *p_pub_key,
+                                       uint32_t pub_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        ret_val = mbedcrypto_key_type(p_mbed_ctx, key_type, &p_key);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_key_get_pub(p_key, p_pub_key, pub_key_size);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                     ockam_vault_host_key_write()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_write(void *p_ctx,
+                                     OCKAM_VAULT_KEY_e key_type,
+                                     uint8_t *p_priv_key, uint32_t priv_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        ret_val = mbedcrypto_key_type(p_mbed_ctx, key_type, &p_key);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_key->pub_size = 0;
+        ret_val = mbedcrypto_key_write(p_mbed_ctx,
+                                       &(p_key->keypair),
+                                       p_priv_key, priv_key_size);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_host_ecdh()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_ecdh(void *p_ctx,
+                                OCKAM_VAULT_KEY_e key_type,
+                                uint8_t *p_pub_key, uint32_t pub_key_size,
+                                uint8_t *p_pms, uint32_t pms_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        ret_val = mbedcrypto_key_type(p_mbed_ctx, key_type, &p_key);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_ecdh(p_mbed_ctx,
+                                  &(p_key->keypair),
+                                  p_pub_key, pub_key_size,
+                                  p_pms, pms_size);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                   ockam_vault_host_key_pool_fill()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_pool_fill(void *p_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+    uint32_t count = 0;
+    mbedtls_ecp_keypair keypair;
+#endif
+
+
+    do {
+        if(p_mbed_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+        while(count < OCKAM_VAULT_CFG_KEY_POOL_SIZE) {
+            mbedtls_ecp_keypair_init(&keypair);                 /* Generate without holding the pool lock so keys can */
+            ret_val = mbedcrypto_key_gen(p_mbed_ctx, &keypair); /* be taken while the pool is being filled            */
+            if(ret_val != OCKAM_ERR_NONE) {
+                mbedtls_ecp_keypair_free(&keypair);
+                break;
+            }
+
+            ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->pool_mutex), 0, 0);
+            if(ret_val != OCKAM_ERR_NONE) {
+                mbedtls_ecp_keypair_free(&keypair);
+                break;
+            }
+
+            count = p_mbed_ctx->pool_count;
+            if(count < OCKAM_VAULT_CFG_KEY_POOL_SIZE) {         /* The pool owns the key material from here on        */
+                p_mbed_ctx->pool[count] = keypair;
+                count++;
+                p_mbed_ctx->pool_count = count;
+            } else {                                            /* Another thread filled the last entry first         */
+                mbedtls_ecp_keypair_free(&keypair);
+            }
+
+            ockam_kal_mutex_unlock(&(p_mbed_ctx->pool_mutex), 0);
+        }
+#endif
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                   ockam_vault_host_key_pool_count()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_pool_count(void *p_ctx, uint32_t *p_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        if((p_mbed_ctx == 0) || (p_count == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        *p_count = 0;
+
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+        ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->pool_mutex), 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        *p_count = p_mbed_ctx->pool_count;
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->pool_mutex), 0);
+#endif
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                  ockam_vault_host_key_handle_create()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_create(void *p_ctx, void **p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_new = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        if((p_mbed_ctx == 0) || (p_key == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = mbedcrypto_key_alloc(p_mbed_ctx, &p_new);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        *p_key = mbedcrypto_key_handle(p_new);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                 ockam_vault_host_key_handle_generate()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_generate(void *p_ctx, void *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+    mbedtls_ecp_keypair keypair;
+
+
+    mbedtls_ecp_keypair_init(&keypair);
+
+    do {
+        if(p_mbed_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+                                                                /* Generate without holding the key table lock        */
+        ret_val = mbedcrypto_key_gen_pooled(p_mbed_ctx, &keypair);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_key_commit(p_mbed_ctx, p_key, &keypair);
+    } while(0);
+
+    mbedtls_ecp_keypair_free(&keypair);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                  ockam_vault_host_key_handle_import()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_import(void *p_ctx, void *p_key,
+                                             uint8_t *p_priv_key, uint32_t priv_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+    mbedtls_ecp_keypair keypair;
+
+
+    mbedtls_ecp_keypair_init(&keypair);
+
+    do {
+        if(p_mbed_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = mbedcrypto_key_write(p_mbed_ctx,              /* Load without holding the key table lock            */
+                                       &keypair,
+                                       p_priv_key, priv_key_size);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_key_commit(p_mbed_ctx, p_key, &keypair);
+    } while(0);
+
+    mbedtls_ecp_keypair_free(&keypair);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                  ockam_vault_host_key_handle_get_pub()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_get_pub(void *p_ctx, void *p_key,
+                                              uint8_t *p_pub_key, uint32_t pub_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_mbed_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        if(p_mbed_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->key_mutex), 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_key_check(p_mbed_ctx, p_key, &p_mbed_key);
+        if(ret_val == OCKAM_ERR_NONE) {                         /* Usually a copy of the kept public key              */
+            ret_val = mbedcrypto_key_get_pub(p_mbed_key, p_pub_key, pub_key_size);
+        }
+
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->key_mutex), 0);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                   ockam_vault_host_key_handle_ecdh()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_ecdh(void *p_ctx, void *p_key,
+                                           uint8_t *p_pub_key, uint32_t pub_key_size,
+                                           uint8_t *p_pms, uint32_t pms_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_mbed_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+    mbedtls_ecp_keypair keypair;
+
+
+    mbedtls_ecp_keypair_init(&keypair);
+
+    do {
+        if(p_mbed_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->key_mutex), 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+                                                                /* Copy out the private key so ECDH runs without the  */
+                                                                /* key table lock, even if the handle is destroyed or */
+                                                                /* regenerated meanwhile                              */
+        ret_val = mbedcrypto_key_check(p_mbed_ctx, p_key, &p_mbed_key);
+        if(ret_val == OCKAM_ERR_NONE) {
+            if((mbedtls_ecp_group_load(&(keypair.grp), p_mbed_key->keypair.grp.id) != 0) ||
+               (mbedtls_mpi_copy(&(keypair.d), &(p_mbed_key->keypair.d)) != 0)) {
+                ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+            }
+        }
+
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->key_mutex), 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_ecdh(p_mbed_ctx,
+                                  &keypair,
+                                  p_pub_key, pub_key_size,
+                                  p_pms, pms_size);
+    } while(0);
+
+    mbedtls_ecp_keypair_free(&keypair);                         /* Clear the copy of the private key                  */
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                  ockam_vault_host_key_handle_destroy()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_key_handle_destroy(void *p_ctx, void *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_mbed_key = 0;
+    MBEDCRYPTO_CTX_s *p_mbed_ctx = (MBEDCRYPTO_CTX_s*) p_ctx;
+
+
+    do {
+        if(p_mbed_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->key_mutex), 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_key_check(p_mbed_ctx, p_key, &p_mbed_key);
+        if(ret_val == OCKAM_ERR_NONE) {
+            mbedcrypto_key_release(p_mbed_ctx, p_mbed_key);
+        }
+
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->key_mutex), 0);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_key_commit()
+ *
+ * @brief   Move a keypair built without the key table lock into the key behind a handle. The key
+ *          previously held is cleared.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context that owns the table
+ *
+ * @param   p_handle[in]    The key handle to replace the key of
+ *
+ * @param   p_keypair[in]   The new keypair. Left empty once it is moved into the table.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_commit(MBEDCRYPTO_CTX_s *p_mbed_ctx, void *p_handle,
+                                       mbedtls_ecp_keypair *p_keypair)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_s *p_key = 0;
+
+
+    do {
+        ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->key_mutex), 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = mbedcrypto_key_check(p_mbed_ctx, p_handle, &p_key);
+        if(ret_val == OCKAM_ERR_NONE) {
+            mbedtls_ecp_keypair_free(&(p_key->keypair));        /* The table owns the key material from here on       */
+            p_key->keypair = *p_keypair;
+            p_key->pub_size = 0;
+            mbedtls_ecp_keypair_init(p_keypair);
+        }
+
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->key_mutex), 0);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_key_alloc()
+ *
+ * @brief   Take a key from the key table of a vault instance. The table grows by a whole slab when no
+ *          free key is left, so handing out a key is a list pop rather than an allocation. Takes the
+ *          key table lock.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context that owns the table
+ *
+ * @param   p_key[out]      Returns the empty key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_alloc(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_KEY_s **p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t i = 0;
+    MBEDCRYPTO_KEY_SLAB_s *p_slab = 0;
+    MBEDCRYPTO_KEY_s *p_new = 0;
+
+
+    ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->key_mutex), 0, 0);
+    if(ret_val != OCKAM_ERR_NONE) {
+        return ret_val;
+    }
+
+    do {
+        if(p_mbed_ctx->p_key_free == 0) {
+            if(p_mbed_ctx->key_slots > (MBEDCRYPTO_KEY_SLOT_MAX - MBEDCRYPTO_KEY_SLAB_SIZE)) {
+                ret_val = OCKAM_ERR_MEM_UNAVAIL;                /* No slot numbers left for handles to address        */
+                break;
+            }
+
+            ret_val = ockam_mem_alloc((void**) &p_slab, sizeof(MBEDCRYPTO_KEY_SLAB_s));
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            p_slab->base = p_mbed_ctx->key_slots + 1;
+
+            for(i = 0; i < MBEDCRYPTO_KEY_SLAB_SIZE; i++) {     /* Keypairs are initialized up front so they can      */
+                p_new = &(p_slab->key[i]);                      /* always be safely freed                             */
+                mbedtls_ecp_keypair_init(&(p_new->keypair));
+                p_new->p_owner = 0;
+                p_new->slot = p_slab->base + i;
+                p_new->gen = 0;
+                p_new->pub_size = 0;
+                p_new->p_next = p_mbed_ctx->p_key_free;
+                p_mbed_ctx->p_key_free = p_new;
+            }
+
+            p_slab->p_next = p_mbed_ctx->p_key_slab;
+            p_mbed_ctx->p_key_slab = p_slab;
+            p_mbed_ctx->key_slots += MBEDCRYPTO_KEY_SLAB_SIZE;
+        }
+
+        p_new = p_mbed_ctx->p_key_free;                         /* Most recently released key is reused first         */
+        p_mbed_ctx->p_key_free = p_new->p_next;
+
+        p_new->p_next = 0;
+        p_new->p_owner = p_mbed_ctx;
+        *p_key = p_new;
+    } while(0);
+
+    ockam_kal_mutex_unlock(&(p_mbed_ctx->key_mutex), 0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       mbedcrypto_key_release()
+ *
+ * @brief   Clear a key and return it to the free list of the key table. Must be called with the key
+ *          table locked.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context that owns the table
+ *
+ * @param   p_key[in]       The key to release
+ *
+ ********************************************************************************************************
+ */
+
+static void mbedcrypto_key_release(MBEDCRYPTO_CTX_s *p_mbed_ctx, MBEDCRYPTO_KEY_s *p_key)
+{
+    mbedtls_ecp_keypair_free(&(p_key->keypair));                /* Clear the key material and leave the keypair       */
+    mbedtls_ecp_keypair_init(&(p_key->keypair));                /* ready for the next handle                          */
+
+    p_key->p_owner = 0;                                         /* Catches use of the handle after it is destroyed,   */
+    p_key->gen = (p_key->gen + 1) & MBEDCRYPTO_KEY_GEN_MASK;    /* even once the key is handed out again              */
+    p_key->pub_size = 0;
+    p_key->p_next = p_mbed_ctx->p_key_free;
+    p_mbed_ctx->p_key_free = p_key;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_key_handle()
+ *
+ * @brief   Get the handle handed out for a key. The handle holds the key slot and generation rather
+ *          than the key address, so a handle kept after its key was destroyed never matches the key
+ *          that reuses the slot.
+ *
+ * @param   p_key[in]       The key to get the handle of
+ *
+ * @return  The key handle, never 0.
+ *
+ ********************************************************************************************************
+ */
+
+static void *mbedcrypto_key_handle(MBEDCRYPTO_KEY_s *p_key)
+{
+    return (void*) (uintptr_t) ((p_key->slot << MBEDCRYPTO_KEY_GEN_BITS) | p_key->gen);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_key_check()
+ *
+ * @brief   Look up the key behind a handle handed out by a vault instance, checking that the key has
+ *          not been destroyed since. Must be called with the key table locked, and the key is only
+ *          valid until it is unlocked.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context of the vault instance
+ *
+ * @param   p_handle[in]    The key handle to check
+ *
+ * @param   p_key[out]      Returns the key behind the handle
+ *
+ * @return  OCKAM_ERR_NONE if the handle is valid.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_check(MBEDCRYPTO_CTX_s *p_mbed_ctx, void *p_handle, MBEDCRYPTO_KEY_s **p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_KEY_SLAB_s *p_slab = 0;
+    MBEDCRYPTO_KEY_s *p_found = 0;
+    uintptr_t slot = 0;
+    uintptr_t gen = 0;
+
+
+    do {
+        if((p_mbed_ctx == 0) || (p_handle == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        slot = ((uintptr_t) p_handle) >> MBEDCRYPTO_KEY_GEN_BITS;
+        gen = ((uintptr_t) p_handle) & MBEDCRYPTO_KEY_GEN_MASK;
+
+        p_slab = p_mbed_ctx->p_key_slab;                        /* Newest slab first, it holds the highest slots      */
+        while((p_slab != 0) && (p_slab->base > slot)) {
+            p_slab = p_slab->p_next;
+        }
+
+        if((p_slab == 0) || (slot >= (p_slab->base + MBEDCRYPTO_KEY_SLAB_SIZE))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_found = &(p_slab->key[slot - p_slab->base]);
+        if((p_found->p_owner != p_mbed_ctx) || (p_found->gen != gen)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* Destroyed, possibly reused by a newer handle       */
+            break;
+        }
+
+        *p_key = p_found;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_key_type()
+ *
+ * @brief   Get the key table entry behind a static or ephemeral key type. The entry is taken from the
+ *          table the first time the key type is used.
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context of the vault instance
+ *
+ * @param   key_type[in]    OCKAM_VAULT_KEY_STATIC or OCKAM_VAULT_KEY_EPHEMERAL
+ *
+ * @param   p_key[out]      Returns the key table entry
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_type(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                     OCKAM_VAULT_KEY_e key_type,
+                                     MBEDCRYPTO_KEY_s **p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if((key_type != OCKAM_VAULT_KEY_STATIC) &&
+           (key_type != OCKAM_VAULT_KEY_EPHEMERAL)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_mbed_ctx->p_key_type[key_type] == 0) {
+            ret_val = mbedcrypto_key_alloc(p_mbed_ctx, &(p_mbed_ctx->p_key_type[key_type]));
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        *p_key = p_mbed_ctx->p_key_type[key_type];
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         mbedcrypto_key_gen()
+ *
+ * @brief   Generate a Curve25519 keypair, replacing any key already held
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context with the DRBG to use
+ *
+ * @param   p_key[in,out]   The keypair to generate
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_gen(MBEDCRYPTO_CTX_s *p_mbed_ctx, mbedtls_ecp_keypair *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+
+
+    do {
+        mbedtls_ecp_keypair_free(p_key);                        /* Release any key previously held in this slot and   */
+        mbedtls_ecp_keypair_init(p_key);                        /* re-initialize the keypair before generating        */
+
+                                                                /* Generate the keypair on Curve25519                 */
+        mbed_ret = mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_CURVE25519,
+                                       p_key,
+                                       mbedcrypto_drbg_random,
+                                       p_mbed_ctx);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_ecp_check_pubkey(&(p_key->grp),      /* Check that generated public key lies on the curve  */
+                                            &(p_key->Q));
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_ecp_check_privkey(&(p_key->grp),     /* Check that the generated private key is valid      */
+                                             &(p_key->d));
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     mbedcrypto_key_gen_pooled()
+ *
+ * @brief   Replace the key held in a keypair with one from the key pool, or generate one inline if the
+ *          pool is empty
+ *
+ * @param   p_mbed_ctx[in]  The mbedcrypto context with the key pool and DRBG to use
+ *
+ * @param   p_key[in,out]   The keypair to fill
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_gen_pooled(MBEDCRYPTO_CTX_s *p_mbed_ctx, mbedtls_ecp_keypair *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint8_t taken = 0;
+
+
+#if(OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0)
+    if(ockam_kal_mutex_lock(&(p_mbed_ctx->pool_mutex), 0, 0) == OCKAM_ERR_NONE) {
+        if(p_mbed_ctx->pool_count > 0) {
+            p_mbed_ctx->pool_count--;
+            mbedtls_ecp_keypair_free(p_key);                    /* Release any key previously held in this slot       */
+                                                                /* Hand over the pooled key material and leave an     */
+                                                                /* empty keypair behind in the pool                   */
+            *p_key = p_mbed_ctx->pool[p_mbed_ctx->pool_count];
+            mbedtls_ecp_keypair_init(&(p_mbed_ctx->pool[p_mbed_ctx->pool_count]));
+            taken = 1;
+        }
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->pool_mutex), 0);
+    }
+#endif
+
+    if(!taken) {
+        ret_val = mbedcrypto_key_gen(p_mbed_ctx, p_key);
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       mbedcrypto_key_get_pub()
+ *
+ * @brief   Output the public key of a key. The serialized key is kept in the key table entry and
+ *          handed out again until the key changes.
+ *
+ * @param   p_key[in]           The key
+ *
+ * @param   p_pub_key[out]      Buffer for the public key
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_get_pub(MBEDCRYPTO_KEY_s *p_key,
+                                        uint8_t *p_pub_key, uint32_t pub_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    size_t olen = 0;
+
+
+    do {
+        if((p_key->pub_size != 0) && (pub_key_size >= p_key->pub_size)) {
+            ockam_mem_copy(p_pub_key, p_key->pub, p_key->pub_size);
+            break;
+        }
+
+        mbed_ret = mbedtls_ecp_point_write_binary(&(p_key->keypair.grp),
+                                                  &(p_key->keypair.Q),
+                                                  MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                                  &olen,
+                                                  p_pub_key,
+                                                  pub_key_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+
+        if(olen <= MBEDCRYPTO_KEY_PUB_SIZE) {                   /* Kept until the key is generated or written again   */
+            ockam_mem_copy(p_key->pub, p_pub_key, (uint32_t) olen);
+            p_key->pub_size = (uint32_t) olen;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_key_write()
+ *
+ * @brief   Load a Curve25519 private key into a keypair and derive its public key
+ *
+ * @param   p_mbed_ctx[in]      The mbedcrypto context with the DRBG to use
+ *
+ * @param   p_ecp[in,out]       The keypair to load
+ *
+ * @param   p_priv_key[in]      Buffer with the little endian private key. Clamped in place.
+ *
+ * @param   priv_key_size[in]   Size of the private key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_key_write(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                      mbedtls_ecp_keypair *p_ecp,
+                                      uint8_t *p_priv_key, uint32_t priv_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    uint8_t *p_priv_key_byte = 0;
+
+
+    do {
+        p_priv_key_byte = p_priv_key;                           /* Ensure the private key is a valid Curve25519 key   */
+        *p_priv_key_byte &= 248;                                /* Bit modifications come from RFC7748 Section 5      */
+        p_priv_key_byte += 31;
+        *p_priv_key_byte &= 127;
+        *p_priv_key_byte |= 64;
+
+        mbedtls_ecp_keypair_free(p_ecp);                        /* Release any key previously held in this slot and   */
+        mbedtls_ecp_keypair_init(p_ecp);                        /* re-initialize the keypair before loading           */
+        mbedtls_ecp_group_load(&(p_ecp->grp),                   /* Set the keypair to use Curve25519                  */
+                               MBEDTLS_ECP_DP_CURVE25519);
+
+        mbed_ret = mbedtls_mpi_read_binary_le(&(p_ecp->d),      /* Write the private key buffer data to the MPI point */
+                                           p_priv_key, priv_key_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_ecp_mul(&(p_ecp->grp),               /* Generate the public key from the private key       */
+                                   &(p_ecp->Q),
+                                   &(p_ecp->d),
+                                   &(p_ecp->grp.G),
+                                   mbedcrypto_drbg_random,
+                                   p_mbed_ctx);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_ecp_check_pubkey(&(p_ecp->grp),      /* Check that generated public key lies on the curve  */
+                                            &(p_ecp->Q));
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_ecp_check_privkey(&(p_ecp->grp),     /* Ensure the loaded private key is valid on the      */
+                                             &(p_ecp->d));      /* specified curve.                                   */
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          mbedcrypto_ecdh()
+ *
+ * @brief   Perform ECDH with the private key of a keypair
+ *
+ * @param   p_mbed_ctx[in]      The mbedcrypto context with the DRBG to use
+ *
+ * @param   p_key[in]           The keypair
+ *
+ * @param   p_pub_key[in]       Buffer with the public key of the peer
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_pms[out]          Pre-master secret from ECDH
+ *
+ * @param   pms_size[in]        Size of the pre-master secret buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_ecdh(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                 mbedtls_ecp_keypair *p_key,
+                                 uint8_t *p_pub_key, uint32_t pub_key_size,
+                                 uint8_t *p_pms, uint32_t pms_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    mbedtls_mpi pms;
+    mbedtls_ecp_point pub_key;
+
+
+    mbedtls_mpi_init(&pms);
+    mbedtls_ecp_point_init(&pub_key);
+
+    do {
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+        ret_val = mbedcrypto_peer_get(p_mbed_ctx,               /* Known peers skip decoding and checking the key     */
+                                      &(p_key->grp),
+                                      p_pub_key, pub_key_size,
+                                      &pub_key);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+#else
+        mbed_ret = mbedtls_ecp_point_read_binary(&(p_key->grp), /* Write the received public key to the ECDH context  */
+                                                 &pub_key,
+                                                 p_pub_key,
+                                                 pub_key_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+            break;
+        }
+#endif
+
+        mbed_ret = mbedtls_ecdh_compute_shared(&(p_key->grp),   /* Generate the shared secret                         */
+                                               &pms,
+                                               &pub_key,
+                                               &(p_key->d),
+                                               mbedcrypto_drbg_random,
+                                               p_mbed_ctx);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_mpi_write_binary(&pms,               /* Write the generated PMS to the PMS buffer          */
+                                            p_pms,
+                                            pms_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+            break;
+        }
+    } while(0);
+
+    mbedtls_mpi_free(&pms);                                     /* Clear the shared secret from the heap              */
+    mbedtls_ecp_point_free(&pub_key);
+
+    return ret_val;
+}
+
+
+#if(OCKAM_VAULT_CFG_PEER_CACHE_SIZE > 0)
+/**
+ ********************************************************************************************************
+ *                                        mbedcrypto_peer_get()
+ *
+ * @brief   Find the decoded point for a peer public key in the peer cache. A key seen for the first
+ *          time is decoded, checked against the curve and kept in place of the least recently used
+ *          entry. Takes the peer cache lock.
+ *
+ * @param   p_mbed_ctx[in]      The mbedcrypto context with the peer cache
+ *
+ * @param   p_grp[in]           Curve of the local key
+ *
+ * @param   p_pub_key[in]       Buffer with the public key of the peer
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_point[out]        Returns a copy of the decoded point
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_peer_get(MBEDCRYPTO_CTX_s *p_mbed_ctx,
+                                     mbedtls_ecp_group *p_grp,
+                                     uint8_t *p_pub_key, uint32_t pub_key_size,
+                                     mbedtls_ecp_point *p_point)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    MBEDCRYPTO_PEER_s *p_peer = 0;
+    MBEDCRYPTO_PEER_s *p_found = 0;
+    MBEDCRYPTO_PEER_s *p_oldest = &(p_mbed_ctx->peer[0]);
+
+
+    do {
+        if((p_pub_key == 0) || (pub_key_size > MBEDCRYPTO_PEER_KEY_SIZE)) {
+            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+            break;
+        }
+
+        ret_val = ockam_kal_mutex_lock(&(p_mbed_ctx->peer_mutex), 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; (i < OCKAM_VAULT_CFG_PEER_CACHE_SIZE) && (p_found == 0); i++) {
+            p_peer = &(p_mbed_ctx->peer[i]);
+            if(p_peer->last_use < p_oldest->last_use) {         /* Empty entries are always the oldest                */
+                p_oldest = p_peer;
+            }
+
+            if((p_peer->last_use == 0) || (p_peer->pub_key_size != pub_key_size)) {
+                continue;
+            }
+
+            for(j = 0; j < pub_key_size; j++) {
+                if(p_peer->pub_key[j] != p_pub_key[j]) {
+                    break;
+                }
+            }
+
+            if(j == pub_key_size) {
+                p_found = p_peer;
+            }
+        }
+
+        if(p_found == 0) {
+            p_found = p_oldest;                                 /* Stays empty unless the new key is valid            */
+            p_found->last_use = 0;
+
+            mbed_ret = mbedtls_ecp_point_read_binary(p_grp,
+                                                     &(p_found->point),
+                                                     p_pub_key,
+                                                     pub_key_size);
+            if(mbed_ret == 0) {
+                mbed_ret = mbedtls_ecp_check_pubkey(p_grp, &(p_found->point));
+            }
+            if(mbed_ret == 0) {
+                ockam_mem_copy(p_found->pub_key, p_pub_key, pub_key_size);
+                p_found->pub_key_size = pub_key_size;
+            }
+        }
+
+        if(mbed_ret == 0) {                                     /* Callers work on a copy once the lock is released   */
+            p_mbed_ctx->peer_uses++;
+            p_found->last_use = p_mbed_ctx->peer_uses;
+            mbed_ret = mbedtls_ecp_copy(p_point, &(p_found->point));
+        }
+
+        ockam_kal_mutex_unlock(&(p_mbed_ctx->peer_mutex), 0);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+        }
+    } while(0);
+
+    return ret_val;
+}
+#endif
+
+
+#endif                                                          /* OCKAM_VAULT_CFG_KEY_ECDH                           */
+
+
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                        OCKAM_VAULT_CFG_SHA256
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_SHA256, OCKAM_VAULT_HOST_MBEDCRYPTO))
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_sha256()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256(void *p_ctx,
+                                  uint8_t *p_msg, uint32_t msg_size,
+                                  uint8_t *p_digest, uint8_t digest_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    mbedtls_sha256_context sha256_ctx;
+
+
+    do {
+        mbedtls_sha256_init(&sha256_ctx);                       /* SHA256 context structure must be inited before use */
+
+
+        mbed_ret = mbedtls_sha256_starts_ret(&sha256_ctx,       /* Configure for SHA256 rather than SHA224            */
+                                             MBEDCRYPTO_SHA256_IS224);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_sha256_update_ret(&sha256_ctx,       /* Add the message to the SHA256 context              */
+                                             p_msg,
+                                             msg_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+            break;
+        }
+
+        mbed_ret = mbedtls_sha256_finish_ret(&sha256_ctx,       /* Complete SHA256 hash and output to digest buffer   */
+                                             p_digest);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+            break;
+        }
+    } while(0);
+
+    mbedtls_sha256_free(&sha256_ctx);                           /* Always clear the SHA256 context when finished      */
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_sha256_ctx_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_init(void *p_ctx,
+                                           void **p_sha_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    mbedtls_sha256_context *p_sha256_ctx = 0;
+
+
+    do {
+        if(p_sha_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_sha256_ctx, sizeof(mbedtls_sha256_context));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        mbedtls_sha256_init(p_sha256_ctx);                      /* SHA256 context structure must be inited before use */
+
+        mbed_ret = mbedtls_sha256_starts_ret(p_sha256_ctx,      /* Configure for SHA256 rather than SHA224            */
+                                             MBEDCRYPTO_SHA256_IS224);
+        if(mbed_ret != 0) {
+            ockam_vault_host_sha256_ctx_free(p_sha256_ctx);
+            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+            break;
+        }
+
+        *p_sha_ctx = p_sha256_ctx;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_sha256_ctx_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_update(void *p_sha_ctx,
+                                             uint8_t *p_msg, uint32_t msg_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    mbedtls_sha256_context *p_sha256_ctx = (mbedtls_sha256_context*) p_sha_ctx;
+
+
+    do {
+        if((p_sha256_ctx == 0) || ((p_msg == 0) && (msg_size != 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        mbed_ret = mbedtls_sha256_update_ret(p_sha256_ctx,      /* mbed TLS keeps partial blocks and the              */
+                                             p_msg,             /* 64-bit message length in the context               */
+                                             msg_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_sha256_ctx_finish()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_finish(void *p_sha_ctx,
+                                             uint8_t *p_digest, uint8_t digest_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int mbed_ret = 0;
+    mbedtls_sha256_context *p_sha256_ctx = (mbedtls_sha256_context*) p_sha_ctx;
+
+
+    do {
+        if((p_sha256_ctx == 0) || (p_digest == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        mbed_ret = mbedtls_sha256_finish_ret(p_sha256_ctx,      /* Complete SHA256 hash and output to                 */
+                                             p_digest);         /* digest buffer                                      */
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_sha256_ctx_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_sha256_ctx_free(void *p_sha_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    mbedtls_sha256_context *p_sha256_ctx = (mbedtls_sha256_context*) p_sha_ctx;
+
+
+    do {
+        if(p_sha256_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        mbedtls_sha256_free(p_sha256_ctx);                      /* Always clear the SHA256 context when finished      */
+        ret_val = ockam_mem_free(p_sha256_ctx);
+    } while(0);
+
+    return ret_val;
+}
+
+
+#endif                                                          /* OCKAM_VAULT_CFG_SHA256                             */
+
+
+/**
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                       OCKAM_VAULT_CFG_HKDF
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_HKDF, OCKAM_VAULT_HOST_MBEDCRYPTO))
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_host_hkdf()
+ *
+ * @brief   Perform HKDF in the mbed TLS library
+ *
+ * @param   p_ctx[in]           Backend context for the vault instance. Unused, HKDF is stateless.
+ *
+ * @param   p_salt[in]          Buffer for the Ockam salt value
+ *
+ * @param   salt_size[in]       Size of the Ockam salt value
+ *
+ * @param   p_ikm[in]           Buffer with the input key material for HKDF
+ *
+ * @param   ikm_size[in]        Size of the input key material
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info.
+ *
+ * @param   p_out[out]          Buffer for the output of the HKDF operation
+ *
+ * @param   out_size[in]        Size of the HKDF output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf(void *p_ctx,
+                                uint8_t *p_salt, uint32_t salt_size,
+                                uint8_t *p_ikm, uint32_t ikm_size,
+                                uint8_t *p_info, uint32_t info_size,
+                                uint8_t *p_out, uint32_t out_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    const mbedtls_md_info_t *p_md;
+    int32_t mbed_ret;
+
+
+    do {
+        if((p_ikm == 0) || (ikm_size == 0) ||                   /* Ensure the input key and output buffers are not    */
+           (p_out == 0) || (out_size  == 0)) {                  /* null and the size values are greater than zero     */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+        }
+
+        p_md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);    /* Get the SHA-256 MD context for HKDF                */
+
+        mbed_ret = mbedtls_hkdf(p_md,                           /* Perform the HKDF calculation                       */
+                           p_salt, salt_size,
+                           p_ikm, ikm_size,
+                           p_info, info_size,
+                           p_out, out_size);
+        if(mbed_ret != 0) {                                     /* Check for an mbed TLS error                        */
+            OCKAM_ERR_VAULT_HOST_HKDF_FAIL;
+        }
+
+    } while(0);
+
+    return ret_val;
+}
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_hkdf_extract()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf_extract(void *p_ctx,
+                                        void **p_prk,
+                                        uint8_t *p_salt, uint32_t salt_size,
+                                        uint8_t *p_ikm, uint32_t ikm_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    const mbedtls_md_info_t *p_md;
+    int32_t mbed_ret;
+    MBEDCRYPTO_HKDF_PRK_s *p_hkdf_prk = 0;
+
+
+    do {
+        if((p_prk == 0) || (p_ikm == 0) || (ikm_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_hkdf_prk, sizeof(MBEDCRYPTO_HKDF_PRK_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);    /* Get the SHA-256 MD context for HKDF                */
+
+        mbed_ret = mbedtls_hkdf_extract(p_md,                   /* Only the extract stage, expand is run per output   */
+                                        p_salt, salt_size,
+                                        p_ikm, ikm_size,
+                                        &(p_hkdf_prk->prk[0]));
+        if(mbed_ret != 0) {
+            ockam_vault_host_hkdf_prk_free(p_hkdf_prk);
+            ret_val = OCKAM_ERR_VAULT_HOST_HKDF_FAIL;
+            break;
+        }
+
+        *p_prk = p_hkdf_prk;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_host_hkdf_expand()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf_expand(void *p_prk,
+                                       uint8_t *p_info, uint32_t info_size,
+                                       uint8_t *p_out, uint32_t out_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    const mbedtls_md_info_t *p_md;
+    int32_t mbed_ret;
+    MBEDCRYPTO_HKDF_PRK_s *p_hkdf_prk = (MBEDCRYPTO_HKDF_PRK_s*) p_prk;
+
+
+    do {
+        if((p_hkdf_prk == 0) || (p_out == 0) || (out_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        p_md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);    /* Get the SHA-256 MD context for HKDF                */
+
+        mbed_ret = mbedtls_hkdf_expand(p_md,
+                                       &(p_hkdf_prk->prk[0]), MBEDCRYPTO_HKDF_PRK_SIZE,
+                                       p_info, info_size,
+                                       p_out, out_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_HKDF_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_hkdf_prk_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_hkdf_prk_free(void *p_prk)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_HKDF_PRK_s *p_hkdf_prk = (MBEDCRYPTO_HKDF_PRK_s*) p_prk;
+
+
+    do {
+        if(p_hkdf_prk == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        mbedtls_platform_zeroize(p_hkdf_prk,                    /* Key material must not outlive the handle           */
+                                 sizeof(MBEDCRYPTO_HKDF_PRK_s));
+        ret_val = ockam_mem_free(p_hkdf_prk);
+    } while(0);
+
+    return ret_val;
+}
+
+
+#endif                                                          /* OCKAM_CFG_VAULT_HKDF                               */
+
+
+
+/**
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                      OCKAM_VAULT_CFG_AES_GCM
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_AES_GCM, OCKAM_VAULT_HOST_MBEDCRYPTO))
+
+
+/**
+ ********************************************************************************************************
+ *                                       ockam_vault_host_aes_gcm()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm(void *p_ctx,
+                                   OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                   uint8_t *p_key, uint32_t key_size,
+                                   uint8_t *p_iv, uint32_t iv_size,
+                                   uint8_t *p_aad, uint32_t aad_size,
+                                   uint8_t *p_tag, uint32_t tag_size,
+                                   uint8_t *p_input, uint32_t input_size,
+                                   uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_VAULT_AES_GCM_REC_s rec;
+
+
+    rec.p_iv = p_iv;                                            /* A single operation is a batch of one record        */
+    rec.iv_size = iv_size;
+    rec.p_aad = p_aad;
+    rec.aad_size = aad_size;
+    rec.p_tag = p_tag;
+    rec.tag_size = tag_size;
+    rec.p_input = p_input;
+    rec.input_size = input_size;
+    rec.p_output = p_output;
+    rec.output_size = output_size;
+
+    return ockam_vault_host_aes_gcm_batch(p_ctx, mode, p_key, key_size, &rec, 1);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_host_aes_gcm_batch()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_batch(void *p_ctx,
+                                         OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                         uint8_t *p_key, uint32_t key_size,
+                                         OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret;
+    uint32_t key_bit_size = 0;
+    uint32_t i = 0;
+    mbedtls_gcm_context gcm;
+
+
+    do {
+        if((p_key == 0) || (key_size == 0) ||                   /* Key is required for AES GCM and there must be at   */
+           (p_recs == 0) || (rec_count == 0)) {                 /* least one record to process.                       */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Any modes besides encrypt and decrypt are invalid  */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        key_bit_size = key_size * 8;                            /* Key size is specified in bits. Ensure the key      */
+        if((key_bit_size != 128) &&                             /* size is either 128, 192 or 256 bytes.              */
+           (key_bit_size != 192) &&
+           (key_bit_size != 256)) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;
+            break;
+        }
+
+        do {
+            mbedtls_gcm_init(&gcm);                             /* Always initialize the AES GCM context first        */
+
+            mbed_ret = mbedtls_gcm_setkey(&gcm,                 /* Set the AES key once for every record. Key size    */
+                                          MBEDTLS_CIPHER_ID_AES,/* must be specified in bits.                         */
+                                          p_key,
+                                          key_bit_size);
+            if(mbed_ret != 0) {                                 /* TODO allow platform feature unsupported?           */
+                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+
+            for(i = 0; i < rec_count; i++) {                    /* The key schedule and GHASH tables are reused by    */
+                ret_val = mbedcrypto_aes_gcm_rec(&gcm,          /* every record in the batch                          */
+                                                 mode,
+                                                 &p_recs[i]);
+                if(ret_val != OCKAM_ERR_NONE) {
+                    break;
+                }
+            }
+        } while(0);
+
+        mbedtls_gcm_free(&gcm);                                 /* Always attempt to free even if an error occurred   */
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       mbedcrypto_aes_gcm_rec()
+ *
+ * @brief   Encrypt or decrypt a single record with an AES GCM context that already has its key set
+ *
+ * @param   p_gcm[in]       AES GCM context with the key set
+ *
+ * @param   mode[in]        AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_rec[in,out]   The record to process
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_aes_gcm_rec(mbedtls_gcm_context *p_gcm,
+                                        OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                        OCKAM_VAULT_AES_GCM_REC_s *p_rec)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret;
+
+
+    do {
+        if((p_rec->p_iv == 0) || (p_rec->iv_size == 0) ||       /* IV and tag are always required to be present for   */
+           (p_rec->p_tag == 0) || (p_rec->tag_size == 0)) {     /* encrypt and decrypt.                               */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((p_rec->p_aad == 0) != (p_rec->aad_size == 0)) {     /* Valid for both the AAD buffer and size to be zero  */
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* or non-zero. Can't have a mismatch.                */
+            break;
+        }
+
+        if((p_rec->p_input == 0) != (p_rec->input_size == 0)) { /* Input buffer and size must both either be zero or  */
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* non-zero. Can't have a mismatch.                   */
+            break;
+        }
+
+        if((p_rec->p_output == 0) != (p_rec->output_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* Output buffer and size must both either be zero or */
+            break;                                              /* non-zero. Can't have a mismatch.                   */
+        }
+
+        if((p_rec->p_input != p_rec->p_output) &&               /* The output can be the input buffer to work in      */
+           (p_rec->p_input != 0) && (p_rec->p_output != 0) &&   /* place, but it can not partially overlap it         */
+           (p_rec->p_output < (p_rec->p_input + p_rec->input_size)) &&
+           (p_rec->p_input < (p_rec->p_output + p_rec->output_size))) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER;
+            break;
+        }
+
+        if(p_rec->input_size != p_rec->output_size) {           /* Input buffer size must match the output buffer     */
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;      /* size, otherwise encrypt/decyrpt fails              */
+            break;
+        }
+
+        if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {          /* For encrypt, encrypt the supplied data, IV, and    */
+            mbed_ret = mbedtls_gcm_crypt_and_tag(p_gcm,         /* optional aad data to get encrypted output and tag  */
+                                                 MBEDTLS_GCM_ENCRYPT,
+                                                 p_rec->input_size,
+                                                 p_rec->p_iv,
+                                                 p_rec->iv_size,
+                                                 p_rec->p_aad,
+                                                 p_rec->aad_size,
+                                                 p_rec->p_input,
+                                                 p_rec->p_output,
+                                                 p_rec->tag_size,
+                                                 p_rec->p_tag);
+        } else {
+            mbed_ret = mbedtls_gcm_auth_decrypt(p_gcm,          /* For decrypt, supply the input data, IV, optional   */
+                                                p_rec->input_size,
+                                                p_rec->p_iv,    /* aad data, and the tag to get the output            */
+                                                p_rec->iv_size,
+                                                p_rec->p_aad,
+                                                p_rec->aad_size,
+                                                p_rec->p_tag,
+                                                p_rec->tag_size,
+                                                p_rec->p_input,
+                                                p_rec->p_output);
+        }
+
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_host_aes_gcm_iov()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_iov(void *p_ctx,
+                                       OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                       uint8_t *p_key, uint32_t key_size,
+                                       uint8_t *p_iv, uint32_t iv_size,
+                                       OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                       uint8_t *p_tag, uint32_t tag_size,
+                                       OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                       OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret;
+    uint32_t key_bit_size = 0;
+    uint32_t aad_size = 0;
+    uint32_t input_size = 0;
+    uint32_t output_size = 0;
+    uint32_t aad_off = 0;
+    uint32_t i = 0;
+    uint8_t *p_aad_buf = 0;
+    uint8_t tag[MBEDCRYPTO_AES_GCM_TAG_SIZE_MAX];
+    uint8_t tag_diff = 0;
+    int mbed_mode = MBEDTLS_GCM_DECRYPT;
+    mbedtls_gcm_context gcm;
+
+
+    do {
+        if((p_key == 0) || (key_size == 0) ||                   /* Key, IV and tag are required for AES GCM. There    */
+           (p_iv == 0) || (iv_size == 0) ||                     /* must be valid buffers and sizes greater than zero. */
+           (p_tag == 0) || (tag_size == 0) ||
+           (tag_size > MBEDCRYPTO_AES_GCM_TAG_SIZE_MAX)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(((p_aad == 0) != (aad_count == 0)) ||                /* Fragment arrays and counts must both either be     */
+           ((p_input == 0) != (input_count == 0)) ||            /* zero or non-zero. Can't have a mismatch.           */
+           ((p_output == 0) != (output_count == 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Any modes besides encrypt and decrypt are invalid  */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        key_bit_size = key_size * 8;                            /* Key size is specified in bits. Ensure the key      */
+        if((key_bit_size != 128) &&                             /* size is either 128, 192 or 256 bytes.              */
+           (key_bit_size != 192) &&
+           (key_bit_size != 256)) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;
+            break;
+        }
+
+        ret_val = mbedcrypto_iov_size(p_aad, aad_count, &aad_size);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = mbedcrypto_iov_size(p_input, input_count, &input_size);
+        }
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = mbedcrypto_iov_size(p_output, output_count, &output_size);
+        }
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(input_size != output_size) {                         /* Total input size must match the total output size  */
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;
+            break;
+        }
+
+        if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+            mbed_mode = MBEDTLS_GCM_ENCRYPT;
+        }
+
+        if(aad_count == 1) {                                    /* mbedtls_gcm_starts() takes the additional data as  */
+            p_aad_buf = p_aad[0].p_buf;                         /* a single buffer. Only gather it when it is split,  */
+        } else if(aad_size > 0) {                               /* it is normally a small header.                     */
+            ret_val = ockam_mem_alloc((void**) &p_aad_buf, aad_size);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            for(i = 0; i < aad_count; i++) {
+                ockam_mem_copy(p_aad_buf + aad_off, p_aad[i].p_buf, p_aad[i].size);
+                aad_off += p_aad[i].size;
+            }
+        }
+
+        do {
+            mbedtls_gcm_init(&gcm);                             /* Always initialize the AES GCM context first        */
+
+            mbed_ret = mbedtls_gcm_setkey(&gcm,                 /* Set the AES key. Key size must be specified in     */
+                                          MBEDTLS_CIPHER_ID_AES,/* bits.                                              */
+                                          p_key,
+                                          key_bit_size);
+            if(mbed_ret != 0) {
+                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+
+            mbed_ret = mbedtls_gcm_starts(&gcm,
+                                          mbed_mode,
+                                          p_iv, iv_size,
+                                          p_aad_buf, aad_size);
+            if(mbed_ret != 0) {
+                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+
+            ret_val = mbedcrypto_aes_gcm_iov_update(&gcm,       /* Feed the input to GCM fragment by fragment         */
+                                                    p_input, input_count,
+                                                    p_output, output_count);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {      /* For encrypt, output the resulting tag              */
+                mbed_ret = mbedtls_gcm_finish(&gcm, p_tag, tag_size);
+                if(mbed_ret != 0) {
+                    ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                }
+                break;
+            }
+
+            mbed_ret = mbedtls_gcm_finish(&gcm, &tag[0], tag_size);
+            if(mbed_ret != 0) {
+                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+
+            for(i = 0; i < tag_size; i++) {                     /* For decrypt, check the tag in constant time        */
+                tag_diff |= tag[i] ^ p_tag[i];
+            }
+
+            if(tag_diff != 0) {                                 /* Don't hand back plaintext that failed to verify    */
+                for(i = 0; i < output_count; i++) {
+                    ockam_mem_set(p_output[i].p_buf, 0, p_output[i].size);
+                }
+                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+        } while(0);
+
+        mbedtls_gcm_free(&gcm);                                 /* Always attempt to free even if an error occurred   */
+
+        if((aad_count > 1) && (p_aad_buf != 0)) {               /* Free the gathered additional data, if any          */
+            ockam_mem_free(p_aad_buf);
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    mbedcrypto_aes_gcm_iov_update()
+ *
+ * @brief   Run scatter/gather input through an AES GCM context that has been started. Runs that are
+ *          contiguous in both the input and output are passed to mbed TLS directly. Only a block that
+ *          straddles a fragment boundary is gathered into a temporary block.
+ *
+ * @param   p_gcm[in]           AES GCM context that has been started
+ *
+ * @param   p_input[in]         Input fragments
+ *
+ * @param   input_count[in]     Number of input fragments
+ *
+ * @param   p_output[out]       Output fragments. Total size must match the input.
+ *
+ * @param   output_count[in]    Number of output fragments
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_aes_gcm_iov_update(mbedtls_gcm_context *p_gcm,
+                                               OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                               OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret = 0;
+    MBEDCRYPTO_IOV_CURSOR_s in = { p_input, input_count, 0, 0 };
+    MBEDCRYPTO_IOV_CURSOR_s out = { p_output, output_count, 0, 0 };
+    uint8_t block_in[MBEDCRYPTO_AES_GCM_BLOCK_SIZE];
+    uint8_t block_out[MBEDCRYPTO_AES_GCM_BLOCK_SIZE];
+    uint32_t in_run = 0;
+    uint32_t out_run = 0;
+    uint32_t size = 0;
+
+
+    while(ret_val == OCKAM_ERR_NONE) {
+        in_run = mbedcrypto_iov_run(&in);
+        out_run = mbedcrypto_iov_run(&out);
+        if(in_run == 0) {                                       /* All input has been processed. Total sizes were     */
+            break;                                              /* checked, so the output is full as well.            */
+        }
+
+        size = (in_run < out_run) ? in_run : out_run;           /* Process whole blocks that are contiguous in both   */
+        size -= (size % MBEDCRYPTO_AES_GCM_BLOCK_SIZE);         /* the input and output directly                      */
+
+        if(size > 0) {
+            mbed_ret = mbedtls_gcm_update(p_gcm,
+                                          size,
+                                          in.p_iov[in.idx].p_buf + in.off,
+                                          out.p_iov[out.idx].p_buf + out.off);
+            mbedcrypto_iov_skip(&in, size);
+            mbedcrypto_iov_skip(&out, size);
+        } else {
+            size = mbedcrypto_iov_read(&in,                     /* A block straddles a fragment boundary. Gather it.  */
+                                       &block_in[0],            /* It is only short at the end of the input, which    */
+                                       MBEDCRYPTO_AES_GCM_BLOCK_SIZE);
+            mbed_ret = mbedtls_gcm_update(p_gcm,                /* is the one place mbed TLS allows a partial block.  */
+                                          size,
+                                          &block_in[0],
+                                          &block_out[0]);
+            mbedcrypto_iov_write(&out, &block_out[0], size);
+        }
+
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+        }
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         mbedcrypto_iov_size()
+ *
+ * @brief   Validate a scatter/gather buffer and calculate its total size
+ *
+ * @param   p_iov[in]       Fragments to check. Can be 0 if count is 0.
+ *
+ * @param   count[in]       Number of fragments
+ *
+ * @param   p_size[out]     Total size of all fragments
+ *
+ * @return  OCKAM_ERR_NONE if every fragment is valid.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR mbedcrypto_iov_size(OCKAM_VAULT_IOVEC_s *p_iov, uint32_t count, uint32_t *p_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t i = 0;
+
+
+    *p_size = 0;
+
+    for(i = 0; i < count; i++) {
+        if((p_iov[i].p_buf == 0) && (p_iov[i].size != 0)) {     /* Empty fragments are fine, missing buffers are not  */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        *p_size += p_iov[i].size;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         mbedcrypto_iov_run()
+ *
+ * @brief   Get the number of contiguous bytes at the cursor, moving past used up or empty fragments
+ *
+ * @param   p_cur[in,out]   Cursor to check
+ *
+ * @return  Number of contiguous bytes. 0 if the end of the buffer has been reached.
+ *
+ ********************************************************************************************************
+ */
+
+static uint32_t mbedcrypto_iov_run(MBEDCRYPTO_IOV_CURSOR_s *p_cur)
+{
+    uint32_t run = 0;
+
+
+    while((p_cur->idx < p_cur->count) &&
+          (p_cur->off == p_cur->p_iov[p_cur->idx].size)) {
+        p_cur->idx++;
+        p_cur->off = 0;
+    }
+
+    if(p_cur->idx < p_cur->count) {
+        run = p_cur->p_iov[p_cur->idx].size - p_cur->off;
+    }
+
+    return run;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         mbedcrypto_iov_skip()
+ *
+ * @brief   Advance a cursor
+ *
+ * @param   p_cur[in,out]   Cursor to advance
+ *
+ * @param   size[in]        Number of bytes to advance by
+ *
+ ********************************************************************************************************
+ */
+
+static void mbedcrypto_iov_skip(MBEDCRYPTO_IOV_CURSOR_s *p_cur, uint32_t size)
+{
+    uint32_t run = 0;
+
+
+    while(size > 0) {
+        run = mbedcrypto_iov_run(p_cur);
+        if(run == 0) {
+            break;
+        }
+
+        if(run > size) {
+            run = size;
+        }
+
+        p_cur->off += run;
+        size -= run;
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         mbedcrypto_iov_read()
+ *
+ * @brief   Gather bytes from a scatter/gather buffer and advance the cursor
+ *
+ * @param   p_cur[in,out]   Cursor to read from
+ *
+ * @param   p_buf[out]      Buffer to gather into
+ *
+ * @param   size[in]        Maximum number of bytes to read
+ *
+ * @return  Number of bytes read. Less than size only at the end of the buffer.
+ *
+ ********************************************************************************************************
+ */
+
+static uint32_t mbedcrypto_iov_read(MBEDCRYPTO_IOV_CURSOR_s *p_cur, uint8_t *p_buf, uint32_t size)
+{
+    uint32_t run = 0;
+    uint32_t read = 0;
+
+
+    while(read < size) {
+        run = mbedcrypto_iov_run(p_cur);
+        if(run == 0) {
+            break;
+        }
+
+        if(run > (size - read)) {
+            run = size - read;
+        }
+
+        ockam_mem_copy(p_buf + read, p_cur->p_iov[p_cur->idx].p_buf + p_cur->off, run);
+        p_cur->off += run;
+        read += run;
+    }
+
+    return read;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         mbedcrypto_iov_write()
+ *
+ * @brief   Scatter bytes into a scatter/gather buffer and advance the cursor
+ *
+ * @param   p_cur[in,out]   Cursor to write to
+ *
+ * @param   p_buf[in]       Bytes to scatter
+ *
+ * @param   size[in]        Number of bytes to write
+ *
+ ********************************************************************************************************
+ */
+
+static void mbedcrypto_iov_write(MBEDCRYPTO_IOV_CURSOR_s *p_cur, uint8_t *p_buf, uint32_t size)
+{
+    uint32_t run = 0;
+    uint32_t written = 0;
+
+
+    while(written < size) {
+        run = mbedcrypto_iov_run(p_cur);
+        if(run == 0) {
+            break;
+        }
+
+        if(run > (size - written)) {
+            run = size - written;
+        }
+
+        ockam_mem_copy(p_cur->p_iov[p_cur->idx].p_buf + p_cur->off, p_buf + written, run);
+        p_cur->off += run;
+        written += run;
+    }
+}
+
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_aes_gcm_ctx_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_init(void *p_ctx,
+                                            void **p_gcm_ctx,
+                                            OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                            uint8_t *p_key, uint32_t key_size,
+                                            uint8_t *p_iv, uint32_t iv_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret;
+    uint32_t key_bit_size = 0;
+    MBEDCRYPTO_AES_GCM_CTX_s *p_stream = 0;
+
+
+    do {
+        if((p_gcm_ctx == 0) ||                                  /* Key and IV are required to start the operation     */
+           (p_key == 0) || (key_size == 0) ||
+           (p_iv == 0) || (iv_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Any modes besides encrypt and decrypt are invalid  */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        key_bit_size = key_size * 8;                            /* Key size is specified in bits. Ensure the key      */
+        if((key_bit_size != 128) &&                             /* size is either 128, 192 or 256 bytes.              */
+           (key_bit_size != 192) &&
+           (key_bit_size != 256)) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_stream, sizeof(MBEDCRYPTO_AES_GCM_CTX_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_set(p_stream, 0, sizeof(MBEDCRYPTO_AES_GCM_CTX_s));
+        mbedtls_gcm_init(&(p_stream->gcm));                     /* Always initialize the AES GCM context first        */
+        p_stream->mode = mode;
+        p_stream->state = MBEDCRYPTO_AES_GCM_STATE_AAD;
+
+        mbed_ret = mbedtls_gcm_setkey(&(p_stream->gcm),         /* Set the AES key for the whole operation. Key size  */
+                                      MBEDTLS_CIPHER_ID_AES,    /* must be specified in bits.                         */
+                                      p_key,
+                                      key_bit_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+        }
+
+        if(ret_val == OCKAM_ERR_NONE) {                         /* mbedtls_gcm_starts() needs the IV and all of the   */
+                                                                /* additional data at once, so keep a copy of the IV  */
+                                                                /* until the first block of data arrives.             */
+            ret_val = ockam_mem_alloc((void**) &(p_stream->p_iv), iv_size);
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_host_aes_gcm_ctx_free(p_stream);
+            break;
+        }
+
+        ockam_mem_copy(p_stream->p_iv, p_iv, iv_size);
+        p_stream->iv_size = iv_size;
+
+        *p_gcm_ctx = p_stream;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                               ockam_vault_host_aes_gcm_ctx_aad_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_aad_update(void *p_gcm_ctx,
+                                                  uint8_t *p_aad, uint32_t aad_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_AES_GCM_CTX_s *p_stream = (MBEDCRYPTO_AES_GCM_CTX_s*) p_gcm_ctx;
+    uint8_t *p_buf = 0;
+
+
+    do {
+        if((p_stream == 0) || ((p_aad == 0) != (aad_size == 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_stream->state != MBEDCRYPTO_AES_GCM_STATE_AAD) {   /* Additional data must all come before the data      */
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        if(aad_size == 0) {
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_buf, p_stream->aad_size + aad_size);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_stream->p_aad != 0) {                              /* Append to what has been collected so far           */
+            ockam_mem_copy(p_buf, p_stream->p_aad, p_stream->aad_size);
+            ockam_mem_free(p_stream->p_aad);
+        }
+
+        ockam_mem_copy(p_buf + p_stream->aad_size, p_aad, aad_size);
+        p_stream->p_aad = p_buf;
+        p_stream->aad_size += aad_size;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_aes_gcm_ctx_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_update(void *p_gcm_ctx,
+                                              uint8_t *p_input, uint32_t input_size,
+                                              uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret;
+    MBEDCRYPTO_AES_GCM_CTX_s *p_stream = (MBEDCRYPTO_AES_GCM_CTX_s*) p_gcm_ctx;
+
+
+    do {
+        if((p_stream == 0) ||                                   /* Input and output buffers and sizes must both either*/
+           ((p_input == 0) != (input_size == 0)) ||             /* be zero or non-zero. Can't have a mismatch.        */
+           ((p_output == 0) != (output_size == 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((p_input != p_output) &&                             /* The output can be the input buffer to work in      */
+           (p_input != 0) && (p_output != 0) &&                 /* place, but it can not partially overlap it         */
+           (p_output < (p_input + input_size)) &&
+           (p_input < (p_output + output_size))) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER;
+            break;
+        }
+
+        if(input_size != output_size) {                         /* Input buffer size must match the output buffer     */
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;      /* size, otherwise encrypt/decyrpt fails              */
+            break;
+        }
+
+        ret_val = mbedcrypto_aes_gcm_ctx_start(p_stream);       /* First data starts GCM with the collected AAD       */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_stream->state != MBEDCRYPTO_AES_GCM_STATE_DATA) {  /* Nothing can follow a partial block or the tag      */
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        if(input_size == 0) {
+            break;
+        }
+
+        mbed_ret = mbedtls_gcm_update(&(p_stream->gcm), input_size, p_input, p_output);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            break;
+        }
+
+        if((input_size % MBEDCRYPTO_AES_GCM_BLOCK_SIZE) != 0) { /* mbed TLS only allows a partial block on the last   */
+            p_stream->state = MBEDCRYPTO_AES_GCM_STATE_PARTIAL; /* update                                             */
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_host_aes_gcm_ctx_finish()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_finish(void *p_gcm_ctx,
+                                              uint8_t *p_tag, uint32_t tag_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    int32_t mbed_ret;
+    MBEDCRYPTO_AES_GCM_CTX_s *p_stream = (MBEDCRYPTO_AES_GCM_CTX_s*) p_gcm_ctx;
+    uint8_t tag[MBEDCRYPTO_AES_GCM_TAG_SIZE_MAX];
+    uint8_t tag_diff = 0;
+    uint32_t i = 0;
+
+
+    do {
+        if((p_stream == 0) ||                                   /* Tag is always required for encrypt and decrypt     */
+           (p_tag == 0) || (tag_size == 0) ||
+           (tag_size > MBEDCRYPTO_AES_GCM_TAG_SIZE_MAX)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = mbedcrypto_aes_gcm_ctx_start(p_stream);       /* Start GCM if no data was passed in at all          */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_stream->state == MBEDCRYPTO_AES_GCM_STATE_DONE) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        p_stream->state = MBEDCRYPTO_AES_GCM_STATE_DONE;
+
+                                                                /* For encrypt, output the resulting tag              */
+        if(p_stream->mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+            mbed_ret = mbedtls_gcm_finish(&(p_stream->gcm), p_tag, tag_size);
+            if(mbed_ret != 0) {
+                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            }
+            break;
+        }
+
+        mbed_ret = mbedtls_gcm_finish(&(p_stream->gcm), &tag[0], tag_size);
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            break;
+        }
+
+        for(i = 0; i < tag_size; i++) {                         /* For decrypt, check the tag in constant time        */
+            tag_diff |= tag[i] ^ p_tag[i];
+        }
+
+        if(tag_diff != 0) {                                     /* Data already handed back must be discarded by the  */
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;            /* caller                                             */
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_host_aes_gcm_ctx_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_host_aes_gcm_ctx_free(void *p_gcm_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    MBEDCRYPTO_AES_GCM_CTX_s *p_stream = (MBEDCRYPTO_AES_GCM_CTX_s*) p_gcm_ctx;
+
+
+    do {
+        if(p_stream == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        mbedtls_gcm_free(&(p_stream->gcm));                     /* Clears the key schedule from the context           */
+
+        if(p_stream->p_iv != 0) {
+            ockam_mem_free(p_stream->p_iv);
+        }
+
+        if(p_stream->p_aad != 0) {
+            ockam_mem_free(p_stream->p_aad);
         }
+
+        ret_val = ockam_mem_free(p_stream);
     } while(0);
 
     return ret_val;
 }
 
 
-/*
+/**
  ********************************************************************************************************
- *                                     ockam_vault_host_key_write()
+ *                                    mbedcrypto_aes_gcm_ctx_start()
+ *
+ * @brief   Start GCM on a streaming context once all of its additional data has been collected. Does
+ *          nothing if GCM has already been started.
+ *
+ * @param   p_stream[in]    The streaming context
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_key_write(OCKAM_VAULT_KEY_e key_type,
-                                     uint8_t *p_priv_key, uint32_t priv_key_size)
+static OCKAM_ERR mbedcrypto_aes_gcm_ctx_start(MBEDCRYPTO_AES_GCM_CTX_s *p_stream)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    int mbed_ret = 0;
-    uint8_t *p_priv_key_byte = 0;
-    mbedtls_ecp_keypair *p_ecp = 0;
+    int32_t mbed_ret;
+    int mbed_mode = MBEDTLS_GCM_DECRYPT;
 
 
     do {
-        if(key_type == OCKAM_VAULT_KEY_STATIC) {                /* Set the keypair data based on the desired key      */
-            p_ecp = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_STATIC];
-        } else if(key_type == OCKAM_VAULT_KEY_EPHEMERAL) {
-            p_ecp = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_EPHEMERAL];
-        } else {
-            ret_val = OCKAM_ERR_INVALID_PARAM;
+        if(p_stream->state != MBEDCRYPTO_AES_GCM_STATE_AAD) {
             break;
         }
 
-        p_priv_key_byte = p_priv_key;                           /* Ensure the private key is a valid Curve25519 key   */
-        *p_priv_key_byte &= 248;                                /* Bit modifications come from RFC7748 Section 5      */
-        p_priv_key_byte += 31;
-        *p_priv_key_byte &= 127;
-        *p_priv_key_byte |= 64;
-
-        mbedtls_ecp_keypair_init(p_ecp);                        /* Always initialize the keypair first                */
-        mbedtls_ecp_group_load(&(p_ecp->grp),                   /* Set the keypair to use Curve25519                  */
-                               MBEDTLS_ECP_DP_CURVE25519);
-
-        mbed_ret = mbedtls_mpi_read_binary_le(&(p_ecp->d),      /* Write the private key buffer data to the MPI point */
-                                           p_priv_key, priv_key_size);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
+        if(p_stream->mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+            mbed_mode = MBEDTLS_GCM_ENCRYPT;
         }
 
-        mbed_ret = mbedtls_ecp_mul(&(p_ecp->grp),               /* Generate the public key from the private key       */
-                                   &(p_ecp->Q),
-                                   &(p_ecp->d),
-                                   &(p_ecp->grp.G),
-                                   mbedtls_ctr_drbg_random,
-                                   &g_ctr_drbg);
+        mbed_ret = mbedtls_gcm_starts(&(p_stream->gcm),
+                                      mbed_mode,
+                                      p_stream->p_iv, p_stream->iv_size,
+                                      p_stream->p_aad, p_stream->aad_size);
         if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
             break;
         }
 
-        mbed_ret = mbedtls_ecp_check_pubkey(&(p_ecp->grp),      /* Check that generated public key lies on the curve  */
-                                            &(p_ecp->Q));
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
+        if(p_stream->p_aad != 0) {                              /* The additional data is only needed to start        */
+            ockam_mem_free(p_stream->p_aad);
+            p_stream->p_aad = 0;
+            p_stream->aad_size = 0;
         }
 
-        mbed_ret = mbedtls_ecp_check_privkey(&(p_ecp->grp),     /* Ensure the loaded private key is valid on the      */
-                                             &(p_ecp->d));      /* specified curve.                                   */
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_KEY_FAIL;
-            break;
-        }
+        p_stream->state = MBEDCRYPTO_AES_GCM_STATE_DATA;
     } while(0);
 
     return ret_val;
@@ -356,337 +3539,271 @@ OCKAM_ERR ockam_vault_host_key_write(OCKAM_VAULT_KEY_e key_type,
 
 /**
  ********************************************************************************************************
- *                                      ockam_vault_host_ecdh()
+ *                                   ockam_vault_host_secret_import()
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_ecdh(OCKAM_VAULT_KEY_e key_type,
-                                uint8_t *p_pub_key, uint32_t pub_key_size,
-                                uint8_t *p_pms, uint32_t pms_size)
+OCKAM_ERR ockam_vault_host_secret_import(void *p_ctx,
+                                         void **p_secret,
+                                         uint8_t *p_key, uint32_t key_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    int mbed_ret = 0;
-
-    mbedtls_ecp_keypair *p_key = 0;
-    mbedtls_mpi pms;
-    mbedtls_ecp_point pub_key;
+    int32_t mbed_ret;
+    uint32_t key_bit_size = 0;
+    MBEDCRYPTO_SECRET_s *p_new = 0;
 
 
     do {
-        mbedtls_mpi_init(&pms);
-        mbedtls_ecp_point_init(&pub_key);
-
-
-        if(key_type == OCKAM_VAULT_KEY_STATIC) {                /* Set the keypair data based on the desired key      */
-            p_key = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_STATIC];
-        } else if(key_type == OCKAM_VAULT_KEY_EPHEMERAL) {
-            p_key = &g_keypair_data[MBEDCRYPTO_KEY_CURVE25519_EPHEMERAL];
-        } else {
+        if((p_secret == 0) || (p_key == 0) || (key_size == 0)) {
             ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        mbed_ret = mbedtls_ecp_point_read_binary(&(p_key->grp), /* Write the received public key to the ECDH context  */
-                                                 &pub_key,
-                                                 p_pub_key,
-                                                 pub_key_size);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+        key_bit_size = key_size * 8;                            /* Key size is specified in bits. Ensure the key      */
+        if((key_bit_size != 128) &&                             /* size is either 128, 192 or 256 bytes.              */
+           (key_bit_size != 192) &&
+           (key_bit_size != 256)) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;
             break;
         }
 
-        mbed_ret = mbedtls_ecdh_compute_shared(&(p_key->grp),   /* Generate the shared secret                         */
-                                               &pms,
-                                               &pub_key,
-                                               &(p_key->d),
-                                               mbedtls_ctr_drbg_random,
-                                               &g_ctr_drbg);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(MBEDCRYPTO_SECRET_s));
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        mbed_ret = mbedtls_mpi_write_binary(&pms,               /* Write the generated PMS to the PMS buffer          */
-                                            p_pms,
-                                            pms_size);
+        mbedtls_gcm_init(&(p_new->gcm));                        /* Always initialize the AES GCM context first        */
+
+        ret_val = ockam_kal_mutex_init(&(p_new->mutex));
+        if(ret_val != OCKAM_ERR_NONE) {
+            mbedtls_gcm_free(&(p_new->gcm));
+            ockam_mem_free(p_new);
+            break;
+        }
+
+        mbed_ret = mbedtls_gcm_setkey(&(p_new->gcm),            /* The key schedule and GHASH tables are built once   */
+                                      MBEDTLS_CIPHER_ID_AES,    /* here and stay resident until the secret is freed   */
+                                      p_key,
+                                      key_bit_size);
         if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_ECDH_FAIL;
+            ockam_vault_host_secret_free(p_new);
+            ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
             break;
         }
 
+        *p_secret = p_new;
     } while(0);
 
-
     return ret_val;
 }
 
 
-#endif                                                          /* OCKAM_VAULT_CFG_KEY_ECDH                           */
-
-
-/*
- ********************************************************************************************************
- ********************************************************************************************************
- *                                        OCKAM_VAULT_CFG_SHA256
- ********************************************************************************************************
- ********************************************************************************************************
- */
-
-#if(OCKAM_VAULT_CFG_SHA256 == OCKAM_VAULT_HOST_MBEDCRYPTO)
-
-
 /**
  ********************************************************************************************************
- *                                    ockam_vault_host_sha256()
+ *                                   ockam_vault_host_secret_aes_gcm()
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_sha256(uint8_t *p_msg, uint16_t msg_size,
-                                  uint8_t *p_digest, uint8_t digest_size)
+OCKAM_ERR ockam_vault_host_secret_aes_gcm(void *p_secret,
+                                          OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                          uint8_t *p_iv, uint32_t iv_size,
+                                          uint8_t *p_aad, uint32_t aad_size,
+                                          uint8_t *p_tag, uint32_t tag_size,
+                                          uint8_t *p_input, uint32_t input_size,
+                                          uint8_t *p_output, uint32_t output_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    int mbed_ret = 0;
-    mbedtls_sha256_context sha256_ctx;
+    OCKAM_VAULT_AES_GCM_REC_s rec;
+    MBEDCRYPTO_SECRET_s *p_gcm_secret = (MBEDCRYPTO_SECRET_s*) p_secret;
 
 
     do {
-        mbedtls_sha256_init(&sha256_ctx);                       /* SHA256 context structure must be inited before use */
-
-
-        mbed_ret = mbedtls_sha256_starts_ret(&sha256_ctx,       /* Configure for SHA256 rather than SHA224            */
-                                             MBEDCRYPTO_SHA256_IS224);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+        if(p_secret == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        mbed_ret = mbedtls_sha256_update_ret(&sha256_ctx,       /* Add the message to the SHA256 context              */
-                                             p_msg,
-                                             msg_size);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Any modes besides encrypt and decrypt are invalid  */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        mbed_ret = mbedtls_sha256_finish_ret(&sha256_ctx,       /* Complete SHA256 hash and output to digest buffer   */
-                                             p_digest);
-        if(mbed_ret != 0) {
-            ret_val = OCKAM_ERR_VAULT_HOST_SHA256_FAIL;
+        rec.p_iv = p_iv;
+        rec.iv_size = iv_size;
+        rec.p_aad = p_aad;
+        rec.aad_size = aad_size;
+        rec.p_tag = p_tag;
+        rec.tag_size = tag_size;
+        rec.p_input = p_input;
+        rec.input_size = input_size;
+        rec.p_output = p_output;
+        rec.output_size = output_size;
+
+        ret_val = ockam_kal_mutex_lock(&(p_gcm_secret->mutex),  /* The GCM context keeps per-call state next to the   */
+                                       OCKAM_KAL_OPT_BLOCKING,  /* key schedule, so calls on one secret take turns.   */
+                                       0);                      /* Calls on different secrets still run in parallel.  */
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
-    } while(0);
 
-    mbedtls_sha256_free(&sha256_ctx);                           /* Always clear the SHA256 context when finished      */
+        ret_val = mbedcrypto_aes_gcm_rec(&(p_gcm_secret->gcm), mode, &rec);
+
+        ockam_kal_mutex_unlock(&(p_gcm_secret->mutex), 0);
+    } while(0);
 
     return ret_val;
 }
 
 
-#endif                                                          /* OCKAM_VAULT_CFG_SHA256                             */
-
-
-/**
- ********************************************************************************************************
- ********************************************************************************************************
- *                                       OCKAM_VAULT_CFG_HKDF
- ********************************************************************************************************
- ********************************************************************************************************
- */
-
-#if(OCKAM_VAULT_CFG_HKDF == OCKAM_VAULT_HOST_MBEDCRYPTO)
-
-
 /**
  ********************************************************************************************************
- *                                          ockam_vault_host_hkdf()
- *
- * @brief   Perform HKDF in the mbed TLS library
- *
- * @param   p_salt[in]          Buffer for the Ockam salt value
- *
- * @param   salt_size[in]       Size of the Ockam salt value
- *
- * @param   p_ikm[in]           Buffer with the input key material for HKDF
- *
- * @param   ikm_size[in]        Size of the input key material
- *
- * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
- *
- * @param   info_size[in]       Size of the optional context specific info.
- *
- * @param   p_out[out]          Buffer for the output of the HKDF operation
- *
- * @param   out_size[in]        Size of the HKDF output buffer
- *
- * @return  OCKAM_ERR_NONE if successful.
- *
+ *                                    ockam_vault_host_secret_free()
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_hkdf(uint8_t *p_salt, uint32_t salt_size,
-                                uint8_t *p_ikm, uint32_t ikm_size,
-                                uint8_t *p_info, uint32_t info_size,
-                                uint8_t *p_out, uint32_t out_size)
+OCKAM_ERR ockam_vault_host_secret_free(void *p_secret)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    const mbedtls_md_info_t *p_md;
-    int32_t mbed_ret;
+    MBEDCRYPTO_SECRET_s *p_gcm_secret = (MBEDCRYPTO_SECRET_s*) p_secret;
 
 
     do {
-        if((p_ikm == 0) || (ikm_size == 0) ||                   /* Ensure the input key and output buffers are not    */
-           (p_out == 0) || (out_size  == 0)) {                  /* null and the size values are greater than zero     */
+        if(p_secret == 0) {
             ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
         }
 
-        p_md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);    /* Get the SHA-256 MD context for HKDF                */
-
-        mbed_ret = mbedtls_hkdf(p_md,                           /* Perform the HKDF calculation                       */
-                           p_salt, salt_size,
-                           p_ikm, ikm_size,
-                           p_info, info_size,
-                           p_out, out_size);
-        if(mbed_ret != 0) {                                     /* Check for an mbed TLS error                        */
-            OCKAM_ERR_VAULT_HOST_HKDF_FAIL;
-        }
+        mbedtls_gcm_free(&(p_gcm_secret->gcm));                 /* Clears the key schedule from the context           */
+        ockam_kal_mutex_free(&(p_gcm_secret->mutex));
 
+        ret_val = ockam_mem_free(p_secret);
     } while(0);
 
     return ret_val;
 }
 
 
-#endif                                                          /* OCKAM_CFG_VAULT_HKDF                               */
-
-
-
-/**
- ********************************************************************************************************
- ********************************************************************************************************
- *                                      OCKAM_VAULT_CFG_AES_GCM
- ********************************************************************************************************
- ********************************************************************************************************
- */
-
-#if(OCKAM_VAULT_CFG_AES_GCM == OCKAM_VAULT_HOST_MBEDCRYPTO)
-
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH, OCKAM_VAULT_HOST_MBEDCRYPTO) && \
+    OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_HKDF, OCKAM_VAULT_HOST_MBEDCRYPTO))
 
 /**
  ********************************************************************************************************
- *                                       ockam_vault_host_aes_gcm()
+ *                                    ockam_vault_host_ecdh_derive()
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_host_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
-                                   uint8_t *p_key, uint32_t key_size,
-                                   uint8_t *p_iv, uint32_t iv_size,
-                                   uint8_t *p_aad, uint32_t aad_size,
-                                   uint8_t *p_tag, uint32_t tag_size,
-                                   uint8_t *p_input, uint32_t input_size,
-                                   uint8_t *p_output, uint32_t output_size)
+OCKAM_ERR ockam_vault_host_ecdh_derive(void *p_ctx,
+                                       OCKAM_VAULT_KEY_e key_type,
+                                       uint8_t *p_pub_key, uint32_t pub_key_size,
+                                       uint8_t *p_salt, uint32_t salt_size,
+                                       uint8_t *p_info, uint32_t info_size,
+                                       uint32_t key_size,
+                                       void **p_secrets, uint32_t secret_count)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     int32_t mbed_ret;
-    uint32_t key_bit_size = 0;
-    mbedtls_gcm_context gcm;
+    uint32_t i = 0;
+    const mbedtls_md_info_t *p_md;
+    uint8_t pms[MBEDCRYPTO_PMS_SIZE];
+    uint8_t okm[MBEDCRYPTO_AES_GCM_KEY_SIZE_MAX * OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX];
 
 
     do {
-        if((p_key == 0) || (key_size == 0) ||                   /* Key and IV are required for AES GCM. There must be */
-           (p_iv == 0) || (iv_size == 0) ||                     /* valid buffers and sizes greater than zero. Tag is  */
-           (p_tag == 0) || (tag_size == 0)) {                   /* also always required to be present for encrypt and */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* decrypt.                                           */
-            break;
-        }
-
-        if((p_aad == 0) != (aad_size == 0)) {                   /* Valid for both the AAD buffer and size to be zero  */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* or non-zero. Can't have a mismatch.                */
-            break;
-        }
-
-        if((p_input == 0) != (input_size == 0)) {               /* Input buffer and size must both either be zero or  */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* non-zero. Can't have a mismatch.                   */
-            break;
-        }
-
-        if((p_output == 0) != (output_size == 0)) {             /* Output buffer and size must both either be zero o  */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* non-zero. Can't have a mismatch.                   */
+        if((p_secrets == 0) || (secret_count == 0) ||
+           (key_size > MBEDCRYPTO_AES_GCM_KEY_SIZE_MAX) ||
+           (secret_count > OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        key_bit_size = key_size * 8;                            /* Key size is specified in bits. Ensure the key      */
-        if((key_bit_size != 128) &&                             /* size is either 128, 192 or 256 bytes.              */
-           (key_bit_size != 192) &&
-           (key_bit_size != 256)) {
-            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;
+        ret_val = ockam_vault_host_ecdh(p_ctx,                  /* Shared secret stays in this stack frame            */
+                                        key_type,
+                                        p_pub_key, pub_key_size,
+                                        &pms[0], MBEDCRYPTO_PMS_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if((p_input == p_output) && (p_input != 0)) {           /* The input buffer can not be used for the result    */
-            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER;
-            break;
-        }
+        p_md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
 
-        if(input_size != output_size) {                         /* Input buffer size must match the output buffer     */
-            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;      /* size, otherwise encrypt/decyrpt fails              */
+        mbed_ret = mbedtls_hkdf(p_md,
+                                p_salt, salt_size,
+                                &pms[0], MBEDCRYPTO_PMS_SIZE,
+                                p_info, info_size,
+                                &okm[0], (key_size * secret_count));
+        if(mbed_ret != 0) {
+            ret_val = OCKAM_ERR_VAULT_HOST_HKDF_FAIL;
             break;
         }
 
-        do {
-            mbedtls_gcm_init(&gcm);                             /* Always initialize the AES GCM context first        */
-
-            mbed_ret = mbedtls_gcm_setkey(&gcm,                 /* Set the AES key. Key size must be specified in     */
-                                          MBEDTLS_CIPHER_ID_AES,/* bits.                                              */
-                                          p_key,
-                                          key_bit_size);
-            if(mbed_ret != 0) {                                 /* TODO allow platform feature unsupported?           */
-                ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+        for(i = 0; i < secret_count; i++) {                     /* Each secret takes the next key_size bytes          */
+            ret_val = ockam_vault_host_secret_import(p_ctx,
+                                                     &p_secrets[i],
+                                                     &okm[i * key_size], key_size);
+            if(ret_val != OCKAM_ERR_NONE) {
                 break;
             }
+        }
 
-            if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {      /* For encrypt, encrypt the supplied data, IV, and    */
-                mbed_ret = mbedtls_gcm_crypt_and_tag(&gcm,      /* optional aad data to get encrypted output and tag  */
-                                                     MBEDTLS_GCM_ENCRYPT,
-                                                     input_size,
-                                                     p_iv,
-                                                     iv_size,
-                                                     p_aad,
-                                                     aad_size,
-                                                     p_input,
-                                                     p_output,
-                                                     tag_size,
-                                                     p_tag);
-                if(mbed_ret != 0) {
-                    ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
-                    break;
-                }
-            } else if(mode == OCKAM_VAULT_AES_GCM_MODE_DECRYPT) {
-                mbed_ret = mbedtls_gcm_auth_decrypt(&gcm,       /* For decrypt, supply the input data, IV, optional   */
-                                                    input_size, /* aad data, and the tag to get the decrypted output  */
-                                                    p_iv,
-                                                    iv_size,
-                                                    p_aad,
-                                                    aad_size,
-                                                    p_tag,
-                                                    tag_size,
-                                                    p_input,
-                                                    p_output);
-                if(mbed_ret != 0) {
-                    ret_val = OCKAM_ERR_VAULT_HOST_AES_FAIL;
-                    break;
-                }
-            } else {                                            /* Any modes besides encrypt and decrypt are invalid  */
-                ret_val = OCKAM_ERR_INVALID_PARAM;
-                break;
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Release the secrets imported before the failure    */
+            while(i > 0) {
+                i--;
+                ockam_vault_host_secret_free(p_secrets[i]);
+                p_secrets[i] = 0;
             }
-        } while(0);
-
-        mbedtls_gcm_free(&gcm);                                 /* Always attempt to free even if an error occurred   */
+        }
     } while(0);
 
+    mbedtls_platform_zeroize(&pms[0], sizeof(pms));
+    mbedtls_platform_zeroize(&okm[0], sizeof(okm));
+
     return ret_val;
 }
 
+#endif                                                          /* OCKAM_VAULT_CFG_KEY_ECDH && OCKAM_VAULT_CFG_HKDF   */
+
 
 #endif                                                          /* OCKAM_VAULT_CFG_AES_GCM                            */
 
+
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                        Backend Function Table
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN && (OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_HOST_MBEDCRYPTO))
+
+const OCKAM_VAULT_BACKEND_s ockam_vault_host_backend = {
+    .random                     = ockam_vault_host_random,
+    .key_gen                    = ockam_vault_host_key_gen,
+    .key_get_pub                = ockam_vault_host_key_get_pub,
+    .key_write                  = ockam_vault_host_key_write,
+    .ecdh                       = ockam_vault_host_ecdh,
+    .sha256                     = ockam_vault_host_sha256,
+    .sha256_ctx_init            = ockam_vault_host_sha256_ctx_init,
+    .sha256_ctx_update          = ockam_vault_host_sha256_ctx_update,
+    .sha256_ctx_finish          = ockam_vault_host_sha256_ctx_finish,
+    .sha256_ctx_free            = ockam_vault_host_sha256_ctx_free,
+    .hkdf                       = ockam_vault_host_hkdf,
+    .hkdf_extract               = ockam_vault_host_hkdf_extract,
+    .hkdf_expand                = ockam_vault_host_hkdf_expand,
+    .hkdf_prk_free              = ockam_vault_host_hkdf_prk_free,
+    .aes_gcm                    = ockam_vault_host_aes_gcm,
+    .aes_gcm_batch              = ockam_vault_host_aes_gcm_batch,
+    .aes_gcm_iov                = ockam_vault_host_aes_gcm_iov,
+    .aes_gcm_ctx_init           = ockam_vault_host_aes_gcm_ctx_init,
+    .aes_gcm_ctx_aad_update     = ockam_vault_host_aes_gcm_ctx_aad_update,
+    .aes_gcm_ctx_update         = ockam_vault_host_aes_gcm_ctx_update,
+    .aes_gcm_ctx_finish         = ockam_vault_host_aes_gcm_ctx_finish,
+    .aes_gcm_ctx_free           = ockam_vault_host_aes_gcm_ctx_free,
+    .secret_import              = ockam_vault_host_secret_import,
+    .secret_aes_gcm             = ockam_vault_host_secret_aes_gcm,
+    .secret_free                = ockam_vault_host_secret_free,
+    .ecdh_derive                = ockam_vault_host_ecdh_derive
+};
+
+#endif                                                          /* OCKAM_VAULT_CFG_DISPATCH_EN                        */
@@ -18,6 +18,7 @@
 #include <ockam/memory.h>
 #include <ockam/vault.h>
 #include <ockam/vault/tpm.h>
+#include <ockam/vault/backend.h>
 #include <ockam/vault/tpm/microchip.h>
 
 #include <cryptoauthlib/lib/cryptoauthlib.h>
@@ -79,6 +80,8 @@
 #define ATECC508A_CFG_LOCK_CONFIG_UNLOCKED    0x55              /* Config zone is in an unlocked/configurable state   */
 #define ATECC508A_CFG_LOCK_CONFIG_LOCKED      0x00              /* Config zone is in a locked/unconfigurable state    */
 
+#define ATECC508A_SHA256_BLOCK_SIZE           64u               /* SHA update commands take exactly one block         */
+
 #define ATECC508A_HKDF_SLOT                    9u               /* Use slot 9 for the HKDF key                        */
 #define ATECC508A_HKDF_SLOT_SIZE              72u               /* Slot 9 is 72 bytes                                 */
 #define ATECC508A_HKDF_UPDATE_SIZE            64u               /* HMAC updates MUST be 64 bytes                      */
@@ -133,6 +136,18 @@ typedef struct {                                                /*!< Byte(s): De
 #pragma pack()
 
 
+/**
+ *******************************************************************************
+ * @struct  ATECC508A_HKDF_PRK_s
+ * @brief   Pseudo-random key kept from an HKDF extract
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint8_t prk[ATECC508A_HMAC_HASH_SIZE];                      /*!< Copy to reload into the HKDF slot                */
+} ATECC508A_HKDF_PRK_s;
+
+
 /*
  ********************************************************************************************************
  *                                            INLINE FUNCTIONS                                          *
@@ -147,6 +162,14 @@ typedef struct {                                                /*!< Byte(s): De
 
 static ATECC508A_CFG_DATA_s *g_atecc508a_cfg_data;
 
+static ATECC508A_HKDF_PRK_s *g_atecc508a_hkdf_owner = 0;        /* Key whose PRK is loaded in the HKDF slot           */
+
+                                                                /* Public keys read back from the key slots. Reading  */
+                                                                /* one recomputes it from the private key on the chip,*/
+                                                                /* so each is kept until its slot gets a new key.     */
+static uint8_t g_atecc508a_pub_key[MAX_OCKAM_VAULT_KEY][ATECC508A_PUB_KEY_SIZE];
+static uint8_t g_atecc508a_pub_key_valid[MAX_OCKAM_VAULT_KEY] = {0};
+
 
 /*
  ********************************************************************************************************
@@ -171,6 +194,8 @@ OCKAM_ERR atecc508a_hkdf_expand(uint8_t key_slot,
                                 uint8_t *p_info, uint32_t info_size,
                                 uint8_t *p_output, uint32_t output_size);
 
+OCKAM_ERR atecc508a_hkdf_prk_key(ATECC508A_HKDF_PRK_s *p_hkdf_prk);
+
 
 /*
  ********************************************************************************************************
@@ -188,7 +213,7 @@ OCKAM_ERR atecc508a_hkdf_expand(uint8_t key_slot,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
+OCKAM_ERR ockam_vault_tpm_init(void *p_arg, void **p_ctx)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -196,7 +221,7 @@ OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
 
 
     do {
-        if(p_arg == 0) {                                        /* Ensure the p_arg value is not null                 */
+        if((p_arg == 0) || (p_ctx == 0)) {                      /* Ensure the p_arg and p_ctx values are not null     */
             ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
@@ -234,6 +259,8 @@ OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
             ret_val = OCKAM_ERR_VAULT_TPM_UNLOCKED;
             break;
         }
+
+        *p_ctx = g_atecc508a_cfg_data;                          /* The configuration data doubles as the TPM context  */
     } while(0);
 
     return ret_val;
@@ -246,9 +273,25 @@ OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_free (void)
+OCKAM_ERR ockam_vault_tpm_free (void *p_ctx)
 {
-   return OCKAM_ERR_NONE;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(p_ctx != g_atecc508a_cfg_data) {                     /* Only the context handed out by init can be freed   */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        atcab_release();                                        /* Release the interface before dropping the config   */
+        ockam_mem_set(g_atecc508a_pub_key_valid, 0, sizeof(g_atecc508a_pub_key_valid));
+
+        ret_val = ockam_mem_free(g_atecc508a_cfg_data);
+        g_atecc508a_cfg_data = 0;
+    } while(0);
+
+    return ret_val;
 }
 
 #endif                                                          /* OCKAM_VAULT_CFG_INIT                               */
@@ -262,7 +305,7 @@ OCKAM_ERR ockam_vault_tpm_free (void)
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_RAND == OCKAM_VAULT_TPM_MICROCHIP_ATECC508A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_RAND, OCKAM_VAULT_TPM_MICROCHIP_ATECC508A))
 
 
 /*
@@ -271,7 +314,8 @@ OCKAM_ERR ockam_vault_tpm_free (void)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_random(uint8_t *p_rand_num, uint32_t rand_num_size)
+OCKAM_ERR ockam_vault_tpm_random(void *p_ctx,
+                                 uint8_t *p_rand_num, uint32_t rand_num_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -303,7 +347,7 @@ OCKAM_ERR ockam_vault_tpm_random(uint8_t *p_rand_num, uint32_t rand_num_size)
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_KEY_ECDH == OCKAM_VAULT_TPM_MICROCHIP_ATECC508A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH, OCKAM_VAULT_TPM_MICROCHIP_ATECC508A))
 
 
 /*
@@ -312,7 +356,8 @@ OCKAM_ERR ockam_vault_tpm_random(uint8_t *p_rand_num, uint32_t rand_num_size)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_key_gen(OCKAM_VAULT_KEY_e key_type)
+OCKAM_ERR ockam_vault_tpm_key_gen(void *p_ctx,
+                                  OCKAM_VAULT_KEY_e key_type)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -321,6 +366,10 @@ OCKAM_ERR ockam_vault_tpm_key_gen(OCKAM_VAULT_KEY_e key_type)
 
     do
     {
+        if(key_type < MAX_OCKAM_VAULT_KEY) {                    /* The slot is about to get a new key, so forget its  */
+            g_atecc508a_pub_key_valid[key_type] = 0;            /* public key even if the generation fails            */
+        }
+
         status = atcab_random(&rand[0]);                        /* Get a random number from the ATECC508A             */
         if(status != ATCA_SUCCESS) {                            /* before a genkey operation.                         */
             ret_val = OCKAM_ERR_VAULT_TPM_KEY_FAIL;
@@ -365,7 +414,8 @@ OCKAM_ERR ockam_vault_tpm_key_gen(OCKAM_VAULT_KEY_e key_type)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_tpm_key_get_pub(void *p_ctx,
+                                      OCKAM_VAULT_KEY_e key_type,
                                       uint8_t *p_pub_key, uint32_t pub_key_size)
 {
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -384,6 +434,12 @@ OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
             break;
         }
 
+                                                                /* Serve repeat requests without touching the chip    */
+        if((key_type < MAX_OCKAM_VAULT_KEY) && (g_atecc508a_pub_key_valid[key_type])) {
+            ockam_mem_copy(p_pub_key, g_atecc508a_pub_key[key_type], ATECC508A_PUB_KEY_SIZE);
+            break;
+        }
+
         switch(key_type) {
             case OCKAM_VAULT_KEY_STATIC:                        /* Get the static public key                          */
                 status = atcab_get_pubkey(ATECC508A_KEY_SLOT_STATIC,
@@ -407,6 +463,11 @@ OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
                 ret_val = OCKAM_ERR_INVALID_PARAM;
                 break;
         }
+
+        if(ret_val == OCKAM_ERR_NONE) {
+            ockam_mem_copy(g_atecc508a_pub_key[key_type], p_pub_key, ATECC508A_PUB_KEY_SIZE);
+            g_atecc508a_pub_key_valid[key_type] = 1;
+        }
     } while (0);
 
     return ret_val;
@@ -419,7 +480,8 @@ OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_ecdh(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_tpm_ecdh(void *p_ctx,
+                               OCKAM_VAULT_KEY_e key_type,
                                uint8_t *p_pub_key, uint32_t pub_key_size,
                                uint8_t *p_pms, uint32_t pms_size)
 {
@@ -484,7 +546,7 @@ OCKAM_ERR ockam_vault_tpm_ecdh(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_SHA256 == OCKAM_VAULT_TPM_MICROCHIP_ATECC508A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_SHA256, OCKAM_VAULT_TPM_MICROCHIP_ATECC508A))
 
 
 /**
@@ -493,7 +555,8 @@ OCKAM_ERR ockam_vault_tpm_ecdh(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
+OCKAM_ERR ockam_vault_tpm_sha256(void *p_ctx,
+                                 uint8_t *p_msg, uint32_t msg_size,
                                  uint8_t *p_digest, uint8_t digest_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
@@ -501,9 +564,25 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
 
 
     do {
-        status = atcab_sha(msg_size,                            /* Run the SHA256 command in the ATECC508A. The ATCAB */
-                           p_msg,                               /* library handles sending data in 32 byte chunks.    */
-                           p_digest);
+        if((p_msg == 0) && (msg_size != 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        status = atcab_sha_start();                             /* Run the SHA256 command in the ATECC508A one block  */
+        while((status == ATCA_SUCCESS) &&                       /* at a time so the message length is not limited to  */
+              (msg_size >= ATECC508A_SHA256_BLOCK_SIZE)) {      /* the 16-bit length atcab_sha() takes.               */
+            status = atcab_sha_update(p_msg);
+            p_msg += ATECC508A_SHA256_BLOCK_SIZE;
+            msg_size -= ATECC508A_SHA256_BLOCK_SIZE;
+        }
+
+        if(status == ATCA_SUCCESS) {                            /* The final partial block is sent with the end       */
+            status = atcab_sha_end(p_digest,                    /* command                                            */
+                                   (uint16_t) msg_size,
+                                   p_msg);
+        }
+
         if(status != ATCA_SUCCESS) {
             ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
             break;
@@ -513,6 +592,59 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
     return ret_val;
 }
 
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_tpm_sha256_ctx_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_init(void *p_ctx,
+                                          void **p_sha_ctx)
+{
+                                                                /* The ATECC508A can not save the SHA engine state,   */
+                                                                /* so a digest can not stay open between calls.       */
+    return OCKAM_ERR_VAULT_TPM_UNSUPPORTED;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_tpm_sha256_ctx_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_update(void *p_sha_ctx,
+                                            uint8_t *p_msg, uint32_t msg_size)
+{
+    return OCKAM_ERR_VAULT_TPM_UNSUPPORTED;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_tpm_sha256_ctx_finish()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_finish(void *p_sha_ctx,
+                                            uint8_t *p_digest, uint8_t digest_size)
+{
+    return OCKAM_ERR_VAULT_TPM_UNSUPPORTED;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_tpm_sha256_ctx_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_free(void *p_sha_ctx)
+{
+    return OCKAM_ERR_VAULT_TPM_UNSUPPORTED;
+}
+
 #endif                                                          /* OCKAM_VAULT_CFG_SHA256                             */
 
 
@@ -524,7 +656,7 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_HKDF == OCKAM_VAULT_TPM_MICROCHIP_ATECC508A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_HKDF, OCKAM_VAULT_TPM_MICROCHIP_ATECC508A))
 
 
 /**
@@ -533,7 +665,8 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_hkdf(uint8_t *p_salt, uint32_t salt_size,
+OCKAM_ERR ockam_vault_tpm_hkdf(void *p_ctx,
+                               uint8_t *p_salt, uint32_t salt_size,
                                uint8_t *p_ikm, uint32_t ikm_size,
                                uint8_t *p_info, uint32_t info_size,
                                uint8_t *p_out, uint32_t out_size)
@@ -549,6 +682,8 @@ OCKAM_ERR ockam_vault_tpm_hkdf(uint8_t *p_salt, uint32_t salt_size,
             break;
         }
 
+        g_atecc508a_hkdf_owner = 0;                             /* Slot is overwritten, any kept PRK must reload      */
+
         ret_val = atecc508a_hkdf_write_key(p_salt,              /* Salt must be written to the key slot before the    */
                                            salt_size,           /* HMAC operation can be performed.                   */
                                            ATECC508A_HKDF_SLOT,
@@ -583,6 +718,167 @@ OCKAM_ERR ockam_vault_tpm_hkdf(uint8_t *p_salt, uint32_t salt_size,
 }
 
 
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_hkdf_extract()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_hkdf_extract(void *p_ctx,
+                                       void **p_prk,
+                                       uint8_t *p_salt, uint32_t salt_size,
+                                       uint8_t *p_ikm, uint32_t ikm_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC508A_HKDF_PRK_s *p_hkdf_prk = 0;
+
+
+    do {
+        if((p_prk == 0) || (salt_size > ATECC508A_HKDF_SLOT_SIZE)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_hkdf_prk, sizeof(ATECC508A_HKDF_PRK_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        g_atecc508a_hkdf_owner = 0;                             /* Salt overwrites the slot                           */
+
+        ret_val = atecc508a_hkdf_write_key(p_salt,              /* Salt must be in the key slot for the HMAC          */
+                                           salt_size,
+                                           ATECC508A_HKDF_SLOT,
+                                           ATECC508A_HKDF_SLOT_SIZE);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = atecc508a_hkdf_extract(p_ikm,             /* PRK is kept by the handle                          */
+                                             ikm_size,
+                                             &(p_hkdf_prk->prk[0]),
+                                             ATECC508A_HMAC_HASH_SIZE,
+                                             ATECC508A_HKDF_SLOT);
+        }
+
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = atecc508a_hkdf_prk_key(p_hkdf_prk);       /* Left loaded for the first expand                   */
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_tpm_hkdf_prk_free(p_hkdf_prk);
+            break;
+        }
+
+        *p_prk = p_hkdf_prk;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_tpm_hkdf_expand()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_hkdf_expand(void *p_prk,
+                                      uint8_t *p_info, uint32_t info_size,
+                                      uint8_t *p_out, uint32_t out_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC508A_HKDF_PRK_s *p_hkdf_prk = (ATECC508A_HKDF_PRK_s*) p_prk;
+
+
+    do {
+        if((p_hkdf_prk == 0) || (p_out == 0) || (out_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = atecc508a_hkdf_prk_key(p_hkdf_prk);           /* Only rewritten if the slot was used since          */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = atecc508a_hkdf_expand(ATECC508A_HKDF_SLOT,    /* Expand stage of HKDF from the kept PRK             */
+                                        p_info, info_size,
+                                        p_out, out_size);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_hkdf_prk_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_hkdf_prk_free(void *p_prk)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC508A_HKDF_PRK_s *p_hkdf_prk = (ATECC508A_HKDF_PRK_s*) p_prk;
+
+
+    do {
+        if(p_hkdf_prk == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(g_atecc508a_hkdf_owner == p_hkdf_prk) {              /* A later key may be allocated at the same address   */
+            g_atecc508a_hkdf_owner = 0;
+        }
+
+                                                                /* Clear the key copy before releasing it             */
+        ockam_mem_set(p_hkdf_prk, 0, sizeof(ATECC508A_HKDF_PRK_s));
+        ret_val = ockam_mem_free(p_hkdf_prk);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      atecc508a_hkdf_prk_key()
+ *
+ * @brief   Make sure the HKDF slot holds a kept pseudo-random key. The slot is shared by every HKDF
+ *          operation, so the key is only rewritten when something else used it since.
+ *
+ * @param   p_hkdf_prk[in]  The kept pseudo-random key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc508a_hkdf_prk_key(ATECC508A_HKDF_PRK_s *p_hkdf_prk)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(g_atecc508a_hkdf_owner == p_hkdf_prk) {
+            break;
+        }
+
+        ret_val = atecc508a_hkdf_write_key(&(p_hkdf_prk->prk[0]),
+                                           ATECC508A_HMAC_HASH_SIZE,
+                                           ATECC508A_HKDF_SLOT,
+                                           ATECC508A_HKDF_SLOT_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            g_atecc508a_hkdf_owner = 0;
+            break;
+        }
+
+        g_atecc508a_hkdf_owner = p_hkdf_prk;
+    } while(0);
+
+    return ret_val;
+}
+
+
 /*
  ********************************************************************************************************
  *                                    atecc508a_hkdf_write_key()
@@ -856,3 +1152,43 @@ OCKAM_ERR atecc508a_hkdf_expand(uint8_t key_slot,
 #endif                                                          /* OCKAM_VAULT_CFG_AES_GCM                            */
 
 
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                        Backend Function Table
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN && (OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_TPM_MICROCHIP_ATECC508A))
+
+const OCKAM_VAULT_BACKEND_s ockam_vault_tpm_backend = {
+    .random                     = ockam_vault_tpm_random,
+    .key_gen                    = ockam_vault_tpm_key_gen,
+    .key_get_pub                = ockam_vault_tpm_key_get_pub,
+    .key_write                  = 0,
+    .ecdh                       = ockam_vault_tpm_ecdh,
+    .sha256                     = ockam_vault_tpm_sha256,
+    .sha256_ctx_init            = 0,
+    .sha256_ctx_update          = 0,
+    .sha256_ctx_finish          = 0,
+    .sha256_ctx_free            = 0,
+    .hkdf                       = ockam_vault_tpm_hkdf,
+    .hkdf_extract               = ockam_vault_tpm_hkdf_extract,
+    .hkdf_expand                = ockam_vault_tpm_hkdf_expand,
+    .hkdf_prk_free              = ockam_vault_tpm_hkdf_prk_free,
+    .aes_gcm                    = 0,
+    .aes_gcm_batch              = 0,
+    .aes_gcm_iov                = 0,
+    .aes_gcm_ctx_init           = 0,
+    .aes_gcm_ctx_aad_update     = 0,
+    .aes_gcm_ctx_update         = 0,
+    .aes_gcm_ctx_finish         = 0,
+    .aes_gcm_ctx_free           = 0,
+    .secret_import              = 0,
+    .secret_aes_gcm             = 0,
+    .secret_free                = 0,
+    .ecdh_derive                = 0
+};
+
+#endif                                                          /* OCKAM_VAULT_CFG_DISPATCH_EN                        */
@@ -18,6 +18,7 @@
 #include <ockam/memory.h>
 #include <ockam/vault.h>
 #include <ockam/vault/tpm.h>
+#include <ockam/vault/backend.h>
 #include <ockam/vault/tpm/microchip.h>
 
 #include <cryptoauthlib/lib/cryptoauthlib.h>
@@ -80,6 +81,9 @@
 #define ATECC608A_CFG_LOCK_CONFIG_UNLOCKED     0x55             /* Config zone is in an unlocked/configurable state   */
 #define ATECC608A_CFG_LOCK_CONFIG_LOCKED       0x00             /* Config zone is in a locked/unconfigurable state    */
 
+#define ATECC608A_SHA256_BLOCK_SIZE             64u             /* SHA update commands take exactly one block         */
+#define ATECC608A_SHA256_CONTEXT_SIZE          130u             /* Largest SHA engine state the device can save       */
+
 #define ATECC608A_HKDF_SLOT                      9u             /* Use slot 9 for the HKDF key                        */
 #define ATECC608A_HKDF_SLOT_SIZE                72u             /* Slot 9 is 72 bytes                                 */
 #define ATECC608A_HKDF_UPDATE_SIZE              64u             /* HMAC updates MUST be 64 bytes                      */
@@ -89,6 +93,7 @@
 #define ATECC608A_AES_GCM_KEY_SIZE             128u             /* ATECC608A only supports AES GCM 128                */
 #define ATECC608A_AES_GCM_KEY_BLOCK              0u             /* AES Key starts at block 0 in slot 15               */
 #define ATECC608A_AES_GCM_KEY_SLOT_SIZE         72u             /* Size of slot 15 for AES key                        */
+#define ATECC608A_AES_GCM_INPLACE_SIZE          64u             /* Bounce buffer size for in place AES GCM            */
 
 #define ATECC608A_IO_KEY_SIZE                   32u             /* IO Protection Key Size                             */
 #define ATECC608A_IO_KEY_SLOT                    6u             /* IO Protection Key Slot                             */
@@ -143,6 +148,63 @@ typedef struct {                                                /*!< Byte(s): De
 #pragma pack()
 
 
+/**
+ *******************************************************************************
+ * @struct  ATECC608A_HKDF_PRK_s
+ * @brief   Pseudo-random key kept from an HKDF extract
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint8_t prk[ATECC608A_HMAC_HASH_SIZE];                      /*!< Copy to reload into the HKDF slot                */
+} ATECC608A_HKDF_PRK_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  ATECC608A_SHA256_CTX_s
+ * @brief   State for a streaming SHA-256 digest
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint8_t context[ATECC608A_SHA256_CONTEXT_SIZE];             /*!< SHA engine state saved after the last update     */
+    uint16_t context_size;                                      /*!< Size of the saved state, 0 if not started        */
+    uint8_t block[ATECC608A_SHA256_BLOCK_SIZE];                 /*!< Message bytes not yet sent to the device         */
+    uint32_t block_size;                                        /*!< Number of bytes in the block buffer              */
+    bool is_done;                                               /*!< Digest has been output                           */
+} ATECC608A_SHA256_CTX_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  ATECC608A_AES_GCM_CTX_s
+ * @brief   State for a streaming AES GCM operation
+ *******************************************************************************
+ */
+
+typedef struct {
+    atca_aes_gcm_ctx_t gcm;                                     /*!< cryptoauthlib AES GCM context                    */
+    OCKAM_VAULT_AES_GCM_MODE_e mode;                            /*!< Encrypt or decrypt                               */
+    uint8_t key[ATECC608A_AES_GCM_KEY_SIZE / 8];                /*!< Copy of the key to reload into the AES GCM slot  */
+    bool is_data;                                               /*!< Data has been processed, no more AAD allowed     */
+    bool is_done;                                               /*!< Tag has been output or verified                  */
+} ATECC608A_AES_GCM_CTX_s;
+
+
+/**
+ *******************************************************************************
+ * @struct  ATECC608A_SECRET_s
+ * @brief   AES GCM key kept for use by handle
+ *******************************************************************************
+ */
+
+typedef struct {
+    atca_aes_gcm_ctx_t gcm;                                     /*!< cryptoauthlib AES GCM context reused per message */
+    uint8_t key[ATECC608A_AES_GCM_KEY_SIZE / 8];                /*!< Copy of the key to reload into the AES GCM slot  */
+} ATECC608A_SECRET_s;
+
+
 /*
  ********************************************************************************************************
  *                                            INLINE FUNCTIONS                                          *
@@ -157,6 +219,16 @@ typedef struct {                                                /*!< Byte(s): De
 
 static ATECC608A_CFG_DATA_s *g_atecc608a_cfg_data;
 
+static ATECC608A_HKDF_PRK_s *g_atecc608a_hkdf_owner = 0;        /* Key whose PRK is loaded in the HKDF slot           */
+
+                                                                /* Public keys read back from the key slots. Reading  */
+                                                                /* one recomputes it from the private key on the chip,*/
+                                                                /* so each is kept until its slot gets a new key.     */
+static uint8_t g_atecc608a_pub_key[MAX_OCKAM_VAULT_KEY][ATECC608A_PUB_KEY_SIZE];
+static uint8_t g_atecc608a_pub_key_valid[MAX_OCKAM_VAULT_KEY] = {0};
+
+static void *g_atecc608a_aes_gcm_owner = 0;                     /* Stream or secret whose key is in the AES GCM slot  */
+
 static uint8_t g_atecc608a_io_key[] = {                         /* IO Protection Key is used to encrypt data sent via */
     0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,             /* I2C to the ATECC608A. During init the key is       */
     0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,             /* written into the device. In a production system    */
@@ -188,6 +260,21 @@ OCKAM_ERR atecc608a_hkdf_expand(uint8_t key_slot,
                                 uint8_t *p_info, uint32_t info_size,
                                 uint8_t *p_output, uint32_t output_size);
 
+OCKAM_ERR atecc608a_aes_gcm_rec(atca_aes_gcm_ctx_t *p_gcm,
+                                OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                OCKAM_VAULT_AES_GCM_REC_s *p_rec);
+
+OCKAM_ERR atecc608a_aes_gcm_update(atca_aes_gcm_ctx_t *p_gcm,
+                                   OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                   uint8_t *p_input, uint32_t size,
+                                   uint8_t *p_output);
+
+OCKAM_ERR atecc608a_aes_gcm_key(void *p_owner, uint8_t *p_key);
+
+OCKAM_ERR atecc608a_sha256_resume(ATECC608A_SHA256_CTX_s *p_sha);
+
+OCKAM_ERR atecc608a_hkdf_prk_key(ATECC608A_HKDF_PRK_s *p_hkdf_prk);
+
 
 /*
  ********************************************************************************************************
@@ -205,7 +292,7 @@ OCKAM_ERR atecc608a_hkdf_expand(uint8_t key_slot,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
+OCKAM_ERR ockam_vault_tpm_init(void *p_arg, void **p_ctx)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -213,7 +300,7 @@ OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
 
 
     do {
-        if(p_arg == 0) {                                        /* Ensure the p_arg value is not null                 */
+        if((p_arg == 0) || (p_ctx == 0)) {                      /* Ensure the p_arg and p_ctx values are not null     */
             ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
@@ -260,6 +347,8 @@ OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
         if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
+
+        *p_ctx = g_atecc608a_cfg_data;                          /* The configuration data doubles as the TPM context  */
     } while(0);
 
     return ret_val;
@@ -272,9 +361,25 @@ OCKAM_ERR ockam_vault_tpm_init(void *p_arg)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_free (void)
+OCKAM_ERR ockam_vault_tpm_free (void *p_ctx)
 {
-   return OCKAM_ERR_NONE;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(p_ctx != g_atecc608a_cfg_data) {                     /* Only the context handed out by init can be freed   */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        atcab_release();                                        /* Release the interface before dropping the config   */
+        ockam_mem_set(g_atecc608a_pub_key_valid, 0, sizeof(g_atecc608a_pub_key_valid));
+
+        ret_val = ockam_mem_free(g_atecc608a_cfg_data);
+        g_atecc608a_cfg_data = 0;
+    } while(0);
+
+    return ret_val;
 }
 
 
@@ -390,7 +495,7 @@ OCKAM_ERR atecc608a_write_key(uint8_t *p_key, uint32_t key_size,
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_RAND == OCKAM_VAULT_TPM_MICROCHIP_ATECC608A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_RAND, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
 
 
 /*
@@ -399,7 +504,8 @@ OCKAM_ERR atecc608a_write_key(uint8_t *p_key, uint32_t key_size,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_random(uint8_t *p_rand_num, uint32_t rand_num_size)
+OCKAM_ERR ockam_vault_tpm_random(void *p_ctx,
+                                 uint8_t *p_rand_num, uint32_t rand_num_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -431,7 +537,7 @@ OCKAM_ERR ockam_vault_tpm_random(uint8_t *p_rand_num, uint32_t rand_num_size)
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_KEY_ECDH == OCKAM_VAULT_TPM_MICROCHIP_ATECC608A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
 
 
 /*
@@ -440,7 +546,8 @@ OCKAM_ERR ockam_vault_tpm_random(uint8_t *p_rand_num, uint32_t rand_num_size)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_key_gen(OCKAM_VAULT_KEY_e key_type)
+OCKAM_ERR ockam_vault_tpm_key_gen(void *p_ctx,
+                                  OCKAM_VAULT_KEY_e key_type)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -449,6 +556,10 @@ OCKAM_ERR ockam_vault_tpm_key_gen(OCKAM_VAULT_KEY_e key_type)
 
     do
     {
+        if(key_type < MAX_OCKAM_VAULT_KEY) {                    /* The slot is about to get a new key, so forget its  */
+            g_atecc608a_pub_key_valid[key_type] = 0;            /* public key even if the generation fails            */
+        }
+
         status = atcab_random(&rand[0]);                        /* Get a random number from the ATECC608A             */
         if(status != ATCA_SUCCESS) {                            /* before a genkey operation.                         */
             ret_val = OCKAM_ERR_VAULT_TPM_KEY_FAIL;
@@ -493,7 +604,8 @@ OCKAM_ERR ockam_vault_tpm_key_gen(OCKAM_VAULT_KEY_e key_type)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_tpm_key_get_pub(void *p_ctx,
+                                      OCKAM_VAULT_KEY_e key_type,
                                       uint8_t *p_pub_key, uint32_t pub_key_size)
 {
     ATCA_STATUS status = ATCA_SUCCESS;
@@ -512,6 +624,12 @@ OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
             break;
         }
 
+                                                                /* Serve repeat requests without touching the chip    */
+        if((key_type < MAX_OCKAM_VAULT_KEY) && (g_atecc608a_pub_key_valid[key_type])) {
+            ockam_mem_copy(p_pub_key, g_atecc608a_pub_key[key_type], ATECC608A_PUB_KEY_SIZE);
+            break;
+        }
+
         switch(key_type) {
             case OCKAM_VAULT_KEY_STATIC:                        /* Get the static public key                          */
                 status = atcab_get_pubkey(ATECC608A_KEY_SLOT_STATIC,
@@ -535,6 +653,11 @@ OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
                 ret_val = OCKAM_ERR_INVALID_PARAM;
                 break;
         }
+
+        if(ret_val == OCKAM_ERR_NONE) {
+            ockam_mem_copy(g_atecc608a_pub_key[key_type], p_pub_key, ATECC608A_PUB_KEY_SIZE);
+            g_atecc608a_pub_key_valid[key_type] = 1;
+        }
     } while (0);
 
     return ret_val;
@@ -547,7 +670,8 @@ OCKAM_ERR ockam_vault_tpm_key_get_pub(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_ecdh(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_tpm_ecdh(void *p_ctx,
+                               OCKAM_VAULT_KEY_e key_type,
                                uint8_t *p_pub_key, uint32_t pub_key_size,
                                uint8_t *p_pms, uint32_t pms_size)
 {
@@ -627,7 +751,7 @@ OCKAM_ERR ockam_vault_tpm_ecdh(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_SHA256 == OCKAM_VAULT_TPM_MICROCHIP_ATECC608A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_SHA256, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
 
 
 /**
@@ -636,7 +760,8 @@ OCKAM_ERR ockam_vault_tpm_ecdh(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
+OCKAM_ERR ockam_vault_tpm_sha256(void *p_ctx,
+                                 uint8_t *p_msg, uint32_t msg_size,
                                  uint8_t *p_digest, uint8_t digest_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
@@ -644,9 +769,240 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
 
 
     do {
-        status = atcab_sha(msg_size,                            /* Run the SHA256 command in the ATECC608A. The ATCAB */
-                           p_msg,                               /* library handles sending data in 32 byte chunks.    */
-                           p_digest);
+        if((p_msg == 0) && (msg_size != 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        status = atcab_sha_start();                             /* Run the SHA256 command in the ATECC608A one block  */
+        while((status == ATCA_SUCCESS) &&                       /* at a time so the message length is not limited to  */
+              (msg_size >= ATECC608A_SHA256_BLOCK_SIZE)) {      /* the 16-bit length atcab_sha() takes.               */
+            status = atcab_sha_update(p_msg);
+            p_msg += ATECC608A_SHA256_BLOCK_SIZE;
+            msg_size -= ATECC608A_SHA256_BLOCK_SIZE;
+        }
+
+        if(status == ATCA_SUCCESS) {                            /* The final partial block is sent with the end       */
+            status = atcab_sha_end(p_digest,                    /* command                                            */
+                                   (uint16_t) msg_size,
+                                   p_msg);
+        }
+
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_sha256_ctx_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_init(void *p_ctx,
+                                          void **p_sha_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_SHA256_CTX_s *p_sha = 0;
+
+
+    do {
+        if(p_sha_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_sha, sizeof(ATECC608A_SHA256_CTX_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+                                                                /* The SHA engine is not started until there is a     */
+                                                                /* full block to send                                 */
+        ockam_mem_set(p_sha, 0, sizeof(ATECC608A_SHA256_CTX_s));
+        *p_sha_ctx = p_sha;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_tpm_sha256_ctx_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_update(void *p_sha_ctx,
+                                            uint8_t *p_msg, uint32_t msg_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    ATECC608A_SHA256_CTX_s *p_sha = (ATECC608A_SHA256_CTX_s*) p_sha_ctx;
+    uint32_t size = 0;
+    uint32_t offset = 0;
+
+
+    do {
+        if((p_sha == 0) || ((p_msg == 0) && (msg_size != 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_sha->is_done) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        if((p_sha->block_size + msg_size) < ATECC608A_SHA256_BLOCK_SIZE) {
+            ockam_mem_copy(&(p_sha->block[p_sha->block_size]),  /* Not enough for a full block yet, keep it on the    */
+                           p_msg,                               /* host without touching the device                   */
+                           msg_size);
+            p_sha->block_size += msg_size;
+            break;
+        }
+
+        ret_val = atecc608a_sha256_resume(p_sha);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_sha->block_size > 0) {                             /* Complete the block left over from the last update  */
+            size = ATECC608A_SHA256_BLOCK_SIZE - p_sha->block_size;
+            ockam_mem_copy(&(p_sha->block[p_sha->block_size]), p_msg, size);
+            status = atcab_sha_update(&(p_sha->block[0]));
+            offset = size;
+        }
+
+        while((status == ATCA_SUCCESS) &&                       /* Send every full block directly from the message    */
+              ((msg_size - offset) >= ATECC608A_SHA256_BLOCK_SIZE)) {
+            status = atcab_sha_update(p_msg + offset);
+            offset += ATECC608A_SHA256_BLOCK_SIZE;
+        }
+
+        if(status == ATCA_SUCCESS) {                            /* Save the engine state. Other commands may run on   */
+            p_sha->context_size = sizeof(p_sha->context);       /* the device before the next update.                 */
+            status = atcab_sha_read_context(&(p_sha->context[0]), &(p_sha->context_size));
+        }
+
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
+            break;
+        }
+
+        p_sha->block_size = msg_size - offset;                  /* Keep the remainder for the next update             */
+        ockam_mem_copy(&(p_sha->block[0]), p_msg + offset, p_sha->block_size);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_tpm_sha256_ctx_finish()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_finish(void *p_sha_ctx,
+                                            uint8_t *p_digest, uint8_t digest_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    ATECC608A_SHA256_CTX_s *p_sha = (ATECC608A_SHA256_CTX_s*) p_sha_ctx;
+
+
+    do {
+        if((p_sha == 0) || (p_digest == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_sha->is_done) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        ret_val = atecc608a_sha256_resume(p_sha);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_sha->is_done = true;
+
+        status = atcab_sha_end(p_digest,                        /* Send the partial block and output the digest       */
+                               (uint16_t) p_sha->block_size,
+                               &(p_sha->block[0]));
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_sha256_ctx_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_free(void *p_sha_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_SHA256_CTX_s *p_sha = (ATECC608A_SHA256_CTX_s*) p_sha_ctx;
+
+
+    do {
+        if(p_sha == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+                                                                /* Clear any message data before releasing it         */
+        ockam_mem_set(p_sha, 0, sizeof(ATECC608A_SHA256_CTX_s));
+        ret_val = ockam_mem_free(p_sha);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      atecc608a_sha256_resume()
+ *
+ * @brief   Get the SHA engine of the ATECC608A ready for the next block of a streaming digest. The
+ *          engine is started for the first block, otherwise the state saved by the last update is
+ *          written back since other commands may have used the engine in the meantime.
+ *
+ * @param   p_sha[in]       The streaming context
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_sha256_resume(ATECC608A_SHA256_CTX_s *p_sha)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+
+
+    do {
+        if(p_sha->context_size == 0) {
+            status = atcab_sha_start();
+        } else {
+            status = atcab_sha_write_context(&(p_sha->context[0]), p_sha->context_size);
+        }
+
         if(status != ATCA_SUCCESS) {
             ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
             break;
@@ -667,7 +1023,7 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_HKDF == OCKAM_VAULT_TPM_MICROCHIP_ATECC608A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_HKDF, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
 
 /**
  ********************************************************************************************************
@@ -675,7 +1031,8 @@ OCKAM_ERR ockam_vault_tpm_sha256(uint8_t *p_msg, uint16_t msg_size,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_hkdf(uint8_t *p_salt, uint32_t salt_size,
+OCKAM_ERR ockam_vault_tpm_hkdf(void *p_ctx,
+                               uint8_t *p_salt, uint32_t salt_size,
                                uint8_t *p_ikm, uint32_t ikm_size,
                                uint8_t *p_info, uint32_t info_size,
                                uint8_t *p_out, uint32_t out_size)
@@ -691,6 +1048,8 @@ OCKAM_ERR ockam_vault_tpm_hkdf(uint8_t *p_salt, uint32_t salt_size,
             break;
         }
 
+        g_atecc608a_hkdf_owner = 0;                             /* Slot is overwritten, any kept PRK must reload      */
+
         ret_val = atecc608a_write_key(p_salt,                   /* Salt must be written to the key slot before the    */
                                       salt_size,                /* HMAC operation can be performed.                   */
                                       ATECC608A_HKDF_SLOT,
@@ -725,75 +1084,236 @@ OCKAM_ERR ockam_vault_tpm_hkdf(uint8_t *p_salt, uint32_t salt_size,
 }
 
 
-
-/*
+/**
  ********************************************************************************************************
- *                                      atecc608a_hkdf_extract()
+ *                                    ockam_vault_tpm_hkdf_extract()
  ********************************************************************************************************
  */
 
-OCKAM_ERR atecc608a_hkdf_extract(uint8_t *p_input, uint32_t input_size,
-                                 uint8_t *p_prk, uint32_t prk_size,
-                                 uint8_t key_slot)
+OCKAM_ERR ockam_vault_tpm_hkdf_extract(void *p_ctx,
+                                       void **p_prk,
+                                       uint8_t *p_salt, uint32_t salt_size,
+                                       uint8_t *p_ikm, uint32_t ikm_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    ATCA_STATUS status = ATCA_SUCCESS;
+    ATECC608A_HKDF_PRK_s *p_hkdf_prk = 0;
 
 
     do {
-        if(p_input == 0) {                                      /* Ensure input buffer is valid                       */
+        if((p_prk == 0) || (salt_size > ATECC608A_HMAC_HASH_SIZE)) {
             ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        if(prk_size != ATECC608A_HMAC_HASH_SIZE) {              /* PRK buffer must be length of the hash output       */
-            ret_val = OCKAM_ERR_VAULT_SIZE_MISMATCH;
+        ret_val = ockam_mem_alloc((void**) &p_hkdf_prk, sizeof(ATECC608A_HKDF_PRK_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
         }
 
-        status = atcab_sha_hmac(p_input,                        /* Run HMAC on the input data using the salt located  */
-                                input_size,                     /* in the HKDF key slot. Digest is returned to the    */
-                                key_slot,                       /* output buffer AND placed in TEMPKEY.               */
-                                p_prk,
-                                SHA_MODE_TARGET_TEMPKEY);
-        if(status != ATCA_SUCCESS)
-        {
-            ret_val = OCKAM_ERR_VAULT_TPM_HKDF_FAIL;
+        g_atecc608a_hkdf_owner = 0;                             /* Salt overwrites the slot                           */
+
+        ret_val = atecc608a_write_key(p_salt,                   /* Salt must be in the key slot for the HMAC          */
+                                      salt_size,
+                                      ATECC608A_HKDF_SLOT,
+                                      ATECC608A_HKDF_SLOT_SIZE);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = atecc608a_hkdf_extract(p_ikm,             /* PRK is kept by the handle                          */
+                                             ikm_size,
+                                             &(p_hkdf_prk->prk[0]),
+                                             ATECC608A_HMAC_HASH_SIZE,
+                                             ATECC608A_HKDF_SLOT);
+        }
+
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = atecc608a_hkdf_prk_key(p_hkdf_prk);       /* Left loaded for the first expand                   */
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_tpm_hkdf_prk_free(p_hkdf_prk);
             break;
         }
-    } while (0);
+
+        *p_prk = p_hkdf_prk;
+    } while(0);
 
     return ret_val;
 }
 
 
-/*
+/**
  ********************************************************************************************************
- *                                      atecc608a_hkdf_expand()
+ *                                     ockam_vault_tpm_hkdf_expand()
  ********************************************************************************************************
  */
 
-OCKAM_ERR atecc608a_hkdf_expand(uint8_t key_slot,
-                                uint8_t *p_info, uint32_t info_size,
-                                uint8_t *p_output, uint32_t output_size)
+OCKAM_ERR ockam_vault_tpm_hkdf_expand(void *p_prk,
+                                      uint8_t *p_info, uint32_t info_size,
+                                      uint8_t *p_out, uint32_t out_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    ATCA_STATUS status = ATCA_SUCCESS;
-    uint8_t i = 0;
-    uint8_t iterations = 0;
-    uint32_t bytes_written = 0;
-    uint32_t bytes_to_copy = 0;
-    uint32_t digest_len = 0;
-    atca_hmac_sha256_ctx_t *p_ctx = 0;
-    uint8_t digest[ATECC608A_HMAC_HASH_SIZE] = {0};
+    ATECC608A_HKDF_PRK_s *p_hkdf_prk = (ATECC608A_HKDF_PRK_s*) p_prk;
 
 
     do {
-        if(p_output == 0) {                                     /* Must have a valid output buffer, info is optional  */
+        if((p_hkdf_prk == 0) || (p_out == 0) || (out_size == 0)) {
             ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        if((p_info == 0) && (info_size > 0)) {                  /* Info size must be 0 if info pointer is null        */
+        ret_val = atecc608a_hkdf_prk_key(p_hkdf_prk);           /* Only rewritten if the slot was used since          */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = atecc608a_hkdf_expand(ATECC608A_HKDF_SLOT,    /* Expand stage of HKDF from the kept PRK             */
+                                        p_info, info_size,
+                                        p_out, out_size);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_hkdf_prk_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_hkdf_prk_free(void *p_prk)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_HKDF_PRK_s *p_hkdf_prk = (ATECC608A_HKDF_PRK_s*) p_prk;
+
+
+    do {
+        if(p_hkdf_prk == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(g_atecc608a_hkdf_owner == p_hkdf_prk) {              /* A later key may be allocated at the same address   */
+            g_atecc608a_hkdf_owner = 0;
+        }
+
+                                                                /* Clear the key copy before releasing it             */
+        ockam_mem_set(p_hkdf_prk, 0, sizeof(ATECC608A_HKDF_PRK_s));
+        ret_val = ockam_mem_free(p_hkdf_prk);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      atecc608a_hkdf_prk_key()
+ *
+ * @brief   Make sure the HKDF slot holds a kept pseudo-random key. The slot is shared by every HKDF
+ *          operation, so the key is only rewritten when something else used it since.
+ *
+ * @param   p_hkdf_prk[in]  The kept pseudo-random key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_hkdf_prk_key(ATECC608A_HKDF_PRK_s *p_hkdf_prk)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(g_atecc608a_hkdf_owner == p_hkdf_prk) {
+            break;
+        }
+
+        ret_val = atecc608a_write_key(&(p_hkdf_prk->prk[0]),
+                                      ATECC608A_HMAC_HASH_SIZE,
+                                      ATECC608A_HKDF_SLOT,
+                                      ATECC608A_HKDF_SLOT_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            g_atecc608a_hkdf_owner = 0;
+            break;
+        }
+
+        g_atecc608a_hkdf_owner = p_hkdf_prk;
+    } while(0);
+
+    return ret_val;
+}
+
+
+
+/*
+ ********************************************************************************************************
+ *                                      atecc608a_hkdf_extract()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_hkdf_extract(uint8_t *p_input, uint32_t input_size,
+                                 uint8_t *p_prk, uint32_t prk_size,
+                                 uint8_t key_slot)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+
+
+    do {
+        if(p_input == 0) {                                      /* Ensure input buffer is valid                       */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(prk_size != ATECC608A_HMAC_HASH_SIZE) {              /* PRK buffer must be length of the hash output       */
+            ret_val = OCKAM_ERR_VAULT_SIZE_MISMATCH;
+        }
+
+        status = atcab_sha_hmac(p_input,                        /* Run HMAC on the input data using the salt located  */
+                                input_size,                     /* in the HKDF key slot. Digest is returned to the    */
+                                key_slot,                       /* output buffer AND placed in TEMPKEY.               */
+                                p_prk,
+                                SHA_MODE_TARGET_TEMPKEY);
+        if(status != ATCA_SUCCESS)
+        {
+            ret_val = OCKAM_ERR_VAULT_TPM_HKDF_FAIL;
+            break;
+        }
+    } while (0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                      atecc608a_hkdf_expand()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_hkdf_expand(uint8_t key_slot,
+                                uint8_t *p_info, uint32_t info_size,
+                                uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    uint8_t i = 0;
+    uint8_t iterations = 0;
+    uint32_t bytes_written = 0;
+    uint32_t bytes_to_copy = 0;
+    uint32_t digest_len = 0;
+    atca_hmac_sha256_ctx_t *p_ctx = 0;
+    uint8_t digest[ATECC608A_HMAC_HASH_SIZE] = {0};
+
+
+    do {
+        if(p_output == 0) {                                     /* Must have a valid output buffer, info is optional  */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((p_info == 0) && (info_size > 0)) {                  /* Info size must be 0 if info pointer is null        */
             ret_val = OCKAM_ERR_INVALID_SIZE;
         }
 
@@ -893,7 +1413,7 @@ OCKAM_ERR atecc608a_hkdf_expand(uint8_t key_slot,
  ********************************************************************************************************
  */
 
-#if(OCKAM_VAULT_CFG_AES_GCM == OCKAM_VAULT_TPM_MICROCHIP_ATECC608A)
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_AES_GCM, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
 
 
 /*
@@ -902,42 +1422,152 @@ OCKAM_ERR atecc608a_hkdf_expand(uint8_t key_slot,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_tpm_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
+OCKAM_ERR ockam_vault_tpm_aes_gcm(void *p_ctx,
+                                  OCKAM_VAULT_AES_GCM_MODE_e mode,
                                   uint8_t *p_key, uint32_t key_size,
                                   uint8_t *p_iv, uint32_t iv_size,
                                   uint8_t *p_aad, uint32_t aad_size,
                                   uint8_t *p_tag, uint32_t tag_size,
                                   uint8_t *p_input, uint32_t input_size,
                                   uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_VAULT_AES_GCM_REC_s rec;
+
+
+    rec.p_iv = p_iv;                                            /* A single operation is a batch of one record        */
+    rec.iv_size = iv_size;
+    rec.p_aad = p_aad;
+    rec.aad_size = aad_size;
+    rec.p_tag = p_tag;
+    rec.tag_size = tag_size;
+    rec.p_input = p_input;
+    rec.input_size = input_size;
+    rec.p_output = p_output;
+    rec.output_size = output_size;
+
+    return ockam_vault_tpm_aes_gcm_batch(p_ctx, mode, p_key, key_size, &rec, 1);
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_aes_gcm_batch()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_batch(void *p_ctx,
+                                        OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                        uint8_t *p_key, uint32_t key_size,
+                                        OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
     OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
-    ATCA_STATUS status = ATCA_SUCCESS;
-    atca_aes_gcm_ctx_t *p_ctx = 0;
-    bool is_verified = false;
+    atca_aes_gcm_ctx_t *p_gcm = 0;
     uint32_t key_bit_size = 0;
+    uint32_t i = 0;
 
 
     do {
-        if((p_key == 0) || (key_size == 0) ||                   /* Key and IV are required for AES GCM. There must be */
-           (p_iv == 0) || (iv_size == 0) ||                     /* valid buffers and sizes greater than zero. Tag is  */
-           (p_tag == 0) || (tag_size == 0)) {                   /* also always required to be present for encrypt and */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* decrypt.                                           */
+        if((p_key == 0) || (key_size == 0) ||                   /* Key is required for AES GCM and there must be at   */
+           (p_recs == 0) || (rec_count == 0)) {                 /* least one record to process.                       */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        if((p_aad == 0) != (aad_size == 0)) {                   /* Valid for both the AAD buffer and size to be zero  */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* or non-zero. Can't have a mismatch.                */
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Unknown operation, return an error                 */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
-        if((p_input == 0) != (input_size == 0)) {               /* Input buffer and size must both either be zero or  */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* non-zero. Can't have a mismatch.                   */
+        key_bit_size = key_size * 8;                            /* Key size is specified in bits. Ensure the key      */
+        if(key_bit_size != ATECC608A_AES_GCM_KEY_SIZE) {        /* size is set to 128 for the ATECC608A.              */
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;
             break;
         }
 
-        if((p_output == 0) != (output_size == 0)) {             /* Output buffer and size must both either be zero o  */
-            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* non-zero. Can't have a mismatch.                   */
+        ret_val = atecc608a_write_key(p_key,                    /* Write the AES key to the AES GCM slot once. The    */
+                                      key_size,                 /* encrypted write is the most expensive part of an   */
+                                      ATECC608A_AES_GCM_KEY,    /* AES GCM operation on the ATECC608A.                */
+                                      ATECC608A_AES_GCM_KEY_SLOT_SIZE);
+        g_atecc608a_aes_gcm_owner = 0;                          /* Any open stream or secret must reload its key      */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**)&p_gcm,               /* Allocate an AES GCM context struct shared by every */
+                                  sizeof(atca_aes_gcm_ctx_t));  /* record in the batch.                               */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < rec_count; i++) {
+            ret_val = atecc608a_aes_gcm_rec(p_gcm, mode, &p_recs[i]);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        t_ret_val = ockam_mem_free(p_gcm);                      /* Free the AES GCM context data. If ret_val does not */
+        if(ret_val == OCKAM_ERR_NONE) {                         /* contain an error, save the free return code,       */
+            ret_val = t_ret_val;                                /* otherwise don't overwrite the existing error       */
+        }
+
+    } while(0);
+
+    return ret_val;
+}
+
+
+/*
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_aes_gcm_iov()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_iov(void *p_ctx,
+                                      OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                      uint8_t *p_key, uint32_t key_size,
+                                      uint8_t *p_iv, uint32_t iv_size,
+                                      OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                      uint8_t *p_tag, uint32_t tag_size,
+                                      OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                      OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    atca_aes_gcm_ctx_t *p_gcm = 0;
+    bool is_verified = false;
+    uint32_t key_bit_size = 0;
+    uint32_t input_size = 0;
+    uint32_t output_size = 0;
+    uint32_t in_idx = 0;
+    uint32_t in_off = 0;
+    uint32_t out_idx = 0;
+    uint32_t out_off = 0;
+    uint32_t size = 0;
+    uint32_t i = 0;
+
+
+    do {
+        if((p_key == 0) || (key_size == 0) ||                   /* Key, IV and tag are required for AES GCM. There    */
+           (p_iv == 0) || (iv_size == 0) ||                     /* must be valid buffers and sizes greater than zero. */
+           (p_tag == 0) || (tag_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(((p_aad == 0) != (aad_count == 0)) ||                /* Fragment arrays and counts must both either be     */
+           ((p_input == 0) != (input_count == 0)) ||            /* zero or non-zero. Can't have a mismatch.           */
+           ((p_output == 0) != (output_count == 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Unknown operation, return an error                 */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
             break;
         }
 
@@ -947,13 +1577,16 @@ OCKAM_ERR ockam_vault_tpm_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
             break;
         }
 
-        if((p_input == p_output) && (p_input != 0)) {           /* The input buffer can not be used for the result    */
-            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER;
-            break;
+        for(i = 0; i < input_count; i++) {                      /* Total the input and output sizes, they must match  */
+            input_size += p_input[i].size;
         }
 
-        if(input_size != output_size) {                         /* Input buffer size must match the output buffer     */
-            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;      /* size, otherwise encrypt/decyrpt fails              */
+        for(i = 0; i < output_count; i++) {
+            output_size += p_output[i].size;
+        }
+
+        if(input_size != output_size) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;
             break;
         }
 
@@ -961,18 +1594,19 @@ OCKAM_ERR ockam_vault_tpm_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
                                       key_size,
                                       ATECC608A_AES_GCM_KEY,
                                       ATECC608A_AES_GCM_KEY_SLOT_SIZE);
+        g_atecc608a_aes_gcm_owner = 0;                          /* Any open stream or secret must reload its key      */
         if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        ret_val = ockam_mem_alloc((void**)&p_ctx,               /* Allocate an AES GCM context struct for either      */
+        ret_val = ockam_mem_alloc((void**)&p_gcm,               /* Allocate an AES GCM context struct for either      */
                                   sizeof(atca_aes_gcm_ctx_t));  /* encryption or decryption.                          */
         if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
         do {
-            status = atcab_aes_gcm_init(p_ctx,                  /* Initialize AES GCM context using the key loaded    */
+            status = atcab_aes_gcm_init(p_gcm,                  /* Initialize AES GCM context using the key loaded    */
                                         ATECC608A_AES_GCM_KEY,  /* into TEMPKEY and the supplied IV                   */
                                         ATECC608A_AES_GCM_KEY_BLOCK,
                                         p_iv,
@@ -982,61 +1616,78 @@ OCKAM_ERR ockam_vault_tpm_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
                 break;
             }
 
-            status = atcab_aes_gcm_aad_update(p_ctx,            /*  Add additional data to GCM                        */
-                                              p_aad,
-                                              aad_size);
+            for(i = 0; i < aad_count; i++) {                    /* The AAD update keeps partial blocks between calls, */
+                status = atcab_aes_gcm_aad_update(p_gcm,        /* so each fragment can be added as is                */
+                                                  p_aad[i].p_buf,
+                                                  p_aad[i].size);
+                if(status != ATCA_SUCCESS) {
+                    break;
+                }
+            }
+
             if(status != ATCA_SUCCESS) {
                 ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
                 break;
             }
 
-            if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
-                status = atcab_aes_gcm_encrypt_update(p_ctx,    /* If mode is encrypt, resulting cipertext is placed  */
-                                                      p_input,  /* into p_output.                                     */
-                                                      input_size,
-                                                      p_output);
-                if(status != ATCA_SUCCESS) {
-                    ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
-                    break;
+            while(input_size > 0) {                             /* Walk the input and output together. Each update    */
+                while(in_off == p_input[in_idx].size) {         /* covers the run that is contiguous in both.         */
+                    in_idx++;
+                    in_off = 0;
                 }
 
-                status = atcab_aes_gcm_encrypt_finish(p_ctx,    /* After the cipertext has been generated, output the */
-                                                      p_tag,    /* resulting tag to p_tag and end AES GCM encryption  */
-                                                      tag_size);
-                if(status != ATCA_SUCCESS) {
-                    ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
-                    break;
+                while(out_off == p_output[out_idx].size) {
+                    out_idx++;
+                    out_off = 0;
                 }
-            } else if(mode == OCKAM_VAULT_AES_GCM_MODE_DECRYPT) {
-                status = atcab_aes_gcm_decrypt_update(p_ctx,    /* If mode is decrypt, resulting plaintext is placed  */
-                                                      p_input,  /* into p_output.                                     */
-                                                      input_size,
-                                                      p_output);
-                if(status != ATCA_SUCCESS) {
-                    ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+
+                size = p_input[in_idx].size - in_off;
+                if(size > (p_output[out_idx].size - out_off)) {
+                    size = p_output[out_idx].size - out_off;
+                }
+
+                ret_val = atecc608a_aes_gcm_update(p_gcm,
+                                                   mode,
+                                                   p_input[in_idx].p_buf + in_off,
+                                                   size,
+                                                   p_output[out_idx].p_buf + out_off);
+                if(ret_val != OCKAM_ERR_NONE) {
                     break;
                 }
 
-                status = atcab_aes_gcm_decrypt_finish(p_ctx,    /* After the plaintext has been generated, complete   */
-                                                      p_tag,    /* the GCM decrypt by verifying the auth tag          */
+                in_off += size;
+                out_off += size;
+                input_size -= size;
+            }
+
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+                status = atcab_aes_gcm_encrypt_finish(p_gcm,    /* Output the resulting tag to p_tag and end AES GCM  */
+                                                      p_tag,    /* encryption                                         */
+                                                      tag_size);
+            } else {
+                status = atcab_aes_gcm_decrypt_finish(p_gcm,    /* Complete the GCM decrypt by verifying the auth tag */
+                                                      p_tag,
                                                       tag_size,
                                                       &is_verified);
-                if(status != ATCA_SUCCESS) {
-                    ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
-                    break;
-                }
+            }
 
-                if(!is_verified) {                              /* If auth tag is invalid, return an error            */
-                    ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_DECRYPT_INVALID;
-                    break;
-                }
-            } else {                                            /* Unknown operation, return an error                 */
-                ret_val = OCKAM_ERR_INVALID_PARAM;
+            if(status != ATCA_SUCCESS) {
+                ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+                break;
+            }
+
+            if((mode == OCKAM_VAULT_AES_GCM_MODE_DECRYPT) &&    /* If auth tag is invalid, return an error            */
+               (!is_verified)) {
+                ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_DECRYPT_INVALID;
                 break;
             }
         } while(0);
 
-        t_ret_val = ockam_mem_free(p_ctx);                      /* Free the AES GCM context data. If ret_val does not */
+        t_ret_val = ockam_mem_free(p_gcm);                      /* Free the AES GCM context data. If ret_val does not */
         if(ret_val == OCKAM_ERR_NONE) {                         /* contain an error, save the free return code,       */
             ret_val = t_ret_val;                                /* otherwise don't overwrite the existing error       */
         }
@@ -1047,5 +1698,813 @@ OCKAM_ERR ockam_vault_tpm_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
 }
 
 
-#endif                                                          /* OCKAM_VAULT_CFG_AES_GCM                            */
+/**
+ ********************************************************************************************************
+ *                                      atecc608a_aes_gcm_update()
+ *
+ * @brief   Encrypt or decrypt data with an AES GCM context that has been initialized. cryptoauthlib
+ *          does not document in place operation, so when the output is the input the data is passed
+ *          through a small bounce buffer one chunk at a time. Peak memory stays bounded no matter
+ *          how large the message is.
+ *
+ * @param   p_gcm[in]       AES GCM context that has been initialized
+ *
+ * @param   mode[in]        AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_input[in]     Data to encrypt or decrypt
+ *
+ * @param   size[in]        Number of bytes to process
+ *
+ * @param   p_output[out]   Buffer for the result. Can be p_input.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_aes_gcm_update(atca_aes_gcm_ctx_t *p_gcm,
+                                   OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                   uint8_t *p_input, uint32_t size,
+                                   uint8_t *p_output)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    uint8_t chunk[ATECC608A_AES_GCM_INPLACE_SIZE];
+    uint8_t *p_dst = p_output;
+    uint32_t chunk_size = size;
+    uint32_t offset = 0;
+
+
+    while(offset < size) {
+        if(p_input == p_output) {                               /* In place, process one bounce buffer at a time and  */
+            p_dst = &chunk[0];                                  /* copy each result back over the input               */
+            chunk_size = size - offset;
+            if(chunk_size > ATECC608A_AES_GCM_INPLACE_SIZE) {
+                chunk_size = ATECC608A_AES_GCM_INPLACE_SIZE;
+            }
+        } else {
+            p_dst = p_output + offset;
+        }
+
+        if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {          /* The GCM updates carry partial blocks between calls */
+            status = atcab_aes_gcm_encrypt_update(p_gcm, p_input + offset, chunk_size, p_dst);
+        } else {
+            status = atcab_aes_gcm_decrypt_update(p_gcm, p_input + offset, chunk_size, p_dst);
+        }
+
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+            break;
+        }
+
+        if(p_dst == &chunk[0]) {
+            ockam_mem_copy(p_output + offset, &chunk[0], chunk_size);
+        }
+
+        offset += chunk_size;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       atecc608a_aes_gcm_rec()
+ *
+ * @brief   Encrypt or decrypt a single record using the key already loaded into the AES GCM slot
+ *
+ * @param   p_gcm[in]       AES GCM context to use for the record
+ *
+ * @param   mode[in]        AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_rec[in,out]   The record to process
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_aes_gcm_rec(atca_aes_gcm_ctx_t *p_gcm,
+                                OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                OCKAM_VAULT_AES_GCM_REC_s *p_rec)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    bool is_verified = false;
+
+
+    do {
+        if((p_rec->p_iv == 0) || (p_rec->iv_size == 0) ||       /* IV and tag are always required to be present for   */
+           (p_rec->p_tag == 0) || (p_rec->tag_size == 0)) {     /* encrypt and decrypt.                               */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((p_rec->p_aad == 0) != (p_rec->aad_size == 0)) {     /* Valid for both the AAD buffer and size to be zero  */
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* or non-zero. Can't have a mismatch.                */
+            break;
+        }
+
+        if((p_rec->p_input == 0) != (p_rec->input_size == 0)) { /* Input buffer and size must both either be zero or  */
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* non-zero. Can't have a mismatch.                   */
+            break;
+        }
+
+        if((p_rec->p_output == 0) != (p_rec->output_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;                  /* Output buffer and size must both either be zero or */
+            break;                                              /* non-zero. Can't have a mismatch.                   */
+        }
+
+        if((p_rec->p_input != p_rec->p_output) &&               /* The output can be the input buffer to work in      */
+           (p_rec->p_input != 0) && (p_rec->p_output != 0) &&   /* place, but it can not partially overlap it         */
+           (p_rec->p_output < (p_rec->p_input + p_rec->input_size)) &&
+           (p_rec->p_input < (p_rec->p_output + p_rec->output_size))) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER;
+            break;
+        }
+
+        if(p_rec->input_size != p_rec->output_size) {           /* Input buffer size must match the output buffer     */
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;      /* size, otherwise encrypt/decyrpt fails              */
+            break;
+        }
+
+        status = atcab_aes_gcm_init(p_gcm,                      /* Initialize AES GCM context using the key loaded    */
+                                    ATECC608A_AES_GCM_KEY,      /* into the AES GCM slot and the record IV            */
+                                    ATECC608A_AES_GCM_KEY_BLOCK,
+                                    p_rec->p_iv,
+                                    p_rec->iv_size);
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+            break;
+        }
+
+        status = atcab_aes_gcm_aad_update(p_gcm,                /*  Add additional data to GCM                        */
+                                          p_rec->p_aad,
+                                          p_rec->aad_size);
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+            break;
+        }
+
+        if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+            ret_val = atecc608a_aes_gcm_update(p_gcm,           /* Encrypt the record input into the record output    */
+                                               mode,
+                                               p_rec->p_input,
+                                               p_rec->input_size,
+                                               p_rec->p_output);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            status = atcab_aes_gcm_encrypt_finish(p_gcm,        /* After the cipertext has been generated, output the */
+                                                  p_rec->p_tag, /* resulting tag to p_tag and end AES GCM encryption  */
+                                                  p_rec->tag_size);
+            if(status != ATCA_SUCCESS) {
+                ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+                break;
+            }
+        } else {
+            ret_val = atecc608a_aes_gcm_update(p_gcm,           /* Decrypt the record input into the record output    */
+                                               mode,
+                                               p_rec->p_input,
+                                               p_rec->input_size,
+                                               p_rec->p_output);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            status = atcab_aes_gcm_decrypt_finish(p_gcm,        /* After the plaintext has been generated, complete   */
+                                                  p_rec->p_tag, /* the GCM decrypt by verifying the auth tag          */
+                                                  p_rec->tag_size,
+                                                  &is_verified);
+            if(status != ATCA_SUCCESS) {
+                ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+                break;
+            }
+
+            if(!is_verified) {                                  /* If auth tag is invalid, return an error            */
+                ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_DECRYPT_INVALID;
+                break;
+            }
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_aes_gcm_ctx_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_ctx_init(void *p_ctx,
+                                           void **p_gcm_ctx,
+                                           OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                           uint8_t *p_key, uint32_t key_size,
+                                           uint8_t *p_iv, uint32_t iv_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    ATECC608A_AES_GCM_CTX_s *p_stream = 0;
+
+
+    do {
+        if((p_gcm_ctx == 0) ||                                  /* Key and IV are required to start the operation     */
+           (p_key == 0) || (key_size == 0) ||
+           (p_iv == 0) || (iv_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Unknown operation, return an error                 */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((key_size * 8) != ATECC608A_AES_GCM_KEY_SIZE) {      /* Key size is specified in bits. Ensure the key      */
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;         /* size is set to 128 for the ATECC608A.              */
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_stream, sizeof(ATECC608A_AES_GCM_CTX_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_set(p_stream, 0, sizeof(ATECC608A_AES_GCM_CTX_s));
+        ockam_mem_copy(&(p_stream->key[0]), p_key, key_size);   /* Keep the key in case another operation replaces it */
+        p_stream->mode = mode;                                  /* in the AES GCM slot before this one finishes       */
+
+        ret_val = atecc608a_aes_gcm_key(p_stream, &(p_stream->key[0]));
+        if(ret_val == OCKAM_ERR_NONE) {
+            status = atcab_aes_gcm_init(&(p_stream->gcm),       /* Initialize AES GCM context using the key loaded    */
+                                        ATECC608A_AES_GCM_KEY,  /* into the AES GCM slot and the supplied IV          */
+                                        ATECC608A_AES_GCM_KEY_BLOCK,
+                                        p_iv,
+                                        iv_size);
+            if(status != ATCA_SUCCESS) {
+                ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+            }
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_vault_tpm_aes_gcm_ctx_free(p_stream);
+            break;
+        }
+
+        *p_gcm_ctx = p_stream;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_tpm_aes_gcm_ctx_aad_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_ctx_aad_update(void *p_gcm_ctx,
+                                                 uint8_t *p_aad, uint32_t aad_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    ATECC608A_AES_GCM_CTX_s *p_stream = (ATECC608A_AES_GCM_CTX_s*) p_gcm_ctx;
+
+
+    do {
+        if((p_stream == 0) || ((p_aad == 0) != (aad_size == 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_stream->is_data || p_stream->is_done) {            /* Additional data must all come before the data      */
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        if(aad_size == 0) {
+            break;
+        }
+
+        ret_val = atecc608a_aes_gcm_key(p_stream, &(p_stream->key[0]));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        status = atcab_aes_gcm_aad_update(&(p_stream->gcm),     /* The AAD update keeps partial blocks between calls  */
+                                          p_aad,
+                                          aad_size);
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_tpm_aes_gcm_ctx_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_ctx_update(void *p_gcm_ctx,
+                                             uint8_t *p_input, uint32_t input_size,
+                                             uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_AES_GCM_CTX_s *p_stream = (ATECC608A_AES_GCM_CTX_s*) p_gcm_ctx;
+
+
+    do {
+        if((p_stream == 0) ||                                   /* Input and output buffers and sizes must both either*/
+           ((p_input == 0) != (input_size == 0)) ||             /* be zero or non-zero. Can't have a mismatch.        */
+           ((p_output == 0) != (output_size == 0))) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((p_input != p_output) &&                             /* The output can be the input buffer to work in      */
+           (p_input != 0) && (p_output != 0) &&                 /* place, but it can not partially overlap it         */
+           (p_output < (p_input + input_size)) &&
+           (p_input < (p_output + output_size))) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER;
+            break;
+        }
+
+        if(input_size != output_size) {                         /* Input buffer size must match the output buffer     */
+            ret_val = OCKAM_ERR_VAULT_INVALID_BUFFER_SIZE;      /* size, otherwise encrypt/decyrpt fails              */
+            break;
+        }
+
+        if(p_stream->is_done) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        p_stream->is_data = true;
+        if(input_size == 0) {
+            break;
+        }
+
+        ret_val = atecc608a_aes_gcm_key(p_stream, &(p_stream->key[0]));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = atecc608a_aes_gcm_update(&(p_stream->gcm),    /* The GCM updates carry partial blocks between calls */
+                                           p_stream->mode,
+                                           p_input,
+                                           input_size,
+                                           p_output);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_tpm_aes_gcm_ctx_finish()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_ctx_finish(void *p_gcm_ctx,
+                                             uint8_t *p_tag, uint32_t tag_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    ATECC608A_AES_GCM_CTX_s *p_stream = (ATECC608A_AES_GCM_CTX_s*) p_gcm_ctx;
+    atca_aes_gcm_ctx_t *p_gcm = 0;
+    bool is_verified = false;
+
+
+    do {
+        if((p_stream == 0) ||                                   /* Tag is always required for encrypt and decrypt     */
+           (p_tag == 0) || (tag_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(p_stream->is_done) {
+            ret_val = OCKAM_ERR_VAULT_INVALID_STATE;
+            break;
+        }
+
+        ret_val = atecc608a_aes_gcm_key(p_stream, &(p_stream->key[0]));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_gcm = &(p_stream->gcm);
+        p_stream->is_done = true;
+
+        if(p_stream->mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+            status = atcab_aes_gcm_encrypt_finish(p_gcm,        /* Output the resulting tag to p_tag and end AES GCM  */
+                                                  p_tag,        /* encryption                                         */
+                                                  tag_size);
+        } else {
+            status = atcab_aes_gcm_decrypt_finish(p_gcm,        /* Complete the GCM decrypt by verifying the auth tag */
+                                                  p_tag,
+                                                  tag_size,
+                                                  &is_verified);
+        }
+
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL;
+            break;
+        }
+
+        if((p_stream->mode == OCKAM_VAULT_AES_GCM_MODE_DECRYPT) &&
+           (!is_verified)) {                                    /* If auth tag is invalid, return an error. Data      */
+                                                                /* already handed back must be discarded by the caller*/
+            ret_val = OCKAM_ERR_VAULT_TPM_AES_GCM_DECRYPT_INVALID;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_aes_gcm_ctx_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_aes_gcm_ctx_free(void *p_gcm_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_AES_GCM_CTX_s *p_stream = (ATECC608A_AES_GCM_CTX_s*) p_gcm_ctx;
+
+
+    do {
+        if(p_stream == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(g_atecc608a_aes_gcm_owner == p_stream) {             /* A later stream may be allocated at the same address*/
+            g_atecc608a_aes_gcm_owner = 0;
+        }
+
+                                                                /* Clear the key copy before releasing it             */
+        ockam_mem_set(p_stream, 0, sizeof(ATECC608A_AES_GCM_CTX_s));
+        ret_val = ockam_mem_free(p_stream);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_secret_import()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_secret_import(void *p_ctx,
+                                        void **p_secret,
+                                        uint8_t *p_key, uint32_t key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_SECRET_s *p_new = 0;
+
+
+    do {
+        if((p_secret == 0) || (p_key == 0) || (key_size == 0)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((key_size * 8) != ATECC608A_AES_GCM_KEY_SIZE) {      /* Key size is specified in bits. Ensure the key      */
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;         /* size is set to 128 for the ATECC608A.              */
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(ATECC608A_SECRET_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_set(p_new, 0, sizeof(ATECC608A_SECRET_s));
+        ockam_mem_copy(&(p_new->key[0]), p_key, key_size);      /* The key is written to the slot on first use and    */
+                                                                /* stays there until another operation replaces it    */
+        *p_secret = p_new;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_secret_aes_gcm()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_secret_aes_gcm(void *p_secret,
+                                         OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                         uint8_t *p_iv, uint32_t iv_size,
+                                         uint8_t *p_aad, uint32_t aad_size,
+                                         uint8_t *p_tag, uint32_t tag_size,
+                                         uint8_t *p_input, uint32_t input_size,
+                                         uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATECC608A_SECRET_s *p_secret_key = (ATECC608A_SECRET_s*) p_secret;
+    OCKAM_VAULT_AES_GCM_REC_s rec;
+
+
+    do {
+        if(p_secret_key == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((mode != OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) &&        /* Unknown operation, return an error                 */
+           (mode != OCKAM_VAULT_AES_GCM_MODE_DECRYPT)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+                                                                /* Skips the encrypted key write if still loaded    */
+        ret_val = atecc608a_aes_gcm_key(p_secret_key, &(p_secret_key->key[0]));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        rec.p_iv = p_iv;
+        rec.iv_size = iv_size;
+        rec.p_aad = p_aad;
+        rec.aad_size = aad_size;
+        rec.p_tag = p_tag;
+        rec.tag_size = tag_size;
+        rec.p_input = p_input;
+        rec.input_size = input_size;
+        rec.p_output = p_output;
+        rec.output_size = output_size;
+
+        ret_val = atecc608a_aes_gcm_rec(&(p_secret_key->gcm), mode, &rec);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_tpm_secret_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_secret_free(void *p_secret)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(p_secret == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if(g_atecc608a_aes_gcm_owner == p_secret) {             /* A later secret may be allocated at the same address*/
+            g_atecc608a_aes_gcm_owner = 0;
+        }
+
+                                                                /* Clear the key copy before releasing it             */
+        ockam_mem_set(p_secret, 0, sizeof(ATECC608A_SECRET_s));
+        ret_val = ockam_mem_free(p_secret);
+    } while(0);
+
+    return ret_val;
+}
+
+
+#if(OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A) && \
+    OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_HKDF, OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_tpm_ecdh_derive()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_ecdh_derive(void *p_ctx,
+                                      OCKAM_VAULT_KEY_e key_type,
+                                      uint8_t *p_pub_key, uint32_t pub_key_size,
+                                      uint8_t *p_salt, uint32_t salt_size,
+                                      uint8_t *p_info, uint32_t info_size,
+                                      uint32_t key_size,
+                                      void **p_secrets, uint32_t secret_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    uint16_t key_slot = 0;
+    uint32_t i = 0;
+    uint8_t rand[ATECC608A_RAND_SIZE] = {0};
+    uint8_t okm[(ATECC608A_AES_GCM_KEY_SIZE / 8) * OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX];
+
+
+    do {
+        if((p_pub_key == 0) || (p_secrets == 0) ||
+           (secret_count == 0) || (secret_count > OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        if((pub_key_size != ATECC608A_PUB_KEY_SIZE) ||          /* Salt must fit in the HKDF key slot                 */
+           (salt_size > ATECC608A_HMAC_HASH_SIZE)) {
+            ret_val = OCKAM_ERR_VAULT_SIZE_MISMATCH;
+            break;
+        }
+
+        if((key_size * 8) != ATECC608A_AES_GCM_KEY_SIZE) {      /* Key size is specified in bits. Ensure the key      */
+            ret_val = OCKAM_ERR_VAULT_INVALID_KEY_SIZE;         /* size is set to 128 for the ATECC608A.              */
+            break;
+        }
+
+        if(key_type == OCKAM_VAULT_KEY_STATIC) {
+            key_slot = ATECC608A_KEY_SLOT_STATIC;
+        } else if(key_type == OCKAM_VAULT_KEY_EPHEMERAL) {
+            key_slot = ATECC608A_KEY_SLOT_EPHEMERAL;
+
+            status = atcab_random(&rand[0]);                    /* Same nonce sequence as ockam_vault_tpm_ecdh() for  */
+            if(status == ATCA_SUCCESS) {                        /* the ephemeral key                                  */
+                status = atcab_nonce((const uint8_t *)&rand[0]);
+            }
+            if(status != ATCA_SUCCESS) {
+                ret_val = OCKAM_ERR_VAULT_TPM_KEY_FAIL;
+                break;
+            }
+        } else {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        g_atecc608a_hkdf_owner = 0;                             /* Salt and then the PRK overwrite the HKDF slot      */
+
+        ret_val = atecc608a_write_key(p_salt,
+                                      salt_size,
+                                      ATECC608A_HKDF_SLOT,
+                                      ATECC608A_HKDF_SLOT_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+                                                                /* The shared secret is only copied into TempKey and */
+                                                                /* never sent over the bus                            */
+        status = atcab_ecdh_base((ECDH_MODE_SOURCE_EEPROM_SLOT | ECDH_MODE_COPY_TEMP_KEY),
+                                 key_slot,
+                                 p_pub_key,
+                                 0,
+                                 0);
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_ECDH_FAIL;
+            break;
+        }
+
+        status = atcab_kdf((KDF_MODE_ALG_HKDF |                 /* HKDF extract on the device: HMAC keyed with the    */
+                            KDF_MODE_SOURCE_SLOT |              /* salt in the HKDF slot over the shared secret in    */
+                            KDF_MODE_TARGET_SLOT),              /* TempKey. The PRK replaces the salt in the slot.    */
+                           ((ATECC608A_HKDF_SLOT << 8) | ATECC608A_HKDF_SLOT),
+                           KDF_DETAILS_HKDF_MSG_LOC_TEMPKEY,
+                           0,
+                           0,
+                           0);
+        if(status != ATCA_SUCCESS) {
+            ret_val = OCKAM_ERR_VAULT_TPM_HKDF_FAIL;
+            break;
+        }
+
+        ret_val = atecc608a_hkdf_expand(ATECC608A_HKDF_SLOT,    /* Expand stage runs from the PRK left in the slot    */
+                                        p_info, info_size,
+                                        &okm[0], (key_size * secret_count));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < secret_count; i++) {                     /* Each secret takes the next key_size bytes          */
+            ret_val = ockam_vault_tpm_secret_import(p_ctx,
+                                                    &p_secrets[i],
+                                                    &okm[i * key_size], key_size);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Release the secrets imported before the failure    */
+            while(i > 0) {
+                i--;
+                ockam_vault_tpm_secret_free(p_secrets[i]);
+                p_secrets[i] = 0;
+            }
+        }
+    } while(0);
+
+    ockam_mem_set(&okm[0], 0, sizeof(okm));
+
+    return ret_val;
+}
+
+#endif                                                          /* OCKAM_VAULT_CFG_KEY_ECDH && OCKAM_VAULT_CFG_HKDF   */
+
+
+/**
+ ********************************************************************************************************
+ *                                       atecc608a_aes_gcm_key()
+ *
+ * @brief   Make sure the AES GCM slot holds the key of a stream or secret. The slot is shared by
+ *          every AES GCM operation, so the key is only rewritten when something else used it since.
+ *
+ * @param   p_owner[in]     The stream or secret the key belongs to
+ *
+ * @param   p_key[in]       Copy of the key kept by the owner
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR atecc608a_aes_gcm_key(void *p_owner, uint8_t *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(g_atecc608a_aes_gcm_owner == p_owner) {
+            break;
+        }
+
+        ret_val = atecc608a_write_key(p_key,
+                                      (ATECC608A_AES_GCM_KEY_SIZE / 8),
+                                      ATECC608A_AES_GCM_KEY,
+                                      ATECC608A_AES_GCM_KEY_SLOT_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            g_atecc608a_aes_gcm_owner = 0;
+            break;
+        }
+
+        g_atecc608a_aes_gcm_owner = p_owner;
+    } while(0);
+
+    return ret_val;
+}
+
+
+#endif                                                          /* OCKAM_VAULT_CFG_AES_GCM                            */
+
+
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                        Backend Function Table
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN && (OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
+
+const OCKAM_VAULT_BACKEND_s ockam_vault_tpm_backend = {
+    .random                     = ockam_vault_tpm_random,
+    .key_gen                    = ockam_vault_tpm_key_gen,
+    .key_get_pub                = ockam_vault_tpm_key_get_pub,
+    .key_write                  = 0,
+    .ecdh                       = ockam_vault_tpm_ecdh,
+    .sha256                     = ockam_vault_tpm_sha256,
+    .sha256_ctx_init            = ockam_vault_tpm_sha256_ctx_init,
+    .sha256_ctx_update          = ockam_vault_tpm_sha256_ctx_update,
+    .sha256_ctx_finish          = ockam_vault_tpm_sha256_ctx_finish,
+    .sha256_ctx_free            = ockam_vault_tpm_sha256_ctx_free,
+    .hkdf                       = ockam_vault_tpm_hkdf,
+    .hkdf_extract               = ockam_vault_tpm_hkdf_extract,
+    .hkdf_expand                = ockam_vault_tpm_hkdf_expand,
+    .hkdf_prk_free              = ockam_vault_tpm_hkdf_prk_free,
+    .aes_gcm                    = ockam_vault_tpm_aes_gcm,
+    .aes_gcm_batch              = ockam_vault_tpm_aes_gcm_batch,
+    .aes_gcm_iov                = ockam_vault_tpm_aes_gcm_iov,
+    .aes_gcm_ctx_init           = ockam_vault_tpm_aes_gcm_ctx_init,
+    .aes_gcm_ctx_aad_update     = ockam_vault_tpm_aes_gcm_ctx_aad_update,
+    .aes_gcm_ctx_update         = ockam_vault_tpm_aes_gcm_ctx_update,
+    .aes_gcm_ctx_finish         = ockam_vault_tpm_aes_gcm_ctx_finish,
+    .aes_gcm_ctx_free           = ockam_vault_tpm_aes_gcm_ctx_free,
+    .secret_import              = ockam_vault_tpm_secret_import,
+    .secret_aes_gcm             = ockam_vault_tpm_secret_aes_gcm,
+    .secret_free                = ockam_vault_tpm_secret_free,
+    .ecdh_derive                = ockam_vault_tpm_ecdh_derive
+};
 
+#endif                                                          /* OCKAM_VAULT_CFG_DISPATCH_EN                        */
@@ -15,9 +15,11 @@
 #include <ockam/error.h>
 
 #include <ockam/kal.h>
+#include <ockam/memory.h>
 #include <ockam/vault.h>
 #include <ockam/vault/tpm.h>
 #include <ockam/vault/host.h>
+#include <ockam/vault/backend.h>
 
 #if !defined(OCKAM_VAULT_CONFIG_FILE)
 #error "Error: Ockam Vault Config File Missing"
@@ -33,6 +35,97 @@
  */
 
 #define VAULT_SHA256_DIGEST_SIZE                    32u         /* Size of the resulting SHA256 operation             */
+#define VAULT_SECRET_KEY_SIZE_MAX                   32u         /* Largest AES key a secret can be derived into       */
+#define VAULT_PMS_SIZE                              32u         /* Size of the shared secret from ECDH                */
+
+#ifndef OCKAM_VAULT_CFG_SHA256_HOST_SIZE
+#define OCKAM_VAULT_CFG_SHA256_HOST_SIZE            OCKAM_VAULT_SIZE_AUTO
+#endif
+
+#ifndef OCKAM_VAULT_CFG_HKDF_HOST_SIZE
+#define OCKAM_VAULT_CFG_HKDF_HOST_SIZE              OCKAM_VAULT_SIZE_AUTO
+#endif
+
+#ifndef OCKAM_VAULT_CFG_AES_GCM_HOST_SIZE
+#define OCKAM_VAULT_CFG_AES_GCM_HOST_SIZE           OCKAM_VAULT_SIZE_AUTO
+#endif
+
+#ifndef OCKAM_VAULT_CFG_TPM_FAIL_LIMIT
+#define OCKAM_VAULT_CFG_TPM_FAIL_LIMIT              3u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_TPM_RETRY_MS
+#define OCKAM_VAULT_CFG_TPM_RETRY_MS                5000u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_HOST_SEED_TPM
+#define OCKAM_VAULT_CFG_HOST_SEED_TPM               OCKAM_VAULT_HOST_SEED_PLATFORM
+#endif
+
+#ifndef OCKAM_VAULT_CFG_KEY_POOL_SIZE
+#define OCKAM_VAULT_CFG_KEY_POOL_SIZE               0u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_KEY_POOL_LOW
+#define OCKAM_VAULT_CFG_KEY_POOL_LOW                (OCKAM_VAULT_CFG_KEY_POOL_SIZE / 2u)
+#endif
+
+#ifndef OCKAM_VAULT_CFG_REFILL_EN
+#define OCKAM_VAULT_CFG_REFILL_EN                   0u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_RAND_BUF_SIZE
+#define OCKAM_VAULT_CFG_RAND_BUF_SIZE               0u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_LOCK_OPT_THREADS
+#define OCKAM_VAULT_CFG_LOCK_OPT_THREADS            0u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_RAND_BUF_COUNT
+#define OCKAM_VAULT_CFG_RAND_BUF_COUNT              4u
+#endif
+
+#ifndef OCKAM_VAULT_CFG_RAND_BUF_LOW
+#define OCKAM_VAULT_CFG_RAND_BUF_LOW                (OCKAM_VAULT_CFG_RAND_BUF_SIZE / 2u)
+#endif
+
+#define VAULT_RAND_CHUNK_SIZE                       32u         /* Random bytes the TPM returns per command           */
+#define VAULT_TPM_ENTROPY_WAIT_MS                   100u        /* Longest wait for the TPM bus when seeding          */
+
+                                                                /* The refill thread is only started when there is    */
+                                                                /* something for it to refill                         */
+#define VAULT_REFILL_KEYS_EN                        (OCKAM_VAULT_CFG_REFILL_EN &&                                  \
+                                                     ((OCKAM_VAULT_CFG_INIT) & OCKAM_VAULT_CFG_HOST) &&           \
+                                                     (OCKAM_VAULT_CFG_KEY_POOL_SIZE > 0))
+#define VAULT_REFILL_RAND_EN                        (OCKAM_VAULT_CFG_REFILL_EN &&                                  \
+                                                     (OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0))
+#define VAULT_REFILL_EN                             (VAULT_REFILL_KEYS_EN || VAULT_REFILL_RAND_EN)
+#define VAULT_REFILL_WAKE_SIZE                      1u          /* One pending wake up covers everything found low    */
+
+#if((OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0) && (OCKAM_VAULT_CFG_RAND_BUF_SIZE < VAULT_RAND_CHUNK_SIZE))
+#error "Ockam Vault: Random buffer must hold at least one chunk from the backend"
+#endif
+
+                                                                /* Without dispatching, ECDH derive is only fused in  */
+                                                                /* the TPM when ECDH, HKDF and AES GCM all run there. */
+                                                                /* Otherwise the stages are run one at a time.        */
+#define VAULT_ECDH_DERIVE_TPM_EN                    (OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_KEY_ECDH,                  \
+                                                                        OCKAM_VAULT_TPM_MICROCHIP_ATECC608A) &&   \
+                                                     OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_HKDF,                      \
+                                                                        OCKAM_VAULT_TPM_MICROCHIP_ATECC608A) &&   \
+                                                     OCKAM_VAULT_CFG_EN(OCKAM_VAULT_CFG_AES_GCM,                   \
+                                                                        OCKAM_VAULT_TPM_MICROCHIP_ATECC608A))
+
+#define VAULT_ECDH_DERIVE_SPLIT_EN                  (OCKAM_VAULT_CFG_DISPATCH_EN ||                                \
+                                                     (((OCKAM_VAULT_CFG_INIT) & OCKAM_VAULT_CFG_TPM) &&           \
+                                                      !VAULT_ECDH_DERIVE_TPM_EN))
+
+#define VAULT_CALIBRATE_SIZE_SMALL                  64u         /* Input sizes timed on each backend at init. The     */
+#define VAULT_CALIBRATE_SIZE_LARGE                  1024u       /* cost is taken as linear between the two.           */
+#define VAULT_CALIBRATE_AES_KEY_SIZE                16u         /* AES key size used for the AES GCM measurement      */
+#define VAULT_CALIBRATE_AES_IV_SIZE                 12u         /* IV size used for the AES GCM measurement           */
+#define VAULT_CALIBRATE_AES_TAG_SIZE                16u         /* Tag size used for the AES GCM measurement          */
 
 
 /*
@@ -55,27 +148,302 @@ typedef enum {
 } VAULT_STATE_e;
 
 
+/**
+ *******************************************************************************
+ * @enum    VAULT_OP_e
+ * @brief   Groups of operations that are routed to a backend together. Each
+ *          group matches one of the OCKAM_VAULT_CFG_xxx config values.
+ *******************************************************************************
+ */
+
+typedef enum {
+    VAULT_OP_RAND = 0,                                          /*!< Random number generation                         */
+    VAULT_OP_KEY_ECDH,                                          /*!< Key generation, retrieval, write and ECDH        */
+    VAULT_OP_SHA256,                                            /*!< SHA-256                                          */
+    VAULT_OP_HKDF,                                              /*!< HKDF                                             */
+    VAULT_OP_AES_GCM,                                           /*!< AES GCM                                          */
+    MAX_VAULT_OP                                                /*!< Total number of operation groups                 */
+} VAULT_OP_e;
+
+
 /*
  ********************************************************************************************************
  *                                               DATA TYPES                                             *
  ********************************************************************************************************
  */
 
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+/**
+ *******************************************************************************
+ * @struct  VAULT_ROUTE_s
+ * @brief   Backend selected for an operation group
+ *******************************************************************************
+ */
+
+typedef struct {
+    const OCKAM_VAULT_BACKEND_s *p_backend;                     /*!< Function table of the selected backend           */
+    void *p_ctx;                                                /*!< Context passed to every call on the backend      */
+} VAULT_ROUTE_s;
+#endif
+
+
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+/**
+ *******************************************************************************
+ * @struct  VAULT_RAND_BUF_s
+ * @brief   Random bytes generated ahead of time for small requests
+ *******************************************************************************
+ */
+
+typedef struct {
+    OCKAM_KAL_MUTEX mutex;                                      /*!< Only waited on by threads sharing the buffer     */
+    uint32_t avail;                                             /*!< Unused bytes, from the start of data             */
+    uint8_t data[OCKAM_VAULT_CFG_RAND_BUF_SIZE];                /*!< Used bytes are wiped as they are handed out      */
+} VAULT_RAND_BUF_s;
+#endif
+
+
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+/**
+ *******************************************************************************
+ * @struct  VAULT_LOCK_OPT_s
+ * @brief   Lock options used by one thread instead of those given at init
+ *******************************************************************************
+ */
+
+typedef struct {
+    uint32_t thread_id;                                         /*!< KAL thread id the options apply to, 0 if unused  */
+    OCKAM_KAL_OPT lock_opt;                                     /*!< Blocking or non-blocking lock waits              */
+    uint32_t lock_timeout_ms;                                   /*!< Longest lock wait when blocking, 0 is forever    */
+} VAULT_LOCK_OPT_s;
+#endif
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_s
+ * @brief   State for a single Ockam Vault instance
+ *******************************************************************************
+ */
+
+struct OCKAM_VAULT_s {
+    VAULT_STATE_e state;                                        /*!< Current state of this vault instance             */
+    OCKAM_KAL_MUTEX mutex;                                      /*!< Protects the instance key material               */
+    OCKAM_KAL_RWLOCK users;                                     /*!< Held by calls made without the instance lock     */
+    void *p_tpm_ctx;                                            /*!< TPM context, shared by all vault instances       */
+    void *p_host_ctx;                                           /*!< Host library context owned by this instance      */
+    OCKAM_KAL_OPT lock_opt;                                     /*!< Blocking or non-blocking lock waits              */
+    uint32_t lock_timeout_ms;                                   /*!< Longest lock wait when blocking, 0 is forever    */
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+    OCKAM_KAL_RWLOCK opt_lock;                                  /*!< Protects opt                                     */
+    VAULT_LOCK_OPT_s opt[OCKAM_VAULT_CFG_LOCK_OPT_THREADS];     /*!< Overrides the init options for listed threads    */
+#endif
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s route[MAX_VAULT_OP];                          /*!< Backend used for each group of operations        */
+    VAULT_ROUTE_s route_host;                                   /*!< Host library, for inputs over host_size          */
+    uint32_t host_size[MAX_VAULT_OP];                           /*!< One-shot inputs this size or larger use the host */
+#endif
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+    VAULT_RAND_BUF_s rand_buf[OCKAM_VAULT_CFG_RAND_BUF_COUNT];  /*!< Threads are spread across these by thread id     */
+#endif
+#if(VAULT_REFILL_EN)
+    OCKAM_KAL_THREAD refill_thread;                             /*!< Tops up the key pool and random buffers          */
+    OCKAM_KAL_QUEUE refill_wake;                                /*!< Wakes the refill thread. A null item stops it.   */
+#endif
+};
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_SHA256_CTX_s
+ * @brief   State for a streaming SHA-256 operation
+ *******************************************************************************
+ */
+
+struct OCKAM_VAULT_SHA256_CTX_s {
+    OCKAM_VAULT_s *p_vault;                                     /*!< Vault instance the digest was started on         */
+    void *p_backend_ctx;                                        /*!< Streaming state owned by the backend             */
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route;                                     /*!< Backend the digest was started on                */
+#endif
+};
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_HKDF_PRK_s
+ * @brief   Pseudo-random key kept from an HKDF extract
+ *******************************************************************************
+ */
+
+struct OCKAM_VAULT_HKDF_PRK_s {
+    OCKAM_VAULT_s *p_vault;                                     /*!< Vault instance the extract ran on                */
+    void *p_backend_prk;                                        /*!< Pseudo-random key owned by the backend           */
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route;                                     /*!< Backend holding the pseudo-random key            */
+#endif
+};
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_AES_GCM_CTX_s
+ * @brief   State for a streaming AES GCM operation
+ *******************************************************************************
+ */
+
+struct OCKAM_VAULT_AES_GCM_CTX_s {
+    OCKAM_VAULT_s *p_vault;                                     /*!< Vault instance the operation was started on      */
+    void *p_backend_ctx;                                        /*!< Streaming state owned by the backend             */
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route;                                     /*!< Backend the operation was started on             */
+#endif
+};
+
+
+/**
+ *******************************************************************************
+ * @struct  OCKAM_VAULT_SECRET_s
+ * @brief   AES GCM key loaded once into a backend
+ *******************************************************************************
+ */
+
+struct OCKAM_VAULT_SECRET_s {
+    OCKAM_VAULT_s *p_vault;                                     /*!< Vault instance the secret was imported into      */
+    void *p_backend_secret;                                     /*!< Loaded key owned by the backend                  */
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route;                                     /*!< Backend holding the loaded key                   */
+#endif
+};
+
+
 /*
  ********************************************************************************************************
  *                                          FUNCTION PROTOTYPES                                         *
  ********************************************************************************************************
  */
 
+static OCKAM_ERR vault_enter(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_s **p_entered);
+
+static void vault_leave(OCKAM_VAULT_s *p_entered);
+
+static OCKAM_ERR vault_lock(OCKAM_VAULT_s *p_vault);
+
+static OCKAM_ERR vault_unlock(OCKAM_VAULT_s *p_vault, OCKAM_ERR ret_val);
+
+static void vault_lock_opt(OCKAM_VAULT_s *p_vault, OCKAM_KAL_OPT *p_opt, uint32_t *p_timeout_ms);
+
+static OCKAM_ERR vault_rand_gen(OCKAM_VAULT_s *p_vault, uint8_t *p_rand_num, uint32_t rand_num_size);
+
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+static OCKAM_ERR vault_rand_buf_lock(OCKAM_VAULT_s *p_vault, VAULT_RAND_BUF_s *p_buf);
+
+static OCKAM_ERR vault_rand_buf_fill(OCKAM_VAULT_s *p_vault, VAULT_RAND_BUF_s *p_buf);
+
+static OCKAM_ERR vault_rand_buf_refill(OCKAM_VAULT_s *p_vault, VAULT_RAND_BUF_s *p_buf);
+
+static OCKAM_ERR vault_rand_buf_take(OCKAM_VAULT_s *p_vault, uint8_t *p_rand_num, uint32_t rand_num_size);
+#endif
+
+#if(VAULT_REFILL_EN)
+static OCKAM_ERR vault_refill_start(OCKAM_VAULT_s *p_vault);
+
+static void vault_refill_stop(OCKAM_VAULT_s *p_vault);
+
+static void vault_refill_run(void *p_arg);
+
+static void vault_refill_wake(OCKAM_VAULT_s *p_vault);
+#endif
+
+#if(VAULT_REFILL_KEYS_EN)
+static void vault_refill_keys(OCKAM_VAULT_s *p_vault);
+#endif
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM)
+static OCKAM_ERR vault_tpm_mutex_init(void);
+
+static OCKAM_ERR vault_tpm_attach(void *p_arg, void **p_tpm_ctx);
+
+static void vault_tpm_detach(void);
+
+static OCKAM_ERR vault_tpm_lock(OCKAM_VAULT_s *p_vault);
+
+static OCKAM_ERR vault_tpm_lock_opt(OCKAM_VAULT_s *p_vault, OCKAM_KAL_OPT opt, uint32_t timeout_ms);
+
+static OCKAM_ERR vault_tpm_unlock(OCKAM_ERR ret_val);
+
+static OCKAM_ERR vault_tpm_ready(void);
+
+static void vault_tpm_health(OCKAM_ERR ret_val);
+
+static uint8_t vault_tpm_failed(OCKAM_ERR ret_val);
+#endif
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN && OCKAM_VAULT_CFG_HOST_SEED_TPM)
+static OCKAM_ERR vault_tpm_entropy(void *p_arg, uint8_t *p_buf, uint32_t size, uint32_t *p_size);
+#endif
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+static void vault_route_init(OCKAM_VAULT_s *p_vault);
+
+static void vault_route_set(OCKAM_VAULT_s *p_vault, VAULT_OP_e op, uint32_t cfg);
+
+static OCKAM_ERR vault_route_lock(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s *p_route);
+
+static OCKAM_ERR vault_route_lock_fast(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s **p_route);
+
+static OCKAM_ERR vault_route_unlock(VAULT_ROUTE_s *p_route, OCKAM_ERR ret_val);
+
+static VAULT_ROUTE_s *vault_route_get(OCKAM_VAULT_s *p_vault, VAULT_OP_e op, uint32_t size);
+
+static uint8_t vault_route_failover(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s **p_route,
+                                    OCKAM_ERR ret_val, uint8_t retry);
+
+static OCKAM_ERR vault_route_mutex_init(void);
+
+static uint32_t vault_route_calibrate(OCKAM_VAULT_s *p_vault, VAULT_OP_e op);
+
+static OCKAM_ERR vault_route_time(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s *p_route, VAULT_OP_e op,
+                                  uint8_t *p_buf, uint32_t size, uint64_t *p_time_us);
+#endif
+
+#if(VAULT_ECDH_DERIVE_SPLIT_EN)
+static OCKAM_ERR vault_ecdh_derive_split(OCKAM_VAULT_s *p_vault,
+                                         OCKAM_VAULT_KEY_e key_type,
+                                         uint8_t *p_pub_key, uint32_t pub_key_size,
+                                         uint8_t *p_salt, uint32_t salt_size,
+                                         uint8_t *p_info, uint32_t info_size,
+                                         uint32_t key_size,
+                                         OCKAM_VAULT_SECRET_s **p_secrets, uint32_t secret_count);
+#endif
+
+
 /*
  ********************************************************************************************************
  *                                            GLOBAL VARIABLES                                          *
  ********************************************************************************************************
  */
-                                                                /* Used in a multi-threaded application to protect    */
-static OCKAM_KAL_MUTEX g_vault_mutex;                           /* multiple accesses to vault.                        */
 
-static VAULT_STATE_e g_vault_state = VAULT_STATE_UNINIT;
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM)
+static OCKAM_KAL_ONCE g_vault_tpm_once = OCKAM_KAL_ONCE_INIT;   /* Creates the TPM lock on the first attach           */
+static OCKAM_KAL_MUTEX g_vault_tpm_mutex;                       /* There is a single TPM bus regardless of how many   */
+static void *g_vault_tpm_ctx = 0;                               /* vault instances exist, so the TPM context and the  */
+static uint32_t g_vault_tpm_refs = 0;                           /* lock protecting it are shared and ref counted.     */
+static uint32_t g_vault_tpm_fails = 0;                          /* TPM failures in a row and when to try the TPM      */
+static uint64_t g_vault_tpm_retry_us = 0;                       /* again once they reach the limit. Both are only     */
+                                                                /* used with the TPM lock held.                       */
+static uint8_t g_vault_tpm_track = 0;                           /* Set while the lock is held for a TPM command       */
+                                                                /* that counts toward the TPM health                  */
+#endif
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+                                                                /* Creates the calibration lock on the first init     */
+static OCKAM_KAL_ONCE g_vault_route_once = OCKAM_KAL_ONCE_INIT;
+static OCKAM_KAL_MUTEX g_vault_route_mutex;                     /* AUTO size thresholds are measured by the first     */
+static uint32_t g_vault_route_host_size[MAX_VAULT_OP];          /* instance that needs them and copied by the rest.   */
+static uint32_t g_vault_route_measured = 0;                     /* Bit per operation group. Both are only used with   */
+                                                                /* the calibration lock held.                         */
+#endif
 
 
 /*
@@ -95,56 +463,146 @@ static VAULT_STATE_e g_vault_state = VAULT_STATE_UNINIT;
  ********************************************************************************************************
  *                                          ockam_vault_init()
  *
- * @brief   Initialize the Ockam Vault
+ * @brief   Initialize a new Ockam Vault instance
+ *
+ * @param   p_vault[out]    Returns the handle for the new vault instance
  *
- * @param   p_cfg[in]   Configuration values for a TPM and/or a host software library
+ * @param   p_cfg[in]       Configuration values for a TPM and/or a host software library
  *
- * @return  OCKAM_ERR_NONE if initialized successfully. OCKAM_ERR_VAULT_ALREADY_INIT if already
- *          initialized. Other errors if specific chip fails init.
+ * @return  OCKAM_ERR_NONE if initialized successfully. Other errors if specific chip fails init.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_init(OCKAM_VAULT_CFG_s *p_cfg)
+OCKAM_ERR ockam_vault_init(OCKAM_VAULT_s **p_vault, OCKAM_VAULT_CFG_s *p_cfg)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_new = 0;
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+    uint32_t i = 0;
+#endif
 
 
     do {
-        if(g_vault_state != VAULT_STATE_UNINIT) {               /* Make sure we're not already initialized            */
-            ret_val = OCKAM_ERR_VAULT_ALREADY_INIT;
+        if((p_vault == 0) || (p_cfg == 0)) {                    /* Need somewhere to return the handle and a config   */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        *p_vault = 0;
+
+        ret_val = ockam_mem_alloc((void**) &p_new,              /* Each vault instance is allocated separately so     */
+                                  sizeof(OCKAM_VAULT_s));       /* multiple instances can run side by side            */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_set(p_new, 0, sizeof(OCKAM_VAULT_s));
+        p_new->state = VAULT_STATE_UNINIT;
+
+        ret_val = ockam_kal_mutex_init(&(p_new->mutex));        /* Create a mutex for this vault instance             */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_kal_rwlock_init(&(p_new->users));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+        ret_val = ockam_kal_rwlock_init(&(p_new->opt_lock));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+#endif
+
+#if(VAULT_REFILL_EN)
+        ret_val = vault_refill_start(p_new);                    /* Idle until the instance is ready and first woken   */
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
+#endif
 
-        ret_val = ockam_kal_mutex_init(&g_vault_mutex);         /* Create a mutex for vault access                    */
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+        for(i = 0; i < OCKAM_VAULT_CFG_RAND_BUF_COUNT; i++) {   /* Random buffers start empty and are filled on first */
+            ret_val = ockam_kal_mutex_init(&(p_new->rand_buf[i].mutex));
+            if(ret_val != OCKAM_ERR_NONE) {                     /* use or by ockam_vault_random_refill()              */
+                break;
+            }
+        }
         if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
+#endif
 
 #if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_init(p_cfg->p_tpm);           /* Initialize the TPM code if needed                  */
+        ret_val = vault_tpm_attach(p_cfg->p_tpm,                /* Initialize the TPM code if needed                  */
+                                   &(p_new->p_tpm_ctx));
         if(ret_val != OCKAM_ERR_NONE) {
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+            ret_val = OCKAM_ERR_NONE;                           /* A device without the TPM fitted is not an error    */
+            p_new->p_tpm_ctx = 0;                               /* when dispatching, the host library takes over all  */
+#else                                                           /* of the operations instead.                         */
             break;
+#endif
         }
 #endif
 
 #if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_init(p_cfg->p_host);         /* Initialize the host software lib code if needed    */
-
-        if(ret_val != OCKAM_ERR_NONE) {                         /* If the software lib fails, free tpm if necessary   */
+#if(OCKAM_VAULT_CFG_DISPATCH_EN && OCKAM_VAULT_CFG_HOST_SEED_TPM)
+                                                                /* Initialize the host software lib code, seeding its */
+                                                                /* DRBGs from the TPM as well when the TPM is fitted  */
+        ret_val = ockam_vault_host_init(p_cfg->p_host,
+                                        (p_new->p_tpm_ctx != 0) ? vault_tpm_entropy : 0,
+                                        p_new->p_tpm_ctx,
+                                        &(p_new->p_host_ctx));
+#else
+        ret_val = ockam_vault_host_init(p_cfg->p_host,          /* Initialize the host software lib code. Every vault */
+                                        0, 0,                   /* instance gets its own DRBG and key storage.        */
+                                        &(p_new->p_host_ctx));
+#endif
+        if(ret_val != OCKAM_ERR_NONE) {
 #if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM)
-            ockam_vault_tpm_free();
+            if(p_new->p_tpm_ctx != 0) {                         /* If the software lib fails, free tpm if necessary   */
+                vault_tpm_detach();
+            }
 #endif
             break;
         }
 #endif
 
-        g_vault_state = VAULT_STATE_IDLE;                       /* Set the vault state to idle so it can be used      */
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        vault_route_init(p_new);                                /* Select a backend for every operation group         */
+#endif
+
+        p_new->lock_opt = p_cfg->lock_opt;                      /* Applied last so init itself always waits           */
+        p_new->lock_timeout_ms = p_cfg->lock_timeout_ms;
+
+        p_new->state = VAULT_STATE_IDLE;                        /* Set the vault state to idle so it can be used      */
+        *p_vault = p_new;
+
+#if(VAULT_REFILL_EN)
+        vault_refill_wake(p_new);                               /* Fill ahead of time rather than on first use        */
+#endif
     } while(0);
 
-    if(ret_val != OCKAM_ERR_NONE) {                             /* If init fails, release any mutexes acquired        */
-        ockam_kal_mutex_free(&g_vault_mutex);                   /*  No need to check return, free may fail if it was  */
-    }                                                           /*  never acquired.                                   */
+    if((ret_val != OCKAM_ERR_NONE) && (p_new != 0)) {           /* If init fails, release the mutex and the instance  */
+#if(VAULT_REFILL_EN)
+        vault_refill_stop(p_new);
+#endif
+        ockam_kal_mutex_free(&(p_new->mutex));                  /*  No need to check return, free may fail if it was  */
+        ockam_kal_rwlock_free(&(p_new->users));                 /*  never acquired.                                   */
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+        ockam_kal_rwlock_free(&(p_new->opt_lock));
+#endif
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+        for(i = 0; i < OCKAM_VAULT_CFG_RAND_BUF_COUNT; i++) {
+            ockam_kal_mutex_free(&(p_new->rand_buf[i].mutex));
+        }
+#endif
+        ockam_mem_free(p_new);
+    }
 
     return ret_val;
 }
@@ -152,51 +610,87 @@ OCKAM_ERR ockam_vault_init(OCKAM_VAULT_CFG_s *p_cfg)
 
 /**
  ********************************************************************************************************
- *                                        ockam_vault_random()
- *
- * @brief   Generate and return a random number
+ *                                          ockam_vault_free()
  *
- * @param   p_rand_num[out]     32-byte array to be filled with the random number
+ * @brief   Free an Ockam Vault instance and all of its host library state. Waits for calls already
+ *          running on the instance, with or without the instance lock, whatever the lock options
+ *          given at init. Calls made after free has started fail with OCKAM_ERR_VAULT_UNINITIALIZED
+ *          until it returns, and must not be made at all once it has.
  *
- * @param   rand_num_size[in]   The size of the desired random number & buffer passed in. Used to verify
- *                              correct size.
+ * @param   p_vault[in]     The vault instance to free. The handle is invalid once this returns.
  *
- * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_VAULT_INVALID_SIZE if size
+ * @return  OCKAM_ERR_NONE if freed successfully.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_random(uint8_t *p_rand_num, uint32_t rand_num_size)
+OCKAM_ERR ockam_vault_free(OCKAM_VAULT_s *p_vault)
 {
-    OCKAM_ERR ret_val;
-    OCKAM_ERR t_ret_val;
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+    uint32_t i = 0;
+#endif
+
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state           */
+        if(p_vault == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_kal_mutex_lock(&(p_vault->mutex),       /* Always waits for other calls to finish. A busy     */
+                                       OCKAM_KAL_OPT_BLOCKING,  /* result here would leak the instance.               */
+                                       0);
         if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
+        if(p_vault->state != VAULT_STATE_IDLE) {
+            ockam_kal_mutex_unlock(&(p_vault->mutex), 0);
             ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
             break;
         }
 
-#if(OCKAM_VAULT_CFG_RAND & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_random(p_rand_num,            /* Get a random number from the TPM                   */
-                                         rand_num_size);
-#elif(OCKAM_VAULT_CFG_RAND & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_random(p_rand_num,           /* Get a random number from the host library          */
-                                          rand_num_size);
-#else
-#error "Ockam Vault: Random function not specified"
+        p_vault->state = VAULT_STATE_UNINIT;                    /* Any call racing with free now sees uninitialized   */
+
+                                                                /* Wait for calls running without the instance lock.  */
+                                                                /* None of them take the instance lock, so holding it */
+                                                                /* here cannot deadlock.                              */
+        ockam_kal_rwlock_write_lock(&(p_vault->users), OCKAM_KAL_OPT_BLOCKING, 0);
+
+#if(VAULT_REFILL_EN)
+        vault_refill_stop(p_vault);                             /* Refills now fail fast, so this does not wait long  */
 #endif
-    } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_free(p_vault->p_host_ctx);   /* Release the DRBG and keys owned by this instance   */
+        p_vault->p_host_ctx = 0;
+#endif
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM)
+        if(p_vault->p_tpm_ctx != 0) {                           /* The last instance out shuts down the TPM           */
+            vault_tpm_detach();
+            p_vault->p_tpm_ctx = 0;
+        }
+#endif
+
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+        for(i = 0; i < OCKAM_VAULT_CFG_RAND_BUF_COUNT; i++) {   /* Unused random bytes are not left in freed memory   */
+            ockam_mem_set(p_vault->rand_buf[i].data, 0, OCKAM_VAULT_CFG_RAND_BUF_SIZE);
+            ockam_kal_mutex_free(&(p_vault->rand_buf[i].mutex));
+        }
+#endif
+
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+        ockam_kal_rwlock_free(&(p_vault->opt_lock));
+#endif
+
+        ockam_kal_rwlock_unlock(&(p_vault->users));
+        ockam_kal_rwlock_free(&(p_vault->users));
+        ockam_kal_mutex_unlock(&(p_vault->mutex), 0);
+        ockam_kal_mutex_free(&(p_vault->mutex));
+        ockam_mem_free(p_vault);
+    } while(0);
 
     return ret_val;
 }
@@ -204,47 +698,298 @@ OCKAM_ERR ockam_vault_random(uint8_t *p_rand_num, uint32_t rand_num_size)
 
 /**
  ********************************************************************************************************
- *                                          ockam_vault_key_gen()
+ *                                       ockam_vault_lock_opt_set()
  *
- * @brief   Generate an ECC keypair and get the public key
+ * @brief   Set the lock options used by calls the calling thread makes on a vault instance, in place
+ *          of the lock_opt and lock_timeout_ms given at init. Lets a latency sensitive thread fail
+ *          fast with OCKAM_ERR_VAULT_BUSY while other threads keep waiting, or the other way round.
+ *          The options stay in place until ockam_vault_lock_opt_clear() is called from the thread.
  *
- * @param   key_type[in]        The type of key pair to generate.
+ * @param   p_vault[in]         Handle of the vault instance to use
  *
- * @return  OCKAM_ERR_NONE if successful.
+ * @param   lock_opt[in]        Blocking or non-blocking lock waits for this thread
+ *
+ * @param   lock_timeout_ms[in] Longest lock wait when blocking, 0 waits forever
+ *
+ * @return  OCKAM_ERR_NONE if the options now apply to the calling thread.
+ *          OCKAM_ERR_VAULT_LOCK_OPT_FULL if OCKAM_VAULT_CFG_LOCK_OPT_THREADS other threads already
+ *          have their own options, or the feature is disabled.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_key_gen(OCKAM_VAULT_KEY_e key_type)
+OCKAM_ERR ockam_vault_lock_opt_set(OCKAM_VAULT_s *p_vault,
+                                   OCKAM_KAL_OPT lock_opt, uint32_t lock_timeout_ms)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+    VAULT_LOCK_OPT_s *p_opt = 0;
+    uint32_t thread_id = 0;
+    uint32_t i = 0;
+#endif
 
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* generating a key                                   */
+        ret_val = vault_enter(p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+        ret_val = ockam_kal_thread_id(&thread_id);
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-#if(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_key_gen(key_type);            /* Generate a key in the TPM                          */
-#elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_key_gen(key_type);           /* Generate a key using the host library              */
-#else
-#error "Ockam Vault: Key Gen Function Missing"
-#endif
-    } while(0);
+        ret_val = ockam_kal_rwlock_write_lock(&(p_vault->opt_lock), OCKAM_KAL_OPT_BLOCKING, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+        for(i = 0; i < OCKAM_VAULT_CFG_LOCK_OPT_THREADS; i++) {
+            if(p_vault->opt[i].thread_id == thread_id) {        /* Reuse the slot the thread already has, otherwise   */
+                p_opt = &(p_vault->opt[i]);                     /* take the first free one                            */
+                break;
+            } else if((p_opt == 0) && (p_vault->opt[i].thread_id == 0)) {
+                p_opt = &(p_vault->opt[i]);
+            }
+        }
+
+        if(p_opt == 0) {
+            ret_val = OCKAM_ERR_VAULT_LOCK_OPT_FULL;
+        } else {
+            p_opt->thread_id = thread_id;
+            p_opt->lock_opt = lock_opt;
+            p_opt->lock_timeout_ms = lock_timeout_ms;
+        }
+
+        ockam_kal_rwlock_unlock(&(p_vault->opt_lock));
+#else
+        ret_val = OCKAM_ERR_VAULT_LOCK_OPT_FULL;
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_lock_opt_clear()
+ *
+ * @brief   Go back to the lock options given at init for calls the calling thread makes on a vault
+ *          instance. Must be called before a thread with its own options exits, so its slot can be
+ *          reused.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @return  OCKAM_ERR_NONE if the thread now uses the init options, including when it had none set.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_lock_opt_clear(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+    uint32_t thread_id = 0;
+    uint32_t i = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+        ret_val = ockam_kal_thread_id(&thread_id);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_kal_rwlock_write_lock(&(p_vault->opt_lock), OCKAM_KAL_OPT_BLOCKING, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < OCKAM_VAULT_CFG_LOCK_OPT_THREADS; i++) {
+            if(p_vault->opt[i].thread_id == thread_id) {
+                p_vault->opt[i].thread_id = 0;
+                break;
+            }
+        }
+
+        ockam_kal_rwlock_unlock(&(p_vault->opt_lock));
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        ockam_vault_random()
+ *
+ * @brief   Generate and return a random number
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_rand_num[out]     32-byte array to be filled with the random number
+ *
+ * @param   rand_num_size[in]   The size of the desired random number & buffer passed in. Used to verify
+ *                              correct size.
+ *
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_VAULT_INVALID_SIZE if size
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_random(OCKAM_VAULT_s *p_vault,
+                             uint8_t *p_rand_num, uint32_t rand_num_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The host library DRBGs, the TPM bus and the random */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* buffers have their own locks, so no need for the   */
+            break;                                              /* vault lock.                                        */
+        }
+
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+        if(rand_num_size < VAULT_RAND_CHUNK_SIZE) {             /* Small requests are served from memory              */
+            ret_val = vault_rand_buf_take(p_vault, p_rand_num, rand_num_size);
+            break;
+        }
+#endif
+
+        ret_val = vault_rand_gen(p_vault, p_rand_num, rand_num_size);
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_random_refill()
+ *
+ * @brief   Top up every random buffer of a vault instance so small ockam_vault_random() requests do
+ *          not have to wait on the TPM or DRBG. With OCKAM_VAULT_CFG_REFILL_EN set, the refill thread
+ *          of the instance calls this whenever a buffer drops to OCKAM_VAULT_CFG_RAND_BUF_LOW bytes.
+ *          Otherwise call it from a background thread or the async slow lane.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @return  OCKAM_ERR_NONE if every buffer is full. Also returned if random buffers are disabled.
+ *          OCKAM_ERR_VAULT_BUSY if a buffer is in use and the instance does not wait.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_random_refill(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+    uint32_t i = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+        for(i = 0; i < OCKAM_VAULT_CFG_RAND_BUF_COUNT; i++) {
+            ret_val = vault_rand_buf_refill(p_vault, &(p_vault->rand_buf[i]));
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_key_gen()
+ *
+ * @brief   Generate an ECC keypair and get the public key
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   key_type[in]        The type of key pair to generate.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_key_gen(OCKAM_VAULT_s *p_vault,
+                              OCKAM_VAULT_KEY_e key_type)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_lock(p_vault);                          /* Lock the vault instance and ensure it is idle      */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_KEY_ECDH]);
+        ret_val = vault_route_lock(p_vault, p_route);           /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->key_gen(p_route->p_ctx,
+                                                  key_type);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_key_gen(p_vault->p_tpm_ctx,
+                                              key_type);        /* Generate a key in the TPM                          */
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_key_gen(p_vault->p_host_ctx, /* Generate a key using the host library              */
+                                           key_type);
+#else
+#error "Ockam Vault: Key Gen Function Missing"
+#endif
+
+#if(VAULT_REFILL_KEYS_EN)
+        if((ret_val == OCKAM_ERR_NONE) && (key_type == OCKAM_VAULT_KEY_EPHEMERAL)) {
+            vault_refill_keys(p_vault);                         /* The key may have come from the pool                */
+        }
+#endif
+
+        ret_val = vault_unlock(p_vault, ret_val);               /* Unlock the vault after all operations finish       */
+    } while(0);
 
     return ret_val;
 }
@@ -256,6 +1001,8 @@ OCKAM_ERR ockam_vault_key_gen(OCKAM_VAULT_KEY_e key_type)
  *
  * @brief   Get a public key from the ATECC508A
  *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
  * @param   key_type[in]        OCKAM_VAULT_KEY_STATIC if requesting static public key
  *                              OCKAM_VAULT_KEY_EPHEMERAL if requesting the ephemeral public key
  *
@@ -268,40 +1015,52 @@ OCKAM_ERR ockam_vault_key_gen(OCKAM_VAULT_KEY_e key_type)
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_key_get_pub(OCKAM_VAULT_KEY_e key_type, uint8_t *p_key_pub, uint32_t key_pub_size)
+OCKAM_ERR ockam_vault_key_get_pub(OCKAM_VAULT_s *p_vault,
+                                  OCKAM_VAULT_KEY_e key_type,
+                                  uint8_t *p_key_pub, uint32_t key_pub_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
 
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* getting the public key                             */
+        ret_val = vault_lock(p_vault);                          /* Lock the vault instance and ensure it is idle      */
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
-            break;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_KEY_ECDH]);
+        ret_val = vault_route_lock(p_vault, p_route);           /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->key_get_pub(p_route->p_ctx,
+                                                      key_type,
+                                                      p_key_pub,
+                                                      key_pub_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_key_get_pub(p_vault->p_tpm_ctx,
+                                                  key_type,     /* Get a public key from the TPM                      */
+                                                  p_key_pub,
+                                                  key_pub_size);
+            ret_val = vault_tpm_unlock(ret_val);
         }
-
-#if(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_key_get_pub(key_type,         /* Get a public key from the TPM                      */
-                                              p_key_pub,
-                                              key_pub_size);
 #elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_key_get_pub(key_type,        /* Get a public key from the host library             */
+        ret_val = ockam_vault_host_key_get_pub(p_vault->p_host_ctx,
+                                               key_type,        /* Get a public key from the host library             */
                                                p_key_pub,
                                                key_pub_size);
 #else
 #error "Ockam Vault: Key Get Pub Function Missing"
 #endif
-    } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+        ret_val = vault_unlock(p_vault, ret_val);               /* Unlock the vault after all operations finish       */
+    } while(0);
 
     return ret_val;
 }
@@ -313,6 +1072,8 @@ OCKAM_ERR ockam_vault_key_get_pub(OCKAM_VAULT_KEY_e key_type, uint8_t *p_key_pub
  *
  * @brief   Write a private key to the Ockam Vault. Should typically be used for testing only.
  *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
  * @param   key_type[in]        OCKAM_VAULT_KEY_STATIC if requesting static public key
  *                              OCKAM_VAULT_KEY_EPHEMERAL if requesting the ephemeral public key
  *
@@ -325,39 +1086,49 @@ OCKAM_ERR ockam_vault_key_get_pub(OCKAM_VAULT_KEY_e key_type, uint8_t *p_key_pub
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_key_write(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_key_write(OCKAM_VAULT_s *p_vault,
+                                OCKAM_VAULT_KEY_e key_type,
                                 uint8_t *p_key_priv, uint32_t key_priv_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
 
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* performing the key write operation                 */
+        ret_val = vault_lock(p_vault);                          /* Lock the vault instance and ensure it is idle      */
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
-            break;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_KEY_ECDH]);
+        if(p_route->p_backend->key_write == 0) {                /* Not every backend can load a private key           */
+            ret_val = OCKAM_ERR_UNIMPLEMENTED;
+        } else {
+            ret_val = vault_route_lock(p_vault, p_route);       /* Takes the TPM bus lock if routed to the TPM        */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->key_write(p_route->p_ctx,
+                                                        key_type,
+                                                        p_key_priv,
+                                                        key_priv_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
         }
-
-#if(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
+#elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
         ret_val = OCKAM_ERR_UNIMPLEMENTED;
 #elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_key_write(key_type,          /* Perform the key write operation in the host library*/
+        ret_val = ockam_vault_host_key_write(p_vault->p_host_ctx,
+                                             key_type,          /* Perform the key write in the host library          */
                                              p_key_priv,
                                              key_priv_size);
 #else
 #error "Ockam Vault: Key Write Function missing"
 #endif
-    } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+        ret_val = vault_unlock(p_vault, ret_val);               /* Unlock the vault after all operations finish       */
+    } while(0);
 
     return ret_val;
 }
@@ -369,6 +1140,8 @@ OCKAM_ERR ockam_vault_key_write(OCKAM_VAULT_KEY_e key_type,
  *
  * @brief   Perform ECDH using the specified key
  *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
  * @param   key_type[in]        Specify which key type to use in the ECDH execution
  *
  * @param   p_pub_key[in]       Buffer with the public key
@@ -384,35 +1157,51 @@ OCKAM_ERR ockam_vault_key_write(OCKAM_VAULT_KEY_e key_type,
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_ecdh(OCKAM_VAULT_KEY_e key_type,
+OCKAM_ERR ockam_vault_ecdh(OCKAM_VAULT_s *p_vault,
+                           OCKAM_VAULT_KEY_e key_type,
                            uint8_t *p_key_pub,
                            uint32_t key_pub_size,
                            uint8_t *p_pms,
                            uint32_t pms_size)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
 
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* performing the ECDH operation                      */
+        ret_val = vault_lock(p_vault);                          /* Lock the vault instance and ensure it is idle      */
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
-            break;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_KEY_ECDH]);
+        ret_val = vault_route_lock(p_vault, p_route);           /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->ecdh(p_route->p_ctx,
+                                               key_type,
+                                               p_key_pub,
+                                               key_pub_size,
+                                               p_pms,
+                                               pms_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_ecdh(p_vault->p_tpm_ctx,  /* Perform an ECDH operation in a TPM                 */
+                                           key_type,
+                                           p_key_pub,
+                                           key_pub_size,
+                                           p_pms,
+                                           pms_size);
+            ret_val = vault_tpm_unlock(ret_val);
         }
-
-#if(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_ecdh(key_type,                /* Perform an ECDH operation in a TPM                 */
-                                       p_key_pub,
-                                       key_pub_size,
-                                       p_pms,
-                                       pms_size);
 #elif(OCKAM_VAULT_CFG_KEY_ECDH & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_ecdh(key_type,               /* Perform an ECDH operation in the host library      */
+        ret_val = ockam_vault_host_ecdh(p_vault->p_host_ctx,    /* Perform an ECDH operation in the host library      */
+                                        key_type,
                                         p_key_pub,
                                         key_pub_size,
                                         p_pms,
@@ -420,12 +1209,9 @@ OCKAM_ERR ockam_vault_ecdh(OCKAM_VAULT_KEY_e key_type,
 #else
 #error "Ockam Vault: ECDH Function missing"
 #endif
-    } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+        ret_val = vault_unlock(p_vault, ret_val);               /* Unlock the vault after all operations finish       */
+    } while(0);
 
     return ret_val;
 }
@@ -433,60 +1219,45 @@ OCKAM_ERR ockam_vault_ecdh(OCKAM_VAULT_KEY_e key_type,
 
 /**
  ********************************************************************************************************
- *                                          ockam_vault_sha256()
- *
- * @brief   Perform a SHA256 operation on the message passed in.
+ *                                     ockam_vault_key_pool_fill()
  *
- * @param   p_msg[in]       The message to run through SHA256
- *
- * @param   msg_size[in]    The size of the message to be run through SHA256
+ * @brief   Generate keys ahead of time for ephemeral key generation and new key handles, which then
+ *          take a ready key instead of generating one inline. Call from a background thread or the
+ *          async slow lane while the vault is idle. Does not take the vault lock, so handshakes can
+ *          keep taking keys while the pool is filled.
  *
- * @param   p_digest[out]   Buffer to place the resulting SHA256 digest in
+ * @param   p_vault[in]         Handle of the vault instance to use
  *
- * @param   digest_size[in] The size of the digest buffer
+ * @return  OCKAM_ERR_NONE once the pool is full.
+ *          OCKAM_ERR_UNIMPLEMENTED if there is no host library. TPM keys are generated in
+ *          their fixed key slots.
  *
- * @return  OCKAM_ERR_NONE on success
+ * @note    With OCKAM_VAULT_CFG_REFILL_EN set, each vault instance calls this from its own refill
+ *          thread whenever the pool drops to OCKAM_VAULT_CFG_KEY_POOL_LOW keys.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_sha256(uint8_t *p_msg, uint16_t msg_size,
-                             uint8_t *p_digest, uint8_t digest_size)
+OCKAM_ERR ockam_vault_key_pool_fill(OCKAM_VAULT_s *p_vault)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
 
-    do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* performing the SHA256 operation                    */
-            break;
-        }
-
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
-            break;
-        }
 
-        if(digest_size != VAULT_SHA256_DIGEST_SIZE) {           /* Digest buffer must always be 32 bytes              */
-            ret_val = OCKAM_ERR_INVALID_SIZE;
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The pool has its own lock, key generation only     */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* uses the thread's DRBG                             */
             break;
         }
 
-#if(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_sha256(p_msg, msg_size,       /* Perform SHA256 operation in the TPM                */
-                                         p_digest, digest_size);
-#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_sha256(p_msg, msg_size,      /* Perform SHA256 operation in the host library       */
-                                          p_digest, digest_size);
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_key_pool_fill(p_vault->p_host_ctx);
 #else
-#error "Ockam Vault: SHA256 Function missing"
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;
 #endif
     } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+    vault_leave(p_entered);
 
     return ret_val;
 }
@@ -494,282 +1265,4131 @@ OCKAM_ERR ockam_vault_sha256(uint8_t *p_msg, uint16_t msg_size,
 
 /**
  ********************************************************************************************************
- *                                          ockam_vault_hkdf()
- *
- * @brief   Perform HKDF operation on the input key material and optional salt and info. Place the
- *          result in the output buffer.
- *
- * @param   p_salt[in]          Buffer for the Ockam salt value
+ *                                   ockam_vault_key_handle_create()
  *
- * @param   salt_size[in]       Size of the Ockam salt value
- *
- * @param   p_ikm[in]           Buffer with the input key material for HKDF
- *
- * @param   ikm_size[in]        Size of the input key material
- *
- * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
- *
- * @param   info_size[in]       Size of the optional context specific info.
+ * @brief   Take a new, empty key handle from the key table of a vault instance. Every handle
+ *          holds its own keypair, so any number of handshakes can each keep an ephemeral key.
+ *          Key handles are held by the host library. The TPM only has the fixed static and
+ *          ephemeral key slots used by ockam_vault_key_gen().
  *
- * @param   p_out[out]          Buffer for the output of the HKDF operation
+ * @param   p_vault[in]         Handle of the vault instance to use
  *
- * @param   out_size[in]        Size of the HKDF output buffer
+ * @param   p_key[out]          Returns the key handle
  *
- * @return  OCKAM_ERR_NONE if successful.
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_UNIMPLEMENTED if the vault was built
+ *          without the host library.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_hkdf(uint8_t *p_salt,
-                           uint32_t salt_size,
-                           uint8_t *p_ikm,
-                           uint32_t ikm_size,
-                           uint8_t *p_info,
-                           uint32_t info_size,
-                           uint8_t *p_out,
-                           uint32_t out_size)
+OCKAM_ERR ockam_vault_key_handle_create(OCKAM_VAULT_s *p_vault,
+                                        OCKAM_VAULT_KEY_s **p_key)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
 
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* performing the HKDF operation                      */
-            break;
-        }
-
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
+        ret_val = vault_enter(p_vault, &p_entered);             /* The key table has its own lock, key generation and */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* ECDH only use the thread's DRBG                    */
             break;
         }
 
-#if(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_hkdf(p_salt, salt_size,       /* Perform an HKDF operation in a TPM                 */
-                                       p_ikm, ikm_size,
-                                       p_info, info_size,
-                                       p_out, out_size);
-#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_hkdf(p_salt, salt_size,      /* Perform an HKDF operation in the host library      */
-                                        p_ikm, ikm_size,
-                                        p_info, info_size,
-                                        p_out, out_size);
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+                                                                /* Take a key from the host key table                 */
+        ret_val = ockam_vault_host_key_handle_create(p_vault->p_host_ctx,
+                                                     (void**) p_key);
 #else
-#error "Ockam Vault: HKDF Function missing"
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;                      /* TPM keys are limited to the fixed key slots        */
 #endif
     } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_key_handle_generate()
+ *
+ * @brief   Generate a Curve25519 keypair into a key handle, replacing any key it held
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_key_handle_create()
+ *
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_UNIMPLEMENTED if the vault was built
+ *          without the host library.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_key_handle_generate(OCKAM_VAULT_s *p_vault,
+                                          OCKAM_VAULT_KEY_s *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The key table has its own lock, key generation and */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* ECDH only use the thread's DRBG                    */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+                                                                /* Generate a key using the host library              */
+        ret_val = ockam_vault_host_key_handle_generate(p_vault->p_host_ctx,
+                                                       p_key);
+#if(VAULT_REFILL_KEYS_EN)
+        if(ret_val == OCKAM_ERR_NONE) {
+            vault_refill_keys(p_vault);
+        }
+#endif
+#else
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;                      /* TPM keys are limited to the fixed key slots        */
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_key_handle_import()
+ *
+ * @brief   Load a private key into a key handle and derive its public key
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_key_handle_create()
+ *
+ * @param   p_priv_key[in]      Buffer with the little endian private key
+ *
+ * @param   priv_key_size[in]   Size of the private key
+ *
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_UNIMPLEMENTED if the vault was built
+ *          without the host library.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_key_handle_import(OCKAM_VAULT_s *p_vault,
+                                        OCKAM_VAULT_KEY_s *p_key,
+                                        uint8_t *p_priv_key, uint32_t priv_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The key table has its own lock, key generation and */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* ECDH only use the thread's DRBG                    */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+                                                                /* Load the key in the host library                   */
+        ret_val = ockam_vault_host_key_handle_import(p_vault->p_host_ctx,
+                                                     p_key,
+                                                     p_priv_key, priv_key_size);
+#else
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;                      /* TPM keys are limited to the fixed key slots        */
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_key_handle_get_pub()
+ *
+ * @brief   Get the public key of a key handle
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_key_handle_create()
+ *
+ * @param   p_pub_key[out]      Buffer to place the public key in
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_UNIMPLEMENTED if the vault was built
+ *          without the host library.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_key_handle_get_pub(OCKAM_VAULT_s *p_vault,
+                                         OCKAM_VAULT_KEY_s *p_key,
+                                         uint8_t *p_pub_key, uint32_t pub_key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The key table has its own lock, key generation and */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* ECDH only use the thread's DRBG                    */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+                                                                /* Get a public key from the host library             */
+        ret_val = ockam_vault_host_key_handle_get_pub(p_vault->p_host_ctx,
+                                                      p_key,
+                                                      p_pub_key, pub_key_size);
+#else
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;                      /* TPM keys are limited to the fixed key slots        */
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_key_handle_ecdh()
+ *
+ * @brief   Perform ECDH using the private key of a key handle
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_key_handle_create()
+ *
+ * @param   p_pub_key[in]       Buffer with the public key of the peer
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_pms[out]          Pre-master secret from ECDH
+ *
+ * @param   pms_size[in]        Size of the pre-master secret buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_UNIMPLEMENTED if the vault was built
+ *          without the host library.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_key_handle_ecdh(OCKAM_VAULT_s *p_vault,
+                                      OCKAM_VAULT_KEY_s *p_key,
+                                      uint8_t *p_pub_key, uint32_t pub_key_size,
+                                      uint8_t *p_pms, uint32_t pms_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The key table has its own lock, key generation and */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* ECDH only use the thread's DRBG                    */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+                                                                /* Perform ECDH in the host library                   */
+        ret_val = ockam_vault_host_key_handle_ecdh(p_vault->p_host_ctx,
+                                                   p_key,
+                                                   p_pub_key, pub_key_size,
+                                                   p_pms, pms_size);
+#else
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;                      /* TPM keys are limited to the fixed key slots        */
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_key_handle_destroy()
+ *
+ * @brief   Clear the key material of a key handle and return it to the key table. The handle must
+ *          not be used afterwards.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Key handle from ockam_vault_key_handle_create()
+ *
+ * @return  OCKAM_ERR_NONE if successful. OCKAM_ERR_UNIMPLEMENTED if the vault was built
+ *          without the host library.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_key_handle_destroy(OCKAM_VAULT_s *p_vault,
+                                         OCKAM_VAULT_KEY_s *p_key)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* The key table has its own lock, key generation and */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* ECDH only use the thread's DRBG                    */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+                                                                /* Return the key to the host key table               */
+        ret_val = ockam_vault_host_key_handle_destroy(p_vault->p_host_ctx,
+                                                      p_key);
+#else
+        ret_val = OCKAM_ERR_UNIMPLEMENTED;                      /* TPM keys are limited to the fixed key slots        */
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_sha256()
+ *
+ * @brief   Perform a SHA256 operation on the message passed in.
+ *
+ * @param   p_vault[in]     Handle of the vault instance to use
+ *
+ * @param   p_msg[in]       The message to run through SHA256
+ *
+ * @param   msg_size[in]    The size of the message to be run through SHA256
+ *
+ * @param   p_digest[out]   Buffer to place the resulting SHA256 digest in
+ *
+ * @param   digest_size[in] The size of the digest buffer
+ *
+ * @return  OCKAM_ERR_NONE on success
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_sha256(OCKAM_VAULT_s *p_vault,
+                             uint8_t *p_msg, uint32_t msg_size,
+                             uint8_t *p_digest, uint8_t digest_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(digest_size != VAULT_SHA256_DIGEST_SIZE) {           /* Digest buffer must always be 32 bytes              */
+            ret_val = OCKAM_ERR_INVALID_SIZE;
+            break;
+        }
+
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Only ensure the instance is valid and idle.        */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = vault_route_get(p_vault, VAULT_OP_SHA256, msg_size);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock_fast(p_vault, &p_route); /* Takes the TPM bus if free, else uses the host      */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->sha256(p_route->p_ctx,
+                                                     p_msg, msg_size,
+                                                     p_digest, digest_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_sha256(p_vault->p_tpm_ctx,
+                                             p_msg, msg_size,   /* Perform SHA256 operation in the TPM                */
+                                             p_digest, digest_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_sha256(p_vault->p_host_ctx,  /* Perform SHA256 operation in the host library       */
+                                          p_msg, msg_size,
+                                          p_digest, digest_size);
+#else
+#error "Ockam Vault: SHA256 Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_sha256_ctx_init()
+ *
+ * @brief   Start a streaming SHA-256 digest. Messages of any length can then be hashed a piece at a
+ *          time. The context must be released with ockam_vault_sha256_ctx_free() whether or not the
+ *          digest is finished.
+ *
+ * @param   p_vault[in]     Handle of the vault instance to use
+ *
+ * @param   p_ctx[out]      Returns the handle for the streaming digest
+ *
+ * @return  OCKAM_ERR_NONE on success
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_sha256_ctx_init(OCKAM_VAULT_s *p_vault,
+                                      OCKAM_VAULT_SHA256_CTX_s **p_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+    OCKAM_VAULT_SHA256_CTX_s *p_new = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(OCKAM_VAULT_SHA256_CTX_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_new->p_vault = p_vault;
+        p_new->p_backend_ctx = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_SHA256]);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock(p_vault, p_route);       /* Takes the TPM bus lock if routed to the TPM        */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->sha256_ctx_init(p_route->p_ctx,
+                                                              &(p_new->p_backend_ctx));
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+        p_new->p_route = p_route;                               /* Later calls go to the same backend                 */
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_sha256_ctx_init(p_vault->p_tpm_ctx,
+                                                      &(p_new->p_backend_ctx));
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_sha256_ctx_init(p_vault->p_host_ctx,
+                                                   &(p_new->p_backend_ctx));
+#else
+#error "Ockam Vault: SHA256 Function missing"
+#endif
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_mem_free(p_new);
+            break;
+        }
+
+        *p_ctx = p_new;
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_sha256_ctx_update()
+ *
+ * @brief   Add the next part of the message to a streaming SHA-256 digest
+ *
+ * @param   p_ctx[in]       Handle of the streaming digest
+ *
+ * @param   p_msg[in]       The next part of the message
+ *
+ * @param   msg_size[in]    Size of this part of the message
+ *
+ * @return  OCKAM_ERR_NONE on success
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_sha256_ctx_update(OCKAM_VAULT_SHA256_CTX_s *p_ctx,
+                                        uint8_t *p_msg, uint32_t msg_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_ctx->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(p_ctx->p_vault, p_route);    /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->sha256_ctx_update(p_ctx->p_backend_ctx,
+                                                            p_msg, msg_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_ctx->p_vault);               /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_sha256_ctx_update(p_ctx->p_backend_ctx,
+                                                        p_msg, msg_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_sha256_ctx_update(p_ctx->p_backend_ctx,
+                                                     p_msg, msg_size);
+#else
+#error "Ockam Vault: SHA256 Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_sha256_ctx_finish()
+ *
+ * @brief   Output the digest of everything passed to a streaming SHA-256 digest
+ *
+ * @param   p_ctx[in]       Handle of the streaming digest
+ *
+ * @param   p_digest[out]   Buffer to place the resulting SHA256 digest in
+ *
+ * @param   digest_size[in] The size of the digest buffer
+ *
+ * @return  OCKAM_ERR_NONE on success
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_sha256_ctx_finish(OCKAM_VAULT_SHA256_CTX_s *p_ctx,
+                                        uint8_t *p_digest, uint8_t digest_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(digest_size != VAULT_SHA256_DIGEST_SIZE) {           /* Digest buffer must always be 32 bytes              */
+            ret_val = OCKAM_ERR_INVALID_SIZE;
+            break;
+        }
+
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_ctx->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(p_ctx->p_vault, p_route);    /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->sha256_ctx_finish(p_ctx->p_backend_ctx,
+                                                            p_digest, digest_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_ctx->p_vault);               /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_sha256_ctx_finish(p_ctx->p_backend_ctx,
+                                                        p_digest, digest_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_sha256_ctx_finish(p_ctx->p_backend_ctx,
+                                                     p_digest, digest_size);
+#else
+#error "Ockam Vault: SHA256 Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_sha256_ctx_free()
+ *
+ * @brief   Release a streaming SHA-256 digest, whether or not it was finished
+ *
+ * @param   p_ctx[in]       Handle of the streaming digest
+ *
+ * @return  OCKAM_ERR_NONE on success
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_sha256_ctx_free(OCKAM_VAULT_SHA256_CTX_s *p_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(0, p_route);                 /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->sha256_ctx_free(p_ctx->p_backend_ctx);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(0);                            /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_sha256_ctx_free(p_ctx->p_backend_ctx);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_SHA256 & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_sha256_ctx_free(p_ctx->p_backend_ctx);
+#else
+#error "Ockam Vault: SHA256 Function missing"
+#endif
+        t_ret_val = ockam_mem_free(p_ctx);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = t_ret_val;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_hkdf()
+ *
+ * @brief   Perform HKDF operation on the input key material and optional salt and info. Place the
+ *          result in the output buffer.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_salt[in]          Buffer for the Ockam salt value
+ *
+ * @param   salt_size[in]       Size of the Ockam salt value
+ *
+ * @param   p_ikm[in]           Buffer with the input key material for HKDF
+ *
+ * @param   ikm_size[in]        Size of the input key material
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info.
+ *
+ * @param   p_out[out]          Buffer for the output of the HKDF operation
+ *
+ * @param   out_size[in]        Size of the HKDF output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_hkdf(OCKAM_VAULT_s *p_vault,
+                           uint8_t *p_salt,
+                           uint32_t salt_size,
+                           uint8_t *p_ikm,
+                           uint32_t ikm_size,
+                           uint8_t *p_info,
+                           uint32_t info_size,
+                           uint8_t *p_out,
+                           uint32_t out_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Only ensure the instance is valid and idle.        */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = vault_route_get(p_vault, VAULT_OP_HKDF, ikm_size);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock_fast(p_vault, &p_route); /* Takes the TPM bus if free, else uses the host      */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->hkdf(p_route->p_ctx,
+                                                   p_salt, salt_size,
+                                                   p_ikm, ikm_size,
+                                                   p_info, info_size,
+                                                   p_out, out_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_hkdf(p_vault->p_tpm_ctx,  /* Perform an HKDF operation in a TPM                 */
+                                           p_salt, salt_size,
+                                           p_ikm, ikm_size,
+                                           p_info, info_size,
+                                           p_out, out_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_hkdf(p_vault->p_host_ctx,    /* Perform an HKDF operation in the host library      */
+                                        p_salt, salt_size,
+                                        p_ikm, ikm_size,
+                                        p_info, info_size,
+                                        p_out, out_size);
+#else
+#error "Ockam Vault: HKDF Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_hkdf_extract()
+ *
+ * @brief   Run the HKDF extract stage once and keep the pseudo-random key. Any number of outputs
+ *          can then be derived from it with ockam_vault_hkdf_expand(). The key must be released
+ *          with ockam_vault_hkdf_prk_free().
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_prk[out]          Returns the handle for the pseudo-random key
+ *
+ * @param   p_salt[in]          Buffer for the Ockam salt value
+ *
+ * @param   salt_size[in]       Size of the Ockam salt value
+ *
+ * @param   p_ikm[in]           Buffer with the input key material for HKDF
+ *
+ * @param   ikm_size[in]        Size of the input key material
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_hkdf_extract(OCKAM_VAULT_s *p_vault,
+                                   OCKAM_VAULT_HKDF_PRK_s **p_prk,
+                                   uint8_t *p_salt, uint32_t salt_size,
+                                   uint8_t *p_ikm, uint32_t ikm_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+    OCKAM_VAULT_HKDF_PRK_s *p_new = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_prk == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(OCKAM_VAULT_HKDF_PRK_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_new->p_vault = p_vault;
+        p_new->p_backend_prk = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_HKDF]);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock(p_vault, p_route);       /* Takes the TPM bus lock if routed to the TPM        */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->hkdf_extract(p_route->p_ctx,
+                                                           &(p_new->p_backend_prk),
+                                                           p_salt, salt_size,
+                                                           p_ikm, ikm_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+        p_new->p_route = p_route;                               /* Expand on the backend holding the key              */
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_hkdf_extract(p_vault->p_tpm_ctx,
+                                                   &(p_new->p_backend_prk),
+                                                   p_salt, salt_size,
+                                                   p_ikm, ikm_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_hkdf_extract(p_vault->p_host_ctx,
+                                                &(p_new->p_backend_prk),
+                                                p_salt, salt_size,
+                                                p_ikm, ikm_size);
+#else
+#error "Ockam Vault: HKDF Function missing"
+#endif
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_mem_free(p_new);
+            break;
+        }
+
+        *p_prk = p_new;
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_hkdf_expand()
+ *
+ * @brief   Run the HKDF expand stage from a pseudo-random key kept by ockam_vault_hkdf_extract()
+ *
+ * @param   p_prk[in]           Handle for the pseudo-random key
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info.
+ *
+ * @param   p_out[out]          Buffer for the output of the HKDF operation
+ *
+ * @param   out_size[in]        Size of the HKDF output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_hkdf_expand(OCKAM_VAULT_HKDF_PRK_s *p_prk,
+                                  uint8_t *p_info, uint32_t info_size,
+                                  uint8_t *p_out, uint32_t out_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_prk == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_prk->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_prk->p_route;
+        ret_val = vault_route_lock(p_prk->p_vault, p_route);    /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->hkdf_expand(p_prk->p_backend_prk,
+                                                      p_info, info_size,
+                                                      p_out, out_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_prk->p_vault);               /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_hkdf_expand(p_prk->p_backend_prk,
+                                                  p_info, info_size,
+                                                  p_out, out_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_hkdf_expand(p_prk->p_backend_prk,
+                                               p_info, info_size,
+                                               p_out, out_size);
+#else
+#error "Ockam Vault: HKDF Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_hkdf_prk_free()
+ *
+ * @brief   Clear and release a pseudo-random key kept by ockam_vault_hkdf_extract()
+ *
+ * @param   p_prk[in]           Handle for the pseudo-random key
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_hkdf_prk_free(OCKAM_VAULT_HKDF_PRK_s *p_prk)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_prk == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_prk->p_route;
+        ret_val = vault_route_lock(0, p_route);                 /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->hkdf_prk_free(p_prk->p_backend_prk);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(0);                            /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_hkdf_prk_free(p_prk->p_backend_prk);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_HKDF & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_hkdf_prk_free(p_prk->p_backend_prk);
+#else
+#error "Ockam Vault: HKDF Function missing"
+#endif
+        t_ret_val = ockam_mem_free(p_prk);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = t_ret_val;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_aes_gcm_encrypt()
+ *
+ * @brief   AES GCM function for encrypt. Depending on underlying implementation may support 128, 192
+ *          and/or 256.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data (can be NULL)
+ *
+ * @param   aad_size[in]        Size of the additional data (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the input data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can be the input
+ *                              buffer to operate in place, but must not partially overlap it.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_encrypt(OCKAM_VAULT_s *p_vault,
+                                      uint8_t *p_key, uint32_t key_size,
+                                      uint8_t *p_iv, uint32_t iv_size,
+                                      uint8_t *p_aad, uint32_t aad_size,
+                                      uint8_t *p_tag, uint32_t tag_size,
+                                      uint8_t *p_input, uint32_t input_size,
+                                      uint8_t *p_output, uint32_t output_size)
+{
+    return ockam_vault_aes_gcm(p_vault,
+                               OCKAM_VAULT_AES_GCM_MODE_ENCRYPT,
+                               p_key, key_size,
+                               p_iv, iv_size,
+                               p_aad, aad_size,
+                               p_tag, tag_size,
+                               p_input, input_size,
+                               p_output, output_size);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                ockam_vault_aes_gcm_decrypt()
+ *
+ * @brief   AES GCM function for decrypt. Depending on underlying implementation may support 128, 192
+ *          and/or 256.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data (can be NULL)
+ *
+ * @param   aad_size[in]        Size of the additional data (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the input data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can be the input
+ *                              buffer to operate in place, but must not partially overlap it.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_decrypt(OCKAM_VAULT_s *p_vault,
+                                      uint8_t *p_key, uint32_t key_size,
+                                      uint8_t *p_iv, uint32_t iv_size,
+                                      uint8_t *p_aad, uint32_t aad_size,
+                                      uint8_t *p_tag, uint32_t tag_size,
+                                      uint8_t *p_input, uint32_t input_size,
+                                      uint8_t *p_output, uint32_t output_size)
+{
+    return ockam_vault_aes_gcm(p_vault,
+                               OCKAM_VAULT_AES_GCM_MODE_DECRYPT,
+                               p_key, key_size,
+                               p_iv, iv_size,
+                               p_aad, aad_size,
+                               p_tag, tag_size,
+                               p_input, input_size,
+                               p_output, output_size);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_aes_gcm()
+ *
+ * @brief   AES GCM function for both encrypt and decrypt Depending on underlying implementation may
+ *          support 128, 192 and/or 256.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data (can be NULL)
+ *
+ * @param   aad_size[in]        Size of the additional data (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the input data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can be the input
+ *                              buffer to operate in place, but must not partially overlap it.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm(OCKAM_VAULT_s *p_vault,
+                              OCKAM_VAULT_AES_GCM_MODE_e mode,
+                              uint8_t *p_key, uint32_t key_size,
+                              uint8_t *p_iv, uint32_t iv_size,
+                              uint8_t *p_aad, uint32_t aad_size,
+                              uint8_t *p_tag, uint32_t tag_size,
+                              uint8_t *p_input, uint32_t input_size,
+                              uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Only ensure the instance is valid and idle.        */
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = vault_route_get(p_vault, VAULT_OP_AES_GCM, input_size);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock_fast(p_vault, &p_route); /* Takes the TPM bus if free, else uses the host      */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->aes_gcm(p_route->p_ctx,
+                                                      mode,
+                                                      p_key, key_size,
+                                                      p_iv, iv_size,
+                                                      p_aad, aad_size,
+                                                      p_tag, tag_size,
+                                                      p_input, input_size,
+                                                      p_output, output_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, (p_output != p_input)));
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm(p_vault->p_tpm_ctx,
+                                              mode,             /* Perform the AES GCM operation in the TPM           */
+                                              p_key, key_size,
+                                              p_iv, iv_size,
+                                              p_aad, aad_size,
+                                              p_tag, tag_size,
+                                              p_input, input_size,
+                                              p_output, output_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm(p_vault->p_host_ctx, /* Perform the AES GCM operation on the host          */
+                                           mode,
+                                           p_key, key_size,
+                                           p_iv, iv_size,
+                                           p_aad, aad_size,
+                                           p_tag, tag_size,
+                                           p_input, input_size,
+                                           p_output, output_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_aes_gcm_encrypt_batch()
+ *
+ * @brief   AES GCM encrypt of a batch of records that share one key.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Buffer for the AES Key shared by every record
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_recs[in,out]      Array of records. Each holds the IV, optional additional data, tag,
+ *                              input and output for one AES GCM operation.
+ *
+ * @param   rec_count[in]       Number of records in the array
+ *
+ * @return  OCKAM_ERR_NONE if every record was successful. Processing stops at the first record that
+ *          fails and its error is returned.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_encrypt_batch(OCKAM_VAULT_s *p_vault,
+                                            uint8_t *p_key, uint32_t key_size,
+                                            OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count)
+{
+    return ockam_vault_aes_gcm_batch(p_vault,
+                                     OCKAM_VAULT_AES_GCM_MODE_ENCRYPT,
+                                     p_key, key_size,
+                                     p_recs, rec_count);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_aes_gcm_decrypt_batch()
+ *
+ * @brief   AES GCM decrypt of a batch of records that share one key.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Buffer for the AES Key shared by every record
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_recs[in,out]      Array of records. Each holds the IV, optional additional data, tag,
+ *                              input and output for one AES GCM operation.
+ *
+ * @param   rec_count[in]       Number of records in the array
+ *
+ * @return  OCKAM_ERR_NONE if every record was successful. Processing stops at the first record that
+ *          fails and its error is returned.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_decrypt_batch(OCKAM_VAULT_s *p_vault,
+                                            uint8_t *p_key, uint32_t key_size,
+                                            OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count)
+{
+    return ockam_vault_aes_gcm_batch(p_vault,
+                                     OCKAM_VAULT_AES_GCM_MODE_DECRYPT,
+                                     p_key, key_size,
+                                     p_recs, rec_count);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_aes_gcm_batch()
+ *
+ * @brief   AES GCM encrypt or decrypt of a batch of records that share one key. The backend lock is
+ *          taken and the key schedule is set up once for the whole batch instead of once per record.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key shared by every record
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_recs[in,out]      Array of records. Each holds the IV, optional additional data, tag,
+ *                              input and output for one AES GCM operation.
+ *
+ * @param   rec_count[in]       Number of records in the array
+ *
+ * @return  OCKAM_ERR_NONE if every record was successful. Processing stops at the first record that
+ *          fails and its error is returned.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_batch(OCKAM_VAULT_s *p_vault,
+                                    OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                    uint8_t *p_key, uint32_t key_size,
+                                    OCKAM_VAULT_AES_GCM_REC_s *p_recs, uint32_t rec_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+    uint32_t size = 0;
+    uint8_t retry = 1;
+    uint32_t i;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if((p_recs == 0) || (rec_count == 0)) {                 /* Need at least one record to process                */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        for(i = 0; i < rec_count; i++) {                        /* Route on the data volume of the whole batch        */
+            size += p_recs[i].input_size;
+            if(p_recs[i].p_output == p_recs[i].p_input) {       /* A failed in place batch may have overwritten its   */
+                retry = 0;                                      /* input, so it can't be rerun on the host            */
+            }
+        }
+
+        p_route = vault_route_get(p_vault, VAULT_OP_AES_GCM, size);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock_fast(p_vault, &p_route); /* One TPM bus lock for the entire batch              */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->aes_gcm_batch(p_route->p_ctx,
+                                                            mode,
+                                                            p_key, key_size,
+                                                            p_recs, rec_count);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, retry));
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* One TPM bus lock for the entire batch              */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_batch(p_vault->p_tpm_ctx,
+                                                    mode,
+                                                    p_key, key_size,
+                                                    p_recs, rec_count);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_batch(p_vault->p_host_ctx,
+                                                 mode,
+                                                 p_key, key_size,
+                                                 p_recs, rec_count);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_aes_gcm_encrypt_iov()
+ *
+ * @brief   AES GCM encrypt of scatter/gather buffers. Encrypts straight from a chain of buffers without
+ *          copying them into one contiguous staging buffer first.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Fragments of the additional data (can be NULL)
+ *
+ * @param   aad_count[in]       Number of additional data fragments (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Fragments of the data to encrypt or decrypt
+ *
+ * @param   input_count[in]     Number of input fragments
+ *
+ * @param   p_output[out]       Fragments for the result. Fragment boundaries do not need to line
+ *                              up with the input, but the total size must match the input. A
+ *                              fragment can be the matching input fragment to operate in place.
+ *
+ * @param   output_count[in]    Number of output fragments
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_encrypt_iov(OCKAM_VAULT_s *p_vault,
+                                          uint8_t *p_key, uint32_t key_size,
+                                          uint8_t *p_iv, uint32_t iv_size,
+                                          OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                          uint8_t *p_tag, uint32_t tag_size,
+                                          OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                          OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count)
+{
+    return ockam_vault_aes_gcm_iov(p_vault,
+                                   OCKAM_VAULT_AES_GCM_MODE_ENCRYPT,
+                                   p_key, key_size,
+                                   p_iv, iv_size,
+                                   p_aad, aad_count,
+                                   p_tag, tag_size,
+                                   p_input, input_count,
+                                   p_output, output_count);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                  ockam_vault_aes_gcm_decrypt_iov()
+ *
+ * @brief   AES GCM decrypt of scatter/gather buffers. Decrypts straight into a chain of buffers without
+ *          a contiguous staging buffer.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Fragments of the additional data (can be NULL)
+ *
+ * @param   aad_count[in]       Number of additional data fragments (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Fragments of the data to encrypt or decrypt
+ *
+ * @param   input_count[in]     Number of input fragments
+ *
+ * @param   p_output[out]       Fragments for the result. Fragment boundaries do not need to line
+ *                              up with the input, but the total size must match the input. A
+ *                              fragment can be the matching input fragment to operate in place.
+ *
+ * @param   output_count[in]    Number of output fragments
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_decrypt_iov(OCKAM_VAULT_s *p_vault,
+                                          uint8_t *p_key, uint32_t key_size,
+                                          uint8_t *p_iv, uint32_t iv_size,
+                                          OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                          uint8_t *p_tag, uint32_t tag_size,
+                                          OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                          OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count)
+{
+    return ockam_vault_aes_gcm_iov(p_vault,
+                                   OCKAM_VAULT_AES_GCM_MODE_DECRYPT,
+                                   p_key, key_size,
+                                   p_iv, iv_size,
+                                   p_aad, aad_count,
+                                   p_tag, tag_size,
+                                   p_input, input_count,
+                                   p_output, output_count);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_aes_gcm_iov()
+ *
+ * @brief   AES GCM encrypt or decrypt of scatter/gather buffers
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Fragments of the additional data (can be NULL)
+ *
+ * @param   aad_count[in]       Number of additional data fragments (set to 0 if p_aad is NULL)
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Fragments of the data to encrypt or decrypt
+ *
+ * @param   input_count[in]     Number of input fragments
+ *
+ * @param   p_output[out]       Fragments for the result. Fragment boundaries do not need to line
+ *                              up with the input, but the total size must match the input. A
+ *                              fragment can be the matching input fragment to operate in place.
+ *
+ * @param   output_count[in]    Number of output fragments
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_iov(OCKAM_VAULT_s *p_vault,
+                                  OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                  uint8_t *p_key, uint32_t key_size,
+                                  uint8_t *p_iv, uint32_t iv_size,
+                                  OCKAM_VAULT_IOVEC_s *p_aad, uint32_t aad_count,
+                                  uint8_t *p_tag, uint32_t tag_size,
+                                  OCKAM_VAULT_IOVEC_s *p_input, uint32_t input_count,
+                                  OCKAM_VAULT_IOVEC_s *p_output, uint32_t output_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+    uint32_t size = 0;
+    uint8_t retry = 1;
+    uint32_t i;
+    uint32_t j;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+                                                                /* Route on the total size of the input fragments     */
+        for(i = 0; (p_input != 0) && (i < input_count); i++) {
+            size += p_input[i].size;
+                                                                /* Only rerun on the host if no fragment is worked    */
+                                                                /* on in place                                        */
+            for(j = 0; (p_output != 0) && (j < output_count); j++) {
+                if(p_output[j].p_buf == p_input[i].p_buf) {
+                    retry = 0;
+                }
+            }
+        }
+
+        p_route = vault_route_get(p_vault, VAULT_OP_AES_GCM, size);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock_fast(p_vault, &p_route); /* Takes the TPM bus if free, else uses the host      */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->aes_gcm_iov(p_route->p_ctx,
+                                                          mode,
+                                                          p_key, key_size,
+                                                          p_iv, iv_size,
+                                                          p_aad, aad_count,
+                                                          p_tag, tag_size,
+                                                          p_input, input_count,
+                                                          p_output, output_count);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, retry));
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_iov(p_vault->p_tpm_ctx,
+                                                  mode,
+                                                  p_key, key_size,
+                                                  p_iv, iv_size,
+                                                  p_aad, aad_count,
+                                                  p_tag, tag_size,
+                                                  p_input, input_count,
+                                                  p_output, output_count);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_iov(p_vault->p_host_ctx,
+                                               mode,
+                                               p_key, key_size,
+                                               p_iv, iv_size,
+                                               p_aad, aad_count,
+                                               p_tag, tag_size,
+                                               p_input, input_count,
+                                               p_output, output_count);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_aes_gcm_ctx_init()
+ *
+ * @brief   Start a streaming AES GCM operation. Large payloads can then be encrypted or decrypted
+ *          a piece at a time with constant memory. The context must be released with
+ *          ockam_vault_aes_gcm_ctx_free() whether or not the operation finishes.
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_ctx[out]          Returns the handle for the streaming operation
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_init(OCKAM_VAULT_s *p_vault,
+                                       OCKAM_VAULT_AES_GCM_CTX_s **p_ctx,
+                                       OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                       uint8_t *p_key, uint32_t key_size,
+                                       uint8_t *p_iv, uint32_t iv_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+    OCKAM_VAULT_AES_GCM_CTX_s *p_new = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(OCKAM_VAULT_AES_GCM_CTX_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_new->p_vault = p_vault;
+        p_new->p_backend_ctx = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_AES_GCM]);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock(p_vault, p_route);       /* Takes the TPM bus lock if routed to the TPM        */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->aes_gcm_ctx_init(p_route->p_ctx,
+                                                               &(p_new->p_backend_ctx),
+                                                               mode,
+                                                               p_key, key_size,
+                                                               p_iv, iv_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+        p_new->p_route = p_route;                               /* Later calls go to the same backend                 */
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_ctx_init(p_vault->p_tpm_ctx,
+                                                       &(p_new->p_backend_ctx),
+                                                       mode,
+                                                       p_key, key_size,
+                                                       p_iv, iv_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_ctx_init(p_vault->p_host_ctx,
+                                                    &(p_new->p_backend_ctx),
+                                                    mode,
+                                                    p_key, key_size,
+                                                    p_iv, iv_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_mem_free(p_new);
+            break;
+        }
+
+        *p_ctx = p_new;
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_aes_gcm_ctx_aad_update()
+ *
+ * @brief   Add additional data to a streaming AES GCM operation. Can be called more than once, but
+ *          only before any data has been encrypted or decrypted.
+ *
+ * @param   p_ctx[in]           Handle of the streaming operation
+ *
+ * @param   p_aad[in]           Buffer with the additional data
+ *
+ * @param   aad_size[in]        Size of the additional data
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_INVALID_STATE if data has already been encrypted or decrypted.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_aad_update(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx,
+                                             uint8_t *p_aad, uint32_t aad_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_ctx->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(p_ctx->p_vault, p_route);    /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->aes_gcm_ctx_aad_update(p_ctx->p_backend_ctx,
+                                                                 p_aad, aad_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_ctx->p_vault);               /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_ctx_aad_update(p_ctx->p_backend_ctx,
+                                                             p_aad, aad_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_ctx_aad_update(p_ctx->p_backend_ctx,
+                                                          p_aad, aad_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_aes_gcm_ctx_update()
+ *
+ * @brief   Encrypt or decrypt the next part of a streaming AES GCM operation. Every update except the
+ *          last must be a multiple of OCKAM_VAULT_AES_GCM_BLOCK_SIZE bytes. When decrypting, the
+ *          output must not be trusted until ockam_vault_aes_gcm_ctx_finish() has verified the tag.
+ *
+ * @param   p_ctx[in]           Handle of the streaming operation
+ *
+ * @param   p_input[in]         Buffer with the data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the result. Can be the input buffer.
+ *
+ * @param   output_size[in]     Size of the output buffer. Must match the input size.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *          OCKAM_ERR_VAULT_INVALID_STATE if called after a partial block or after finishing.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_update(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx,
+                                         uint8_t *p_input, uint32_t input_size,
+                                         uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_ctx->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(p_ctx->p_vault, p_route);    /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->aes_gcm_ctx_update(p_ctx->p_backend_ctx,
+                                                             p_input, input_size,
+                                                             p_output, output_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_ctx->p_vault);               /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_ctx_update(p_ctx->p_backend_ctx,
+                                                         p_input, input_size,
+                                                         p_output, output_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_ctx_update(p_ctx->p_backend_ctx,
+                                                      p_input, input_size,
+                                                      p_output, output_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_aes_gcm_ctx_finish()
+ *
+ * @brief   Finish a streaming AES GCM operation. Outputs the tag when encrypting and verifies it when
+ *          decrypting.
+ *
+ * @param   p_ctx[in]           Handle of the streaming operation
+ *
+ * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
+ *                              when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_finish(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx,
+                                         uint8_t *p_tag, uint32_t tag_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_ctx->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(p_ctx->p_vault, p_route);    /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->aes_gcm_ctx_finish(p_ctx->p_backend_ctx,
+                                                             p_tag, tag_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_ctx->p_vault);               /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_ctx_finish(p_ctx->p_backend_ctx,
+                                                         p_tag, tag_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_ctx_finish(p_ctx->p_backend_ctx,
+                                                      p_tag, tag_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_aes_gcm_ctx_free()
+ *
+ * @brief   Release a streaming AES GCM operation, whether or not it was finished
+ *
+ * @param   p_ctx[in]           Handle of the streaming operation
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_aes_gcm_ctx_free(OCKAM_VAULT_AES_GCM_CTX_s *p_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_ctx == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_ctx->p_route;
+        ret_val = vault_route_lock(0, p_route);                 /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->aes_gcm_ctx_free(p_ctx->p_backend_ctx);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(0);                            /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_aes_gcm_ctx_free(p_ctx->p_backend_ctx);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_aes_gcm_ctx_free(p_ctx->p_backend_ctx);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+        t_ret_val = ockam_mem_free(p_ctx);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = t_ret_val;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_secret_import()
+ *
+ * @brief   Load an AES GCM key into the vault once. The backend keeps the key ready for use, so
+ *          any number of messages can then be encrypted or decrypted by handle without setting
+ *          the key up again. The secret must be released with ockam_vault_secret_free().
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   p_secret[out]       Returns the handle for the secret
+ *
+ * @param   p_key[in]           Buffer for the AES Key
+ *
+ * @param   key_size[in]        Size of the AES Key in bytes
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_secret_import(OCKAM_VAULT_s *p_vault,
+                                    OCKAM_VAULT_SECRET_s **p_secret,
+                                    uint8_t *p_key, uint32_t key_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+    OCKAM_VAULT_SECRET_s *p_new = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        ret_val = vault_enter(p_vault, &p_entered);             /* Stateless operation, no need for the vault lock.   */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_secret == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_mem_alloc((void**) &p_new, sizeof(OCKAM_VAULT_SECRET_s));
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_new->p_vault = p_vault;
+        p_new->p_backend_secret = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = &(p_vault->route[VAULT_OP_AES_GCM]);
+        do {                                                    /* Rerun on the host library if the TPM fails         */
+            ret_val = vault_route_lock(p_vault, p_route);       /* Takes the TPM bus lock if routed to the TPM        */
+            if(ret_val == OCKAM_ERR_NONE) {
+                ret_val = p_route->p_backend->secret_import(p_route->p_ctx,
+                                                            &(p_new->p_backend_secret),
+                                                            p_key, key_size);
+                ret_val = vault_route_unlock(p_route, ret_val);
+            }
+        } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+        p_new->p_route = p_route;                               /* Later calls go to the backend holding the key      */
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_secret_import(p_vault->p_tpm_ctx,
+                                                    &(p_new->p_backend_secret),
+                                                    p_key, key_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_secret_import(p_vault->p_host_ctx,
+                                                 &(p_new->p_backend_secret),
+                                                 p_key, key_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_mem_free(p_new);
+            break;
+        }
+
+        *p_secret = p_new;
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_secret_derive()
+ *
+ * @brief   Expand an AES GCM key from a pseudo-random key and load it as a secret. The derived key
+ *          only lives on the stack for the duration of the call.
+ *
+ * @param   p_prk[in]           Handle for the pseudo-random key
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info.
+ *
+ * @param   key_size[in]        Size of the AES Key to derive in bytes
+ *
+ * @param   p_secret[out]       Returns the handle for the secret
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_secret_derive(OCKAM_VAULT_HKDF_PRK_s *p_prk,
+                                    uint8_t *p_info, uint32_t info_size,
+                                    uint32_t key_size,
+                                    OCKAM_VAULT_SECRET_s **p_secret)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint8_t key[VAULT_SECRET_KEY_SIZE_MAX];
+
+
+    do {
+        if((p_prk == 0) || (key_size > VAULT_SECRET_KEY_SIZE_MAX)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = ockam_vault_hkdf_expand(p_prk,
+                                          p_info, info_size,
+                                          &key[0], key_size);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_vault_secret_import(p_prk->p_vault,
+                                            p_secret,
+                                            &key[0], key_size);
+    } while(0);
+
+    ockam_mem_set(&key[0], 0, sizeof(key));
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                     ockam_vault_secret_aes_gcm()
+ *
+ * @brief   AES GCM encrypt or decrypt with the key of a secret. A secret can be used from several
+ *          threads at once.
+ *
+ * @param   p_secret[in]        Handle of the secret
+ *
+ * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data
+ *
+ * @param   aad_size[in]        Size of the additional data
+ *
+ * @param   p_tag[in,out]       Buffer for the tag. Output when encrypting, checked when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the result. Can be p_input to work in place.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_secret_aes_gcm(OCKAM_VAULT_SECRET_s *p_secret,
+                                     OCKAM_VAULT_AES_GCM_MODE_e mode,
+                                     uint8_t *p_iv, uint32_t iv_size,
+                                     uint8_t *p_aad, uint32_t aad_size,
+                                     uint8_t *p_tag, uint32_t tag_size,
+                                     uint8_t *p_input, uint32_t input_size,
+                                     uint8_t *p_output, uint32_t output_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_VAULT_s *p_entered = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_secret == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        ret_val = vault_enter(p_secret->p_vault, &p_entered);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_secret->p_route;
+        ret_val = vault_route_lock(p_secret->p_vault, p_route); /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->secret_aes_gcm(p_secret->p_backend_secret,
+                                                         mode,
+                                                         p_iv, iv_size,
+                                                         p_aad, aad_size,
+                                                         p_tag, tag_size,
+                                                         p_input, input_size,
+                                                         p_output, output_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(p_secret->p_vault);            /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_secret_aes_gcm(p_secret->p_backend_secret,
+                                                     mode,
+                                                     p_iv, iv_size,
+                                                     p_aad, aad_size,
+                                                     p_tag, tag_size,
+                                                     p_input, input_size,
+                                                     p_output, output_size);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_secret_aes_gcm(p_secret->p_backend_secret,
+                                                  mode,
+                                                  p_iv, iv_size,
+                                                  p_aad, aad_size,
+                                                  p_tag, tag_size,
+                                                  p_input, input_size,
+                                                  p_output, output_size);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+    } while(0);
+
+    vault_leave(p_entered);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_secret_aes_gcm_encrypt()
+ *
+ * @brief   AES GCM encrypt with the key of a secret
+ *
+ * @param   p_secret[in]        Handle of the secret
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data
+ *
+ * @param   aad_size[in]        Size of the additional data
+ *
+ * @param   p_tag[in,out]       Buffer for the tag. Output when encrypting, checked when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the result. Can be p_input to work in place.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_secret_aes_gcm_encrypt(OCKAM_VAULT_SECRET_s *p_secret,
+                                             uint8_t *p_iv, uint32_t iv_size,
+                                             uint8_t *p_aad, uint32_t aad_size,
+                                             uint8_t *p_tag, uint32_t tag_size,
+                                             uint8_t *p_input, uint32_t input_size,
+                                             uint8_t *p_output, uint32_t output_size)
+{
+    return ockam_vault_secret_aes_gcm(p_secret,
+                                      OCKAM_VAULT_AES_GCM_MODE_ENCRYPT,
+                                      p_iv, iv_size,
+                                      p_aad, aad_size,
+                                      p_tag, tag_size,
+                                      p_input, input_size,
+                                      p_output, output_size);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                 ockam_vault_secret_aes_gcm_decrypt()
+ *
+ * @brief   AES GCM decrypt with the key of a secret
+ *
+ * @param   p_secret[in]        Handle of the secret
+ *
+ * @param   p_iv[in]            Buffer with the initialization vector
+ *
+ * @param   iv_size[in]         Size of the initialization vector
+ *
+ * @param   p_aad[in]           Buffer with the additional data
+ *
+ * @param   aad_size[in]        Size of the additional data
+ *
+ * @param   p_tag[in,out]       Buffer for the tag. Output when encrypting, checked when decrypting.
+ *
+ * @param   tag_size[in]        Size of the tag buffer
+ *
+ * @param   p_input[in]         Buffer with the data to encrypt or decrypt
+ *
+ * @param   input_size[in]      Size of the input data
+ *
+ * @param   p_output[out]       Buffer for the result. Can be p_input to work in place.
+ *
+ * @param   output_size[in]     Size of the output buffer
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_secret_aes_gcm_decrypt(OCKAM_VAULT_SECRET_s *p_secret,
+                                             uint8_t *p_iv, uint32_t iv_size,
+                                             uint8_t *p_aad, uint32_t aad_size,
+                                             uint8_t *p_tag, uint32_t tag_size,
+                                             uint8_t *p_input, uint32_t input_size,
+                                             uint8_t *p_output, uint32_t output_size)
+{
+    return ockam_vault_secret_aes_gcm(p_secret,
+                                      OCKAM_VAULT_AES_GCM_MODE_DECRYPT,
+                                      p_iv, iv_size,
+                                      p_aad, aad_size,
+                                      p_tag, tag_size,
+                                      p_input, input_size,
+                                      p_output, output_size);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_secret_free()
+ *
+ * @brief   Clear and release a secret
+ *
+ * @param   p_secret[in]        Handle of the secret
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_secret_free(OCKAM_VAULT_SECRET_s *p_secret)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if(p_secret == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        p_route = p_secret->p_route;
+        ret_val = vault_route_lock(0, p_route);                 /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->secret_free(p_secret->p_backend_secret);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
+        ret_val = vault_tpm_lock(0);                            /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_secret_free(p_secret->p_backend_secret);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_secret_free(p_secret->p_backend_secret);
+#else
+#error "Ockam Vault: AES GCM Function missing"
+#endif
+        t_ret_val = ockam_mem_free(p_secret);
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = t_ret_val;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      ockam_vault_ecdh_derive()
+ *
+ * @brief   Calculate an ECDH shared secret, run HKDF over it with the supplied salt and info, and
+ *          load the output as secret_count AES GCM secrets of key_size bytes each. When key
+ *          operations, HKDF and AES GCM all run on the same backend this is a single backend call
+ *          and the shared secret is never handed back to the caller. Each secret must be released
+ *          with ockam_vault_secret_free().
+ *
+ * @param   p_vault[in]         Handle of the vault instance to use
+ *
+ * @param   key_type[in]        Specify which key type to use in the ECDH execution
+ *
+ * @param   p_pub_key[in]       Buffer with the peer public key
+ *
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_salt[in]          Buffer for the HKDF salt
+ *
+ * @param   salt_size[in]       Size of the HKDF salt
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info
+ *
+ * @param   key_size[in]        Size of each AES Key in bytes
+ *
+ * @param   p_secrets[out]      Array that returns secret_count secret handles
+ *
+ * @param   secret_count[in]    Number of secrets to derive, at most OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_ecdh_derive(OCKAM_VAULT_s *p_vault,
+                                  OCKAM_VAULT_KEY_e key_type,
+                                  uint8_t *p_pub_key, uint32_t pub_key_size,
+                                  uint8_t *p_salt, uint32_t salt_size,
+                                  uint8_t *p_info, uint32_t info_size,
+                                  uint32_t key_size,
+                                  OCKAM_VAULT_SECRET_s **p_secrets, uint32_t secret_count)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    void *p_backend_secrets[OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX] = {0};
+    OCKAM_VAULT_SECRET_s *p_new[OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX] = {0};
+    uint32_t i = 0;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+    do {
+        if((p_vault == 0) || (p_secrets == 0) ||
+           (secret_count == 0) || (secret_count > OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX) ||
+           (key_size == 0) || (key_size > VAULT_SECRET_KEY_SIZE_MAX)) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+                                                                /* Can only be fused when every stage is on the same  */
+                                                                /* backend, otherwise run the stages one at a time    */
+        p_route = &(p_vault->route[VAULT_OP_KEY_ECDH]);
+        if((p_route->p_backend != p_vault->route[VAULT_OP_HKDF].p_backend) ||
+           (p_route->p_backend != p_vault->route[VAULT_OP_AES_GCM].p_backend) ||
+           (p_route->p_backend->ecdh_derive == 0)) {
+            ret_val = vault_ecdh_derive_split(p_vault,
+                                              key_type,
+                                              p_pub_key, pub_key_size,
+                                              p_salt, salt_size,
+                                              p_info, info_size,
+                                              key_size,
+                                              p_secrets, secret_count);
+            break;
+        }
+#elif(!VAULT_ECDH_DERIVE_TPM_EN && (OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM))
+        ret_val = vault_ecdh_derive_split(p_vault,
+                                          key_type,
+                                          p_pub_key, pub_key_size,
+                                          p_salt, salt_size,
+                                          p_info, info_size,
+                                          key_size,
+                                          p_secrets, secret_count);
+        break;
+#endif
+
+        for(i = 0; i < secret_count; i++) {                     /* Allocate the handles first so nothing can fail     */
+            ret_val = ockam_mem_alloc((void**) &p_new[i],       /* once the backend has created its secrets           */
+                                      sizeof(OCKAM_VAULT_SECRET_s));
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = vault_lock(p_vault);                          /* Lock the vault instance and ensure it is idle      */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+        ret_val = vault_route_lock(p_vault, p_route);           /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->ecdh_derive(p_route->p_ctx,
+                                                      key_type,
+                                                      p_pub_key, pub_key_size,
+                                                      p_salt, salt_size,
+                                                      p_info, info_size,
+                                                      key_size,
+                                                      &p_backend_secrets[0], secret_count);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+        p_route = &(p_vault->route[VAULT_OP_AES_GCM]);          /* The secrets are used through the AES GCM route     */
+#elif(VAULT_ECDH_DERIVE_TPM_EN)
+        ret_val = vault_tpm_lock(p_vault);                      /* The TPM bus is shared by all vault instances       */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = ockam_vault_tpm_ecdh_derive(p_vault->p_tpm_ctx,
+                                                  key_type,
+                                                  p_pub_key, pub_key_size,
+                                                  p_salt, salt_size,
+                                                  p_info, info_size,
+                                                  key_size,
+                                                  &p_backend_secrets[0], secret_count);
+            ret_val = vault_tpm_unlock(ret_val);
+        }
+#elif(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_HOST)
+        ret_val = ockam_vault_host_ecdh_derive(p_vault->p_host_ctx,
+                                               key_type,
+                                               p_pub_key, pub_key_size,
+                                               p_salt, salt_size,
+                                               p_info, info_size,
+                                               key_size,
+                                               &p_backend_secrets[0], secret_count);
+#elif(!VAULT_ECDH_DERIVE_SPLIT_EN)
+#error "Ockam Vault: ECDH Derive Function missing"
+#endif
+
+        ret_val = vault_unlock(p_vault, ret_val);               /* Unlock the vault after all operations finish       */
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < secret_count; i++) {
+            p_new[i]->p_vault = p_vault;
+            p_new[i]->p_backend_secret = p_backend_secrets[i];
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+            p_new[i]->p_route = p_route;
+#endif
+            p_secrets[i] = p_new[i];
+            p_new[i] = 0;
+        }
+    } while(0);
+
+    for(i = 0; i < OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX; i++) {   /* Only handles left over after a failure remain      */
+        if(p_new[i] != 0) {
+            ockam_mem_free(p_new[i]);
+        }
+    }
+
+    return ret_val;
+}
+
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_enter()
+ *
+ * @brief   Start a call on a vault instance without taking its lock. Used by the stateless
+ *          operations (SHA256, HKDF and AES GCM) which only use caller supplied buffers and contexts
+ *          on the stack, so they can run concurrently with each other and with key operations. Random
+ *          numbers and key pool fills also skip the lock since the host library gives each thread its
+ *          own DRBG. Every successful call must be paired with vault_leave(), which ockam_vault_free()
+ *          waits for.
+ *
+ * @param   p_vault[in]         The vault instance to use
+ *
+ * @param   p_entered[out]      Set to the instance on success, to pass to vault_leave()
+ *
+ * @return  OCKAM_ERR_NONE if the instance is idle.
+ *          OCKAM_ERR_VAULT_UNINITIALIZED if the instance has not been initialized or is being freed.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_enter(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_s **p_entered)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        if(p_vault == 0) {
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+                                                                /* Only free takes the write lock, so never wait for  */
+                                                                /* it. Failing means the instance is being freed.     */
+        ret_val = ockam_kal_rwlock_read_lock(&(p_vault->users), OCKAM_KAL_OPT_NON_BLOCKING, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
+            break;
+        }
+
+        if(p_vault->state != VAULT_STATE_IDLE) {                /* Checked with the read lock held, so free cannot    */
+            ockam_kal_rwlock_unlock(&(p_vault->users));         /* start releasing the instance until vault_leave()   */
+            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
+            break;
+        }
+
+        *p_entered = p_vault;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_leave()
+ *
+ * @brief   Finish a call started with vault_enter()
+ *
+ * @param   p_entered[in]   The instance returned by vault_enter(). 0 if it failed or was never called.
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_leave(OCKAM_VAULT_s *p_entered)
+{
+    if(p_entered != 0) {
+        ockam_kal_rwlock_unlock(&(p_entered->users));
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_lock()
+ *
+ * @brief   Lock a vault instance and make sure it is ready to be used
+ *
+ * @param   p_vault[in]     The vault instance to lock
+ *
+ * @return  OCKAM_ERR_NONE if the instance is locked and idle.
+ *          OCKAM_ERR_VAULT_BUSY if another call holds the instance and the instance does not wait.
+ *          OCKAM_ERR_VAULT_UNINITIALIZED if the instance has not been initialized or is being freed.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_lock(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_KAL_OPT opt = OCKAM_KAL_OPT_BLOCKING;
+    uint32_t timeout_ms = 0;
+
+
+    do {
+        if(p_vault == 0) {                                      /* A handle must be supplied for every vault call     */
+            ret_val = OCKAM_ERR_INVALID_PARAM;
+            break;
+        }
+
+        vault_lock_opt(p_vault, &opt, &timeout_ms);
+
+        ret_val = ockam_kal_mutex_lock(&(p_vault->mutex),       /* Lock the mutex before checking the state. Waits    */
+                                       opt,                     /* according to the options of the calling thread.    */
+                                       timeout_ms);
+        if(ret_val == OCKAM_ERR_KAL_TIMEOUT) {
+            ret_val = OCKAM_ERR_VAULT_BUSY;
+            break;
+        } else if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(p_vault->state != VAULT_STATE_IDLE) {                /* Ensure vault is in an idle state before continuing */
+            ockam_kal_mutex_unlock(&(p_vault->mutex), 0);
+            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_unlock()
+ *
+ * @brief   Unlock a vault instance previously locked with vault_lock()
+ *
+ * @param   p_vault[in]     The vault instance to unlock
+ *
+ * @param   ret_val[in]     Result of the operation performed while the vault was locked
+ *
+ * @return  ret_val if it indicates an error, otherwise the result of the mutex unlock.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_unlock(OCKAM_VAULT_s *p_vault, OCKAM_ERR ret_val)
+{
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+
+
+    t_ret_val = ockam_kal_mutex_unlock(&(p_vault->mutex), 0);   /* Unlock the mutex after all vault operations finish */
+    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
+        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_lock_opt()
+ *
+ * @brief   Get the lock options for a call on a vault instance. Those set by the calling thread with
+ *          ockam_vault_lock_opt_set() if any, otherwise those given at init.
+ *
+ * @param   p_vault[in]         The vault instance being called
+ *
+ * @param   p_opt[out]          Returns blocking or non-blocking
+ *
+ * @param   p_timeout_ms[out]   Returns the longest wait when blocking
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_lock_opt(OCKAM_VAULT_s *p_vault, OCKAM_KAL_OPT *p_opt, uint32_t *p_timeout_ms)
+{
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+    uint32_t thread_id = 0;
+    uint32_t i = 0;
+#endif
+
+
+    *p_opt = p_vault->lock_opt;
+    *p_timeout_ms = p_vault->lock_timeout_ms;
+
+#if(OCKAM_VAULT_CFG_LOCK_OPT_THREADS > 0)
+    if((ockam_kal_thread_id(&thread_id) == OCKAM_ERR_NONE) &&
+       (ockam_kal_rwlock_read_lock(&(p_vault->opt_lock), OCKAM_KAL_OPT_BLOCKING, 0) == OCKAM_ERR_NONE)) {
+        for(i = 0; i < OCKAM_VAULT_CFG_LOCK_OPT_THREADS; i++) {
+            if(p_vault->opt[i].thread_id == thread_id) {
+                *p_opt = p_vault->opt[i].lock_opt;
+                *p_timeout_ms = p_vault->opt[i].lock_timeout_ms;
+                break;
+            }
+        }
+
+        ockam_kal_rwlock_unlock(&(p_vault->opt_lock));
+    }
+#endif
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_rand_gen()
+ *
+ * @brief   Get random bytes from the backend selected for random numbers
+ *
+ * @param   p_vault[in]         The vault instance to use
+ *
+ * @param   p_rand_num[out]     Buffer to fill
+ *
+ * @param   rand_num_size[in]   Size of the buffer. The TPM only accepts VAULT_RAND_CHUNK_SIZE.
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_rand_gen(OCKAM_VAULT_s *p_vault, uint8_t *p_rand_num, uint32_t rand_num_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    VAULT_ROUTE_s *p_route = 0;
+#endif
+
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+    p_route = &(p_vault->route[VAULT_OP_RAND]);
+    do {                                                        /* Rerun on the host library if the TPM fails         */
+        ret_val = vault_route_lock(p_vault, p_route);           /* Takes the TPM bus lock if routed to the TPM        */
+        if(ret_val == OCKAM_ERR_NONE) {
+            ret_val = p_route->p_backend->random(p_route->p_ctx,
+                                                 p_rand_num,
+                                                 rand_num_size);
+            ret_val = vault_route_unlock(p_route, ret_val);
+        }
+    } while(vault_route_failover(p_vault, &p_route, ret_val, 1));
+#elif(OCKAM_VAULT_CFG_RAND & OCKAM_VAULT_CFG_TPM)
+    ret_val = vault_tpm_lock(p_vault);                          /* The TPM bus is shared by all vault instances       */
+    if(ret_val == OCKAM_ERR_NONE) {
+        ret_val = ockam_vault_tpm_random(p_vault->p_tpm_ctx,
+                                         p_rand_num,            /* Get a random number from the TPM                   */
+                                         rand_num_size);
+        ret_val = vault_tpm_unlock(ret_val);
+    }
+#elif(OCKAM_VAULT_CFG_RAND & OCKAM_VAULT_CFG_HOST)
+    ret_val = ockam_vault_host_random(p_vault->p_host_ctx,      /* Get a random number from the host library          */
+                                      p_rand_num,
+                                      rand_num_size);
+#else
+#error "Ockam Vault: Random function not specified"
+#endif
+
+    return ret_val;
+}
+
+
+#if(OCKAM_VAULT_CFG_RAND_BUF_SIZE > 0)
+/**
+ ********************************************************************************************************
+ *                                        vault_rand_buf_lock()
+ *
+ * @brief   Lock a random buffer. Waits according to the lock options of the vault instance.
+ *
+ * @param   p_vault[in]     The vault instance the buffer belongs to
+ *
+ * @param   p_buf[in]       The random buffer to lock
+ *
+ * @return  OCKAM_ERR_NONE if the buffer is now owned by the caller.
+ *          OCKAM_ERR_VAULT_BUSY if another thread holds the buffer and the instance does not wait.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_rand_buf_lock(OCKAM_VAULT_s *p_vault, VAULT_RAND_BUF_s *p_buf)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    OCKAM_KAL_OPT opt = OCKAM_KAL_OPT_BLOCKING;
+    uint32_t timeout_ms = 0;
+
+
+    vault_lock_opt(p_vault, &opt, &timeout_ms);
+
+    ret_val = ockam_kal_mutex_lock(&(p_buf->mutex), opt, timeout_ms);
+    if(ret_val == OCKAM_ERR_KAL_TIMEOUT) {
+        ret_val = OCKAM_ERR_VAULT_BUSY;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_rand_buf_fill()
+ *
+ * @brief   Add one backend chunk to a random buffer. Must be called with the buffer locked.
+ *
+ * @param   p_vault[in]     The vault instance the buffer belongs to
+ *
+ * @param   p_buf[in]       The random buffer to fill
+ *
+ * @return  OCKAM_ERR_NONE if the chunk was added.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_rand_buf_fill(OCKAM_VAULT_s *p_vault, VAULT_RAND_BUF_s *p_buf)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t size = 0;
+    uint8_t chunk[VAULT_RAND_CHUNK_SIZE];
+
+
+    do {
+        size = OCKAM_VAULT_CFG_RAND_BUF_SIZE - p_buf->avail;    /* The last chunk may only be partly used             */
+        if(size > VAULT_RAND_CHUNK_SIZE) {
+            size = VAULT_RAND_CHUNK_SIZE;
+        }
+
+        if(size == 0) {
+            break;
+        }
+
+        ret_val = vault_rand_gen(p_vault, chunk, VAULT_RAND_CHUNK_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_copy(&(p_buf->data[p_buf->avail]), chunk, size);
+        p_buf->avail += size;
+    } while(0);
+
+    ockam_mem_set(chunk, 0, VAULT_RAND_CHUNK_SIZE);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       vault_rand_buf_refill()
+ *
+ * @brief   Fill a random buffer to the top. Chunks are generated with the buffer unlocked and only
+ *          copied in with it locked, so threads sharing the buffer never wait on the backend.
+ *
+ * @param   p_vault[in]     The vault instance the buffer belongs to
+ *
+ * @param   p_buf[in]       The random buffer to fill
+ *
+ * @return  OCKAM_ERR_NONE once the buffer is full.
+ *          OCKAM_ERR_VAULT_BUSY if the buffer is in use and the instance does not wait.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_rand_buf_refill(OCKAM_VAULT_s *p_vault, VAULT_RAND_BUF_s *p_buf)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t size = 0;
+    uint8_t ready = 0;
+    uint8_t chunk[VAULT_RAND_CHUNK_SIZE];
+
+
+    while(ret_val == OCKAM_ERR_NONE) {
+        ret_val = vault_rand_buf_lock(p_vault, p_buf);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        size = OCKAM_VAULT_CFG_RAND_BUF_SIZE - p_buf->avail;    /* Takers may have used some bytes since the last     */
+        if(size > VAULT_RAND_CHUNK_SIZE) {                      /* chunk was added                                    */
+            size = VAULT_RAND_CHUNK_SIZE;
+        }
+
+        if(ready) {
+            ockam_mem_copy(&(p_buf->data[p_buf->avail]), chunk, size);
+            p_buf->avail += size;
+            ready = 0;
+        }
+
+        size = OCKAM_VAULT_CFG_RAND_BUF_SIZE - p_buf->avail;
+        ockam_kal_mutex_unlock(&(p_buf->mutex), 0);
+        if(size == 0) {
+            break;
+        }
+
+        ret_val = vault_rand_gen(p_vault, chunk, VAULT_RAND_CHUNK_SIZE);
+        ready = 1;
+    }
+
+    ockam_mem_set(chunk, 0, VAULT_RAND_CHUNK_SIZE);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_rand_buf_take()
+ *
+ * @brief   Serve a small random request from the calling thread's random buffer. If the buffer runs
+ *          short only one chunk is added, so the caller never waits on a full refill. A buffer held by
+ *          another thread is skipped rather than waited on, and the request goes to the backend.
+ *
+ * @param   p_vault[in]         The vault instance to use
+ *
+ * @param   p_rand_num[out]     Buffer to fill
+ *
+ * @param   rand_num_size[in]   Size of the buffer, less than VAULT_RAND_CHUNK_SIZE
+ *
+ * @return  OCKAM_ERR_NONE if successful.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_rand_buf_take(OCKAM_VAULT_s *p_vault, uint8_t *p_rand_num, uint32_t rand_num_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t thread_id = 0;
+    VAULT_RAND_BUF_s *p_buf = 0;
+#if(VAULT_REFILL_RAND_EN)
+    uint8_t low = 0;
+#endif
+
+
+    do {
+        if(ockam_kal_thread_id(&thread_id) != OCKAM_ERR_NONE) { /* Without a thread id everything shares the first    */
+            thread_id = 0;                                      /* buffer, which is still correct                     */
+        }
+
+        p_buf = &(p_vault->rand_buf[thread_id % OCKAM_VAULT_CFG_RAND_BUF_COUNT]);
+
+                                                                /* A thread sharing the buffer has it. Go to the      */
+                                                                /* backend rather than wait or fail busy.             */
+        if(ockam_kal_mutex_lock(&(p_buf->mutex), OCKAM_KAL_OPT_NON_BLOCKING, 0) != OCKAM_ERR_NONE) {
+            ret_val = vault_rand_gen(p_vault, p_rand_num, rand_num_size);
+            break;
+        }
+
+        if(p_buf->avail < rand_num_size) {                      /* Background refill did not keep up. One chunk is    */
+            ret_val = vault_rand_buf_fill(p_vault, p_buf);      /* always enough, full top ups are left to            */
+        }                                                       /* ockam_vault_random_refill().                       */
+
+        if(ret_val == OCKAM_ERR_NONE) {                         /* Bytes are taken from the end and wiped so each one */
+            p_buf->avail -= rand_num_size;                      /* is only ever handed out once                       */
+            ockam_mem_copy(p_rand_num, &(p_buf->data[p_buf->avail]), rand_num_size);
+            ockam_mem_set(&(p_buf->data[p_buf->avail]), 0, rand_num_size);
+#if(VAULT_REFILL_RAND_EN)
+            low = (p_buf->avail <= OCKAM_VAULT_CFG_RAND_BUF_LOW);
+#endif
+        }
+
+        ockam_kal_mutex_unlock(&(p_buf->mutex), 0);
+
+#if(VAULT_REFILL_RAND_EN)
+        if(low) {
+            vault_refill_wake(p_vault);
+        }
+#endif
+    } while(0);
+
+    return ret_val;
+}
+#endif
+
+
+#if(VAULT_REFILL_EN)
+/**
+ ********************************************************************************************************
+ *                                        vault_refill_start()
+ *
+ * @brief   Start the refill thread of a vault instance. The thread waits until it is woken, and its
+ *          refills fail fast until the instance is idle.
+ *
+ * @param   p_vault[in]     The vault instance to refill
+ *
+ * @return  OCKAM_ERR_NONE if the thread was started.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_refill_start(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        ret_val = ockam_kal_queue_init(&(p_vault->refill_wake), VAULT_REFILL_WAKE_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_kal_thread_create(&(p_vault->refill_thread), vault_refill_run, p_vault);
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_kal_queue_free(&(p_vault->refill_wake));
+            p_vault->refill_wake.queue_ptr = 0;
+            break;
+        }
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         vault_refill_stop()
+ *
+ * @brief   Stop the refill thread of a vault instance and wait for it to finish. Nothing may wake the
+ *          thread once this has been called.
+ *
+ * @param   p_vault[in]     The vault instance being freed
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_refill_stop(OCKAM_VAULT_s *p_vault)
+{
+    if(p_vault->refill_thread.thread_ptr != 0) {                /* Waits for room behind any pending wake up          */
+        ockam_kal_queue_push(&(p_vault->refill_wake), 0, OCKAM_KAL_OPT_BLOCKING);
+        ockam_kal_thread_join(&(p_vault->refill_thread));
+        ockam_kal_queue_free(&(p_vault->refill_wake));
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_refill_run()
+ *
+ * @brief   Body of the refill thread. Each wake up tops up everything the thread looks after. Refills
+ *          enter the instance like any other call made without the instance lock.
+ *
+ * @param   p_arg[in]       The vault instance to refill
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_refill_run(void *p_arg)
+{
+    OCKAM_VAULT_s *p_vault = (OCKAM_VAULT_s*) p_arg;
+    void *p_item = 0;
+
+
+    while(ockam_kal_queue_pop(&(p_vault->refill_wake), &p_item, OCKAM_KAL_OPT_BLOCKING, 0) == OCKAM_ERR_NONE) {
+        if(p_item == 0) {                                       /* Pushed by vault_refill_stop()                      */
+            break;
+        }
+
+                                                                /* A failed refill is retried on the next wake up,    */
+                                                                /* and callers generate inline until then             */
+#if(VAULT_REFILL_KEYS_EN)
+        ockam_vault_key_pool_fill(p_vault);
+#endif
+#if(VAULT_REFILL_RAND_EN)
+        ockam_vault_random_refill(p_vault);
+#endif
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         vault_refill_wake()
+ *
+ * @brief   Wake the refill thread of a vault instance. Never waits: a full queue means a wake up is
+ *          already pending.
+ *
+ * @param   p_vault[in]     The vault instance to refill
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_refill_wake(OCKAM_VAULT_s *p_vault)
+{
+    ockam_kal_queue_push(&(p_vault->refill_wake), p_vault, OCKAM_KAL_OPT_NON_BLOCKING);
+}
+#endif
+
+
+#if(VAULT_REFILL_KEYS_EN)
+/**
+ ********************************************************************************************************
+ *                                         vault_refill_keys()
+ *
+ * @brief   Wake the refill thread once the ephemeral key pool is down to its low-water mark. Must be
+ *          called from within a call on the instance.
+ *
+ * @param   p_vault[in]     The vault instance a key was just taken from
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_refill_keys(OCKAM_VAULT_s *p_vault)
+{
+    uint32_t count = 0;
+
+
+    if((ockam_vault_host_key_pool_count(p_vault->p_host_ctx, &count) == OCKAM_ERR_NONE) &&
+       (count <= OCKAM_VAULT_CFG_KEY_POOL_LOW)) {
+        vault_refill_wake(p_vault);
+    }
+}
+#endif
+
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN && OCKAM_VAULT_CFG_HOST_SEED_TPM)
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_entropy()
+ *
+ * @brief   Entropy source for the host DRBGs backed by the TPM random number generator. Called by the
+ *          host library whenever a DRBG is seeded or reseeded. The TPM bus is only waited on for a
+ *          bounded time, and a TPM that is down is never touched, so the host can fall back to
+ *          platform entropy rather than stall.
+ *
+ * @param   p_arg[in]       The shared TPM context
+ *
+ * @param   p_buf[out]      Buffer to fill with entropy
+ *
+ * @param   size[in]        Size of the buffer
+ *
+ * @param   p_size[out]     Number of bytes written
+ *
+ * @return  OCKAM_ERR_NONE if the whole buffer was filled.
+ *          OCKAM_ERR_VAULT_TPM_DOWN if the TPM is down or a TPM command failed.
+ *          OCKAM_ERR_VAULT_BUSY if the TPM bus stayed busy.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_entropy(void *p_arg, uint8_t *p_buf, uint32_t size, uint32_t *p_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t chunk_size = 0;
+    uint8_t chunk[VAULT_RAND_CHUNK_SIZE];
+
+
+    *p_size = 0;
+
+    while(size > 0) {
+                                                                /* Seeding may run under a call that already owns     */
+                                                                /* the bus, so the wait is bounded rather than forever*/
+        ret_val = ockam_kal_mutex_lock(&g_vault_tpm_mutex, OCKAM_KAL_OPT_BLOCKING, VAULT_TPM_ENTROPY_WAIT_MS);
+        if(ret_val != OCKAM_ERR_NONE) {
+            ret_val = OCKAM_ERR_VAULT_BUSY;
+            break;
+        }
+
+        ret_val = vault_tpm_ready();                            /* Never reach a TPM that is down. A failure here     */
+        if(ret_val == OCKAM_ERR_NONE) {                         /* counts toward its health like any TPM command.     */
+            ret_val = ockam_vault_tpm_random(p_arg, chunk, VAULT_RAND_CHUNK_SIZE);
+            vault_tpm_health(ret_val);
+        }
+        ockam_kal_mutex_unlock(&g_vault_tpm_mutex, 0);
+        if(ret_val != OCKAM_ERR_NONE) {
+            ret_val = OCKAM_ERR_VAULT_TPM_DOWN;
+            break;
+        }
+
+        chunk_size = (size < VAULT_RAND_CHUNK_SIZE) ? size : VAULT_RAND_CHUNK_SIZE;
+        ockam_mem_copy(p_buf, chunk, chunk_size);
+        p_buf += chunk_size;
+        size -= chunk_size;
+        *p_size += chunk_size;
+    }
+
+    ockam_mem_set(chunk, 0, VAULT_RAND_CHUNK_SIZE);
+
+    return ret_val;
+}
+#endif
+
+
+#if(OCKAM_VAULT_CFG_INIT & OCKAM_VAULT_CFG_TPM)
+/**
+ ********************************************************************************************************
+ *                                        vault_tpm_mutex_init()
+ *
+ * @brief   Create the TPM lock. Run once through ockam_kal_once() and never freed, so instances can
+ *          attach and detach from any thread.
+ *
+ * @return  OCKAM_ERR_NONE if the lock was created.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_mutex_init(void)
+{
+    return ockam_kal_mutex_init(&g_vault_tpm_mutex);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_attach()
+ *
+ * @brief   Attach a vault instance to the shared TPM, initializing the TPM on first use
+ *
+ * @param   p_arg[in]       TPM specific configuration
+ *
+ * @param   p_tpm_ctx[out]  Returns the shared TPM context
+ *
+ * @return  OCKAM_ERR_NONE if the TPM is ready for use.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_attach(void *p_arg, void **p_tpm_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        ret_val = ockam_kal_once(&g_vault_tpm_once, vault_tpm_mutex_init);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_kal_mutex_lock(&g_vault_tpm_mutex, 0, 0);
+        if(ret_val != OCKAM_ERR_NONE) {                         /* The TPM lock also guards the ref count             */
+            break;
+        }
+
+        if(g_vault_tpm_refs == 0) {                             /* Only the first vault instance brings up the TPM,   */
+            ret_val = ockam_vault_tpm_init(p_arg, &g_vault_tpm_ctx);
+            if(ret_val != OCKAM_ERR_NONE) {                     /* later instances share the same context             */
+                g_vault_tpm_ctx = 0;
+            }
+            g_vault_tpm_fails = 0;                              /* A fresh TPM starts out healthy                     */
+        }
+
+        if(ret_val == OCKAM_ERR_NONE) {
+            g_vault_tpm_refs++;
+            *p_tpm_ctx = g_vault_tpm_ctx;
+        }
+
+        ockam_kal_mutex_unlock(&g_vault_tpm_mutex, 0);
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_detach()
+ *
+ * @brief   Detach a vault instance from the shared TPM. The last instance out shuts the TPM down.
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_tpm_detach(void)
+{
+    ockam_kal_mutex_lock(&g_vault_tpm_mutex, 0, 0);             /* Waits for calls on other instances to finish       */
+
+    g_vault_tpm_refs--;
+    if(g_vault_tpm_refs == 0) {                                 /* The lock itself is kept for the next attach        */
+        ockam_vault_tpm_free(g_vault_tpm_ctx);
+        g_vault_tpm_ctx = 0;
+    }
+
+    ockam_kal_mutex_unlock(&g_vault_tpm_mutex, 0);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_lock()
+ *
+ * @brief   Lock the TPM bus shared by all vault instances. Waits according to the lock options of
+ *          the calling instance.
+ *
+ * @param   p_vault[in]     The vault instance making the call. 0 always waits and skips the health
+ *                          checks, used when releasing handles so a free never fails for being busy.
+ *
+ * @return  OCKAM_ERR_NONE if the TPM is now owned by the caller.
+ *          OCKAM_ERR_VAULT_BUSY if another instance holds the TPM and the instance does not wait.
+ *          OCKAM_ERR_VAULT_TPM_DOWN if the TPM has failed too often and is not due to be retried.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_lock(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_KAL_OPT opt = OCKAM_KAL_OPT_BLOCKING;
+    uint32_t timeout_ms = 0;
+
+
+    if(p_vault != 0) {
+        vault_lock_opt(p_vault, &opt, &timeout_ms);
+    }
+
+    return vault_tpm_lock_opt(p_vault, opt, timeout_ms);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_tpm_lock_opt()
+ *
+ * @brief   Lock the TPM bus shared by all vault instances with the given lock options
+ *
+ * @param   p_vault[in]     The vault instance making the call. 0 skips the health checks.
+ *
+ * @param   opt[in]         Blocking or non-blocking wait for the TPM bus
+ *
+ * @param   timeout_ms[in]  Longest wait when blocking, 0 is forever
+ *
+ * @return  OCKAM_ERR_NONE if the TPM is now owned by the caller.
+ *          OCKAM_ERR_VAULT_BUSY if another call holds the TPM and the wait ran out.
+ *          OCKAM_ERR_VAULT_TPM_DOWN if the TPM has failed too often and is not due to be retried.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_lock_opt(OCKAM_VAULT_s *p_vault, OCKAM_KAL_OPT opt, uint32_t timeout_ms)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    do {
+        ret_val = ockam_kal_mutex_lock(&g_vault_tpm_mutex, opt, timeout_ms);
+
+        if(ret_val == OCKAM_ERR_KAL_TIMEOUT) {
+            ret_val = OCKAM_ERR_VAULT_BUSY;
+            break;
+        } else if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+                                                                /* Frees always reach the TPM so handles are not      */
+                                                                /* leaked, and say nothing about the TPM health.      */
+        if(p_vault == 0) {                                      /* Otherwise stop here while the TPM is down.         */
+            break;
+        }
+
+        ret_val = vault_tpm_ready();
+        if(ret_val != OCKAM_ERR_NONE) {
+            ockam_kal_mutex_unlock(&g_vault_tpm_mutex, 0);
+            break;
+        }
+
+        g_vault_tpm_track = 1;
+    } while(0);
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_unlock()
+ *
+ * @brief   Unlock the TPM bus shared by all vault instances. When the lock was taken for a vault
+ *          instance, also record whether the TPM operation failed.
+ *
+ * @param   ret_val[in]     Result of the TPM operation performed while the bus was locked
+ *
+ * @return  ret_val if it indicates an error, otherwise the result of the mutex unlock.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_unlock(OCKAM_ERR ret_val)
+{
+    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+
+
+    if(g_vault_tpm_track) {                                     /* Track TPM health while the lock is still held      */
+        vault_tpm_health(ret_val);
+        g_vault_tpm_track = 0;
+    }
+
+    t_ret_val = ockam_kal_mutex_unlock(&g_vault_tpm_mutex, 0);
+    if(ret_val == OCKAM_ERR_NONE) {
+        ret_val = t_ret_val;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_ready()
+ *
+ * @brief   Check whether the TPM may be used. Must be called with the TPM lock held.
+ *
+ * @return  OCKAM_ERR_NONE if the TPM is healthy or due a trial call.
+ *          OCKAM_ERR_VAULT_TPM_DOWN if the TPM has failed too often and is not due to be retried.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_tpm_ready(void)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint64_t now_us = 0;
+
+
+    if((g_vault_tpm_fails >= OCKAM_VAULT_CFG_TPM_FAIL_LIMIT) &&
+       (ockam_kal_time_us(&now_us) == OCKAM_ERR_NONE) &&        /* Past the retry time this call goes through as the  */
+       (now_us < g_vault_tpm_retry_us)) {                       /* trial. Its result decides if the TPM is back.      */
+        ret_val = OCKAM_ERR_VAULT_TPM_DOWN;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_health()
+ *
+ * @brief   Record the result of a TPM command, so a TPM that keeps failing is skipped for a while.
+ *          Must be called with the TPM lock held, and only for commands that really ran on the TPM.
+ *
+ * @param   ret_val[in]     Result of the TPM command
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_tpm_health(OCKAM_ERR ret_val)
+{
+    uint64_t now_us = 0;
+
+
+    if(vault_tpm_failed(ret_val)) {
+        if(g_vault_tpm_fails < OCKAM_VAULT_CFG_TPM_FAIL_LIMIT) {
+            g_vault_tpm_fails++;
+        }
+
+        if((g_vault_tpm_fails >= OCKAM_VAULT_CFG_TPM_FAIL_LIMIT) &&
+           (ockam_kal_time_us(&now_us) == OCKAM_ERR_NONE)) {
+            g_vault_tpm_retry_us = now_us + ((uint64_t) OCKAM_VAULT_CFG_TPM_RETRY_MS * 1000u);
+        }
+    } else if(ret_val == OCKAM_ERR_NONE) {
+        g_vault_tpm_fails = 0;
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_tpm_failed()
+ *
+ * @brief   Check whether the result of a TPM call means the TPM itself failed, as opposed to the call
+ *          being refused or a decrypted message failing authentication
+ *
+ * @param   ret_val[in]     Result of the TPM call
+ *
+ * @return  1 if the result counts against the health of the TPM, 0 otherwise.
+ *
+ ********************************************************************************************************
+ */
+
+static uint8_t vault_tpm_failed(OCKAM_ERR ret_val)
+{
+    uint8_t failed = 0;
+
+
+    if((ret_val >= OCKAM_ERR_VAULT_TPM_INIT_FAIL) &&            /* Only the TPM error range counts. Parameter and     */
+       (ret_val < OCKAM_ERR_VAULT_HOST_INIT_FAIL) &&            /* size errors say nothing about the device.          */
+       (ret_val != OCKAM_ERR_VAULT_TPM_AES_GCM_DECRYPT_INVALID) &&
+       (ret_val != OCKAM_ERR_VAULT_TPM_UNSUPPORTED) &&
+       (ret_val != OCKAM_ERR_VAULT_TPM_DOWN)) {
+        failed = 1;
+    }
+
+    return failed;
+}
+#endif
+
+
+#if(OCKAM_VAULT_CFG_DISPATCH_EN)
+/**
+ ********************************************************************************************************
+ *                                          vault_route_init()
+ *
+ * @brief   Select the backend used by each operation group of a vault instance
+ *
+ * @param   p_vault[in]     The vault instance being initialized. Backend contexts must already be set.
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_route_init(OCKAM_VAULT_s *p_vault)
+{
+    uint32_t i;
+    uint8_t locked;
+
+
+    vault_route_set(p_vault, VAULT_OP_RAND, OCKAM_VAULT_CFG_RAND);
+    vault_route_set(p_vault, VAULT_OP_KEY_ECDH, OCKAM_VAULT_CFG_KEY_ECDH);
+    vault_route_set(p_vault, VAULT_OP_SHA256, OCKAM_VAULT_CFG_SHA256);
+    vault_route_set(p_vault, VAULT_OP_HKDF, OCKAM_VAULT_CFG_HKDF);
+    vault_route_set(p_vault, VAULT_OP_AES_GCM, OCKAM_VAULT_CFG_AES_GCM);
+
+    p_vault->route_host.p_backend = &ockam_vault_host_backend;
+    p_vault->route_host.p_ctx = p_vault->p_host_ctx;
+
+    for(i = 0; i < MAX_VAULT_OP; i++) {                         /* Keyed groups always stay on their configured       */
+        p_vault->host_size[i] = OCKAM_VAULT_SIZE_NEVER;         /* backend. Key material in the TPM never leaves it.  */
+    }
+
+    p_vault->host_size[VAULT_OP_SHA256] = OCKAM_VAULT_CFG_SHA256_HOST_SIZE;
+    p_vault->host_size[VAULT_OP_HKDF] = OCKAM_VAULT_CFG_HKDF_HOST_SIZE;
+    p_vault->host_size[VAULT_OP_AES_GCM] = OCKAM_VAULT_CFG_AES_GCM_HOST_SIZE;
+
+    for(i = 0; i < MAX_VAULT_OP; i++) {
+                                                                /* Already on the host library, nothing to split      */
+        if(p_vault->route[i].p_backend != &ockam_vault_tpm_backend) {
+            p_vault->host_size[i] = OCKAM_VAULT_SIZE_NEVER;
+        } else if(p_vault->host_size[i] == OCKAM_VAULT_SIZE_AUTO) {
+            locked = 0;
+            if(ockam_kal_once(&g_vault_route_once, vault_route_mutex_init) == OCKAM_ERR_NONE) {
+                locked = (ockam_kal_mutex_lock(&g_vault_route_mutex, 0, 0) == OCKAM_ERR_NONE);
+            }
+
+            if(!locked) {
+                p_vault->host_size[i] = OCKAM_VAULT_SIZE_NEVER; /* No lock to share results, keep the TPM route       */
+            } else {
+                if(!(g_vault_route_measured & (1u << i))) {     /* The TPM and the host library are the same for      */
+                    g_vault_route_host_size[i] =                /* every instance, so measure once per process        */
+                        vault_route_calibrate(p_vault, (VAULT_OP_e) i);
+                    g_vault_route_measured |= (1u << i);
+                }
+                p_vault->host_size[i] = g_vault_route_host_size[i];
+                ockam_kal_mutex_unlock(&g_vault_route_mutex, 0);
+            }
+        }
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_route_mutex_init()
+ *
+ * @brief   Create the calibration lock. Run once through ockam_kal_once() and never freed.
+ *
+ * @return  OCKAM_ERR_NONE if the lock was created.
+ *
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_route_mutex_init(void)
+{
+    return ockam_kal_mutex_init(&g_vault_route_mutex);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_route_set()
+ *
+ * @brief   Route an operation group to the configured backend, or to the host library if the
+ *          configured backend is not present on this device or does not implement the operation.
+ *
+ * @param   p_vault[in]     The vault instance being initialized
+ *
+ * @param   op[in]          The operation group to route
+ *
+ * @param   cfg[in]         The OCKAM_VAULT_CFG_xxx value configured for the operation group
+ *
+ ********************************************************************************************************
+ */
+
+static void vault_route_set(OCKAM_VAULT_s *p_vault, VAULT_OP_e op, uint32_t cfg)
+{
+    const OCKAM_VAULT_BACKEND_s *p_tpm = &ockam_vault_tpm_backend;
+    uint8_t use_tpm = 0;
+
+
+    if((cfg & OCKAM_VAULT_CFG_TPM) && (p_vault->p_tpm_ctx != 0)) {
+        switch(op) {                                            /* Check the TPM implements the operation group. The  */
+            case VAULT_OP_RAND:                                 /* host library is expected to implement all of them. */
+                use_tpm = (p_tpm->random != 0);
+                break;
+
+            case VAULT_OP_KEY_ECDH:
+                use_tpm = (p_tpm->key_gen != 0) && (p_tpm->ecdh != 0);
+                break;
+
+            case VAULT_OP_SHA256:
+                use_tpm = (p_tpm->sha256 != 0) && (p_tpm->sha256_ctx_init != 0);
+                break;
+
+            case VAULT_OP_HKDF:
+                use_tpm = (p_tpm->hkdf != 0) && (p_tpm->hkdf_extract != 0);
+                break;
+
+            case VAULT_OP_AES_GCM:
+                use_tpm = (p_tpm->aes_gcm != 0) &&
+                          (p_tpm->aes_gcm_batch != 0) &&
+                          (p_tpm->aes_gcm_iov != 0) &&
+                          (p_tpm->aes_gcm_ctx_init != 0) &&
+                          (p_tpm->secret_import != 0);
+                break;
+
+            default:
+                break;
+        }
     }
 
-    return ret_val;
+    if(use_tpm) {
+        p_vault->route[op].p_backend = p_tpm;
+        p_vault->route[op].p_ctx = p_vault->p_tpm_ctx;
+    } else {
+        p_vault->route[op].p_backend = &ockam_vault_host_backend;
+        p_vault->route[op].p_ctx = p_vault->p_host_ctx;
+    }
 }
 
 
 /**
  ********************************************************************************************************
- *                                ockam_vault_aes_gcm_encrypt()
+ *                                          vault_route_lock()
  *
- * @brief   AES GCM function for encrypt. Depending on underlying implementation may support 128, 192
- *          and/or 256.
+ * @brief   Take any backend wide lock needed before calling through a route
  *
- * @param   p_key[in]           Buffer for the AES Key
+ * @param   p_vault[in]     The vault instance making the call. 0 always waits.
  *
- * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ * @param   p_route[in]     The route about to be called
  *
- * @param   p_iv[in]            Buffer with the initialization vector
+ * @return  OCKAM_ERR_NONE if the backend can be called.
  *
- * @param   iv_size[in]         Size of the initialization vector
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_route_lock(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s *p_route)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    if(p_route->p_backend == &ockam_vault_tpm_backend) {        /* Only the TPM bus is shared between instances       */
+        ret_val = vault_tpm_lock(p_vault);
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_route_lock_fast()
  *
- * @param   p_aad[in]           Buffer with the additional data (can be NULL)
+ * @brief   Take any backend wide lock needed before a one-shot call on caller supplied data. If the
+ *          call is routed to the TPM and another call holds the TPM bus, the call is sent to the host
+ *          library rather than waiting. Slow TPM work such as key generation or ECDH, often queued on
+ *          the async slow lane, then never holds up SHA256, HKDF or AES GCM from the fast lane.
  *
- * @param   aad_size[in]        Size of the additional data (set to 0 if p_aad is NULL)
+ * @param   p_vault[in]     The vault instance making the call
  *
- * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
- *                              when decrypting.
+ * @param   p_route[in,out] The route about to be called. Set to the host route if the TPM is busy.
  *
- * @param   tag_size[in]        Size of the tag buffer
+ * @return  OCKAM_ERR_NONE if the route in p_route can be called.
+ *          OCKAM_ERR_VAULT_TPM_DOWN if the TPM has failed too often and is not due to be retried.
  *
- * @param   p_input[in]         Buffer with the input data to encrypt or decrypt
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_route_lock_fast(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s **p_route)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    if((*p_route)->p_backend == &ockam_vault_tpm_backend) {
+        ret_val = vault_tpm_lock_opt(p_vault, OCKAM_KAL_OPT_NON_BLOCKING, 0);
+        if(ret_val == OCKAM_ERR_VAULT_BUSY) {                   /* Nothing has been sent to the TPM yet, so this is   */
+            *p_route = &(p_vault->route_host);                  /* safe even for calls that work in place             */
+            ret_val = OCKAM_ERR_NONE;
+        }
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          vault_route_unlock()
  *
- * @param   input_size[in]      Size of the input data
+ * @brief   Release any backend wide lock taken by vault_route_lock()
  *
- * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can NOT be the
- *                              input buffer.
+ * @param   p_route[in]     The route that was called
  *
- * @param   output_size[in]     Size of the output buffer
+ * @param   ret_val[in]     Result of the backend call
  *
- * @return  OCKAM_ERR_NONE if successful.
- *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ * @return  ret_val if it indicates an error, otherwise the result of the unlock.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_aes_gcm_encrypt(uint8_t *p_key, uint32_t key_size,
-                                      uint8_t *p_iv, uint32_t iv_size,
-                                      uint8_t *p_aad, uint32_t aad_size,
-                                      uint8_t *p_tag, uint32_t tag_size,
-                                      uint8_t *p_input, uint32_t input_size,
-                                      uint8_t *p_output, uint32_t output_size)
+static OCKAM_ERR vault_route_unlock(VAULT_ROUTE_s *p_route, OCKAM_ERR ret_val)
 {
-    return ockam_vault_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_ENCRYPT,
-                               p_key, key_size,
-                               p_iv, iv_size,
-                               p_aad, aad_size,
-                               p_tag, tag_size,
-                               p_input, input_size,
-                               p_output, output_size);
+    if(p_route->p_backend == &ockam_vault_tpm_backend) {
+        ret_val = vault_tpm_unlock(ret_val);
+    }
+
+    return ret_val;
 }
 
 
 /**
  ********************************************************************************************************
- *                                ockam_vault_aes_gcm_decrypt()
+ *                                          vault_route_get()
  *
- * @brief   AES GCM function for decrypt. Depending on underlying implementation may support 128, 192
- *          and/or 256.
+ * @brief   Pick the route for a one-shot call on an input of the given size. Inputs at or above the
+ *          threshold of the operation group go to the host library, everything else uses the route
+ *          selected at init.
  *
- * @param   p_key[in]           Buffer for the AES Key
+ * @param   p_vault[in]     The vault instance the call is made on
  *
- * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ * @param   op[in]          The operation group of the call
  *
- * @param   p_iv[in]            Buffer with the initialization vector
+ * @param   size[in]        Number of bytes the call processes
  *
- * @param   iv_size[in]         Size of the initialization vector
+ * @return  The route to call through.
  *
- * @param   p_aad[in]           Buffer with the additional data (can be NULL)
+ ********************************************************************************************************
+ */
+
+static VAULT_ROUTE_s *vault_route_get(OCKAM_VAULT_s *p_vault, VAULT_OP_e op, uint32_t size)
+{
+    VAULT_ROUTE_s *p_route = &(p_vault->route[op]);
+
+
+    if((p_vault->host_size[op] != OCKAM_VAULT_SIZE_NEVER) && (size >= p_vault->host_size[op])) {
+        p_route = &(p_vault->route_host);
+    }
+
+    return p_route;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_route_failover()
  *
- * @param   aad_size[in]        Size of the additional data (set to 0 if p_aad is NULL)
+ * @brief   Decide whether a call that went to the TPM should be run again on the host library. Used
+ *          only for calls on caller supplied data, never for keys held in the TPM.
  *
- * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
- *                              when decrypting.
+ * @param   p_vault[in]     The vault instance the call was made on
  *
- * @param   tag_size[in]        Size of the tag buffer
+ * @param   p_route[in,out] The route the call went through. Set to the host route on failover.
  *
- * @param   p_input[in]         Buffer with the input data to encrypt or decrypt
+ * @param   ret_val[in]     Result of the call
  *
- * @param   input_size[in]      Size of the input data
+ * @param   retry[in]       0 if the failed call may have overwritten its own input
  *
- * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can NOT be the
- *                              input buffer.
+ * @return  1 if the call should be run again through the updated route, 0 if ret_val is final.
  *
- * @param   output_size[in]     Size of the output buffer
+ ********************************************************************************************************
+ */
+
+static uint8_t vault_route_failover(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s **p_route,
+                                    OCKAM_ERR ret_val, uint8_t retry)
+{
+    uint8_t failover = 0;
+
+
+    if(((*p_route)->p_backend == &ockam_vault_tpm_backend) && (retry) &&
+       ((ret_val == OCKAM_ERR_VAULT_BUSY) ||
+        (ret_val == OCKAM_ERR_VAULT_TPM_DOWN) ||
+        (vault_tpm_failed(ret_val)))) {
+        *p_route = &(p_vault->route_host);
+        failover = 1;
+    }
+
+    return failover;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        vault_route_calibrate()
  *
- * @return  OCKAM_ERR_NONE if successful.
- *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
+ * @brief   Time an operation group on the TPM and on the host library at two input sizes and find
+ *          the size from which the host library is faster. Cost is taken as linear in the input
+ *          size between and beyond the two measurements.
+ *
+ * @param   p_vault[in]     The vault instance being initialized. Must be routed to the TPM for op.
+ *
+ * @param   op[in]          The operation group to measure
+ *
+ * @return  The host size threshold for the group. OCKAM_VAULT_SIZE_NEVER if the TPM is faster at
+ *          every size or the measurement failed.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_aes_gcm_decrypt(uint8_t *p_key, uint32_t key_size,
-                                      uint8_t *p_iv, uint32_t iv_size,
-                                      uint8_t *p_aad, uint32_t aad_size,
-                                      uint8_t *p_tag, uint32_t tag_size,
-                                      uint8_t *p_input, uint32_t input_size,
-                                      uint8_t *p_output, uint32_t output_size)
+static uint32_t vault_route_calibrate(OCKAM_VAULT_s *p_vault, VAULT_OP_e op)
 {
-    return ockam_vault_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_DECRYPT,
-                               p_key, key_size,
-                               p_iv, iv_size,
-                               p_aad, aad_size,
-                               p_tag, tag_size,
-                               p_input, input_size,
-                               p_output, output_size);
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint32_t host_size = OCKAM_VAULT_SIZE_NEVER;
+    uint8_t *p_buf = 0;
+    uint64_t tpm_small = 0;
+    uint64_t tpm_large = 0;
+    uint64_t host_small = 0;
+    uint64_t host_large = 0;
+    uint64_t tpm_slope;
+    uint64_t host_slope;
+    uint64_t cross;
+
+
+    do {
+        ret_val = ockam_mem_alloc((void**) &p_buf, VAULT_CALIBRATE_SIZE_LARGE);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ockam_mem_set(p_buf, 0, VAULT_CALIBRATE_SIZE_LARGE);
+
+        ret_val = vault_route_time(p_vault, &(p_vault->route[op]), op,
+                                   p_buf, VAULT_CALIBRATE_SIZE_SMALL, &tpm_small);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = vault_route_time(p_vault, &(p_vault->route[op]), op,
+                                   p_buf, VAULT_CALIBRATE_SIZE_LARGE, &tpm_large);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = vault_route_time(p_vault, &(p_vault->route_host), op,
+                                   p_buf, VAULT_CALIBRATE_SIZE_SMALL, &host_small);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = vault_route_time(p_vault, &(p_vault->route_host), op,
+                                   p_buf, VAULT_CALIBRATE_SIZE_LARGE, &host_large);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+                                                                /* Clamp timer noise to a flat cost                   */
+        tpm_slope = (tpm_large > tpm_small) ? (tpm_large - tpm_small) : 0;
+        host_slope = (host_large > host_small) ? (host_large - host_small) : 0;
+
+                                                                /* If the host does not gain on the TPM as inputs     */
+                                                                /* grow, use it for everything only if it already     */
+                                                                /* wins at both sizes.                                */
+        if(host_slope >= tpm_slope) {
+            if((host_small <= tpm_small) && (host_large <= tpm_large)) {
+                host_size = 0;
+            }
+        } else if(host_small <= tpm_small) {                    /* Host wins at the small size and gains from there   */
+            host_size = 0;
+        } else {                                                /* Host loses at the small size but gains on the TPM. */
+            cross = VAULT_CALIBRATE_SIZE_SMALL +                /* Solve for where the two lines meet.                */
+                    (((host_small - tpm_small) * (VAULT_CALIBRATE_SIZE_LARGE - VAULT_CALIBRATE_SIZE_SMALL)) /
+                     (tpm_slope - host_slope));
+            if(cross < OCKAM_VAULT_SIZE_NEVER) {
+                host_size = (uint32_t) cross;
+            }
+        }
+    } while(0);
+
+    if(p_buf != 0) {
+        ockam_mem_free(p_buf);
+    }
+
+    return host_size;
 }
 
 
 /**
  ********************************************************************************************************
- *                                      ockam_vault_aes_gcm()
+ *                                          vault_route_time()
  *
- * @brief   AES GCM function for both encrypt and decrypt Depending on underlying implementation may
- *          support 128, 192 and/or 256.
+ * @brief   Run one call of an operation group through a route on zeroed data and time it
  *
- * @param   mode                AES GCM Mode: Encrypt or Decrypt
+ * @param   p_vault[in]     The vault instance being initialized
  *
- * @param   p_key[in]           Buffer for the AES Key
+ * @param   p_route[in]     The route to measure
  *
- * @param   key_size[in]        Size of the AES Key. Must be 128, 192 or 256 bits
+ * @param   op[in]          The operation group to measure. Only SHA256, HKDF and AES GCM.
  *
- * @param   p_iv[in]            Buffer with the initialization vector
+ * @param   p_buf[in]       Scratch input buffer of at least size bytes. Overwritten by AES GCM.
  *
- * @param   iv_size[in]         Size of the initialization vector
+ * @param   size[in]        Number of input bytes to process
  *
- * @param   p_aad[in]           Buffer with the additional data (can be NULL)
+ * @param   p_time_us[out]  Returns the elapsed time in microseconds
  *
- * @param   aad_size[in]        Size of the additional data (set to 0 if p_aad is NULL)
+ * @return  OCKAM_ERR_NONE if the call succeeded and was timed.
  *
- * @param   p_tag[in,out]       Buffer to either hold the tag when encrypting or pass in the tag
- *                              when decrypting.
+ ********************************************************************************************************
+ */
+
+static OCKAM_ERR vault_route_time(OCKAM_VAULT_s *p_vault, VAULT_ROUTE_s *p_route, VAULT_OP_e op,
+                                  uint8_t *p_buf, uint32_t size, uint64_t *p_time_us)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+    uint8_t key[VAULT_SHA256_DIGEST_SIZE] = {0};                /* Salt for HKDF, key and IV for AES GCM              */
+    uint8_t out[VAULT_SHA256_DIGEST_SIZE];                      /* Digest, HKDF output or AES GCM tag                 */
+    uint64_t start = 0;
+    uint64_t end = 0;
+
+
+    do {
+        ret_val = ockam_kal_time_us(&start);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = vault_route_lock(p_vault, p_route);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        switch(op) {
+            case VAULT_OP_SHA256:
+                ret_val = p_route->p_backend->sha256(p_route->p_ctx,
+                                                     p_buf, size,
+                                                     out, VAULT_SHA256_DIGEST_SIZE);
+                break;
+
+            case VAULT_OP_HKDF:
+                ret_val = p_route->p_backend->hkdf(p_route->p_ctx,
+                                                   key, VAULT_SHA256_DIGEST_SIZE,
+                                                   p_buf, size,
+                                                   0, 0,
+                                                   out, VAULT_SHA256_DIGEST_SIZE);
+                break;
+
+            case VAULT_OP_AES_GCM:
+                ret_val = p_route->p_backend->aes_gcm(p_route->p_ctx,
+                                                      OCKAM_VAULT_AES_GCM_MODE_ENCRYPT,
+                                                      key, VAULT_CALIBRATE_AES_KEY_SIZE,
+                                                      key, VAULT_CALIBRATE_AES_IV_SIZE,
+                                                      0, 0,
+                                                      out, VAULT_CALIBRATE_AES_TAG_SIZE,
+                                                      p_buf, size,
+                                                      p_buf, size);
+                break;
+
+            default:
+                ret_val = OCKAM_ERR_INVALID_PARAM;
+                break;
+        }
+
+        ret_val = vault_route_unlock(p_route, ret_val);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        ret_val = ockam_kal_time_us(&end);
+        if(ret_val != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        *p_time_us = end - start;
+    } while(0);
+
+    return ret_val;
+}
+#endif
+
+
+#if(VAULT_ECDH_DERIVE_SPLIT_EN)
+/**
+ ********************************************************************************************************
+ *                                       vault_ecdh_derive_split()
  *
- * @param   tag_size[in]        Size of the tag buffer
+ * @brief   Run ockam_vault_ecdh_derive() one stage at a time when its stages are routed to different
+ *          backends. The shared secret and HKDF output only live on the stack for the call.
  *
- * @param   p_input[in]         Buffer with the input data to encrypt or decrypt
+ * @param   p_vault[in]         Handle of the vault instance to use
  *
- * @param   input_size[in]      Size of the input data
+ * @param   key_type[in]        Specify which key type to use in the ECDH execution
  *
- * @param   p_output[out]       Buffer for the output of the AES GCM operation. Can NOT be the
- *                              input buffer.
+ * @param   p_pub_key[in]       Buffer with the peer public key
  *
- * @param   output_size[in]     Size of the output buffer
+ * @param   pub_key_size[in]    Size of the public key buffer
+ *
+ * @param   p_salt[in]          Buffer for the HKDF salt
+ *
+ * @param   salt_size[in]       Size of the HKDF salt
+ *
+ * @param   p_info[in]          Buffer with the optional context specific info. Can be 0.
+ *
+ * @param   info_size[in]       Size of the optional context specific info
+ *
+ * @param   key_size[in]        Size of each AES Key in bytes
+ *
+ * @param   p_secrets[out]      Array that returns secret_count secret handles
+ *
+ * @param   secret_count[in]    Number of secrets to derive, at most OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX
  *
  * @return  OCKAM_ERR_NONE if successful.
- *          OCKAM_ERR_VAULT_TPM_AES_GCM_FAIL if unable to perform the requested AES GCM operation.
  *
  ********************************************************************************************************
  */
 
-OCKAM_ERR ockam_vault_aes_gcm(OCKAM_VAULT_AES_GCM_MODE_e mode,
-                              uint8_t *p_key, uint32_t key_size,
-                              uint8_t *p_iv, uint32_t iv_size,
-                              uint8_t *p_aad, uint32_t aad_size,
-                              uint8_t *p_tag, uint32_t tag_size,
-                              uint8_t *p_input, uint32_t input_size,
-                              uint8_t *p_output, uint32_t output_size)
+static OCKAM_ERR vault_ecdh_derive_split(OCKAM_VAULT_s *p_vault,
+                                         OCKAM_VAULT_KEY_e key_type,
+                                         uint8_t *p_pub_key, uint32_t pub_key_size,
+                                         uint8_t *p_salt, uint32_t salt_size,
+                                         uint8_t *p_info, uint32_t info_size,
+                                         uint32_t key_size,
+                                         OCKAM_VAULT_SECRET_s **p_secrets, uint32_t secret_count)
 {
     OCKAM_ERR ret_val = OCKAM_ERR_NONE;
-    OCKAM_ERR t_ret_val = OCKAM_ERR_NONE;
+    uint8_t pms[VAULT_PMS_SIZE];
+    uint8_t okm[VAULT_SECRET_KEY_SIZE_MAX * OCKAM_VAULT_ECDH_DERIVE_SECRET_MAX];
+    uint32_t i = 0;
 
 
     do {
-        ret_val = ockam_kal_mutex_lock(&g_vault_mutex, 0, 0);   /* Lock the mutex before checking the state or        */
-        if(ret_val != OCKAM_ERR_NONE) {                         /* performing the AES GCM operation                   */
+        ret_val = ockam_vault_ecdh(p_vault,
+                                   key_type,
+                                   p_pub_key, pub_key_size,
+                                   &pms[0], VAULT_PMS_SIZE);
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-        if(g_vault_state != VAULT_STATE_IDLE) {                 /* Ensure vault is in an idle state before continuing */
-            ret_val = OCKAM_ERR_VAULT_UNINITIALIZED;
+        ret_val = ockam_vault_hkdf(p_vault,
+                                   p_salt, salt_size,
+                                   &pms[0], VAULT_PMS_SIZE,
+                                   p_info, info_size,
+                                   &okm[0], (key_size * secret_count));
+        if(ret_val != OCKAM_ERR_NONE) {
             break;
         }
 
-#if(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_TPM)
-        ret_val = ockam_vault_tpm_aes_gcm(mode,                 /* Perform the AES GCM operation in the TPM           */
-                                          p_key, key_size,
-                                          p_iv, iv_size,
-                                          p_aad, aad_size,
-                                          p_tag, tag_size,
-                                          p_input, input_size,
-                                          p_output, output_size);
-#elif(OCKAM_VAULT_CFG_AES_GCM & OCKAM_VAULT_CFG_HOST)
-        ret_val = ockam_vault_host_aes_gcm(mode,                /* Perform the AES GCM operation in on the host       */
-                                           p_key, key_size,
-                                           p_iv, iv_size,
-                                           p_aad, aad_size,
-                                           p_tag, tag_size,
-                                           p_input, input_size,
-                                           p_output, output_size);
-#else
-#error "Ockam Vault: AES GCM Function missing"
-#endif
+        for(i = 0; i < secret_count; i++) {
+            ret_val = ockam_vault_secret_import(p_vault,
+                                                &p_secrets[i],
+                                                &okm[i * key_size], key_size);
+            if(ret_val != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        if(ret_val != OCKAM_ERR_NONE) {                         /* Release the secrets imported before the failure    */
+            while(i > 0) {
+                i--;
+                ockam_vault_secret_free(p_secrets[i]);
+                p_secrets[i] = 0;
+            }
+        }
     } while(0);
 
-    t_ret_val = ockam_kal_mutex_unlock(&g_vault_mutex, 0);      /* Unlock the mutex after all vault operations finish */
-    if(ret_val == OCKAM_ERR_NONE) {                             /* Don't overwrite ret_val if there was an error      */
-        ret_val = t_ret_val;                                    /* before the mutex unlock                            */
-    }
+    ockam_mem_set(&pms[0], 0, sizeof(pms));
+    ockam_mem_set(&okm[0], 0, sizeof(okm));
 
     return ret_val;
 }
-
+#endif
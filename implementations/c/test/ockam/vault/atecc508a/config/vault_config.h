@@ -24,7 +24,7 @@
  ********************************************************************************************************
  */
 
-#define OCKAM_VAULT_CFG_INIT               OCKAM_VAULT_TPM_MICROCHIP_ATECC508A | OCKAM_VAULT_HOST_MBEDCRYTPO
+#define OCKAM_VAULT_CFG_INIT               (OCKAM_VAULT_TPM_MICROCHIP_ATECC508A | OCKAM_VAULT_HOST_MBEDCRYPTO)
 
 #define OCKAM_VAULT_CFG_RAND               OCKAM_VAULT_TPM_MICROCHIP_ATECC508A
 
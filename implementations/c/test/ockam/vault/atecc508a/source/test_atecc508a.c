@@ -113,6 +113,7 @@ OCKAM_VAULT_CFG_s vault_cfg =
 void main (void)
 {
     OCKAM_ERR err;
+    OCKAM_VAULT_s *p_vault = 0;
     uint8_t i;
 
 
@@ -121,7 +122,7 @@ void main (void)
     /* ---------- */
 
     for(i = 0; i < TEST_VAULT_ATECC508A_INIT_RETRY_COUNT; i++) {/* Initialize Vault. Retry if init fails. Failure may */
-        err = ockam_vault_init((void*) &vault_cfg);             /* be due to wiring from the pi                       */
+        err = ockam_vault_init(&p_vault, &vault_cfg);           /* be due to wiring from the pi                       */
         if(err != OCKAM_ERR_NONE) {
             sleep(2);
         } else {
@@ -141,31 +142,52 @@ void main (void)
     /* Random Number Generation */
     /* ------------------------ */
 
-    test_vault_random();
+    test_vault_random(p_vault);
 
     /* --------------------- */
     /* Key Generation & ECDH */
     /* --------------------- */
 
-    test_vault_key_ecdh(vault_cfg.ec, 0);
+    test_vault_key_ecdh(p_vault, vault_cfg.ec, 0);
+    test_vault_ecdh_derive(p_vault, vault_cfg.ec);
 
     /* ------ */
     /* SHA256 */
     /* ------ */
 
-    test_vault_sha256();
+    test_vault_sha256(p_vault);
+    test_vault_sha256_stream(p_vault);
 
     /* -----*/
     /* HKDF */
     /* -----*/
 
-    test_vault_hkdf();
+    test_vault_hkdf(p_vault);
+    test_vault_hkdf_split(p_vault);
 
     /* -------------------- */
     /* AES GCM Calculations */
     /* -------------------- */
 
-    test_vault_aes_gcm();
+    test_vault_aes_gcm(p_vault);
+    test_vault_aes_gcm_batch(p_vault);
+    test_vault_aes_gcm_iov(p_vault);
+    test_vault_aes_gcm_inplace(p_vault);
+    test_vault_aes_gcm_stream(p_vault);
+    test_vault_aes_gcm_secret(p_vault);
+    test_vault_aes_gcm_secret_threads(p_vault);
+
+    /* ----------------- */
+    /* Async Vault Queue */
+    /* ----------------- */
+
+    test_vault_async(p_vault);
+
+    /* ---------- */
+    /* Vault Free */
+    /* ---------- */
+
+    ockam_vault_free(p_vault);
 
     return;
 }
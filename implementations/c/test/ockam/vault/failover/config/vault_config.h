@@ -0,0 +1,62 @@
+/**
+ ********************************************************************************************************
+ * @file        vault_config.h
+ * @brief       Vault configuration for the TPM failover test. Random numbers and SHA-256 go to the
+ *              fake TPM, everything else to the host library.
+ ********************************************************************************************************
+ */
+
+#ifndef VAULT_CONFIG_H_
+#define VAULT_CONFIG_H_
+
+
+/*
+ ********************************************************************************************************
+ *                                               INCLUDES                                               *
+ ********************************************************************************************************
+ */
+
+#include <ockam/vault/define.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                         Function Configuration                                       *
+ ********************************************************************************************************
+ */
+
+
+#define OCKAM_VAULT_CFG_INIT               (OCKAM_VAULT_TPM_MICROCHIP_ATECC608A | OCKAM_VAULT_HOST_MBEDCRYPTO)
+
+#define OCKAM_VAULT_CFG_RAND               OCKAM_VAULT_TPM_MICROCHIP_ATECC608A
+
+#define OCKAM_VAULT_CFG_KEY_ECDH           OCKAM_VAULT_HOST_MBEDCRYPTO
+
+#define OCKAM_VAULT_CFG_SHA256             OCKAM_VAULT_TPM_MICROCHIP_ATECC608A
+
+#define OCKAM_VAULT_CFG_HKDF               OCKAM_VAULT_HOST_MBEDCRYPTO
+
+#define OCKAM_VAULT_CFG_AES_GCM            OCKAM_VAULT_HOST_MBEDCRYPTO
+
+
+/*
+ ********************************************************************************************************
+ *                                           Size Based Routing                                         *
+ ********************************************************************************************************
+ */
+
+#define OCKAM_VAULT_CFG_SHA256_HOST_SIZE   OCKAM_VAULT_SIZE_NEVER
+
+
+/*
+ ********************************************************************************************************
+ *                                            TPM Failover                                              *
+ ********************************************************************************************************
+ */
+
+#define OCKAM_VAULT_CFG_TPM_FAIL_LIMIT     3u
+
+#define OCKAM_VAULT_CFG_TPM_RETRY_MS       100u
+
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ ********************************************************************************************************
+ * @file        test_failover.c
+ * @brief       TPM failover test. Runs against the fake TPM in tpm_fake.c.
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <ockam/define.h>
+#include <ockam/error.h>
+#include <ockam/kal.h>
+#include <ockam/log.h>
+#include <ockam/vault.h>
+
+#include <test_vault.h>
+
+#include OCKAM_VAULT_CONFIG_FILE
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+#define TEST_FAILOVER_RAND_SIZE                     32u
+#define TEST_FAILOVER_WAIT_US                       ((OCKAM_VAULT_CFG_TPM_RETRY_MS + 50u) * 1000u)
+
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+void test_failover_check(uint32_t test_case, uint8_t valid, char *p_str);
+
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+extern uint8_t g_tpm_fake_fail;                                 /* Defined by the fake TPM                            */
+extern uint32_t g_tpm_fake_cmds;
+extern uint32_t g_tpm_fake_frees;
+
+OCKAM_VAULT_CFG_s vault_cfg =
+{
+    .p_tpm                       = 0,
+    .p_host                      = 0,
+    OCKAM_VAULT_EC_P256
+};
+
+uint8_t g_failover_rand[TEST_FAILOVER_RAND_SIZE];
+
+
+/*
+ ********************************************************************************************************
+ *                                           GLOBAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            LOCAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+
+/**
+ ********************************************************************************************************
+ *                                             main()
+ *
+ * @brief   Make the fake TPM fail and check random numbers are rerun on the host library, that the
+ *          TPM is skipped once it has failed OCKAM_VAULT_CFG_TPM_FAIL_LIMIT times in a row, that
+ *          releasing a TPM context does not reset that count, and that the TPM is used again once
+ *          the retry time has passed.
+ *
+ ********************************************************************************************************
+ */
+
+void main (void)
+{
+    OCKAM_ERR err;
+    OCKAM_VAULT_s *p_vault = 0;
+    OCKAM_VAULT_SHA256_CTX_s *p_sha_ctx = 0;
+    uint32_t cmds = 0;
+    uint64_t start_us = 0;
+    uint64_t now_us = 0;
+    uint8_t valid = 0;
+    uint32_t i;
+
+
+    /* ---------- */
+    /* Vault Init */
+    /* ---------- */
+
+    err = ockam_vault_init(&p_vault, &vault_cfg);
+    if(err != OCKAM_ERR_NONE) {
+        test_vault_print(OCKAM_LOG_ERROR,
+                         "FAILOVER",
+                          0,
+                         "Error: Ockam Vault Init failed");
+        return;
+    }
+
+    /* ---------------------------- */
+    /* Healthy TPM Serves Requests */
+    /* ---------------------------- */
+
+    cmds = g_tpm_fake_cmds;
+    err = ockam_vault_random(p_vault, &g_failover_rand[0], TEST_FAILOVER_RAND_SIZE);
+    valid = (err == OCKAM_ERR_NONE) && (g_tpm_fake_cmds == cmds + 1);
+
+    if(valid) {                                                 /* Kept open to be released while the TPM is down     */
+        err = ockam_vault_sha256_ctx_init(p_vault, &p_sha_ctx);
+        valid = (err == OCKAM_ERR_NONE) && (g_tpm_fake_cmds == cmds + 2);
+    }
+    test_failover_check(0, valid, "Healthy TPM");
+
+    /* --------------------------------- */
+    /* Failing TPM Is Rerun On The Host */
+    /* --------------------------------- */
+
+    g_tpm_fake_fail = 1;
+    cmds = g_tpm_fake_cmds;
+    valid = 1;
+    for(i = 0; i < OCKAM_VAULT_CFG_TPM_FAIL_LIMIT; i++) {
+        err = ockam_vault_random(p_vault, &g_failover_rand[0], TEST_FAILOVER_RAND_SIZE);
+        if(err != OCKAM_ERR_NONE) {
+            valid = 0;
+        }
+    }
+    valid = valid && (g_tpm_fake_cmds == cmds + OCKAM_VAULT_CFG_TPM_FAIL_LIMIT);
+    test_failover_check(1, valid, "Host Rerun");
+
+    /* ------------------------------------------ */
+    /* TPM Skipped, Not Reset By Releasing Handles */
+    /* ------------------------------------------ */
+
+    cmds = g_tpm_fake_cmds;
+    err = ockam_vault_sha256_ctx_free(p_sha_ctx);               /* Reaches the TPM, but must not count as a success   */
+    p_sha_ctx = 0;
+    valid = (err == OCKAM_ERR_NONE) && (g_tpm_fake_frees == 1);
+
+    if(valid) {
+        err = ockam_vault_random(p_vault, &g_failover_rand[0], TEST_FAILOVER_RAND_SIZE);
+        valid = (err == OCKAM_ERR_NONE) && (g_tpm_fake_cmds == cmds);
+    }
+    test_failover_check(2, valid, "TPM Down");
+
+    /* ------------------------------ */
+    /* TPM Retried After Retry Time */
+    /* ------------------------------ */
+
+    g_tpm_fake_fail = 0;
+    ockam_kal_time_us(&start_us);
+    do {
+        ockam_kal_time_us(&now_us);
+    } while((now_us - start_us) < TEST_FAILOVER_WAIT_US);
+
+    cmds = g_tpm_fake_cmds;
+    valid = 1;
+    for(i = 0; i < 2; i++) {                                    /* The trial call, then a normal one                  */
+        err = ockam_vault_random(p_vault, &g_failover_rand[0], TEST_FAILOVER_RAND_SIZE);
+        if(err != OCKAM_ERR_NONE) {
+            valid = 0;
+        }
+    }
+    valid = valid && (g_tpm_fake_cmds == cmds + 2);
+    test_failover_check(3, valid, "TPM Back");
+
+    /* ---------- */
+    /* Vault Free */
+    /* ---------- */
+
+    ockam_vault_free(p_vault);
+
+    return;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        test_failover_check()
+ *
+ * @brief   Print the result of a failover test case
+ *
+ * @param   test_case   The test case number
+ *
+ * @param   valid       1 if the test case passed
+ *
+ * @param   p_str       Null-terminated name of the test case
+ *
+ ********************************************************************************************************
+ */
+
+void test_failover_check(uint32_t test_case, uint8_t valid, char *p_str)
+{
+    test_vault_print((valid) ? OCKAM_LOG_INFO : OCKAM_LOG_ERROR,
+                     "FAILOVER",
+                      test_case,
+                      p_str);
+}
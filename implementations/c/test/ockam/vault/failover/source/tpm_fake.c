@@ -0,0 +1,254 @@
+/**
+ ********************************************************************************************************
+ * @file    tpm_fake.c
+ * @brief   Fake TPM backend for the failover test. Random numbers and SHA-256 only, with failures
+ *          switched on and off by the test.
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <string.h>
+
+#include <ockam/define.h>
+#include <ockam/error.h>
+#include <ockam/vault.h>
+#include <ockam/vault/tpm.h>
+#include <ockam/vault/backend.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+uint8_t g_tpm_fake_fail = 0;                                    /* Set to make every command fail                     */
+uint32_t g_tpm_fake_cmds = 0;                                   /* Commands that reached the fake TPM                 */
+uint32_t g_tpm_fake_frees = 0;                                  /* Streaming contexts released                        */
+
+static uint8_t g_tpm_fake_ctx = 0;                              /* Only its address is used                           */
+static uint8_t g_tpm_fake_sha_ctx = 0;
+
+
+/*
+ ********************************************************************************************************
+ *                                           GLOBAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            LOCAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_tpm_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_init(void *p_arg, void **p_ctx)
+{
+    *p_ctx = &g_tpm_fake_ctx;
+
+    return OCKAM_ERR_NONE;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          ockam_vault_tpm_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_free(void *p_ctx)
+{
+    return OCKAM_ERR_NONE;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         ockam_vault_tpm_random()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_random(void *p_ctx,
+                                 uint8_t *p_rand_num,
+                                 uint32_t rand_num_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    g_tpm_fake_cmds++;
+
+    if(g_tpm_fake_fail) {
+        ret_val = OCKAM_ERR_VAULT_TPM_RAND_FAIL;
+    } else {
+        memset(p_rand_num, 0xA5, rand_num_size);
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                         ockam_vault_tpm_sha256()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256(void *p_ctx,
+                                 uint8_t *p_msg,
+                                 uint32_t msg_size,
+                                 uint8_t *p_digest,
+                                 uint8_t digest_size)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    g_tpm_fake_cmds++;
+
+    if(g_tpm_fake_fail) {
+        ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
+    } else {
+        memset(p_digest, 0, digest_size);
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_sha256_ctx_init()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_init(void *p_ctx,
+                                          void **p_sha_ctx)
+{
+    OCKAM_ERR ret_val = OCKAM_ERR_NONE;
+
+
+    g_tpm_fake_cmds++;
+
+    if(g_tpm_fake_fail) {
+        ret_val = OCKAM_ERR_VAULT_TPM_SHA256_FAIL;
+    } else {
+        *p_sha_ctx = &g_tpm_fake_sha_ctx;
+    }
+
+    return ret_val;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_sha256_ctx_update()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_update(void *p_sha_ctx,
+                                            uint8_t *p_msg, uint32_t msg_size)
+{
+    g_tpm_fake_cmds++;
+
+    return (g_tpm_fake_fail) ? OCKAM_ERR_VAULT_TPM_SHA256_FAIL : OCKAM_ERR_NONE;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                   ockam_vault_tpm_sha256_ctx_finish()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_finish(void *p_sha_ctx,
+                                            uint8_t *p_digest, uint8_t digest_size)
+{
+    return ockam_vault_tpm_sha256(&g_tpm_fake_ctx, 0, 0, p_digest, digest_size);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    ockam_vault_tpm_sha256_ctx_free()
+ ********************************************************************************************************
+ */
+
+OCKAM_ERR ockam_vault_tpm_sha256_ctx_free(void *p_sha_ctx)
+{
+    g_tpm_fake_frees++;                                         /* Releasing a context never touches the device       */
+
+    return OCKAM_ERR_NONE;
+}
+
+
+/*
+ ********************************************************************************************************
+ ********************************************************************************************************
+ *                                        Backend Function Table
+ ********************************************************************************************************
+ ********************************************************************************************************
+ */
+
+const OCKAM_VAULT_BACKEND_s ockam_vault_tpm_backend = {
+    .random                     = ockam_vault_tpm_random,
+    .key_gen                    = 0,
+    .key_get_pub                = 0,
+    .key_write                  = 0,
+    .ecdh                       = 0,
+    .sha256                     = ockam_vault_tpm_sha256,
+    .sha256_ctx_init            = ockam_vault_tpm_sha256_ctx_init,
+    .sha256_ctx_update          = ockam_vault_tpm_sha256_ctx_update,
+    .sha256_ctx_finish          = ockam_vault_tpm_sha256_ctx_finish,
+    .sha256_ctx_free            = ockam_vault_tpm_sha256_ctx_free,
+    .hkdf                       = 0,
+    .hkdf_extract               = 0,
+    .hkdf_expand                = 0,
+    .hkdf_prk_free              = 0,
+    .aes_gcm                    = 0,
+    .aes_gcm_batch              = 0,
+    .aes_gcm_iov                = 0,
+    .aes_gcm_ctx_init           = 0,
+    .aes_gcm_ctx_aad_update     = 0,
+    .aes_gcm_ctx_update         = 0,
+    .aes_gcm_ctx_finish         = 0,
+    .aes_gcm_ctx_free           = 0,
+    .secret_import              = 0,
+    .secret_aes_gcm             = 0,
+    .secret_free                = 0,
+    .ecdh_derive                = 0
+};
@@ -62,11 +62,23 @@
  ********************************************************************************************************
  */
 
-void test_vault_random(void);
-void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys);
-void test_vault_sha256(void);
-void test_vault_hkdf(void);
-void test_vault_aes_gcm(void);
+void test_vault_random(OCKAM_VAULT_s *p_vault);
+void test_vault_key_ecdh(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_EC_e ec, uint8_t load_keys);
+void test_vault_key_handle(OCKAM_VAULT_s *p_vault);
+void test_vault_ecdh_derive(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_EC_e ec);
+void test_vault_sha256(OCKAM_VAULT_s *p_vault);
+void test_vault_sha256_stream(OCKAM_VAULT_s *p_vault);
+void test_vault_hkdf(OCKAM_VAULT_s *p_vault);
+void test_vault_hkdf_split(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm_batch(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm_iov(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm_inplace(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm_stream(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm_secret(OCKAM_VAULT_s *p_vault);
+void test_vault_aes_gcm_secret_threads(OCKAM_VAULT_s *p_vault);
+void test_vault_async(OCKAM_VAULT_s *p_vault);
+void test_vault_lock(OCKAM_VAULT_CFG_s *p_cfg);
 
 void test_vault_print(OCKAM_LOG_e level, char* p_module, uint32_t test_case, char* p_msg);
 void test_vault_print_array(OCKAM_LOG_e level, char* p_module, char* p_label, uint8_t* p_array, uint32_t size);
@@ -85,6 +85,7 @@ OCKAM_VAULT_CFG_s vault_cfg =
 void main (void)
 {
     OCKAM_ERR err;
+    OCKAM_VAULT_s *p_vault = 0;
     uint8_t i;
 
 
@@ -92,7 +93,7 @@ void main (void)
     /* Vault Init */
     /* ---------- */
 
-    err = ockam_vault_init((void*) &vault_cfg);                 /* Initialize vault                                   */
+    err = ockam_vault_init(&p_vault, &vault_cfg);               /* Initialize vault                                   */
 
     if(err != OCKAM_ERR_NONE) {                                 /* Ensure it initialized before proceeding, otherwise */
         test_vault_print(OCKAM_LOG_ERROR,                       /* don't bother trying to run any other tests         */
@@ -106,31 +107,59 @@ void main (void)
     /* Random Number Generation */
     /* ------------------------ */
 
-    test_vault_random();
+    test_vault_random(p_vault);
 
     /* --------------------- */
     /* Key Generation & ECDH */
     /* --------------------- */
 
-    test_vault_key_ecdh(vault_cfg.ec, 1);
+    test_vault_key_ecdh(p_vault, vault_cfg.ec, 1);
+    test_vault_ecdh_derive(p_vault, vault_cfg.ec);
+    test_vault_key_handle(p_vault);
 
     /* ------ */
     /* SHA256 */
     /* ------ */
 
-    test_vault_sha256();
+    test_vault_sha256(p_vault);
+    test_vault_sha256_stream(p_vault);
 
     /* -----*/
     /* HKDF */
     /* -----*/
 
-    test_vault_hkdf();
+    test_vault_hkdf(p_vault);
+    test_vault_hkdf_split(p_vault);
 
     /* -------------------- */
     /* AES GCM Calculations */
     /* -------------------- */
 
-    test_vault_aes_gcm();
+    test_vault_aes_gcm(p_vault);
+    test_vault_aes_gcm_batch(p_vault);
+    test_vault_aes_gcm_iov(p_vault);
+    test_vault_aes_gcm_inplace(p_vault);
+    test_vault_aes_gcm_stream(p_vault);
+    test_vault_aes_gcm_secret(p_vault);
+    test_vault_aes_gcm_secret_threads(p_vault);
+
+    /* ----------------- */
+    /* Async Vault Queue */
+    /* ----------------- */
+
+    test_vault_async(p_vault);
+
+    /* ------------------ */
+    /* Non-Blocking Locks */
+    /* ------------------ */
+
+    test_vault_lock(&vault_cfg);
+
+    /* ---------- */
+    /* Vault Free */
+    /* ---------- */
+
+    ockam_vault_free(p_vault);
 
     return;
 }
@@ -12,6 +12,7 @@
  */
 
 #include <ockam/error.h>
+#include <ockam/kal.h>
 #include <ockam/log.h>
 #include <ockam/vault.h>
 #include <ockam/memory.h>
@@ -30,6 +31,8 @@
 #define TEST_VAULT_AES_GCM_KEY_SIZE                 16u
 #define TEST_VAULT_AES_GCM_TAG_SIZE                 16u
 
+#define TEST_VAULT_AES_GCM_THREAD_RUNS              500u
+
 
 /*
  ********************************************************************************************************
@@ -63,6 +66,19 @@ typedef struct {
 } TEST_VAULT_AES_GCM_DATA_s;
 
 
+/**
+ *******************************************************************************
+ * @struct  TEST_VAULT_AES_GCM_THREAD_s
+ * @brief   One thread of the shared secret test
+ *******************************************************************************
+ */
+typedef struct {
+    OCKAM_VAULT_SECRET_s *p_secret;                             /*!< Secret shared by both threads                    */
+    TEST_VAULT_AES_GCM_DATA_s *p_data;                          /*!< Test case the thread runs                        */
+    OCKAM_ERR err;                                              /*!< First failure seen by the thread                 */
+} TEST_VAULT_AES_GCM_THREAD_s;
+
+
 /*
  ********************************************************************************************************
  *                                          FUNCTION PROTOTYPES                                         *
@@ -70,6 +86,7 @@ typedef struct {
  */
 
 void test_vault_aes_gcm_print(OCKAM_LOG_e level, uint32_t test_case, char *p_str);
+void test_vault_aes_gcm_thread(void *p_arg);
 
 
 /*
@@ -178,7 +195,7 @@ TEST_VAULT_AES_GCM_DATA_s g_aes_gcm_data[TEST_VAULT_AES_GCM_CASES] =
  ********************************************************************************************************
  */
 
-void test_vault_aes_gcm(void)
+void test_vault_aes_gcm(OCKAM_VAULT_s *p_vault)
 {
     OCKAM_ERR err = OCKAM_ERR_NONE;
     int ret = 0;
@@ -215,7 +232,8 @@ void test_vault_aes_gcm(void)
         /* AES GCM Encrypt */
         /* --------------- */
 
-        err = ockam_vault_aes_gcm_encrypt(g_aes_gcm_data[i].p_key,
+        err = ockam_vault_aes_gcm_encrypt(p_vault,
+                                          g_aes_gcm_data[i].p_key,
                                           TEST_VAULT_AES_GCM_KEY_SIZE,
                                           g_aes_gcm_data[i].p_iv,
                                           g_aes_gcm_data[i].iv_size,
@@ -288,7 +306,8 @@ void test_vault_aes_gcm(void)
         /* AES GCM Decrypt */
         /* --------------- */
 
-        err = ockam_vault_aes_gcm_decrypt(g_aes_gcm_data[i].p_key,
+        err = ockam_vault_aes_gcm_decrypt(p_vault,
+                                          g_aes_gcm_data[i].p_key,
                                           TEST_VAULT_AES_GCM_KEY_SIZE,
                                           g_aes_gcm_data[i].p_iv,
                                           g_aes_gcm_data[i].iv_size,
@@ -340,6 +359,577 @@ void test_vault_aes_gcm(void)
 }
 
 
+/**
+ ********************************************************************************************************
+ *                                       test_vault_aes_gcm_batch()
+ *
+ * @brief   Encrypt and then decrypt every test case in a single batch call. All of the test cases
+ *          share the same key.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_batch(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_AES_GCM_REC_s recs[TEST_VAULT_AES_GCM_CASES];
+    uint8_t tags[TEST_VAULT_AES_GCM_CASES][TEST_VAULT_AES_GCM_TAG_SIZE];
+    uint8_t *p_encrypted[TEST_VAULT_AES_GCM_CASES] = { 0 };
+    uint8_t *p_decrypted[TEST_VAULT_AES_GCM_CASES] = { 0 };
+    uint8_t i = 0;
+
+
+    do {
+        for(i = 0; i < TEST_VAULT_AES_GCM_CASES; i++) {
+            if(g_aes_gcm_data[i].text_size > 0) {
+                err = ockam_mem_alloc(&p_encrypted[i], g_aes_gcm_data[i].text_size);
+                if(err == OCKAM_ERR_NONE) {
+                    err = ockam_mem_alloc(&p_decrypted[i], g_aes_gcm_data[i].text_size);
+                }
+
+                if(err != OCKAM_ERR_NONE) {
+                    test_vault_aes_gcm_print(OCKAM_LOG_FATAL,
+                                             i,
+                                             "Batch Memory Allocation Failed");
+                    break;
+                }
+            }
+
+            recs[i].p_iv = g_aes_gcm_data[i].p_iv;
+            recs[i].iv_size = g_aes_gcm_data[i].iv_size;
+            recs[i].p_aad = g_aes_gcm_data[i].p_aad;
+            recs[i].aad_size = g_aes_gcm_data[i].aad_size;
+            recs[i].p_tag = &tags[i][0];
+            recs[i].tag_size = TEST_VAULT_AES_GCM_TAG_SIZE;
+            recs[i].p_input = g_aes_gcm_data[i].p_plain_text;
+            recs[i].input_size = g_aes_gcm_data[i].text_size;
+            recs[i].p_output = p_encrypted[i];
+            recs[i].output_size = g_aes_gcm_data[i].text_size;
+        }
+
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        /* --------------------- */
+        /* AES GCM Batch Encrypt */
+        /* --------------------- */
+
+        err = ockam_vault_aes_gcm_encrypt_batch(p_vault,
+                                                &g_aes_gcm_test1_key[0],
+                                                TEST_VAULT_AES_GCM_KEY_SIZE,
+                                                &recs[0],
+                                                TEST_VAULT_AES_GCM_CASES);
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                     TEST_VAULT_NO_TEST_CASE,
+                                     "Batch Encrypt Operation Failed");
+            break;
+        }
+
+        for(i = 0; i < TEST_VAULT_AES_GCM_CASES; i++) {
+            if((memcmp(&tags[i][0], g_aes_gcm_data[i].p_tag, TEST_VAULT_AES_GCM_TAG_SIZE) != 0) ||
+               (memcmp(p_encrypted[i], g_aes_gcm_data[i].p_encrypted_text, g_aes_gcm_data[i].text_size) != 0)) {
+                test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                         i,
+                                         "Batch Encrypt Result Invalid");
+            } else {
+                test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                         i,
+                                         "Batch Encrypt Result Valid");
+            }
+
+            recs[i].p_input = p_encrypted[i];                   /* Decrypt what was just encrypted, using the tags    */
+            recs[i].p_output = p_decrypted[i];                  /* calculated by the batch encrypt                    */
+        }
+
+        /* --------------------- */
+        /* AES GCM Batch Decrypt */
+        /* --------------------- */
+
+        err = ockam_vault_aes_gcm_decrypt_batch(p_vault,
+                                                &g_aes_gcm_test1_key[0],
+                                                TEST_VAULT_AES_GCM_KEY_SIZE,
+                                                &recs[0],
+                                                TEST_VAULT_AES_GCM_CASES);
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                     TEST_VAULT_NO_TEST_CASE,
+                                     "Batch Decrypt Operation Failed");
+            break;
+        }
+
+        for(i = 0; i < TEST_VAULT_AES_GCM_CASES; i++) {
+            if(memcmp(p_decrypted[i], g_aes_gcm_data[i].p_plain_text, g_aes_gcm_data[i].text_size) != 0) {
+                test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                         i,
+                                         "Batch Decrypt Result Invalid");
+            } else {
+                test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                         i,
+                                         "Batch Decrypt Result Valid");
+            }
+        }
+    } while(0);
+
+    for(i = 0; i < TEST_VAULT_AES_GCM_CASES; i++) {
+        if(p_encrypted[i] != 0) {
+            ockam_mem_free(p_encrypted[i]);
+        }
+
+        if(p_decrypted[i] != 0) {
+            ockam_mem_free(p_decrypted[i]);
+        }
+    }
+}
+
+
+
+/**
+ ********************************************************************************************************
+ *                                        test_vault_aes_gcm_iov()
+ *
+ * @brief   Encrypt and decrypt the first test case with its additional data, input and output split
+ *          into fragments that do not line up with each other or with the AES block size
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_iov(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    TEST_VAULT_AES_GCM_DATA_s *p_data = &g_aes_gcm_data[0];
+    uint8_t tag[TEST_VAULT_AES_GCM_TAG_SIZE];
+    uint8_t encrypted[60];
+    uint8_t decrypted[60];
+    OCKAM_VAULT_IOVEC_s aad[2];
+    OCKAM_VAULT_IOVEC_s input[3];
+    OCKAM_VAULT_IOVEC_s output[2];
+
+
+    aad[0].p_buf = p_data->p_aad;                               /* Additional data as a 4 byte and 16 byte fragment   */
+    aad[0].size = 4;
+    aad[1].p_buf = p_data->p_aad + 4;
+    aad[1].size = p_data->aad_size - 4;
+
+    input[0].p_buf = p_data->p_plain_text;                      /* Input as 7, 20 and 33 byte fragments, output as    */
+    input[0].size = 7;                                          /* two 30 byte fragments                              */
+    input[1].p_buf = p_data->p_plain_text + 7;
+    input[1].size = 20;
+    input[2].p_buf = p_data->p_plain_text + 27;
+    input[2].size = p_data->text_size - 27;
+
+    output[0].p_buf = &encrypted[0];
+    output[0].size = 30;
+    output[1].p_buf = &encrypted[30];
+    output[1].size = p_data->text_size - 30;
+
+    do {
+        err = ockam_vault_aes_gcm_encrypt_iov(p_vault,
+                                              p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE,
+                                              p_data->p_iv, p_data->iv_size,
+                                              &aad[0], 2,
+                                              &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE,
+                                              &input[0], 3,
+                                              &output[0], 2);
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&tag[0], p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE) != 0) ||
+           (memcmp(&encrypted[0], p_data->p_encrypted_text, p_data->text_size) != 0)) {
+            test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                     0,
+                                     "Scatter/Gather Encrypt Invalid");
+            break;
+        }
+
+        input[0].p_buf = &encrypted[0];                         /* Decrypt the two fragments back into three          */
+        input[1].p_buf = &encrypted[7];
+        input[2].p_buf = &encrypted[27];
+        output[0].p_buf = &decrypted[0];
+        output[1].p_buf = &decrypted[30];
+
+        err = ockam_vault_aes_gcm_decrypt_iov(p_vault,
+                                              p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE,
+                                              p_data->p_iv, p_data->iv_size,
+                                              &aad[0], 2,
+                                              p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE,
+                                              &input[0], 3,
+                                              &output[0], 2);
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&decrypted[0], p_data->p_plain_text, p_data->text_size) != 0)) {
+            test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                     0,
+                                     "Scatter/Gather Decrypt Invalid");
+            break;
+        }
+
+        test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                 0,
+                                 "Scatter/Gather Encrypt & Decrypt Valid");
+    } while(0);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      test_vault_aes_gcm_inplace()
+ *
+ * @brief   Encrypt and decrypt the first test case in place, using one buffer for input and output
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_inplace(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    TEST_VAULT_AES_GCM_DATA_s *p_data = &g_aes_gcm_data[0];
+    uint8_t tag[TEST_VAULT_AES_GCM_TAG_SIZE];
+    uint8_t text[60];
+
+
+    memcpy(&text[0], p_data->p_plain_text, p_data->text_size);
+
+    do {
+        err = ockam_vault_aes_gcm_encrypt(p_vault,
+                                          p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE,
+                                          p_data->p_iv, p_data->iv_size,
+                                          p_data->p_aad, p_data->aad_size,
+                                          &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE,
+                                          &text[0], p_data->text_size,
+                                          &text[0], p_data->text_size);
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&tag[0], p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE) != 0) ||
+           (memcmp(&text[0], p_data->p_encrypted_text, p_data->text_size) != 0)) {
+            test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                     0,
+                                     "In Place Encrypt Invalid");
+            break;
+        }
+
+        err = ockam_vault_aes_gcm_decrypt(p_vault,
+                                          p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE,
+                                          p_data->p_iv, p_data->iv_size,
+                                          p_data->p_aad, p_data->aad_size,
+                                          &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE,
+                                          &text[0], p_data->text_size,
+                                          &text[0], p_data->text_size);
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&text[0], p_data->p_plain_text, p_data->text_size) != 0)) {
+            test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                     0,
+                                     "In Place Decrypt Invalid");
+            break;
+        }
+
+        test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                 0,
+                                 "In Place Encrypt & Decrypt Valid");
+    } while(0);
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      test_vault_aes_gcm_stream()
+ *
+ * @brief   Encrypt and decrypt the first test case with a streaming context, splitting the additional
+ *          data in two and the text into a full block update followed by the remainder
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_stream(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    TEST_VAULT_AES_GCM_DATA_s *p_data = &g_aes_gcm_data[0];
+    OCKAM_VAULT_AES_GCM_CTX_s *p_ctx = 0;
+    OCKAM_VAULT_AES_GCM_MODE_e mode = OCKAM_VAULT_AES_GCM_MODE_ENCRYPT;
+    uint8_t tag[TEST_VAULT_AES_GCM_TAG_SIZE];
+    uint8_t text[60];
+    uint8_t *p_input = p_data->p_plain_text;
+    uint32_t aad_split = p_data->aad_size / 2;
+    uint32_t text_split = 2 * OCKAM_VAULT_AES_GCM_BLOCK_SIZE;
+    uint32_t i = 0;
+
+
+    for(i = 0; i < 2; i++) {
+        err = ockam_vault_aes_gcm_ctx_init(p_vault, &p_ctx, mode,
+                                           p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE,
+                                           p_data->p_iv, p_data->iv_size);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_aes_gcm_ctx_aad_update(p_ctx, p_data->p_aad, aad_split);
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_aes_gcm_ctx_aad_update(p_ctx,
+                                                     p_data->p_aad + aad_split,
+                                                     p_data->aad_size - aad_split);
+        }
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_aes_gcm_ctx_update(p_ctx,
+                                                 p_input, text_split,
+                                                 &text[0], text_split);
+        }
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_aes_gcm_ctx_update(p_ctx,
+                                                 p_input + text_split, p_data->text_size - text_split,
+                                                 &text[text_split], p_data->text_size - text_split);
+        }
+        if(err == OCKAM_ERR_NONE) {
+            if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+                err = ockam_vault_aes_gcm_ctx_finish(p_ctx, &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE);
+            } else {
+                err = ockam_vault_aes_gcm_ctx_finish(p_ctx, p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE);
+            }
+        }
+
+        ockam_vault_aes_gcm_ctx_free(p_ctx);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(mode == OCKAM_VAULT_AES_GCM_MODE_ENCRYPT) {
+            if((memcmp(&tag[0], p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE) != 0) ||
+               (memcmp(&text[0], p_data->p_encrypted_text, p_data->text_size) != 0)) {
+                err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+            mode = OCKAM_VAULT_AES_GCM_MODE_DECRYPT;
+            p_input = p_data->p_encrypted_text;
+        } else if(memcmp(&text[0], p_data->p_plain_text, p_data->text_size) != 0) {
+            err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            break;
+        }
+    }
+
+    if(err != OCKAM_ERR_NONE) {
+        test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                 0,
+                                 "Streaming Encrypt & Decrypt Invalid");
+    } else {
+        test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                 0,
+                                 "Streaming Encrypt & Decrypt Valid");
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                      test_vault_aes_gcm_secret()
+ *
+ * @brief   Encrypt both test cases and decrypt the first one with a secret imported once. A one-shot
+ *          operation runs in between so the secret has to reload its key where the slot is shared.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_secret(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    TEST_VAULT_AES_GCM_DATA_s *p_data = &g_aes_gcm_data[0];
+    OCKAM_VAULT_SECRET_s *p_secret = 0;
+    uint8_t tag[TEST_VAULT_AES_GCM_TAG_SIZE];
+    uint8_t text[60];
+    uint8_t scratch[60];
+    uint32_t i = 0;
+
+
+    do {
+        err = ockam_vault_secret_import(p_vault, &p_secret,
+                                        p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < TEST_VAULT_AES_GCM_CASES; i++) {
+            p_data = &g_aes_gcm_data[i];
+
+            err = ockam_vault_secret_aes_gcm_encrypt(p_secret,
+                                                     p_data->p_iv, p_data->iv_size,
+                                                     p_data->p_aad, p_data->aad_size,
+                                                     &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE,
+                                                     p_data->p_plain_text, p_data->text_size,
+                                                     (p_data->text_size ? &text[0] : 0), p_data->text_size);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            if((memcmp(&tag[0], p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE) != 0) ||
+               (memcmp(&text[0], p_data->p_encrypted_text, p_data->text_size) != 0)) {
+                err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+        }
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        p_data = &g_aes_gcm_data[0];
+
+        err = ockam_vault_aes_gcm_encrypt(p_vault,
+                                          p_data->p_key, TEST_VAULT_AES_GCM_KEY_SIZE,
+                                          p_data->p_iv, p_data->iv_size,
+                                          p_data->p_aad, p_data->aad_size,
+                                          &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE,
+                                          p_data->p_plain_text, p_data->text_size,
+                                          &scratch[0], p_data->text_size);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_secret_aes_gcm_decrypt(p_secret,
+                                                 p_data->p_iv, p_data->iv_size,
+                                                 p_data->p_aad, p_data->aad_size,
+                                                 p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE,
+                                                 p_data->p_encrypted_text, p_data->text_size,
+                                                 &text[0], p_data->text_size);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(memcmp(&text[0], p_data->p_plain_text, p_data->text_size) != 0) {
+            err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            break;
+        }
+    } while(0);
+
+    if(p_secret != 0) {
+        ockam_vault_secret_free(p_secret);
+    }
+
+    if(err != OCKAM_ERR_NONE) {
+        test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                 0,
+                                 "Secret Encrypt & Decrypt Invalid");
+    } else {
+        test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                 0,
+                                 "Secret Encrypt & Decrypt Valid");
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                    test_vault_aes_gcm_secret_threads()
+ *
+ * @brief   Encrypt and decrypt with one secret from two threads at once, each thread running its own
+ *          test case. Every result must still match the expected output.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_secret_threads(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_SECRET_s *p_secret = 0;
+    TEST_VAULT_AES_GCM_THREAD_s runs[TEST_VAULT_AES_GCM_CASES];
+    OCKAM_KAL_THREAD threads[TEST_VAULT_AES_GCM_CASES];
+    uint32_t started = 0;
+    uint32_t i = 0;
+
+
+    do {
+        err = ockam_vault_secret_import(p_vault, &p_secret,     /* Both test cases use the same key                   */
+                                        g_aes_gcm_data[0].p_key, TEST_VAULT_AES_GCM_KEY_SIZE);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < TEST_VAULT_AES_GCM_CASES; i++) {
+            runs[i].p_secret = p_secret;
+            runs[i].p_data = &g_aes_gcm_data[i];
+            runs[i].err = OCKAM_ERR_NONE;
+
+            err = ockam_kal_thread_create(&threads[i], test_vault_aes_gcm_thread, &runs[i]);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+            started++;
+        }
+    } while(0);
+
+    for(i = 0; i < started; i++) {                              /* Always wait so the secret outlives its users       */
+        ockam_kal_thread_join(&threads[i]);
+        if((err == OCKAM_ERR_NONE) && (runs[i].err != OCKAM_ERR_NONE)) {
+            err = runs[i].err;
+        }
+    }
+
+    if(p_secret != 0) {
+        ockam_vault_secret_free(p_secret);
+    }
+
+    if(err != OCKAM_ERR_NONE) {
+        test_vault_aes_gcm_print(OCKAM_LOG_ERROR,
+                                 0,
+                                 "Secret Shared By Threads Invalid");
+    } else {
+        test_vault_aes_gcm_print(OCKAM_LOG_INFO,
+                                 0,
+                                 "Secret Shared By Threads Valid");
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                       test_vault_aes_gcm_thread()
+ *
+ * @brief   Repeatedly encrypt and decrypt one test case with a shared secret
+ *
+ * @param   p_arg       The TEST_VAULT_AES_GCM_THREAD_s of the thread
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_aes_gcm_thread(void *p_arg)
+{
+    TEST_VAULT_AES_GCM_THREAD_s *p_run = (TEST_VAULT_AES_GCM_THREAD_s*) p_arg;
+    TEST_VAULT_AES_GCM_DATA_s *p_data = p_run->p_data;
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    uint8_t tag[TEST_VAULT_AES_GCM_TAG_SIZE];
+    uint8_t text[60];
+    uint32_t i = 0;
+
+
+    for(i = 0; (i < TEST_VAULT_AES_GCM_THREAD_RUNS) && (err == OCKAM_ERR_NONE); i++) {
+        err = ockam_vault_secret_aes_gcm_encrypt(p_run->p_secret,
+                                                 p_data->p_iv, p_data->iv_size,
+                                                 p_data->p_aad, p_data->aad_size,
+                                                 &tag[0], TEST_VAULT_AES_GCM_TAG_SIZE,
+                                                 p_data->p_plain_text, p_data->text_size,
+                                                 (p_data->text_size ? &text[0] : 0), p_data->text_size);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if((memcmp(&tag[0], p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE) != 0) ||
+           (memcmp(&text[0], p_data->p_encrypted_text, p_data->text_size) != 0)) {
+            err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+            break;
+        }
+
+        err = ockam_vault_secret_aes_gcm_decrypt(p_run->p_secret,
+                                                 p_data->p_iv, p_data->iv_size,
+                                                 p_data->p_aad, p_data->aad_size,
+                                                 p_data->p_tag, TEST_VAULT_AES_GCM_TAG_SIZE,
+                                                 p_data->p_encrypted_text, p_data->text_size,
+                                                 (p_data->text_size ? &text[0] : 0), p_data->text_size);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        if(memcmp(&text[0], p_data->p_plain_text, p_data->text_size) != 0) {
+            err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+        }
+    }
+
+    p_run->err = err;
+}
+
+
 /**
  ********************************************************************************************************
  *                                          test_vault_aes_gcm_print()
@@ -0,0 +1,259 @@
+/**
+ ********************************************************************************************************
+ * @file    async.c
+ * @brief   Common async request queue test functions for Ockam Vault
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <ockam/error.h>
+#include <ockam/kal.h>
+#include <ockam/log.h>
+#include <ockam/vault.h>
+#include <ockam/vault/async.h>
+
+#include <test_vault.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+#define TEST_VAULT_ASYNC_QUEUE_SIZE                 4u
+#define TEST_VAULT_ASYNC_RAND_SIZE                  32u
+#define TEST_VAULT_ASYNC_DIGEST_SIZE                32u
+
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+void test_vault_async_cb(OCKAM_VAULT_REQ_s *p_req);
+
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+uint8_t g_async_msg[] = { 0x61, 0x62, 0x63 };                   /* "abc" from FIPS 180-2                              */
+
+uint8_t g_async_digest_expected[] = {
+    0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA,
+    0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+    0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C,
+    0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+};
+
+uint8_t g_async_rand[TEST_VAULT_ASYNC_RAND_SIZE];
+uint8_t g_async_digest[TEST_VAULT_ASYNC_DIGEST_SIZE];
+uint8_t g_async_cancel_digest[TEST_VAULT_ASYNC_DIGEST_SIZE];
+
+
+/*
+ ********************************************************************************************************
+ *                                           GLOBAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            LOCAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+
+/**
+ ********************************************************************************************************
+ *                                          test_vault_async_cb()
+ *
+ * @brief   Completion callback for the async tests. Counts completed requests.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_async_cb(OCKAM_VAULT_REQ_s *p_req)
+{
+    uint32_t *p_done = (uint32_t*) p_req->p_cb_arg;
+
+
+    (*p_done)++;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                          test_vault_async()
+ *
+ * @brief   Submit requests to an async queue, drain it inline and check every completion callback ran
+ *          with the expected result
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_async(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_ASYNC_s *p_async = 0;
+    OCKAM_VAULT_REQ_s rand_req = { 0 };
+    OCKAM_VAULT_REQ_s sha_req = { 0 };
+    OCKAM_VAULT_REQ_s cancel_req = { 0 };
+    OCKAM_VAULT_ASYNC_TOKEN_s token = { 0 };
+    uint32_t done = 0;
+    uint32_t i;
+
+
+    do {
+        err = ockam_vault_async_init(&p_async,
+                                     p_vault,
+                                     TEST_VAULT_ASYNC_QUEUE_SIZE);
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async queue init failed");
+            break;
+        }
+
+        rand_req.op = OCKAM_VAULT_ASYNC_OP_RANDOM;
+        rand_req.cb = test_vault_async_cb;
+        rand_req.p_cb_arg = &done;
+        rand_req.args.random.p_rand_num = &g_async_rand[0];
+        rand_req.args.random.rand_num_size = TEST_VAULT_ASYNC_RAND_SIZE;
+
+        sha_req.op = OCKAM_VAULT_ASYNC_OP_SHA256;
+        sha_req.cb = test_vault_async_cb;
+        sha_req.p_cb_arg = &done;
+        sha_req.args.sha256.p_msg = &g_async_msg[0];
+        sha_req.args.sha256.msg_size = sizeof(g_async_msg);
+        sha_req.args.sha256.p_digest = &g_async_digest[0];
+        sha_req.args.sha256.digest_size = TEST_VAULT_ASYNC_DIGEST_SIZE;
+
+        cancel_req = sha_req;
+        cancel_req.p_token = &token;
+        cancel_req.args.sha256.p_digest = &g_async_cancel_digest[0];
+
+        err = ockam_vault_async_submit(p_async, &rand_req);
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_async_submit(p_async, &sha_req);
+        }
+
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_async_submit(p_async, &cancel_req);
+        }
+
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async submit failed");
+            break;
+        }
+
+        ockam_vault_async_cancel(&token);                       /* Cancel one request while it is still queued        */
+
+                                                                /* Drain the fast lane inline. Only the SHA256        */
+                                                                /* requests are on it, the random request must still  */
+                                                                /* be waiting on the slow lane.                       */
+        do {
+            err = ockam_vault_async_run(p_async,
+                                        OCKAM_VAULT_ASYNC_LANE_FAST,
+                                        OCKAM_KAL_OPT_NON_BLOCKING,
+                                        0);
+        } while(err == OCKAM_ERR_NONE);
+
+        if((err != OCKAM_ERR_KAL_QUEUE_EMPTY) || (done != 2) || (sha_req.result != OCKAM_ERR_NONE)) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async fast lane did not run separately");
+            break;
+        }
+
+        if(cancel_req.result != OCKAM_ERR_VAULT_CANCELLED) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async cancelled request was executed");
+            break;
+        }
+
+        err = ockam_vault_async_submit(p_async, &cancel_req);   /* A dead request is turned away at submit            */
+        if(err != OCKAM_ERR_VAULT_CANCELLED) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async cancelled request was queued");
+            break;
+        }
+
+        do {
+            err = ockam_vault_async_run(p_async,
+                                        OCKAM_VAULT_ASYNC_LANE_SLOW,
+                                        OCKAM_KAL_OPT_NON_BLOCKING,
+                                        0);
+        } while(err == OCKAM_ERR_NONE);
+
+        if((err != OCKAM_ERR_KAL_QUEUE_EMPTY) || (done != 3)) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async requests did not all complete");
+            break;
+        }
+
+        if((rand_req.result != OCKAM_ERR_NONE) ||
+           (sha_req.result != OCKAM_ERR_NONE)) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async request returned an error");
+            break;
+        }
+
+        for(i = 0; i < TEST_VAULT_ASYNC_DIGEST_SIZE; i++) {
+            if(g_async_digest[i] != g_async_digest_expected[i]) {
+                break;
+            }
+        }
+
+        if(i != TEST_VAULT_ASYNC_DIGEST_SIZE) {
+            test_vault_print(OCKAM_LOG_ERROR,
+                             "ASYNC",
+                             TEST_VAULT_NO_TEST_CASE,
+                             "Async SHA256 digest mismatch");
+            break;
+        }
+
+        test_vault_print(OCKAM_LOG_INFO,
+                         "ASYNC",
+                         TEST_VAULT_NO_TEST_CASE,
+                         "Async Requests Success");
+    } while(0);
+
+    if(p_async != 0) {
+        ockam_vault_async_free(p_async);
+    }
+}
@@ -136,7 +136,7 @@ TEST_VAULT_HKDF_DATA_s g_hkdf_data[TEST_VAULT_HKDF_CASES] =
  ********************************************************************************************************
  */
 
-void test_vault_hkdf()
+void test_vault_hkdf(OCKAM_VAULT_s *p_vault)
 {
     OCKAM_ERR err = OCKAM_ERR_NONE;
     uint32_t i = 0;
@@ -147,7 +147,8 @@ void test_vault_hkdf()
 
         uint8_t hkdf_key[g_hkdf_data[i].output_size];
 
-        err = ockam_vault_hkdf( g_hkdf_data[i].p_salt,          /* Calculate HKDF using test vectors                  */
+        err = ockam_vault_hkdf( p_vault,                        /* Calculate HKDF using test vectors                  */
+                                g_hkdf_data[i].p_salt,
                                 g_hkdf_data[i].salt_size,
                                 g_hkdf_data[i].p_shared_secret,
                                 g_hkdf_data[i].shared_secret_size,
@@ -190,6 +191,101 @@ void test_vault_hkdf()
 }
 
 
+/**
+ ********************************************************************************************************
+ *                                        test_vault_hkdf_split()
+ *
+ * @brief   Extract once and expand twice per test vector. A one-shot HKDF runs between the two
+ *          expands so a backend holding the PRK in a shared slot must reload it.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_hkdf_split(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_HKDF_PRK_s *p_prk = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    int hkdf_cmp = 0;
+
+
+    for(i = 0; i < TEST_VAULT_HKDF_CASES; i++) {
+
+        uint8_t hkdf_key[g_hkdf_data[i].output_size];
+        uint8_t other_key[g_hkdf_data[i].output_size];
+
+        err = ockam_vault_hkdf_extract(p_vault,                 /* Extract stage only, PRK kept in the handle         */
+                                       &p_prk,
+                                       g_hkdf_data[i].p_salt,
+                                       g_hkdf_data[i].salt_size,
+                                       g_hkdf_data[i].p_shared_secret,
+                                       g_hkdf_data[i].shared_secret_size);
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_hkdf_print(OCKAM_LOG_ERROR,
+                                  i,
+                                  "HKDF Extract Failed");
+            continue;
+        }
+
+        for(j = 0; j < 2; j++) {
+            if(j == 1) {
+                err = ockam_vault_hkdf(p_vault,                 /* Use the HKDF slot with an unrelated key            */
+                                       g_hkdf_data[i].p_info,
+                                       g_hkdf_data[i].info_size,
+                                       g_hkdf_data[i].p_shared_secret,
+                                       g_hkdf_data[i].shared_secret_size,
+                                       0,
+                                       0,
+                                       &other_key[0],
+                                       g_hkdf_data[i].output_size);
+                if(err != OCKAM_ERR_NONE) {
+                    test_vault_hkdf_print(OCKAM_LOG_ERROR,
+                                          i,
+                                          "HKDF Operation Failed");
+                    break;
+                }
+            }
+
+            err = ockam_vault_hkdf_expand(p_prk,
+                                          g_hkdf_data[i].p_info,
+                                          g_hkdf_data[i].info_size,
+                                          &hkdf_key[0],
+                                          g_hkdf_data[i].output_size);
+            if(err != OCKAM_ERR_NONE) {
+                test_vault_hkdf_print(OCKAM_LOG_ERROR,
+                                      i,
+                                      "HKDF Expand Failed");
+                break;
+            }
+
+            hkdf_cmp = memcmp(&hkdf_key[0],
+                               g_hkdf_data[i].p_output,
+                               g_hkdf_data[i].output_size);
+            if(hkdf_cmp != 0) {
+                test_vault_hkdf_print(OCKAM_LOG_ERROR,
+                                      i,
+                                      "HKDF Expand Invalid");
+                break;
+            }
+        }
+
+        if((err == OCKAM_ERR_NONE) && (hkdf_cmp == 0)) {
+            test_vault_hkdf_print(OCKAM_LOG_INFO,
+                                  i,
+                                  "HKDF Extract/Expand Valid");
+        }
+
+        err = ockam_vault_hkdf_prk_free(p_prk);
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_hkdf_print(OCKAM_LOG_ERROR,
+                                  i,
+                                  "HKDF PRK Free Failed");
+        }
+    }
+}
+
+
 /**
  ********************************************************************************************************
  *                                          test_vault_hkdf_print()
@@ -33,6 +33,11 @@
 
 #define TEST_VAULT_PMS_SIZE                         32u
 
+#define TEST_VAULT_KEY_HANDLE_COUNT                100u         /* More than one slab of the host key table           */
+
+#define TEST_VAULT_DERIVE_KEY_SIZE                  16u         /* AES-128 fits every backend                         */
+#define TEST_VAULT_DERIVE_SECRET_COUNT               2u
+
 
 /*
  ********************************************************************************************************
@@ -207,6 +212,17 @@ TEST_VAULT_KEYS_CURVE25519_s g_test_vault_keys_curve25519[TEST_VAULT_KEY_CURVE25
     },
 };
 
+uint8_t g_test_vault_derive_salt[] = {
+    0x4e, 0x6f, 0x69, 0x73, 0x65, 0x5f, 0x58, 0x58,
+    0x5f, 0x32, 0x35, 0x35, 0x31, 0x39, 0x5f, 0x41,
+    0x45, 0x53, 0x47, 0x43, 0x4d, 0x5f, 0x53, 0x48,
+    0x41, 0x32, 0x35, 0x36, 0x00, 0x00, 0x00, 0x00
+};
+
+uint8_t g_test_vault_derive_info[] = {
+    0x6f, 0x63, 0x6b, 0x61, 0x6d
+};
+
 
 /*
  ********************************************************************************************************
@@ -220,7 +236,7 @@ TEST_VAULT_KEYS_CURVE25519_s g_test_vault_keys_curve25519[TEST_VAULT_KEY_CURVE25
  ********************************************************************************************************
  */
 
-void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
+void test_vault_key_ecdh(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_EC_e ec, uint8_t load_keys)
 {
     OCKAM_ERR err = OCKAM_ERR_NONE;
     uint8_t i = 0;
@@ -234,6 +250,7 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
 
     uint8_t pms_static[TEST_VAULT_PMS_SIZE];
     uint8_t pms_ephemeral[TEST_VAULT_PMS_SIZE];
+    uint8_t static_pub_again[TEST_VAULT_KEY_P256_SIZE];
 
 
     switch(ec) {                                                /* Configure the Key/ECDH tests based on the platform */
@@ -304,7 +321,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
                 p_responder_pub  = &(g_test_vault_keys_curve25519[i].responder_pub[0]);
             }
 
-            err = ockam_vault_key_write(OCKAM_VAULT_KEY_STATIC, /* Write the initiator key to the static slot         */
+            err = ockam_vault_key_write(p_vault,                /* Write the initiator key to the static slot         */
+                                        OCKAM_VAULT_KEY_STATIC,
                                         p_initiator_priv, key_size);
             if(err != OCKAM_ERR_NONE) {
                 test_vault_key_ecdh_print(OCKAM_LOG_ERROR,
@@ -316,7 +334,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
                                           "Static Key Write Success");
             }
                                                                 /* Write the responder key to the epehemral slot      */
-            err = ockam_vault_key_write(OCKAM_VAULT_KEY_EPHEMERAL,
+            err = ockam_vault_key_write(p_vault,
+                                        OCKAM_VAULT_KEY_EPHEMERAL,
                                         p_responder_priv, key_size);
             if(err != OCKAM_ERR_NONE) {
                 test_vault_key_ecdh_print(OCKAM_LOG_ERROR,
@@ -328,7 +347,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
                                           "Ephemeral Key Write Success");
             }
         } else {                                                /* If the platform doesn't support writing keys, then */
-            err = ockam_vault_key_gen(OCKAM_VAULT_KEY_STATIC);  /* generate a static key                              */
+            err = ockam_vault_key_gen(p_vault,                  /* generate a static key                              */
+                                      OCKAM_VAULT_KEY_STATIC);
             if(err != OCKAM_ERR_NONE) {
                 test_vault_key_ecdh_print(OCKAM_LOG_ERROR,
                                           i,
@@ -339,7 +359,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
                                           "Static Key Generate Success");
             }
                                                                 /* Generate an ephemrmal key                          */
-            err = ockam_vault_key_gen(OCKAM_VAULT_KEY_EPHEMERAL);
+            err = ockam_vault_key_gen(p_vault,
+                                      OCKAM_VAULT_KEY_EPHEMERAL);
             if(err != OCKAM_ERR_NONE) {
                 test_vault_key_ecdh_print(OCKAM_LOG_ERROR,
                                           i,
@@ -356,7 +377,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
         /* Key Retrival */
         /* ------------ */
 
-        err = ockam_vault_key_get_pub(OCKAM_VAULT_KEY_STATIC,   /* Get the static public key                          */
+        err = ockam_vault_key_get_pub(p_vault,                  /* Get the static public key                          */
+                                      OCKAM_VAULT_KEY_STATIC,
                                       p_static_pub,
                                       key_size);
         if(err != OCKAM_ERR_NONE) {
@@ -369,7 +391,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
                                       "Get Static Public Key Success");
         }
 
-        err = ockam_vault_key_get_pub(OCKAM_VAULT_KEY_EPHEMERAL,/* Get the ephemeral public key                       */
+        err = ockam_vault_key_get_pub(p_vault,                  /* Get the ephemeral public key                       */
+                                      OCKAM_VAULT_KEY_EPHEMERAL,
                                       p_ephemeral_pub,
                                       key_size);
         if(err != OCKAM_ERR_NONE) {
@@ -410,12 +433,28 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
             }
         }
 
+        err = ockam_vault_key_get_pub(p_vault,                  /* A repeat request is served from the cache and must */
+                                      OCKAM_VAULT_KEY_STATIC,   /* match the key read back the first time             */
+                                      &static_pub_again[0],
+                                      key_size);
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&static_pub_again[0], p_static_pub, key_size) != 0)) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR,
+                                      i,
+                                      "Repeat Static Public Key Invalid");
+        } else {
+            test_vault_key_ecdh_print(OCKAM_LOG_INFO,
+                                      i,
+                                      "Repeat Static Public Key Valid");
+        }
+
 
         /* ----------------- */
         /* ECDH Calculations */
         /* ----------------- */
 
-        err = ockam_vault_ecdh(OCKAM_VAULT_KEY_STATIC,          /* Calculate ECDH with static private/ephemeral pub   */
+        err = ockam_vault_ecdh(p_vault,                         /* Calculate ECDH with static private/ephemeral pub   */
+                               OCKAM_VAULT_KEY_STATIC,
                                p_ephemeral_pub,
                                key_size,
                                &pms_static[0],
@@ -435,7 +474,8 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
                                        key_size);
         }
 
-        err = ockam_vault_ecdh(OCKAM_VAULT_KEY_EPHEMERAL,       /* Calculate ECDH with ephemeral private/static public*/
+        err = ockam_vault_ecdh(p_vault,                         /* Calculate ECDH with ephemeral private/static public*/
+                               OCKAM_VAULT_KEY_EPHEMERAL,
                                p_static_pub,
                                key_size,
                                &pms_ephemeral[0],
@@ -475,6 +515,331 @@ void test_vault_key_ecdh(OCKAM_VAULT_EC_e ec, uint8_t load_keys)
 }
 
 
+/**
+ ********************************************************************************************************
+ *                                         test_vault_key_handle()
+ *
+ * @brief   Test key handles on Curve25519. Imports the known test keys, then fills the key pool,
+ *          holds many generated keys at once and checks every one of them agrees on ECDH with the
+ *          first. Destroyed handles must be rejected, even once their key is handed out again.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_key_handle(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    uint32_t i = 0;
+    uint32_t created = 0;
+    uint8_t failed = 0;
+
+    OCKAM_VAULT_KEY_s *p_initiator = 0;
+    OCKAM_VAULT_KEY_s *p_responder = 0;
+    OCKAM_VAULT_KEY_s *p_reuse = 0;
+    OCKAM_VAULT_KEY_s *p_key[TEST_VAULT_KEY_HANDLE_COUNT];
+
+    uint8_t priv[TEST_VAULT_KEY_CURVE25519_SIZE];
+    uint8_t pub[TEST_VAULT_KEY_HANDLE_COUNT][TEST_VAULT_KEY_CURVE25519_SIZE];
+    uint8_t pms_initiator[TEST_VAULT_PMS_SIZE];
+    uint8_t pms_responder[TEST_VAULT_PMS_SIZE];
+
+
+    do {
+        /* -------------------- */
+        /* Import Known Keypair */
+        /* -------------------- */
+
+        err = ockam_vault_key_handle_create(p_vault, &p_initiator);
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_key_handle_create(p_vault, &p_responder);
+        }
+
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 0, "Key Handle Create Failed");
+            failed = 1;
+            break;
+        }
+
+                                                                /* Import clamps the private key in place, so work    */
+                                                                /* on a copy of the test vector                       */
+        memcpy(&priv[0],
+               &g_test_vault_keys_curve25519[0].initiator_priv[0],
+               TEST_VAULT_KEY_CURVE25519_SIZE);
+        err = ockam_vault_key_handle_import(p_vault, p_initiator, &priv[0], TEST_VAULT_KEY_CURVE25519_SIZE);
+        if(err == OCKAM_ERR_NONE) {
+            memcpy(&priv[0],
+                   &g_test_vault_keys_curve25519[0].responder_priv[0],
+                   TEST_VAULT_KEY_CURVE25519_SIZE);
+            err = ockam_vault_key_handle_import(p_vault, p_responder, &priv[0], TEST_VAULT_KEY_CURVE25519_SIZE);
+        }
+
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_key_handle_get_pub(p_vault, p_initiator, &pub[0][0], TEST_VAULT_KEY_CURVE25519_SIZE);
+        }
+
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&pub[0][0],
+                   &g_test_vault_keys_curve25519[0].initiator_pub[0],
+                   TEST_VAULT_KEY_CURVE25519_SIZE) != 0)) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 0, "Key Handle Import: Public Key Invalid");
+            failed = 1;
+            break;
+        }
+
+        err = ockam_vault_key_handle_ecdh(p_vault,
+                                          p_initiator,
+                                          &g_test_vault_keys_curve25519[0].responder_pub[0],
+                                          TEST_VAULT_KEY_CURVE25519_SIZE,
+                                          &pms_initiator[0],
+                                          TEST_VAULT_PMS_SIZE);
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_key_handle_ecdh(p_vault,
+                                              p_responder,
+                                              &g_test_vault_keys_curve25519[0].initiator_pub[0],
+                                              TEST_VAULT_KEY_CURVE25519_SIZE,
+                                              &pms_responder[0],
+                                              TEST_VAULT_PMS_SIZE);
+        }
+
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&pms_initiator[0], &pms_responder[0], TEST_VAULT_PMS_SIZE) != 0)) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 0, "Key Handle Import: PMS values do not match");
+            failed = 1;
+            break;
+        }
+
+        /* --------------------------- */
+        /* Many Keys Held Concurrently */
+        /* --------------------------- */
+
+        err = ockam_vault_key_pool_fill(p_vault);               /* The first keys come from the pool, the rest are    */
+        if(err != OCKAM_ERR_NONE) {                             /* generated inline once it runs dry                  */
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Pool Fill Failed");
+            failed = 1;
+            break;
+        }
+
+        for(created = 0; created < TEST_VAULT_KEY_HANDLE_COUNT; created++) {
+            err = ockam_vault_key_handle_create(p_vault, &p_key[created]);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            err = ockam_vault_key_handle_generate(p_vault, p_key[created]);
+            if(err == OCKAM_ERR_NONE) {
+                err = ockam_vault_key_handle_get_pub(p_vault,
+                                                     p_key[created],
+                                                     &pub[created][0],
+                                                     TEST_VAULT_KEY_CURVE25519_SIZE);
+            }
+
+            if(err != OCKAM_ERR_NONE) {
+                created++;
+                break;
+            }
+        }
+
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Handle Generate Failed");
+            failed = 1;
+            break;
+        }
+
+        for(i = 1; i < TEST_VAULT_KEY_HANDLE_COUNT; i++) {
+            err = ockam_vault_key_handle_ecdh(p_vault,
+                                              p_key[0],
+                                              &pub[i][0],
+                                              TEST_VAULT_KEY_CURVE25519_SIZE,
+                                              &pms_initiator[0],
+                                              TEST_VAULT_PMS_SIZE);
+            if(err == OCKAM_ERR_NONE) {
+                err = ockam_vault_key_handle_ecdh(p_vault,
+                                                  p_key[i],
+                                                  &pub[0][0],
+                                                  TEST_VAULT_KEY_CURVE25519_SIZE,
+                                                  &pms_responder[0],
+                                                  TEST_VAULT_PMS_SIZE);
+            }
+
+            if((err != OCKAM_ERR_NONE) ||
+               (memcmp(&pms_initiator[0], &pms_responder[0], TEST_VAULT_PMS_SIZE) != 0)) {
+                test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Handle: PMS values do not match");
+                failed = 1;
+                break;
+            }
+        }
+    } while(0);
+
+    for(i = 0; i < created; i++) {
+        err = ockam_vault_key_handle_destroy(p_vault, p_key[i]);
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Handle Destroy Failed");
+            failed = 1;
+        }
+    }
+
+    if(p_initiator != 0) {
+        ockam_vault_key_handle_destroy(p_vault, p_initiator);
+    }
+
+    if(p_responder != 0) {
+        ockam_vault_key_handle_destroy(p_vault, p_responder);
+    }
+
+    if((p_initiator != 0) &&                                    /* A destroyed handle must be rejected                */
+       (ockam_vault_key_handle_destroy(p_vault, p_initiator) == OCKAM_ERR_NONE)) {
+        test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Handle: Destroyed Handle Accepted");
+        failed = 1;
+    }
+
+    if(p_responder != 0) {                                      /* The responder key is reused first. Its old handle  */
+        err = ockam_vault_key_handle_create(p_vault, &p_reuse); /* must not reach the key now behind the new one.     */
+        if(err == OCKAM_ERR_NONE) {
+            if(ockam_vault_key_handle_destroy(p_vault, p_responder) == OCKAM_ERR_NONE) {
+                test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Handle: Stale Handle Accepted");
+                failed = 1;
+            }
+
+            err = ockam_vault_key_handle_destroy(p_vault, p_reuse);
+        }
+
+        if(err != OCKAM_ERR_NONE) {
+            test_vault_key_ecdh_print(OCKAM_LOG_ERROR, 1, "Key Handle: Reused Handle Invalid");
+            failed = 1;
+        }
+    }
+
+    if(!failed) {
+        test_vault_key_ecdh_print(OCKAM_LOG_INFO, 1, "Key Handle: PMS values match");
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        test_vault_ecdh_derive()
+ *
+ * @brief   Derive two AES GCM secrets with a single ECDH derive call and check they encrypt the
+ *          same as secrets built from separate ECDH, HKDF and import calls. Uses the keys left in
+ *          the vault by test_vault_key_ecdh().
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_ecdh_derive(OCKAM_VAULT_s *p_vault, OCKAM_VAULT_EC_e ec)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_SECRET_s *p_fused[TEST_VAULT_DERIVE_SECRET_COUNT] = {0};
+    OCKAM_VAULT_SECRET_s *p_split[TEST_VAULT_DERIVE_SECRET_COUNT] = {0};
+    uint8_t pub[TEST_VAULT_KEY_P256_SIZE];
+    uint8_t pms[TEST_VAULT_PMS_SIZE];
+    uint8_t okm[TEST_VAULT_DERIVE_KEY_SIZE * TEST_VAULT_DERIVE_SECRET_COUNT];
+    uint8_t iv[12] = {0};
+    uint8_t text[TEST_VAULT_DERIVE_KEY_SIZE] = {0};
+    uint8_t tag_fused[TEST_VAULT_DERIVE_KEY_SIZE];
+    uint8_t tag_split[TEST_VAULT_DERIVE_KEY_SIZE];
+    uint32_t key_size = TEST_VAULT_KEY_P256_SIZE;
+    uint32_t i = 0;
+
+
+    if(ec == OCKAM_VAULT_EC_CURVE25519) {
+        key_size = TEST_VAULT_KEY_CURVE25519_SIZE;
+    }
+
+    do {
+        err = ockam_vault_key_get_pub(p_vault,
+                                      OCKAM_VAULT_KEY_EPHEMERAL,
+                                      &pub[0], key_size);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_ecdh_derive(p_vault,
+                                      OCKAM_VAULT_KEY_STATIC,
+                                      &pub[0], key_size,
+                                      &g_test_vault_derive_salt[0], sizeof(g_test_vault_derive_salt),
+                                      &g_test_vault_derive_info[0], sizeof(g_test_vault_derive_info),
+                                      TEST_VAULT_DERIVE_KEY_SIZE,
+                                      &p_fused[0], TEST_VAULT_DERIVE_SECRET_COUNT);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_ecdh(p_vault,                         /* Same derivation one stage at a time                */
+                               OCKAM_VAULT_KEY_STATIC,
+                               &pub[0], key_size,
+                               &pms[0], TEST_VAULT_PMS_SIZE);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_hkdf(p_vault,
+                               &g_test_vault_derive_salt[0], sizeof(g_test_vault_derive_salt),
+                               &pms[0], TEST_VAULT_PMS_SIZE,
+                               &g_test_vault_derive_info[0], sizeof(g_test_vault_derive_info),
+                               &okm[0], sizeof(okm));
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        for(i = 0; i < TEST_VAULT_DERIVE_SECRET_COUNT; i++) {
+            err = ockam_vault_secret_import(p_vault,
+                                            &p_split[i],
+                                            &okm[i * TEST_VAULT_DERIVE_KEY_SIZE], TEST_VAULT_DERIVE_KEY_SIZE);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+
+                                                                /* Tag over the same AAD must match for both secrets  */
+            err = ockam_vault_secret_aes_gcm_encrypt(p_split[i],
+                                                     &iv[0], sizeof(iv),
+                                                     &text[0], sizeof(text),
+                                                     &tag_split[0], sizeof(tag_split),
+                                                     0, 0,
+                                                     0, 0);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            err = ockam_vault_secret_aes_gcm_encrypt(p_fused[i],
+                                                     &iv[0], sizeof(iv),
+                                                     &text[0], sizeof(text),
+                                                     &tag_fused[0], sizeof(tag_fused),
+                                                     0, 0,
+                                                     0, 0);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+
+            if(memcmp(&tag_fused[0], &tag_split[0], sizeof(tag_fused)) != 0) {
+                err = OCKAM_ERR_VAULT_HOST_AES_FAIL;
+                break;
+            }
+        }
+    } while(0);
+
+    for(i = 0; i < TEST_VAULT_DERIVE_SECRET_COUNT; i++) {
+        if(p_fused[i] != 0) {
+            ockam_vault_secret_free(p_fused[i]);
+        }
+
+        if(p_split[i] != 0) {
+            ockam_vault_secret_free(p_split[i]);
+        }
+    }
+
+    if(err != OCKAM_ERR_NONE) {
+        test_vault_key_ecdh_print(OCKAM_LOG_ERROR,
+                                  0,
+                                  "ECDH Derive Secrets Invalid");
+    } else {
+        test_vault_key_ecdh_print(OCKAM_LOG_INFO,
+                                  0,
+                                  "ECDH Derive Secrets Valid");
+    }
+}
+
+
 /**
  ********************************************************************************************************
  *                                          test_vault_key_ecdh_print()
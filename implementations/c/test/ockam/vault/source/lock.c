@@ -0,0 +1,242 @@
+/**
+ ********************************************************************************************************
+ * @file    lock.c
+ * @brief   Ockam Vault common tests for instance locking
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                             INCLUDE FILES                                            *
+ ********************************************************************************************************
+ */
+
+#include <ockam/error.h>
+#include <ockam/kal.h>
+#include <ockam/log.h>
+#include <ockam/vault.h>
+
+#include <test_vault.h>
+
+
+/*
+ ********************************************************************************************************
+ *                                                DEFINES                                               *
+ ********************************************************************************************************
+ */
+
+#define TEST_VAULT_LOCK_RUNS                        1000u       /* Key generations the holding thread runs at most    */
+#define TEST_VAULT_LOCK_PUB_SIZE                    64u         /* Large enough for either curve                      */
+
+
+/*
+ ********************************************************************************************************
+ *                                               CONSTANTS                                              *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES                                             *
+ ********************************************************************************************************
+ */
+
+
+/**
+ *******************************************************************************
+ * @struct  TEST_VAULT_LOCK_s
+ * @brief   State shared with the thread holding the instance lock
+ *******************************************************************************
+ */
+typedef struct {
+    OCKAM_VAULT_s *p_vault;                                     /*!< Instance both threads use                        */
+    volatile uint8_t stop;                                      /*!< Set once the busy result has been seen           */
+    volatile uint8_t done;                                      /*!< Set when the holding thread returns              */
+    OCKAM_ERR err;                                              /*!< First failure seen by the holding thread         */
+} TEST_VAULT_LOCK_s;
+
+
+/*
+ ********************************************************************************************************
+ *                                          FUNCTION PROTOTYPES                                         *
+ ********************************************************************************************************
+ */
+
+void test_vault_lock_hold(void *p_arg);
+void test_vault_lock_print(OCKAM_LOG_e level, uint32_t test_case, char *p_str);
+
+
+/*
+ ********************************************************************************************************
+ *                                            GLOBAL VARIABLES                                          *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                           GLOBAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+/*
+ ********************************************************************************************************
+ *                                            LOCAL FUNCTIONS                                           *
+ ********************************************************************************************************
+ */
+
+
+/**
+ ********************************************************************************************************
+ *                                          test_vault_lock()
+ *
+ * @brief   Start a non-blocking vault instance and keep its lock busy with key generation on another
+ *          thread. A key call made meanwhile must fail with OCKAM_ERR_VAULT_BUSY instead of waiting,
+ *          succeed once the instance is idle, and the instance must still free.
+ *
+ * @param   p_cfg[in]   Configuration of the vault under test. Only the lock options are changed.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_lock(OCKAM_VAULT_CFG_s *p_cfg)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_CFG_s cfg = *p_cfg;
+    OCKAM_KAL_THREAD thread;
+    TEST_VAULT_LOCK_s hold;
+    uint8_t pub_key[TEST_VAULT_LOCK_PUB_SIZE];
+    uint32_t pub_key_size = 0;
+    uint8_t started = 0;
+    uint8_t busy = 0;
+
+
+    hold.p_vault = 0;
+    hold.stop = 0;
+    hold.done = 0;
+    hold.err = OCKAM_ERR_NONE;
+
+    pub_key_size = (cfg.ec == OCKAM_VAULT_EC_P256) ? 64u : 32u;
+
+    do {
+        cfg.lock_opt = OCKAM_KAL_OPT_NON_BLOCKING;
+        cfg.lock_timeout_ms = 0;
+
+        err = ockam_vault_init(&(hold.p_vault), &cfg);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_key_gen(hold.p_vault, OCKAM_VAULT_KEY_STATIC);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_kal_thread_create(&thread, test_vault_lock_hold, &hold);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+        started = 1;
+
+        while((busy == 0) && (hold.done == 0)) {                /* Try until a call lands while the lock is held      */
+            err = ockam_vault_key_get_pub(hold.p_vault,
+                                          OCKAM_VAULT_KEY_STATIC,
+                                          &pub_key[0], pub_key_size);
+            if(err == OCKAM_ERR_VAULT_BUSY) {
+                busy = 1;
+            } else if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+        if((err != OCKAM_ERR_NONE) && (err != OCKAM_ERR_VAULT_BUSY)) {
+            break;
+        }
+
+        hold.stop = 1;
+        ockam_kal_thread_join(&thread);
+        started = 0;
+
+        if((busy == 0) || (hold.err != OCKAM_ERR_NONE)) {
+            err = (hold.err != OCKAM_ERR_NONE) ? hold.err : OCKAM_ERR_VAULT_BUSY;
+            break;
+        }
+
+        err = ockam_vault_key_get_pub(hold.p_vault,             /* The same call succeeds with the instance idle      */
+                                      OCKAM_VAULT_KEY_STATIC,
+                                      &pub_key[0], pub_key_size);
+    } while(0);
+
+    if(started) {
+        hold.stop = 1;
+        ockam_kal_thread_join(&thread);
+    }
+
+    if(hold.p_vault != 0) {
+        if(ockam_vault_free(hold.p_vault) != OCKAM_ERR_NONE) {
+            err = OCKAM_ERR_VAULT_BUSY;
+        }
+    }
+
+    if(err != OCKAM_ERR_NONE) {
+        test_vault_lock_print(OCKAM_LOG_ERROR,
+                              0,
+                              "Non-Blocking Lock Invalid");
+    } else {
+        test_vault_lock_print(OCKAM_LOG_INFO,
+                              0,
+                              "Non-Blocking Lock Valid");
+    }
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        test_vault_lock_hold()
+ *
+ * @brief   Keep the instance lock busy by generating keys until told to stop
+ *
+ * @param   p_arg       The TEST_VAULT_LOCK_s shared with the test
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_lock_hold(void *p_arg)
+{
+    TEST_VAULT_LOCK_s *p_hold = (TEST_VAULT_LOCK_s*) p_arg;
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    uint32_t i = 0;
+
+
+    for(i = 0; (i < TEST_VAULT_LOCK_RUNS) && (p_hold->stop == 0); i++) {
+        err = ockam_vault_key_gen(p_hold->p_vault, OCKAM_VAULT_KEY_EPHEMERAL);
+        if((err != OCKAM_ERR_NONE) && (err != OCKAM_ERR_VAULT_BUSY)) {
+            p_hold->err = err;                                  /* Busy only means the test thread won the lock       */
+            break;
+        }
+    }
+
+    p_hold->done = 1;
+}
+
+
+/**
+ ********************************************************************************************************
+ *                                        test_vault_lock_print()
+ *
+ * @brief   Lock test print function
+ *
+ * @param   level       The level at which to log the message at
+ *
+ * @param   test_case   The test case number associated with the message
+ *
+ * @param   p_str       Null-terminated string message to print
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_lock_print(OCKAM_LOG_e level, uint32_t test_case, char *p_str)
+{
+    test_vault_print( level,
+                     "LOCK",
+                      test_case,
+                      p_str);
+}
@@ -24,6 +24,7 @@
  */
 
 #define TEST_VAULT_RAND_NUM_SIZE                    32u
+#define TEST_VAULT_RAND_NONCE_SIZE                  8u          /* Small enough to come from the random buffer        */
 
 /*
  ********************************************************************************************************
@@ -50,6 +51,7 @@
  */
 
 uint8_t g_rand_num[TEST_VAULT_RAND_NUM_SIZE] = {0};
+uint8_t g_rand_nonce[2][TEST_VAULT_RAND_NONCE_SIZE] = {{0}};
 
 
 /*
@@ -69,17 +71,19 @@ uint8_t g_rand_num[TEST_VAULT_RAND_NUM_SIZE] = {0};
  ********************************************************************************************************
  *                                          test_vault_random()
  *
- * @brief   Ensure the specified ockam vault random function can generate a number
+ * @brief   Ensure the specified ockam vault random function can generate a number, and that small
+ *          requests served from the random buffer never repeat bytes
  *
  ********************************************************************************************************
  */
 
-void test_vault_random()
+void test_vault_random(OCKAM_VAULT_s *p_vault)
 {
     OCKAM_ERR err = OCKAM_ERR_NONE;
 
 
-    err = ockam_vault_random((uint8_t*) &g_rand_num,            /* Generate a random number                           */
+    err = ockam_vault_random(p_vault,                           /* Generate a random number                           */
+                             (uint8_t*) &g_rand_num,
                              TEST_VAULT_RAND_NUM_SIZE);
     if(err != OCKAM_ERR_NONE) {
         test_vault_print(OCKAM_LOG_ERROR,
@@ -97,5 +101,26 @@ void test_vault_random()
                            "Random Number Generation",
                             &g_rand_num[0],
                             TEST_VAULT_RAND_NUM_SIZE);
+
+    err = ockam_vault_random_refill(p_vault);                   /* Fill the buffers then take two small numbers       */
+    if(err == OCKAM_ERR_NONE) {
+        err = ockam_vault_random(p_vault, &g_rand_nonce[0][0], TEST_VAULT_RAND_NONCE_SIZE);
+    }
+    if(err == OCKAM_ERR_NONE) {
+        err = ockam_vault_random(p_vault, &g_rand_nonce[1][0], TEST_VAULT_RAND_NONCE_SIZE);
+    }
+
+    if((err != OCKAM_ERR_NONE) ||
+       (memcmp(&g_rand_nonce[0][0], &g_rand_nonce[1][0], TEST_VAULT_RAND_NONCE_SIZE) == 0)) {
+        test_vault_print(OCKAM_LOG_ERROR,
+                         "RANDOM",
+                         TEST_VAULT_NO_TEST_CASE,
+                         "Buffered random number generation failed");
+    } else {
+        test_vault_print(OCKAM_LOG_INFO,
+                         "RANDOM",
+                         TEST_VAULT_NO_TEST_CASE,
+                         "Buffered Random Number Generation Success");
+    }
 }
 
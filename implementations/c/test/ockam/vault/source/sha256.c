@@ -25,6 +25,8 @@
  */
 
 #define TEST_VAULT_SHA256_CASES                     65u
+#define TEST_VAULT_SHA256_LONG_SIZE                 1000000u    /* NIST long message, one million 'a' characters      */
+#define TEST_VAULT_SHA256_LONG_CHUNK                1000u       /* Size of each update of the long message            */
 
 
 /*
@@ -69,6 +71,12 @@ void test_vault_sha256_print(OCKAM_LOG_e level, uint32_t test_case, char *p_str)
  */
 
 
+uint8_t g_sha256_long_digest[] =
+{
+    0xCD, 0xC7, 0x6E, 0x5C, 0x99, 0x14, 0xFB, 0x92, 0x81, 0xA1, 0xC7, 0xE2, 0x84, 0xD7, 0x3E, 0x67,
+    0xF1, 0x80, 0x9A, 0x48, 0xA4, 0x97, 0x20, 0x0E, 0x04, 0x6D, 0x39, 0xCC, 0xC7, 0x11, 0x2C, 0xD0
+};
+
 TEST_VAULT_SHA256_DATA_s g_sha256_data[] =
 {
     {
@@ -1104,7 +1112,7 @@ TEST_VAULT_SHA256_DATA_s g_sha256_data[] =
  ********************************************************************************************************
  */
 
-void test_vault_sha256()
+void test_vault_sha256(OCKAM_VAULT_s *p_vault)
 {
     OCKAM_ERR err = OCKAM_ERR_NONE;
     uint32_t i = 0;
@@ -1115,7 +1123,8 @@ void test_vault_sha256()
 
         uint8_t sha256_digest[32];
 
-        err = ockam_vault_sha256(&(g_sha256_data[i].msg[0]),    /* Calculate SHA256 using test vectors                */
+        err = ockam_vault_sha256(p_vault,                       /* Calculate SHA256 using test vectors                */
+                                 &(g_sha256_data[i].msg[0]),
                                  (g_sha256_data[i].len / 8),
                                  &sha256_digest[0],
                                  32);
@@ -1154,6 +1163,86 @@ void test_vault_sha256()
 }
 
 
+/**
+ ********************************************************************************************************
+ *                                        test_vault_sha256_stream()
+ *
+ * @brief   Hash each test vector in two uneven parts with a streaming context, then hash a message
+ *          too large for the one-shot 16-bit length in fixed size chunks.
+ *
+ ********************************************************************************************************
+ */
+
+void test_vault_sha256_stream(OCKAM_VAULT_s *p_vault)
+{
+    OCKAM_ERR err = OCKAM_ERR_NONE;
+    OCKAM_VAULT_SHA256_CTX_s *p_ctx = 0;
+    uint8_t sha256_digest[32];
+    uint8_t chunk[TEST_VAULT_SHA256_LONG_CHUNK];
+    uint32_t split = 0;
+    uint32_t i = 0;
+
+
+    for(i = 0; i < TEST_VAULT_SHA256_CASES; i++) {
+        split = (g_sha256_data[i].len / 8) / 3;
+
+        err = ockam_vault_sha256_ctx_init(p_vault, &p_ctx);
+        if(err != OCKAM_ERR_NONE) {
+            break;
+        }
+
+        err = ockam_vault_sha256_ctx_update(p_ctx, &(g_sha256_data[i].msg[0]), split);
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_sha256_ctx_update(p_ctx,
+                                                &(g_sha256_data[i].msg[split]),
+                                                (g_sha256_data[i].len / 8) - split);
+        }
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_sha256_ctx_finish(p_ctx, &sha256_digest[0], 32);
+        }
+
+        ockam_vault_sha256_ctx_free(p_ctx);
+
+        if((err != OCKAM_ERR_NONE) ||
+           (memcmp(&(g_sha256_data[i].digest[0]), &sha256_digest[0], 32) != 0)) {
+            test_vault_sha256_print(OCKAM_LOG_ERROR,
+                                    i,
+                                    "SHA256 Streaming Calculation Invalid");
+            return;
+        }
+    }
+
+    memset(&chunk[0], 'a', TEST_VAULT_SHA256_LONG_CHUNK);
+
+    err = ockam_vault_sha256_ctx_init(p_vault, &p_ctx);
+    if(err == OCKAM_ERR_NONE) {
+        for(i = 0; i < (TEST_VAULT_SHA256_LONG_SIZE / TEST_VAULT_SHA256_LONG_CHUNK); i++) {
+            err = ockam_vault_sha256_ctx_update(p_ctx, &chunk[0], TEST_VAULT_SHA256_LONG_CHUNK);
+            if(err != OCKAM_ERR_NONE) {
+                break;
+            }
+        }
+
+        if(err == OCKAM_ERR_NONE) {
+            err = ockam_vault_sha256_ctx_finish(p_ctx, &sha256_digest[0], 32);
+        }
+
+        ockam_vault_sha256_ctx_free(p_ctx);
+    }
+
+    if((err != OCKAM_ERR_NONE) ||
+       (memcmp(&g_sha256_long_digest[0], &sha256_digest[0], 32) != 0)) {
+        test_vault_sha256_print(OCKAM_LOG_ERROR,
+                                0,
+                                "SHA256 Streaming Long Message Invalid");
+    } else {
+        test_vault_sha256_print(OCKAM_LOG_INFO,
+                                0,
+                                "SHA256 Streaming Calculations Valid");
+    }
+}
+
+
 /**
  ********************************************************************************************************
  *                                          test_vault_sha256_print()